@@ -0,0 +1,114 @@
+/*
+ * \brief Append content to an append blob of Azure storage by coalescing small writes into Append Block requests
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#ifndef QAZURESTORAGEAPPENDBLOBWRITER_H
+#define QAZURESTORAGEAPPENDBLOBWRITER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QTimer>
+#include <QtNetwork>
+
+#include "QAzureStorageRestApi_global.h"
+
+class QAzureStorageRestApi;
+
+class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStorageAppendBlobWriter : public QObject
+{
+  Q_OBJECT
+
+public:
+  //! Max size of an Append Block request accepted by Azure
+  static const int maxAppendBlockSizeInBytes = 4 * 1024 * 1024;
+
+  /*!
+   * \brief QAzureStorageAppendBlobWriter Append content to an append blob (remote path: \s container/\s blobName)
+   *
+   * Content given to \s write is buffered and sent with one Append Block request when the buffer reaches
+   * \s maxBlockSizeInBytes or when \s flushIntervalInMs elapsed since the first buffered write.
+   * Only one Append Block request is sent at a time so that the content keeps the order of the writes.
+   *
+   * \param api Azure storage API used to send the requests
+   * \param container Container of the file
+   * \param blobName Name of the file (append blob) to append content to
+   * \param createIfNeeded (optional) Create the append blob if it does not exist yet
+   * \param flushIntervalInMs (optional) Max time a write is buffered before being sent (in ms)
+   * \param maxBlockSizeInBytes (optional) Max size of each Append Block request (4 MiB max)
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer of each request (in sec)
+   * \param parent (optional) QObject parent
+   */
+  QAzureStorageAppendBlobWriter(QAzureStorageRestApi* api, const QString& container, const QString& blobName,
+                                const bool& createIfNeeded = true, const int& flushIntervalInMs = 1000,
+                                const int& maxBlockSizeInBytes = maxAppendBlockSizeInBytes,
+                                const int& timeoutInSec = -1, QObject* parent = nullptr);
+
+  //! Size of the append blob including all appended blocks (-1 until the blob properties are received)
+  qint64 blobSize() const;
+  //! Number of bytes written but not appended to the blob yet (including the block being sent)
+  qint64 pendingBytes() const;
+  //! True if the writer stopped after an error (see \s failed)
+  bool isFailed() const;
+
+public slots:
+  /*!
+   * \brief write Buffer content to append at the end of the blob
+   *
+   * \param content Content to append (after the content of the previous writes)
+   */
+  void write(const QByteArray& content);
+
+  /*!
+   * \brief flush Send all buffered content without waiting for the flush interval
+   *
+   * \s idle is emitted once all content is appended.
+   */
+  void flush();
+
+signals:
+  //! Emitted each time a block is appended (\s blobSize is the size of the blob after the block)
+  void appended(qint64 blobSize);
+
+  //! Emitted when all written content is appended to the blob
+  void idle();
+
+  //! Emitted when the content can't be appended anymore (writes are ignored afterwards)
+  void failed(QNetworkReply::NetworkError error);
+
+private:
+  void start();
+  void sendNextBlock();
+  void onPropertiesFinished(QNetworkReply* reply);
+  void onCreateFinished(QNetworkReply* reply);
+  void onAppendFinished(QNetworkReply* reply);
+  void onResyncFinished(QNetworkReply* reply, const QNetworkReply::NetworkError& appendError);
+  void onBlockAppended();
+  void fail(const QNetworkReply::NetworkError& error);
+
+private:
+  QAzureStorageRestApi* m_api;
+  QString m_container;
+  QString m_blobName;
+  bool m_createIfNeeded;
+  int m_maxBlockSizeInBytes;
+  int m_timeoutInSec;
+
+  QTimer m_flushTimer;
+  QByteArray m_buffer;
+  QByteArray m_sendingBlock;
+  QNetworkReply* m_reply = nullptr;
+  qint64 m_blobSize = -1;
+  int m_failedAttempts = 0;
+  bool m_isFlushDue = false;
+  bool m_isFlushRequested = false;
+  bool m_isStarted = false;
+  bool m_isFailed = false;
+};
+
+#endif // QAZURESTORAGEAPPENDBLOBWRITER_H
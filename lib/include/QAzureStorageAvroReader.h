@@ -0,0 +1,78 @@
+/*
+ * \brief Streaming decoder of Avro object container files (format of the Azure storage change feed)
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#ifndef QAZURESTORAGEAVROREADER_H
+#define QAZURESTORAGEAVROREADER_H
+
+#include <QByteArray>
+#include <QJsonValue>
+#include <QList>
+#include <QMap>
+#include <QVariant>
+
+#include "QAzureStorageRestApi_global.h"
+
+/*!
+ * \brief The QAzureStorageAvroReader class decodes an Avro object container file while receiving it
+ *
+ * The records are decoded block by block as soon as a block is complete (only the incomplete block is kept in memory),
+ * following the schema of the file: records and maps are decoded as QVariantMap, arrays as QVariantList,
+ * enums as the name of their symbol, unions as their value and strings as QString.
+ * Only the "null" codec is supported (codec of the Azure storage change feed).
+ */
+class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStorageAvroReader
+{
+public:
+  /*!
+   * \brief append Decode the records completed by \p data
+   *
+   * \param data Next received bytes of the file
+   *
+   * \return false if the file is invalid (see \s errorString)
+   */
+  bool append(const QByteArray& data);
+
+  //! Records decoded since the last call (in the order of the file)
+  QList<QVariant> takeRecords();
+
+  bool isHeaderRead() const;
+  //! Check that no incomplete header or block is waiting for more data
+  bool isComplete() const;
+  bool hasError() const;
+  QString errorString() const;
+
+private:
+  struct Input
+  {
+    const char* position;
+    const char* end;
+  };
+
+  bool readHeader(bool& isIncomplete);
+  bool readBlock(bool& isIncomplete);
+  bool parseSchema(const QByteArray& schema);
+  void registerNamedTypes(const QJsonValue& schema, const QString& parentNamespace);
+  bool decodeValue(const QJsonValue& schema, Input& input, QVariant& value, const int& depth) const;
+  bool setError(const QString& errorString);
+
+  static bool readLong(Input& input, qint64& value);
+  static bool readBytes(Input& input, QByteArray& value);
+
+private:
+  QByteArray m_buffer;
+  bool m_isHeaderRead = false;
+  QJsonValue m_schema;
+  QMap<QString, QJsonValue> m_namedTypes;
+  QByteArray m_syncMarker;
+  QList<QVariant> m_records;
+  QString m_errorString;
+};
+
+#endif // QAZURESTORAGEAVROREADER_H
@@ -0,0 +1,79 @@
+/*
+ * \brief Token bucket limiting the bandwidth used by the transfers with Azure storage
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#ifndef QAZURESTORAGEBANDWIDTHLIMITER_H
+#define QAZURESTORAGEBANDWIDTHLIMITER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QIODevice>
+
+#include "QAzureStorageRestApi_global.h"
+
+/*!
+ * \brief The QAzureStorageBandwidthLimiter class is a token bucket refilled at the limited rate
+ *
+ * The bucket only holds 100 ms of bandwidth so that the transfers are paced smoothly instead of sending bursts then waiting.
+ * A limiter can have a parent limiter (for example a transfer limiter and the global limiter of the API):
+ * the bytes are only granted if both limits allow them.
+ */
+class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStorageBandwidthLimiter
+{
+public:
+  /*!
+   * \brief QAzureStorageBandwidthLimiter Bandwidth limiter
+   * \param bytesPerSecond (optional) Max bandwidth (unlimited if 0 or negative)
+   * \param parentLimiter (optional) Limiter which must also allow the bytes (not owned)
+   */
+  explicit QAzureStorageBandwidthLimiter(const qint64& bytesPerSecond = 0, QAzureStorageBandwidthLimiter* parentLimiter = nullptr);
+
+  //! Change the max bandwidth (unlimited if 0 or negative), can be changed while transferring
+  void setRate(const qint64& bytesPerSecond);
+  qint64 rate() const;
+
+  //! Is this limiter or one of its parents limited ?
+  bool isLimited() const;
+
+  /*!
+   * \brief acquire Take the bytes allowed right now (from this limiter and its parents)
+   *
+   * \param maxBytes Number of bytes to transfer
+   *
+   * \return Number of bytes allowed (between 0 and \p maxBytes)
+   */
+  qint64 acquire(const qint64& maxBytes);
+
+  //! Time to wait until a part of \p maxBytes can be acquired (0 if bytes can be acquired now)
+  int waitTimeInMs(const qint64& maxBytes);
+
+  /*!
+   * \brief createThrottledDevice Create a sequential device reading \p content paced by this limiter (to upload it)
+   *
+   * \param content Content to read
+   * \param parent (optional) QObject parent
+   *
+   * \return Opened device (readyRead is emitted each time the limiter allows more bytes)
+   */
+  QIODevice* createThrottledDevice(const QByteArray& content, QObject* parent = nullptr);
+
+private:
+  Q_DISABLE_COPY(QAzureStorageBandwidthLimiter)
+
+  void refill();
+  qint64 bucketSize() const;
+
+  qint64 m_rate;
+  QAzureStorageBandwidthLimiter* m_parentLimiter;
+  qint64 m_tokens = 0;
+  QElapsedTimer m_refillTimer;
+  qint64 m_lastRefillInNs = 0;
+};
+
+#endif // QAZURESTORAGEBANDWIDTHLIMITER_H
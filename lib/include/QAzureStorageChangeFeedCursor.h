@@ -0,0 +1,76 @@
+/*
+ * \brief Local cursor of the events of the Azure storage change feed already consumed (used to resume the change feed)
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#ifndef QAZURESTORAGECHANGEFEEDCURSOR_H
+#define QAZURESTORAGECHANGEFEEDCURSOR_H
+
+#include <QMap>
+#include <QPair>
+#include <QString>
+
+#include "QAzureStorageRestApi_global.h"
+
+/*!
+ * \brief The QAzureStorageChangeFeedCursor class keeps in a small local file the position of the change feed already consumed:
+ *        current segment (hour of events) and, for each shard of this segment, current chunk (Avro file) and number of its events consumed.
+ *
+ * The cursor is written in a temporary file renamed once complete: a crash while saving keeps the previous cursor.
+ */
+class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStorageChangeFeedCursor
+{
+public:
+  /*!
+   * \brief QAzureStorageChangeFeedCursor Cursor of the change feed
+   * \param cursorPath (optional) Path of the local cursor file (cursor disabled if empty: the change feed is read from its start)
+   */
+  explicit QAzureStorageChangeFeedCursor(const QString& cursorPath = QString());
+
+  bool isEnabled() const;
+  QString cursorPath() const;
+
+  /*!
+   * \brief load Load the cursor file
+   *
+   * \return true if a valid cursor was loaded, otherwise the cursor is at the start of the change feed
+   */
+  bool load();
+
+  /*!
+   * \brief save Replace the cursor file by the current position
+   *
+   * \return false if the cursor is disabled or could not be written
+   */
+  bool save();
+
+  //! Manifest of the current segment ("idx/segments/..." in $blobchangefeed, empty at the start of the change feed)
+  QString segmentPath() const;
+  //! Are all the events of the current segment consumed ?
+  bool isSegmentDone() const;
+  //! Move to \p segmentPath (the positions of the shards are cleared if the segment changes)
+  void setSegment(const QString& segmentPath, const bool& isDone);
+
+  /*!
+   * \brief shardPosition Position in a shard of the current segment
+   *
+   * \param shardPath Prefix of the chunks of the shard
+   * \param[out] chunkPath Chunk being consumed (empty if the shard was not started)
+   * \param[out] eventCount Number of events of \p chunkPath already consumed
+   */
+  void shardPosition(const QString& shardPath, QString& chunkPath, qint64& eventCount) const;
+  void setShardPosition(const QString& shardPath, const QString& chunkPath, const qint64& eventCount);
+
+private:
+  QString m_cursorPath;
+  QString m_segmentPath;
+  bool m_isSegmentDone = false;
+  QMap<QString, QPair<QString, qint64> > m_shards;
+};
+
+#endif // QAZURESTORAGECHANGEFEEDCURSOR_H
@@ -0,0 +1,132 @@
+/*
+ * \brief Read the events of the Azure storage change feed since the last read (cost proportional to the changes, not to the containers)
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#ifndef QAZURESTORAGECHANGEFEEDJOB_H
+#define QAZURESTORAGECHANGEFEEDJOB_H
+
+#include <QDateTime>
+#include <QList>
+#include <QMap>
+#include <QStringList>
+#include <QVariant>
+#include <QtNetwork>
+
+#include "QAzureStorageRestApi_global.h"
+#include "QAzureStorageJob.h"
+#include "QAzureStorageAvroReader.h"
+#include "QAzureStorageChangeFeedCursor.h"
+
+class QAzureStorageRestApi;
+class QAzureStorageListJob;
+
+class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStorageChangeFeedJob : public QAzureStorageJob
+{
+  Q_OBJECT
+
+public:
+  /*!
+   * \brief QAzureStorageChangeFeedJob Read the events of the change feed ($blobchangefeed container) after the position of a local cursor
+   *
+   * Use \s QAzureStorageRestApi::readChangeFeed instead of creating the job manually.
+   *
+   * \param api Azure storage API used to send the requests
+   * \param cursorPath Local cursor of the events already read (read from the start of the change feed if empty)
+   * \param container Only report the events of this container (all containers if empty)
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer of each request (in sec)
+   * \param parent (optional) QObject parent
+   */
+  QAzureStorageChangeFeedJob(QAzureStorageRestApi* api, const QString& cursorPath, const QString& container,
+                             const int& timeoutInSec = -1, QObject* parent = nullptr);
+
+  //! Number of events reported so far
+  qint64 eventCount() const;
+  //! Events are available until this time (invalid until the change feed metadata is read)
+  QDateTime lastConsumable() const;
+
+  /*!
+   * \brief parseSubject Get the container and the blob of an event
+   *
+   * \param subject Subject of the event ("/blobServices/default/containers/<container>/blobs/<blob>")
+   * \param[out] container Container of the blob
+   * \param[out] blobName Name of the blob
+   *
+   * \return false if \p subject is not the subject of a blob
+   */
+  static bool parseSubject(const QString& subject, QString& container, QString& blobName);
+
+public slots:
+  /*!
+   * \brief start Read the consumable segments (one per hour) after the cursor, chunk after chunk
+   *
+   * Each chunk (Avro file) is decoded while it is downloaded: \s eventsReceived and \s filesChanged are emitted
+   * for each decoded block of events. The cursor is saved after each chunk and when the job finishes (even with an error):
+   * the events emitted are not read again, unless the application stops before the cursor is saved.
+   * \s progress is emitted with the number of segments read.
+   */
+  void start() override;
+
+signals:
+  //! Emitted with the next events (Avro records of the change feed: "eventType", "subject", "eventTime", "data", ...)
+  void eventsReceived(const QList<QVariantMap>& events);
+
+  /*!
+   * \brief filesChanged Emitted with the files of \p container created or deleted by the next events (last event of each file)
+   *
+   * \p updatedFiles have the keys of \s QAzureStorageRestApi::parseFileList ("Name", "Content-Length", "Last-Modified", "Etag", "BlobType"):
+   * they can be applied directly to a \s QAzureStorageInventory of \p container.
+   */
+  void filesChanged(const QString& container, const QList< QMap<QString,QString> >& updatedFiles, const QStringList& deletedNames);
+
+protected:
+  void cleanup() override;
+
+private:
+  QNetworkReply* requestFile(const QString& blobName);
+  void onSegmentsMetaFinished(QNetworkReply* reply);
+  void listNextSegments();
+  void onSegmentsListed(const QList< QMap<QString,QString> >& files);
+  void startNextSegment();
+  void onSegmentMetaFinished(QNetworkReply* reply);
+  void startNextShard();
+  void onChunksListed(const QList< QMap<QString,QString> >& files);
+  void startNextChunk();
+  void onChunkDataReceived(QNetworkReply* reply);
+  void onChunkFinished(QNetworkReply* reply);
+  void onListingFinished(const QNetworkReply::NetworkError& errorCode, const bool& isListingSegments);
+  void reportEvents(const QList<QVariant>& records);
+  void reportFiles(const QList<QVariantMap>& events);
+
+private:
+  QAzureStorageRestApi* m_api;
+  QAzureStorageChangeFeedCursor m_cursor;
+  QString m_container;
+  int m_timeoutInSec;
+
+  QDateTime m_lastConsumable;
+  QNetworkReply* m_runningReply = nullptr;
+  QAzureStorageListJob* m_listJob = nullptr;
+  QStringList m_segmentPrefixes;
+  QStringList m_segments;
+  int m_segmentCount = 0;
+  int m_segmentsDone = 0;
+  QString m_currentSegment;
+  QStringList m_shards;
+  QString m_currentShard;
+  QStringList m_chunks;
+  QString m_currentChunk;
+  qint64 m_chunkEventIndex = 0;
+  qint64 m_chunkEventsToSkip = 0;
+  QAzureStorageAvroReader m_avroReader;
+  qint64 m_eventCount = 0;
+
+  bool m_isStarted = false;
+};
+
+#endif // QAZURESTORAGECHANGEFEEDJOB_H
@@ -0,0 +1,53 @@
+/*
+ * \brief Checksums (CRC64, MD5) used by Azure storage to check the integrity of the transferred content
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#ifndef QAZURESTORAGECHECKSUM_H
+#define QAZURESTORAGECHECKSUM_H
+
+#include <QByteArray>
+#include <QString>
+
+#include "QAzureStorageRestApi_global.h"
+
+class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStorageChecksum
+{
+public:
+  /*!
+   * \brief crc64 Compute the CRC64 used by Azure storage (x-ms-content-crc64)
+   *
+   * The CRC can be computed incrementally: crc64(b, crc64(a)) == crc64(a + b)
+   *
+   * \param data Data to add to the CRC
+   * \param size Number of bytes of \p data
+   * \param previousCrc (optional) CRC of the previous data
+   *
+   * \return CRC64 of the previous data followed by \p data
+   */
+  static quint64 crc64(const char* data, const qint64& size, const quint64& previousCrc = 0);
+  static quint64 crc64(const QByteArray& data, const quint64& previousCrc = 0);
+
+  /*!
+   * \brief crc32 Compute the CRC32 used by gzip (can be computed incrementally like \s crc64)
+   */
+  static quint32 crc32(const char* data, const qint64& size, const quint32& previousCrc = 0);
+  static quint32 crc32(const QByteArray& data, const quint32& previousCrc = 0);
+
+  /*!
+   * \brief crc64ToBase64 Format a CRC64 as expected by Azure (base64 of the little-endian CRC)
+   */
+  static QString crc64ToBase64(const quint64& crc);
+
+  /*!
+   * \brief md5ToBase64 Compute the MD5 of \p data formatted as expected by Azure (Content-MD5)
+   */
+  static QString md5ToBase64(const QByteArray& data);
+};
+
+#endif // QAZURESTORAGECHECKSUM_H
@@ -0,0 +1,70 @@
+/*
+ * \brief Gzip compression of the content transferred to/from Azure storage (Content-Encoding: gzip)
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#ifndef QAZURESTORAGECOMPRESSION_H
+#define QAZURESTORAGECOMPRESSION_H
+
+#include <QByteArray>
+
+#include "QAzureStorageRestApi_global.h"
+
+/*!
+ * \brief The QAzureStorageCompression class compresses content into gzip members using the zlib embedded in Qt (qCompress).
+ *
+ * Each call creates an independent gzip member: compressed blocks can simply be concatenated into a valid gzip file
+ * (readable by any gzip decoder). The adler32 and deflate size of each member are added in a gzip extra field
+ * so that \s QAzureStorageGzipDecoder can decompress it with qUncompress (no additional dependency).
+ */
+class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStorageCompression
+{
+public:
+  /*!
+   * \brief gzip Compress \p data into one gzip member
+   * \param data Data to compress
+   * \param compressionLevel (optional) zlib compression level (0-9, -1 for default)
+   * \return gzip member (empty if \p data is empty or if compression failed)
+   */
+  static QByteArray gzip(const QByteArray& data, const int& compressionLevel = -1);
+};
+
+/*!
+ * \brief The QAzureStorageGzipDecoder class decompresses (while receiving it) gzip content created by \s QAzureStorageCompression::gzip
+ */
+class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStorageGzipDecoder
+{
+public:
+  /*!
+   * \brief decode Decompress the gzip members completed by \p compressedData
+   *
+   * \param compressedData Next received compressed bytes
+   * \param[out] decompressedData Decompressed content of the completed members (appended)
+   *
+   * \return false if the content is invalid or was not created by \s QAzureStorageCompression::gzip (see \s isStandardGzip)
+   */
+  bool decode(const QByteArray& compressedData, QByteArray& decompressedData);
+
+  /*!
+   * \brief isComplete Check that no incomplete gzip member is waiting for more data
+   */
+  bool isComplete() const;
+
+  /*!
+   * \brief isStandardGzip Check if \s decode failed because the first member is a standard gzip member
+   *        not created by \s QAzureStorageCompression::gzip (it can only be kept compressed)
+   */
+  bool isStandardGzip() const;
+
+private:
+  QByteArray m_buffer;
+  bool m_hasDecodedMember = false;
+  bool m_isStandardGzip = false;
+};
+
+#endif // QAZURESTORAGECOMPRESSION_H
@@ -0,0 +1,141 @@
+/*
+ * \brief Download all the files of an Azure storage virtual "folder" into a local directory while listing them
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#ifndef QAZURESTORAGEDIRECTORYDOWNLOADJOB_H
+#define QAZURESTORAGEDIRECTORYDOWNLOADJOB_H
+
+#include <QList>
+#include <QMap>
+#include <QtNetwork>
+
+#include "QAzureStorageRestApi_global.h"
+#include "QAzureStorageJob.h"
+
+class QAzureStorageRestApi;
+class QAzureStorageListJob;
+class QAzureStorageDownloadJob;
+
+class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStorageDirectoryDownloadJob : public QAzureStorageJob
+{
+  Q_OBJECT
+
+public:
+  /*!
+   * \brief QAzureStorageDirectoryDownloadJob Download all the files of a container under \p prefix into a local directory
+   *
+   * Use \s QAzureStorageRestApi::downloadPrefix instead of creating the job manually.
+   *
+   * The files are downloaded as soon as their listing page is received (the listing goes on meanwhile).
+   * Small files are downloaded with a single Get Blob request each, big files with parallel ranges (\s QAzureStorageDownloadJob).
+   * The number of requests sent at the same time is bounded: a big file uses \p maxParallelRanges of them and the small
+   * files use the requests left. The virtual "folders" under \p prefix are created as local directories.
+   *
+   * \param api Azure storage API used to send the requests
+   * \param container Container to download from
+   * \param prefix Virtual "folder" to download (a "/" is added if missing, whole container if empty)
+   * \param localPath Local directory to download the files into (created if needed)
+   * \param maxParallelRequests Max number of download requests sent at the same time
+   * \param singleGetMaxSizeInBytes Files up to this size are downloaded with a single Get Blob request
+   * \param rangeSizeInBytes Size of the ranges of the bigger files
+   * \param maxParallelRanges Max number of ranges of a big file downloaded at the same time
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer of each request (in sec)
+   * \param parent (optional) QObject parent
+   */
+  QAzureStorageDirectoryDownloadJob(QAzureStorageRestApi* api, const QString& container, const QString& prefix, const QString& localPath,
+                                    const int& maxParallelRequests, const qint64& singleGetMaxSizeInBytes, const qint64& rangeSizeInBytes,
+                                    const int& maxParallelRanges, const int& timeoutInSec = -1, QObject* parent = nullptr);
+
+  //! Number of files listed so far (total number of files once the listing is done)
+  qint64 fileCount() const;
+  //! Number of files downloaded successfully
+  qint64 downloadedFileCount() const;
+  //! Is the listing of \p prefix done ?
+  bool isListingFinished() const;
+  //! Files which could not be downloaded (blob name, error)
+  QMap<QString, QNetworkReply::NetworkError> failedFiles() const;
+
+  /*!
+   * \brief setFiles Only download these files instead of listing the prefix (must be called before \s start)
+   *
+   * \param files Files under the prefix (as returned by \s QAzureStorageRestApi::parseFileList: "Name" and "Content-Length" are used)
+   */
+  void setFiles(const QList< QMap<QString,QString> >& files);
+
+  //! Local path of \p blobName (empty if the blob is not under the prefix or would be written outside of the local directory)
+  QString localFilePath(const QString& blobName) const;
+
+public slots:
+  /*!
+   * \brief start List the files under the prefix and download them while listing
+   *
+   * A file which can not be downloaded does not stop the other files: it is reported by \s fileDownloaded and \s failedFiles,
+   * the job finishes once all the files are done, with the error of the first failed file (if any). A listing error stops the job.
+   * \s progress is emitted with the bytes of all the files (total unknown until the listing is done: -1).
+   */
+  void start() override;
+
+signals:
+  //! Emitted when a file is done (downloaded if isErrorCodeSuccess(errorCode))
+  void fileDownloaded(const QString& blobName, const QString& localFilePath, QNetworkReply::NetworkError errorCode);
+
+protected:
+  void cleanup() override;
+
+private:
+  struct File
+  {
+    QString blobName;
+    qint64 size;
+  };
+
+  void onFilesListed(const QList< QMap<QString,QString> >& files);
+  void onListingFinished(const QNetworkReply::NetworkError& errorCode);
+  void startNextFiles();
+  void startSmallFile(const File& file);
+  void startBigFile(const File& file);
+  void onSmallFileFinished(QNetworkReply* reply);
+  void onBigFileFinished(QAzureStorageDownloadJob* job, const QNetworkReply::NetworkError& errorCode);
+  void onFileDone(const File& file, const QNetworkReply::NetworkError& errorCode);
+  void emitProgress();
+  bool prepareLocalDirectory(const File& file, QString& localPath);
+  int requestsOfBigFile() const;
+
+private:
+  QAzureStorageRestApi* m_api;
+  QString m_container;
+  QString m_prefix;
+  QString m_localPath;
+  int m_maxParallelRequests;
+  qint64 m_singleGetMaxSizeInBytes;
+  qint64 m_rangeSizeInBytes;
+  int m_maxParallelRanges;
+  int m_timeoutInSec;
+
+  QList< QMap<QString,QString> > m_files;
+  bool m_isFileListSet = false;
+  QAzureStorageListJob* m_listJob = nullptr;
+  bool m_isListingFinished = false;
+  QList<File> m_pendingSmallFiles;
+  QList<File> m_pendingBigFiles;
+  QMap<QNetworkReply*, File> m_runningSmallFiles;
+  QMap<QAzureStorageDownloadJob*, File> m_runningBigFiles;
+  QMap<QAzureStorageDownloadJob*, qint64> m_runningBigFilesProgress;
+  int m_runningRequests = 0;
+  qint64 m_fileCount = 0;
+  qint64 m_downloadedFileCount = 0;
+  qint64 m_totalBytes = 0;
+  qint64 m_bytesDone = 0;  //!< Bytes of the files done (downloaded or failed)
+  QMap<QString, QNetworkReply::NetworkError> m_failedFiles;
+  QNetworkReply::NetworkError m_firstError = QNetworkReply::NetworkError::NoError;
+
+  bool m_isStarted = false;
+};
+
+#endif // QAZURESTORAGEDIRECTORYDOWNLOADJOB_H
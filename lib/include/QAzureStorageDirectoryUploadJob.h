@@ -0,0 +1,134 @@
+/*
+ * \brief Upload a local directory (all its files, recursively) into Azure storage with parallel files
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#ifndef QAZURESTORAGEDIRECTORYUPLOADJOB_H
+#define QAZURESTORAGEDIRECTORYUPLOADJOB_H
+
+#include <QList>
+#include <QMap>
+#include <QStringList>
+#include <QtNetwork>
+
+#include "QAzureStorageRestApi_global.h"
+#include "QAzureStorageJob.h"
+
+class QAzureStorageRestApi;
+class QAzureStorageUploadJob;
+
+class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStorageDirectoryUploadJob : public QAzureStorageJob
+{
+  Q_OBJECT
+
+public:
+  /*!
+   * \brief QAzureStorageDirectoryUploadJob Upload all the files of a local directory (and its sub directories) into Azure storage
+   *
+   * Use \s QAzureStorageRestApi::uploadDirectory instead of creating the job manually.
+   *
+   * Small files are uploaded with a single Put Blob request each, big files with parallel blocks (\s QAzureStorageUploadJob).
+   * The number of requests sent at the same time is bounded: a big file uses \p maxParallelBlocks of them and the small
+   * files use the requests left, so that thousands of small files are uploaded in parallel without starving the big ones.
+   *
+   * \param api Azure storage API used to send the requests
+   * \param localPath Local directory to upload
+   * \param container Container to put the files into
+   * \param prefix Virtual "folder" of the files in the container (a "/" is added if missing, container root if empty)
+   * \param maxParallelRequests Max number of requests sent at the same time
+   * \param singlePutMaxSizeInBytes Files up to this size are uploaded with a single Put Blob request
+   * \param blockSizeInBytes Size of the blocks of the bigger files
+   * \param maxParallelBlocks Max number of blocks of a big file uploaded at the same time
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer of each request (in sec)
+   * \param parent (optional) QObject parent
+   */
+  QAzureStorageDirectoryUploadJob(QAzureStorageRestApi* api, const QString& localPath, const QString& container, const QString& prefix,
+                                  const int& maxParallelRequests, const qint64& singlePutMaxSizeInBytes, const qint64& blockSizeInBytes,
+                                  const int& maxParallelBlocks, const int& timeoutInSec = -1, QObject* parent = nullptr);
+
+  //! Number of files to upload (-1 until the job is started)
+  qint64 fileCount() const;
+  //! Number of files uploaded successfully
+  qint64 uploadedFileCount() const;
+  //! Files which could not be uploaded (path relative to the local directory, error)
+  QMap<QString, QNetworkReply::NetworkError> failedFiles() const;
+
+  /*!
+   * \brief setFiles Only upload these files instead of all the files of the local directory (must be called before \s start)
+   *
+   * \param relativePaths Paths of the files relative to the local directory
+   */
+  void setFiles(const QStringList& relativePaths);
+
+  //! Name of the blob of \p relativePath ("/" separators, with the prefix)
+  QString blobName(const QString& relativePath) const;
+
+public slots:
+  /*!
+   * \brief start List the local files then upload them (biggest files first)
+   *
+   * A file which can not be uploaded does not stop the other files: it is reported by \s fileUploaded and \s failedFiles,
+   * the job finishes once all the files are done, with the error of the first failed file (if any).
+   * \s progress is emitted with the bytes of all the files.
+   */
+  void start() override;
+
+signals:
+  //! Emitted when a file is done (uploaded if isErrorCodeSuccess(errorCode), \p etag is the ETag header of the uploaded blob)
+  void fileUploaded(const QString& relativePath, const QString& blobName, QNetworkReply::NetworkError errorCode, const QString& etag);
+
+protected:
+  void cleanup() override;
+
+private:
+  struct File
+  {
+    QString relativePath;
+    qint64 size;
+  };
+
+  void addPendingFile(const File& file);
+  void startNextFiles();
+  void startSmallFile(const File& file);
+  void startBigFile(const File& file);
+  void onSmallFileFinished(QNetworkReply* reply);
+  void onBigFileFinished(QAzureStorageUploadJob* job, const QNetworkReply::NetworkError& errorCode);
+  void onFileDone(const File& file, const QNetworkReply::NetworkError& errorCode, const QString& etag = QString());
+  void emitProgress();
+  int requestsOfBigFile() const;
+
+private:
+  QAzureStorageRestApi* m_api;
+  QString m_localPath;
+  QString m_container;
+  QString m_prefix;
+  int m_maxParallelRequests;
+  qint64 m_singlePutMaxSizeInBytes;
+  qint64 m_blockSizeInBytes;
+  int m_maxParallelBlocks;
+  int m_timeoutInSec;
+
+  QStringList m_files;
+  bool m_isFileListSet = false;
+  QList<File> m_pendingSmallFiles;
+  QList<File> m_pendingBigFiles;
+  QMap<QNetworkReply*, File> m_runningSmallFiles;
+  QMap<QAzureStorageUploadJob*, File> m_runningBigFiles;
+  QMap<QAzureStorageUploadJob*, qint64> m_runningBigFilesProgress;
+  int m_runningRequests = 0;
+  qint64 m_fileCount = -1;
+  qint64 m_uploadedFileCount = 0;
+  qint64 m_totalBytes = 0;
+  qint64 m_bytesDone = 0;  //!< Bytes of the files done (uploaded or failed)
+  QMap<QString, QNetworkReply::NetworkError> m_failedFiles;
+  QNetworkReply::NetworkError m_firstError = QNetworkReply::NetworkError::NoError;
+
+  bool m_isStarted = false;
+};
+
+#endif // QAZURESTORAGEDIRECTORYUPLOADJOB_H
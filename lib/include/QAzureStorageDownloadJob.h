@@ -0,0 +1,144 @@
+/*
+ * \brief Download a file (blob in container) from Azure storage into a local file using parallel ranges
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#ifndef QAZURESTORAGEDOWNLOADJOB_H
+#define QAZURESTORAGEDOWNLOADJOB_H
+
+#include <QFile>
+#include <QMap>
+#include <QSharedPointer>
+#include <QCryptographicHash>
+#include <QtNetwork>
+
+#include "QAzureStorageRestApi_global.h"
+#include "QAzureStorageJob.h"
+#include "QAzureStorageTransferJournal.h"
+#include "QAzureStorageCompression.h"
+#include "QAzureStorageBandwidthLimiter.h"
+
+class QAzureStorageRestApi;
+
+class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStorageDownloadJob : public QAzureStorageJob
+{
+  Q_OBJECT
+
+public:
+  /*!
+   * \brief QAzureStorageDownloadJob Download a file from Azure storage into a local file using parallel ranges
+   *
+   * Use \s QAzureStorageRestApi::downloadFileToPath instead of creating the job manually.
+   *
+   * \param api Azure storage API used to send the requests
+   * \param container Container to take the file from
+   * \param blobName File (any kind of blob) to download
+   * \param filePath Absolute path of the local file to write (created if needed)
+   * \param rangeSizeInBytes Size of each range requested to Azure
+   * \param maxParallelRanges Max number of ranges downloaded at the same time
+   * \param journalPath (optional) Local journal of the downloaded ranges used to resume an interrupted download (no journal if empty)
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer of each request (in sec)
+   * \param parent (optional) QObject parent
+   */
+  QAzureStorageDownloadJob(QAzureStorageRestApi* api, const QString& container, const QString& blobName, const QString& filePath,
+                           const qint64& rangeSizeInBytes, const int& maxParallelRanges, const QString& journalPath = QString(),
+                           const int& timeoutInSec = -1, QObject* parent = nullptr);
+
+  //! Size of the blob (-1 until the blob properties are received)
+  qint64 fileSize() const;
+  //! Number of bytes of the blob already written in the local file (before decompression)
+  qint64 bytesWritten() const;
+
+  /*!
+   * \brief setBandwidthLimit Limit the bandwidth used by this download (can be changed while downloading)
+   *
+   * The global download limit of the API (\s QAzureStorageRestApi::setDownloadBandwidthLimit) still applies.
+   *
+   * \param bytesPerSecond Max bandwidth of this download (unlimited if 0 or negative, default: unlimited)
+   */
+  void setBandwidthLimit(const qint64& bytesPerSecond);
+  qint64 bandwidthLimit() const;
+
+  /*!
+   * \brief setPageRangesOnly Only download the page ranges of a page blob which contain data (must be called before \s start)
+   *
+   * Use \s QAzureStorageRestApi::downloadPageBlobToPath instead of calling it manually.
+   *
+   * \param isEnabled Download the page ranges only (the other parts of the local file are left as holes)
+   * \param prevSnapshot (optional) Snapshot (DateTime) already in the local file: only the pages changed since
+   *        this snapshot are downloaded and the cleared pages are written with zeros
+   */
+  void setPageRangesOnly(const bool& isEnabled, const QString& prevSnapshot = QString());
+
+public slots:
+  /*!
+   * \brief start Get the blob size, pre-size the local file and download all ranges (not already in the journal)
+   *
+   * If content compression is enabled in the API and the blob is gzip encoded, the blob is downloaded in one range
+   * and decompressed while received instead (no journal).
+   * If only the page ranges are requested, they are listed first and only they are downloaded.
+   */
+  void start() override;
+
+protected:
+  void cleanup() override;
+
+private:
+  struct Range
+  {
+    qint64 offset;
+    qint64 length;
+    qint64 written;
+    quint64 crc64;                              //!< CRC64 of the received bytes (updated while receiving them)
+    QSharedPointer<QCryptographicHash> md5;     //!< MD5 of the received bytes (updated while receiving them)
+  };
+
+  void onPropertiesFinished(QNetworkReply* reply);
+  void startRangedDownload();
+  void downloadCompressedContent(QNetworkReply* reply);
+  void requestPageRanges(const QString& marker);
+  void onPageRangesFinished(QNetworkReply* reply);
+  void addPendingRanges(const qint64& offset, const qint64& length);
+  bool writeZeros(const qint64& offset, const qint64& length);
+  void startNextRanges();
+  void onRangeReadyRead(QNetworkReply* reply);
+  void onRangeFinished(QNetworkReply* reply);
+  void scheduleDrain();
+  void drainRanges();
+  bool isRangeChecksumValid(QNetworkReply* reply, const Range& range) const;
+
+private:
+  QAzureStorageRestApi* m_api;
+  QString m_container;
+  QString m_blobName;
+  qint64 m_rangeSizeInBytes;
+  int m_maxParallelRanges;
+  int m_timeoutInSec;
+
+  QFile m_file;
+  QAzureStorageTransferJournal m_journal;
+  QAzureStorageBandwidthLimiter m_bandwidthLimiter;  //!< Limit of this download (child of the global download limiter)
+  QAzureStorageGzipDecoder m_decoder;
+  bool m_isDecompressing = false;
+  bool m_isPageRangesOnly = false;
+  QString m_prevSnapshot;
+  qint64 m_fileSize = -1;
+  QString m_etag;
+  qint64 m_bytesToWrite = 0;
+  qint64 m_bytesWritten = 0;
+  QMap<qint64,qint64> m_completedRanges;
+  QList<Range> m_pendingRanges;
+  QMap<QNetworkReply*, Range> m_runningRanges;
+  QNetworkReply* m_propertiesReply = nullptr;
+  QNetworkReply* m_pageRangesReply = nullptr;
+  bool m_isDrainScheduled = false;  //!< Data of bandwidth limited ranges waiting to be read
+
+  bool m_isStarted = false;
+};
+
+#endif // QAZURESTORAGEDOWNLOADJOB_H
@@ -0,0 +1,78 @@
+/*
+ * \brief Find the files of an Azure storage account (or container) matching an index tags expression following all result pages
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#ifndef QAZURESTORAGEFINDBYTAGSJOB_H
+#define QAZURESTORAGEFINDBYTAGSJOB_H
+
+#include <QList>
+#include <QMap>
+#include <QtNetwork>
+
+#include "QAzureStorageRestApi_global.h"
+#include "QAzureStorageJob.h"
+
+class QAzureStorageRestApi;
+
+class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStorageFindByTagsJob : public QAzureStorageJob
+{
+  Q_OBJECT
+
+public:
+  /*!
+   * \brief QAzureStorageFindByTagsJob Find the files matching \p whereExpression (all result pages)
+   *
+   * Use \s QAzureStorageRestApi::findAllFilesByTags instead of creating the job manually.
+   *
+   * \param api Azure storage API used to send the requests
+   * \param whereExpression Index tags expression (for example "\"tenant\" = 'abc' AND \"status\" = 'done'")
+   * \param container Container to search in (whole account if empty)
+   * \param maxResultsPerPage Max number of files per result page (default Azure REST API number of results if negative)
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer of each request (in sec)
+   * \param parent (optional) QObject parent
+   */
+  QAzureStorageFindByTagsJob(QAzureStorageRestApi* api, const QString& whereExpression, const QString& container,
+                             const int& maxResultsPerPage, const int& timeoutInSec = -1, QObject* parent = nullptr);
+
+  //! Number of files already found
+  qint64 fileCount() const;
+
+public slots:
+  /*!
+   * \brief start Request the first result page then each next page (NextMarker) until all files are found
+   *
+   * \s progress is emitted with the number of files found (total unknown: -1).
+   */
+  void start() override;
+
+signals:
+  //! Emitted for each page of results received (Name, ContainerName and the matching tags as "Tags:<key>")
+  void filesFound(const QList< QMap<QString,QString> >& files);
+
+protected:
+  void cleanup() override;
+
+private:
+  void requestPage(const QString& marker);
+  void onPageFinished(QNetworkReply* reply);
+
+private:
+  QAzureStorageRestApi* m_api;
+  QString m_whereExpression;
+  QString m_container;
+  int m_maxResultsPerPage;
+  int m_timeoutInSec;
+
+  QNetworkReply* m_pageReply = nullptr;
+  qint64 m_fileCount = 0;
+
+  bool m_isStarted = false;
+};
+
+#endif // QAZURESTORAGEFINDBYTAGSJOB_H
@@ -0,0 +1,146 @@
+/*
+ * \brief Local memory-mapped index of the files of an Azure storage container (instant queries without listing the container)
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#ifndef QAZURESTORAGEINVENTORY_H
+#define QAZURESTORAGEINVENTORY_H
+
+#include <QFile>
+#include <QList>
+#include <QMap>
+#include <QStringList>
+
+#include "QAzureStorageRestApi_global.h"
+
+/*!
+ * \brief The QAzureStorageInventory class keeps in a local file the names, sizes, modification times and ETags of the files
+ *        of a container so that point lookups, prefix queries and sizes per prefix are answered without listing the container.
+ *
+ * The file is a sorted name table (names sorted by their UTF-8 bytes, like Azure listings) followed by one column per property
+ * and a column of cumulative sizes: a query is a binary search in the memory-mapped file (nothing is loaded at startup)
+ * and the size of a prefix is a difference of two cumulative sizes.
+ * The inventory is refreshed by replacing the files under a listed prefix (\s replacePrefix) or by applying known changes
+ * (\s applyChanges): the file is rewritten in a temporary file renamed once complete.
+ */
+class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStorageInventory
+{
+public:
+  //! File of the inventory
+  struct Entry
+  {
+    Entry() :
+      size(-1), modifiedInMs(-1)
+    {
+    }
+
+    QString name;         //!< Name of the blob
+    qint64 size;          //!< Size in bytes
+    qint64 modifiedInMs;  //!< Last-Modified (ms since epoch, -1 if unknown)
+    QString etag;         //!< ETag of the blob
+  };
+
+  /*!
+   * \brief QAzureStorageInventory Inventory of a container
+   * \param inventoryPath (optional) Path of the local inventory file (inventory disabled if empty)
+   */
+  explicit QAzureStorageInventory(const QString& inventoryPath = QString());
+  ~QAzureStorageInventory();
+
+  bool isEnabled() const;
+  QString inventoryPath() const;
+
+  /*!
+   * \brief open Map the inventory file if it was built for \p container, otherwise start an empty inventory of \p container
+   *
+   * \return true if an inventory of \p container was mapped
+   */
+  bool open(const QString& container);
+  void close();
+  bool isOpen() const;
+  QString container() const;
+
+  //! Number of files in the inventory
+  qint64 count() const;
+  //! File at \p index (in the order of the names)
+  Entry entryAt(const qint64& index) const;
+
+  /*!
+   * \brief find Point lookup of a file
+   *
+   * \param name Name of the blob
+   * \param entry (optional) File found
+   *
+   * \return true if \p name is in the inventory
+   */
+  bool find(const QString& name, Entry* entry = nullptr) const;
+
+  /*!
+   * \brief filesWithPrefix Files whose name starts with \p prefix (in the order of the names)
+   *
+   * \param prefix Prefix of the names (all the files if empty)
+   * \param maxResults (optional) Max number of files returned (no limit if negative)
+   */
+  QList<Entry> filesWithPrefix(const QString& prefix, const int& maxResults = -1) const;
+  //! Number of files whose name starts with \p prefix
+  qint64 fileCount(const QString& prefix) const;
+  //! Size in bytes of the files whose name starts with \p prefix
+  qint64 totalSize(const QString& prefix) const;
+
+  /*!
+   * \brief replacePrefix Replace the files under \p prefix by a full listing of \p prefix (other files are kept)
+   *
+   * \param prefix Listed prefix (whole inventory replaced if empty)
+   * \param files Listed files (as returned by \s QAzureStorageRestApi::parseFileList), files not under \p prefix are ignored
+   *
+   * \return false if the inventory is disabled or could not be written
+   */
+  bool replacePrefix(const QString& prefix, const QList< QMap<QString,QString> >& files);
+
+  /*!
+   * \brief applyChanges Add or update some files and remove others (for example after uploading or deleting them)
+   *
+   * \param updatedFiles Files added or updated (as returned by \s QAzureStorageRestApi::parseFileList)
+   * \param deletedNames (optional) Names of the files removed
+   *
+   * \return false if the inventory is disabled or could not be written
+   */
+  bool applyChanges(const QList< QMap<QString,QString> >& updatedFiles, const QStringList& deletedNames = QStringList());
+
+  //! File of a listing (as returned by \s QAzureStorageRestApi::parseFileList)
+  static Entry toEntry(const QMap<QString,QString>& file);
+
+private:
+  Q_DISABLE_COPY(QAzureStorageInventory)
+
+  qint64 readValue(const quint64& sectionOffset, const qint64& index) const;
+  QByteArray readString(const quint64& offsetsOffset, const quint64& stringsOffset, const quint64& stringsSize, const qint64& index) const;
+  int compareName(const qint64& index, const QByteArray& key, const bool& isPrefix) const;
+  qint64 lowerBound(const QByteArray& key, const bool& isPrefix) const;
+  qint64 upperBound(const QByteArray& key, const bool& isPrefix) const;
+  QList<Entry> entries(const qint64& from, const qint64& to) const;
+  bool write(const QList<Entry>& sortedEntries);
+
+private:
+  QFile m_file;
+  QString m_container;
+  const uchar* m_data = nullptr;
+  qint64 m_dataSize = 0;
+  qint64 m_count = 0;
+  quint64 m_nameOffsetsOffset = 0;
+  quint64 m_namesOffset = 0;
+  quint64 m_namesSize = 0;
+  quint64 m_sizesOffset = 0;
+  quint64 m_cumulativeSizesOffset = 0;
+  quint64 m_modifiedOffset = 0;
+  quint64 m_etagOffsetsOffset = 0;
+  quint64 m_etagsOffset = 0;
+  quint64 m_etagsSize = 0;
+};
+
+#endif // QAZURESTORAGEINVENTORY_H
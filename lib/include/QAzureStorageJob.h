@@ -0,0 +1,60 @@
+/*
+ * \brief Base class of the transfers (jobs made of several requests) to/from Azure storage
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#ifndef QAZURESTORAGEJOB_H
+#define QAZURESTORAGEJOB_H
+
+#include <QObject>
+#include <QtNetwork>
+
+#include "QAzureStorageRestApi_global.h"
+
+class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStorageJob : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit QAzureStorageJob(QObject* parent = nullptr);
+
+  bool isFinished() const;
+  QNetworkReply::NetworkError error() const;
+
+public slots:
+  /*!
+   * \brief start Send the first requests of the job (nothing done if already started)
+   */
+  virtual void start() = 0;
+
+  /*!
+   * \brief abort Stop all running requests (finished is emitted with QNetworkReply::OperationCanceledError if not already finished)
+   */
+  void abort();
+
+signals:
+  void progress(qint64 bytesDone, qint64 bytesTotal);
+  void finished(QNetworkReply::NetworkError errorCode);
+
+protected:
+  /*!
+   * \brief finish End the job: stop remaining requests (using \s cleanup) and emit \s finished (only once)
+   */
+  void finish(const QNetworkReply::NetworkError& errorCode);
+
+  /*!
+   * \brief cleanup Stop the running requests and release the job resources (called once by \s finish before emitting \s finished)
+   */
+  virtual void cleanup() = 0;
+
+private:
+  bool m_isFinished = false;
+  QNetworkReply::NetworkError m_error = QNetworkReply::NetworkError::NoError;
+};
+
+#endif // QAZURESTORAGEJOB_H
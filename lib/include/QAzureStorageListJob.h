@@ -0,0 +1,97 @@
+/*
+ * \brief List the files of an Azure storage container by walking its virtual "folders" with parallel listings
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#ifndef QAZURESTORAGELISTJOB_H
+#define QAZURESTORAGELISTJOB_H
+
+#include <QList>
+#include <QMap>
+#include <QStringList>
+#include <QtNetwork>
+
+#include "QAzureStorageRestApi_global.h"
+#include "QAzureStorageJob.h"
+
+class QAzureStorageRestApi;
+
+class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStorageListJob : public QAzureStorageJob
+{
+  Q_OBJECT
+
+public:
+  /*!
+   * \brief QAzureStorageListJob List the files of a container under \p prefix, exploring the virtual "folders" in parallel
+   *
+   * Use \s QAzureStorageRestApi::walkFiles instead of creating the job manually.
+   *
+   * \param api Azure storage API used to send the requests
+   * \param container Container to list
+   * \param prefix Virtual "folder" to list (whole container if empty)
+   * \param delimiter Delimiter of virtual "folders" (flat listing of \p prefix if empty)
+   * \param maxDepth Max depth of sub "folders" explored (0: only the files directly in \p prefix, -1: no limit)
+   * \param maxParallelListings Max number of listing requests sent at the same time
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer of each request (in sec)
+   * \param parent (optional) QObject parent
+   */
+  QAzureStorageListJob(QAzureStorageRestApi* api, const QString& container, const QString& prefix, const QString& delimiter,
+                       const int& maxDepth, const int& maxParallelListings, const int& timeoutInSec = -1, QObject* parent = nullptr);
+
+  //! Number of files already listed
+  qint64 fileCount() const;
+  //! Number of virtual "folders" found
+  qint64 folderCount() const;
+
+public slots:
+  /*!
+   * \brief start List \p prefix then each virtual "folder" found (until \p maxDepth) following all NextMarker
+   *
+   * \s progress is emitted with the number of files listed (total unknown: -1).
+   */
+  void start() override;
+
+signals:
+  //! Emitted for each page of results received (files of the virtual "folder" \p prefix, in the Azure order)
+  void filesListed(const QString& prefix, const QList< QMap<QString,QString> >& files);
+
+  //! Emitted for each virtual "folder" found
+  void folderFound(const QString& prefix, int depth);
+
+protected:
+  void cleanup() override;
+
+private:
+  struct Listing
+  {
+    QString prefix;
+    QString marker;
+    int depth;
+  };
+
+  void startNextListings();
+  void onListingFinished(QNetworkReply* reply);
+
+private:
+  QAzureStorageRestApi* m_api;
+  QString m_container;
+  QString m_prefix;
+  QString m_delimiter;
+  int m_maxDepth;
+  int m_maxParallelListings;
+  int m_timeoutInSec;
+
+  QList<Listing> m_pendingListings;
+  QMap<QNetworkReply*, Listing> m_runningListings;
+  qint64 m_fileCount = 0;
+  qint64 m_folderCount = 0;
+
+  bool m_isStarted = false;
+};
+
+#endif // QAZURESTORAGELISTJOB_H
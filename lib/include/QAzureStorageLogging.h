@@ -0,0 +1,39 @@
+/*
+ * \brief Logging categories of the Azure storage library (enable/disable them with QLoggingCategory::setFilterRules)
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#ifndef QAZURESTORAGELOGGING_H
+#define QAZURESTORAGELOGGING_H
+
+#include <QLoggingCategory>
+#include <QString>
+
+#include "QAzureStorageRestApi_global.h"
+
+// Debug messages are disabled by default (enable them with rules like "qazurestorage.url.debug=true"),
+// the message of a disabled category is not built at all.
+QAZURESTORAGERESTAPISHARED_EXPORT const QLoggingCategory& lcAzureStorageUrl();      //!< "qazurestorage.url": generated URLs (SAS signature redacted)
+QAZURESTORAGERESTAPISHARED_EXPORT const QLoggingCategory& lcAzureStorageAuth();     //!< "qazurestorage.auth": credentials and signed requests
+QAZURESTORAGERESTAPISHARED_EXPORT const QLoggingCategory& lcAzureStorageTransfer(); //!< "qazurestorage.transfer": requests, jobs and local files
+QAZURESTORAGERESTAPISHARED_EXPORT const QLoggingCategory& lcAzureStorageParse();    //!< "qazurestorage.parse": XML answers of Azure
+
+class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStorageLogging
+{
+public:
+  /*!
+   * \brief redactSasSignature Hide the SAS signature of a URL (or of SAS credentials) before logging it
+   *
+   * \param urlOrSasCredentials URL or SAS credentials
+   *
+   * \return \p urlOrSasCredentials with the value of its sig= parameter replaced by "REDACTED"
+   */
+  static QString redactSasSignature(const QString& urlOrSasCredentials);
+};
+
+#endif // QAZURESTORAGELOGGING_H
@@ -0,0 +1,107 @@
+/*
+ * \brief Aggregated metrics (latency histograms, bytes, in-flight requests, retries, throttling) of the requests sent to Azure storage
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#ifndef QAZURESTORAGEMETRICS_H
+#define QAZURESTORAGEMETRICS_H
+
+#include <QAtomicInteger>
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+#include "QAzureStorageRestApi_global.h"
+
+/*!
+ * \brief The QAzureStorageMetrics class aggregates the requests sent by a \s QAzureStorageRestApi
+ *
+ * Latencies are counted in HDR-style histograms (4 buckets per power of two, from 1 ms to about 2 min) per
+ * Azure operation and HTTP status class. Everything is updated with atomic operations only, so that the metrics
+ * can be read (or exported) from any thread while the requests are running.
+ */
+class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStorageMetrics
+{
+public:
+  QAzureStorageMetrics();
+
+  //! Count a request sent to Azure (in-flight until \s recordRequestFinished)
+  void recordRequestStarted();
+
+  /*!
+   * \brief recordRequestFinished Count a finished request
+   *
+   * \param operation Azure REST API operation ("GetBlob", "PutBlock", ...)
+   * \param httpStatus HTTP status of the response (0 if no response)
+   * \param durationInUs Time from the send until the end of the response
+   * \param bytesSent Size of the request content
+   * \param bytesReceived Size of the response content
+   */
+  void recordRequestFinished(const QString& operation, const int& httpStatus, const qint64& durationInUs,
+                             const qint64& bytesSent, const qint64& bytesReceived);
+
+  //! Count a request sent again after a failure
+  void recordRetry();
+
+  //! Set all the metrics back to 0 (except the in-flight requests)
+  void reset();
+
+  //! Number of finished requests (of all operations if \p operation is empty)
+  qint64 requestCount(const QString& operation = QString()) const;
+  qint64 sentBytes() const;
+  qint64 receivedBytes() const;
+  qint64 inFlightRequests() const;
+  qint64 retryCount() const;
+  //! Number of requests throttled by Azure (HTTP 503 "Server busy" or 429)
+  qint64 throttledCount() const;
+
+  /*!
+   * \brief latencyPercentileInUs Estimate a latency percentile from the histograms
+   *
+   * \param percentile Percentile (between 0 and 100)
+   * \param operation (optional) Operation to use (all operations if empty)
+   *
+   * \return Upper bound of the histogram bucket of the percentile (-1 if no request finished)
+   */
+  qint64 latencyPercentileInUs(const double& percentile, const QString& operation = QString()) const;
+
+  /*!
+   * \brief toPrometheusText Render the metrics in the Prometheus text exposition format
+   *
+   * \param metricPrefix (optional) Prefix of the metric names
+   *
+   * \return Content to answer to a Prometheus scrape (only the histograms with requests are rendered)
+   */
+  QByteArray toPrometheusText(const QString& metricPrefix = "qazurestorage") const;
+
+  //! Operations with their own histograms (other operations are counted as "Other")
+  static QStringList operations();
+
+private:
+  Q_DISABLE_COPY(QAzureStorageMetrics)
+
+  static const int operationCount = 18;
+  static const int statusClassCount = 5;
+  static const int bucketCount = 70;
+
+  static int operationIndex(const QString& operation);
+  static int statusClassIndex(const int& httpStatus);
+  static int bucketIndex(const qint64& durationInUs);
+  static qint64 bucketUpperBoundInUs(const int& bucket);
+  qint64 bucketCountOf(const int& operation, const int& bucket) const;
+
+  QAtomicInteger<qint64> m_latencyBuckets[operationCount][statusClassCount][bucketCount];
+  QAtomicInteger<qint64> m_latencySumInUs[operationCount][statusClassCount];
+  QAtomicInteger<qint64> m_sentBytes;
+  QAtomicInteger<qint64> m_receivedBytes;
+  QAtomicInteger<qint64> m_inFlightRequests;
+  QAtomicInteger<qint64> m_retries;
+  QAtomicInteger<qint64> m_throttledRequests;
+};
+
+#endif // QAZURESTORAGEMETRICS_H
@@ -0,0 +1,115 @@
+/*
+ * \brief Upload a local file (disk image, ...) into Azure storage as a page blob skipping the pages filled with zeros
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#ifndef QAZURESTORAGEPAGEBLOBUPLOADJOB_H
+#define QAZURESTORAGEPAGEBLOBUPLOADJOB_H
+
+#include <QFile>
+#include <QMap>
+#include <QtNetwork>
+
+#include "QAzureStorageRestApi_global.h"
+#include "QAzureStorageJob.h"
+#include "QAzureStorageBandwidthLimiter.h"
+
+class QAzureStorageRestApi;
+
+class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStoragePageBlobUploadJob : public QAzureStorageJob
+{
+  Q_OBJECT
+
+public:
+  //! Size of a page of a page blob
+  static const int pageSizeInBytes = 512;
+  //! Max size of a Put Page request accepted by Azure
+  static const int maxPutPageSizeInBytes = 4 * 1024 * 1024;
+
+  /*!
+   * \brief QAzureStoragePageBlobUploadJob Upload a local file into Azure storage as a page blob (Put Blob + parallel Put Page)
+   *
+   * Use \s QAzureStorageRestApi::uploadFileAsPageBlob instead of creating the job manually.
+   *
+   * \param api Azure storage API used to send the requests
+   * \param filePath Absolute path of the local file to upload
+   * \param container Container to put the file into
+   * \param blobName Name of the file (page blob) to create
+   * \param maxParallelRanges Max number of page ranges uploaded at the same time
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer of each request (in sec)
+   * \param parent (optional) QObject parent
+   */
+  QAzureStoragePageBlobUploadJob(QAzureStorageRestApi* api, const QString& filePath, const QString& container, const QString& blobName,
+                                 const int& maxParallelRanges, const int& timeoutInSec = -1, QObject* parent = nullptr);
+
+  //! Size of the local file (-1 until the job is started)
+  qint64 fileSize() const;
+  //! Number of bytes of the file already handled (uploaded or skipped because filled with zeros)
+  qint64 bytesDone() const;
+  //! Number of bytes really sent to Azure
+  qint64 bytesUploaded() const;
+
+  /*!
+   * \brief setBandwidthLimit Limit the bandwidth used by this upload (can be changed while uploading)
+   *
+   * The global upload limit of the API (\s QAzureStorageRestApi::setUploadBandwidthLimit) still applies.
+   *
+   * \param bytesPerSecond Max bandwidth of this upload (unlimited if 0 or negative, default: unlimited)
+   */
+  void setBandwidthLimit(const qint64& bytesPerSecond);
+  qint64 bandwidthLimit() const;
+
+  /*!
+   * \brief isZero Check if \p data is only made of zeros
+   *
+   * \param data Data to check
+   * \param size Size of the data (in bytes)
+   *
+   * \return true if all bytes are zeros (or \p size is 0)
+   */
+  static bool isZero(const char* data, const qint64& size);
+
+public slots:
+  /*!
+   * \brief start Create the page blob then upload all page ranges of the file which are not filled with zeros
+   */
+  void start() override;
+
+protected:
+  void cleanup() override;
+
+private:
+  void onCreateFinished(QNetworkReply* reply);
+  void startNextRanges();
+  bool loadChunk();
+  void onRangeFinished(QNetworkReply* reply);
+
+private:
+  QAzureStorageRestApi* m_api;
+  QString m_container;
+  QString m_blobName;
+  int m_maxParallelRanges;
+  int m_timeoutInSec;
+
+  QFile m_file;
+  QAzureStorageBandwidthLimiter m_bandwidthLimiter;  //!< Limit of this upload (child of the global upload limiter)
+  qint64 m_fileSize = -1;
+  qint64 m_blobSize = -1;
+  qint64 m_bytesUploaded = 0;
+  qint64 m_bytesRunning = 0;
+  qint64 m_scanOffset = 0;          //!< Offset of the first page of the file not scanned yet
+  qint64 m_chunkOffset = 0;         //!< Offset of the chunk of the file loaded in memory
+  QByteArray m_chunk;               //!< Part of the file being scanned (padded with zeros to a multiple of the page size)
+  QMap<QNetworkReply*, qint64> m_runningRanges;
+  QNetworkReply* m_createReply = nullptr;
+  bool m_isScanScheduled = false;
+
+  bool m_isStarted = false;
+};
+
+#endif // QAZURESTORAGEPAGEBLOBUPLOADJOB_H
@@ -0,0 +1,131 @@
+/*
+ * \brief List the files of a huge Azure storage container with parallel listings of prefix partitions merged in lexicographic order
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#ifndef QAZURESTORAGEPARTITIONEDLISTJOB_H
+#define QAZURESTORAGEPARTITIONEDLISTJOB_H
+
+#include <QList>
+#include <QMap>
+#include <QStringList>
+#include <QtNetwork>
+
+#include "QAzureStorageRestApi_global.h"
+#include "QAzureStorageJob.h"
+
+class QAzureStorageRestApi;
+
+class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStoragePartitionedListJob : public QAzureStorageJob
+{
+  Q_OBJECT
+
+public:
+  /*!
+   * \brief QAzureStoragePartitionedListJob List the files of a container under \p prefix by listing partitions of the names in parallel
+   *
+   * Use \s QAzureStorageRestApi::listFilesParallel instead of creating the job manually.
+   *
+   * \param api Azure storage API used to send the requests
+   * \param container Container to list
+   * \param prefix Prefix of the files to list (whole container if empty)
+   * \param partitionAlphabet Characters following \p prefix in the file names (one partition per character),
+   *        if empty the partitions are the virtual "folders" found by listing \p prefix with \p delimiter
+   * \param delimiter Delimiter used to find the partitions (only used if \p partitionAlphabet is empty)
+   * \param maxParallelListings Max number of listing requests sent at the same time
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer of each request (in sec)
+   * \param parent (optional) QObject parent
+   */
+  QAzureStoragePartitionedListJob(QAzureStorageRestApi* api, const QString& container, const QString& prefix, const QString& partitionAlphabet,
+                                  const QString& delimiter, const int& maxParallelListings, const int& timeoutInSec = -1, QObject* parent = nullptr);
+
+  //! Number of files already listed (emitted or not)
+  qint64 fileCount() const;
+  /*!
+   * \brief isComplete Check if the listing finished successfully and is known to contain all the files of the prefix
+   *
+   * Always false with a partition alphabet: files whose character after the prefix is not in the alphabet are not listed
+   * and cannot be detected without listing the whole prefix. The partitions found with a delimiter cover all the files.
+   */
+  bool isComplete() const;
+  //! Number of partitions listed in parallel (0 until the partitions are known)
+  int partitionCount() const;
+
+  /*!
+   * \brief partitionPrefixes Prefixes of the partitions of an alphabet (sorted and without duplicates)
+   *
+   * \param prefix Common prefix of the files to list
+   * \param partitionAlphabet Characters following \p prefix in the file names
+   *
+   * \return \p prefix followed by each character of the alphabet, in the order of the Azure listings
+   */
+  static QStringList partitionPrefixes(const QString& prefix, const QString& partitionAlphabet);
+
+  /*!
+   * \brief isListedBefore Check if Azure lists \p name1 before \p name2 (Azure sorts the names by their UTF-8 bytes)
+   */
+  static bool isListedBefore(const QString& name1, const QString& name2);
+
+public slots:
+  /*!
+   * \brief start Find the partitions (if no alphabet) then list all partitions in parallel
+   *
+   * With an alphabet, the file named exactly like the prefix is looked for first (it is in no partition) and the files
+   * outside the alphabet are not listed: the job finishes without error but \s isComplete is false.
+   *
+   * \s filesListed is emitted in the lexicographic order of the names (pages of a partition received before
+   * the end of the previous partitions are kept in memory until then).
+   * \s progress is emitted with the number of files listed (total unknown: -1).
+   */
+  void start() override;
+
+signals:
+  //! Emitted each time the next files (in lexicographic order) are available
+  void filesListed(const QList< QMap<QString,QString> >& files);
+
+protected:
+  void cleanup() override;
+
+private:
+  struct Partition
+  {
+    QString key;                                      //!< Prefix of the partition (or name of the file if \s isFile)
+    bool isFile;                                      //!< File found while looking for partitions (nothing to list)
+    bool isDone;
+    QString marker;
+    QList< QMap<QString,QString> > bufferedFiles;     //!< Files received before the end of the previous partitions
+  };
+
+  void onExactPrefixFinished(QNetworkReply* reply);
+  void requestProbe(const QString& marker);
+  void onProbeFinished(QNetworkReply* reply);
+  void startPartitions();
+  void startNextListings();
+  void onListingFinished(QNetworkReply* reply);
+  void emitReadyFiles();
+
+private:
+  QAzureStorageRestApi* m_api;
+  QString m_container;
+  QString m_prefix;
+  QString m_partitionAlphabet;
+  QString m_delimiter;
+  int m_maxParallelListings;
+  int m_timeoutInSec;
+
+  QList<Partition> m_partitions;
+  QList<int> m_pendingPartitions;
+  QMap<QNetworkReply*, int> m_runningListings;
+  QNetworkReply* m_probeReply = nullptr;
+  int m_nextPartitionToEmit = 0;
+  qint64 m_fileCount = 0;
+
+  bool m_isStarted = false;
+};
+
+#endif // QAZURESTORAGEPARTITIONEDLISTJOB_H
@@ -15,12 +15,88 @@
 #include <QtNetwork>
 
 #include "QAzureStorageRestApi_global.h"
+#include "QAzureStorageMetrics.h"
+#include "QAzureStorageTracer.h"
+#include "QAzureStorageBandwidthLimiter.h"
+
+class QAzureStorageJob;
+class QAzureStorageDownloadJob;
+class QAzureStorageUploadJob;
+class QAzureStoragePageBlobUploadJob;
+class QAzureStorageDirectoryUploadJob;
+class QAzureStorageDirectoryDownloadJob;
+class QAzureStorageSyncJob;
+class QAzureStorageInventory;
+class QAzureStorageChangeFeedJob;
+class QAzureStorageListJob;
+class QAzureStoragePartitionedListJob;
+class QAzureStorageFindByTagsJob;
 
 class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStorageRestApi : public QObject
 {
   Q_OBJECT
 
 public:
+  //! Checksum sent with the uploaded content and requested with the downloaded ranges so that Azure/this library detect corruptions
+  enum TransactionalChecksum
+  {
+    NoChecksum,    //!< No integrity check
+    Md5Checksum,   //!< Content-MD5 (computed with QCryptographicHash)
+    Crc64Checksum  //!< x-ms-content-crc64 (faster to compute than MD5)
+  };
+
+  //! Direction of a synchronization (see \s sync)
+  enum SyncDirection
+  {
+    SyncUpload,   //!< Local directory to container (the local files are the reference)
+    SyncDownload  //!< Container to local directory (the files of the container are the reference)
+  };
+
+  //! Additional information returned with each file when listing files (include= parameter of the listing)
+  struct ListIncludeOptions
+  {
+    ListIncludeOptions() :
+      metadata(false), tags(false), snapshots(false), versions(false), deleted(false), copy(false), uncommittedBlobs(false)
+    {
+    }
+
+    bool metadata;          //!< Metadata of the files ("Metadata:<name>" keys)
+    bool tags;              //!< Index tags of the files ("Tags:<key>" keys)
+    bool snapshots;         //!< Snapshots of the files (listed as files with a "Snapshot" key)
+    bool versions;          //!< Previous versions of the files (listed as files with a "VersionId" key)
+    bool deleted;           //!< Soft deleted files (listed as files with a "Deleted" key)
+    bool copy;              //!< Properties of the last copy of the files
+    bool uncommittedBlobs;  //!< Files which only have uncommitted blocks
+
+    //! Value of the include= parameter (empty if nothing to include)
+    QString toString() const;
+  };
+
+  //! Timings and result of a request sent to Azure (see \s requestFinished), durations are -1 if unknown
+  struct RequestMetrics
+  {
+    RequestMetrics() :
+      buildTimeInUs(-1), queuedTimeInUs(-1), connectTimeInUs(-1), timeToFirstByteInUs(-1), transferTimeInUs(-1), totalTimeInUs(-1),
+      bytesSent(0), bytesReceived(0), httpStatus(0), error(QNetworkReply::NetworkError::NoError)
+    {
+    }
+
+    QString operation;           //!< Azure REST API operation ("GetBlob", "PutBlock", "ListBlobs", ...)
+    QByteArray httpVerb;         //!< "GET", "PUT", "HEAD" or "DELETE"
+    QString resourcePath;        //!< Path of the container/file (URL without parameters nor credentials)
+    qint64 buildTimeInUs;        //!< Time to build and sign the request
+    qint64 queuedTimeInUs;       //!< Time from the send until Qt starts working on the request (waiting for a free connection)
+    qint64 connectTimeInUs;      //!< DNS resolution, TCP and TLS handshakes (-1 if an open connection was reused or Qt older than 6.3)
+    qint64 timeToFirstByteInUs;  //!< Time from the send until the response headers are received
+    qint64 transferTimeInUs;     //!< Time from the response headers until the end of the response
+    qint64 totalTimeInUs;        //!< Time from the send until the end of the response
+    qint64 bytesSent;            //!< Size of the request content
+    qint64 bytesReceived;        //!< Size of the response content
+    int httpStatus;              //!< HTTP status of the response (0 if no response)
+    QByteArray requestId;        //!< x-ms-request-id of the response (identifies the request for Azure support)
+    QNetworkReply::NetworkError error;
+  };
+
   // ------------------------------------- CONSTRUCTOR & INIT -------------------------------------
   /*!
    * \brief QAzureStorageRestApi Send/Receive/List files from Azure storage
@@ -39,6 +115,136 @@ public:
    */
   void updateCredentials(const QString&accountName, const QString& accountKeyOrSasCredentials, const bool isAccountKey = true);
 
+  /*!
+   * \brief setTransactionalChecksum Set the checksum computed on each uploaded file/block (verified by Azure) and
+   *        requested on each downloaded range (verified by this library while receiving it)
+   *
+   * Full details: https://learn.microsoft.com/en-us/azure/storage/blobs/storage-blob-checksums
+   *
+   * \param checksum Checksum to use (default: \s NoChecksum)
+   */
+  void setTransactionalChecksum(const TransactionalChecksum& checksum);
+  TransactionalChecksum transactionalChecksum() const;
+
+  /*!
+   * \brief setContentCompression Compress (gzip) the content of the uploaded block blobs and decompress the gzip files downloaded into a local file
+   *
+   * Uploaded files are stored compressed in Azure with "Content-Encoding: gzip", big files are compressed block by block
+   * (in worker threads, while the previous blocks are uploaded), \s uploadFile and \s uploadFileQByteArray compress
+   * their content in the calling thread. Files downloaded with \s downloadFileToPath are decompressed while received
+   * if they were uploaded compressed by this library (other gzip files are downloaded as is, still compressed).
+   *
+   * \param isEnabled Enable the compression/decompression (default: disabled)
+   */
+  void setContentCompression(const bool& isEnabled);
+  bool isContentCompressionEnabled() const;
+
+  /*!
+   * \brief setHttp2Allowed Allow HTTP/2 for the requests sent to Azure (parallel requests multiplexed on the same connection)
+   *
+   * HTTP/2 is only used if the server accepts it (negotiated during the TLS handshake), HTTP/1.1 is used otherwise.
+   *
+   * \param isAllowed Allow HTTP/2 (default: allowed with Qt 6, not allowed with Qt 5 as in Qt)
+   */
+  void setHttp2Allowed(const bool& isAllowed);
+  bool isHttp2Allowed() const;
+
+  /*!
+   * \brief setMaxConnectionsPerHost Set the max number of HTTP/1.1 connections opened to Azure by each network access manager
+   *
+   * Qt opens 6 connections per host by default, the other requests wait for a free connection (even if more
+   * parallel requests are allowed in the jobs). Only supported with Qt 6.5 or newer, use \s setNetworkAccessManagerCount otherwise.
+   *
+   * \param maxConnectionsPerHost Max number of connections (Qt default if 0 or negative)
+   */
+  void setMaxConnectionsPerHost(const int& maxConnectionsPerHost);
+  int maxConnectionsPerHost() const;
+
+  /*!
+   * \brief setNetworkAccessManagerCount Set the number of network access managers used in turn to send the requests
+   *
+   * Each network access manager has its own connections to Azure (6 HTTP/1.1 connections by default), so that
+   * \p count managers allow up to \p count times more requests on the wire at the same time.
+   *
+   * \param count Number of network access managers (default: 1)
+   */
+  void setNetworkAccessManagerCount(const int& count);
+  int networkAccessManagerCount() const;
+
+  /*!
+   * \brief warmUp Open connections to Azure before sending the first requests (DNS resolution, TCP and TLS handshakes done in advance)
+   *
+   * The connections are spread over the network access managers (\s setNetworkAccessManagerCount) and reused by the next requests.
+   * TLS sessions are shared between the connections of a network access manager, so that only the first handshake is a full one.
+   *
+   * \param connectionCount (optional) Number of connections to open (6 max per network access manager with HTTP/1.1)
+   */
+  void warmUp(const int& connectionCount = 1);
+
+  /*!
+   * \brief setKeepWarmInterval Warm up the connections again each time no request was sent during \p intervalInMs
+   *
+   * Idle connections are closed by Azure after a while, the next requests then pay all the handshakes again.
+   *
+   * \param intervalInMs Interval of the idle check (disabled if 0 or negative)
+   * \param connectionCount (optional) Number of connections to open each time (see \s warmUp)
+   */
+  void setKeepWarmInterval(const int& intervalInMs, const int& connectionCount = 1);
+  int keepWarmInterval() const;
+
+  /*!
+   * \brief setMetricsEnabled Aggregate the requests sent to Azure in \s metrics (latency histograms, bytes, in-flight requests, ...)
+   *
+   * \param isEnabled Enable the metrics (default: disabled, the metrics already aggregated are kept when disabled)
+   */
+  void setMetricsEnabled(const bool& isEnabled);
+  bool isMetricsEnabled() const;
+
+  /*!
+   * \brief metrics Metrics of the requests sent to Azure (can be read and exported from any thread)
+   *
+   * \return Metrics (nullptr if the metrics were never enabled)
+   */
+  QAzureStorageMetrics* metrics() const;
+
+  /*!
+   * \brief setTracer Trace each request sent to Azure (one span per request, see \s QAzureStorageTracer)
+   *
+   * A x-ms-client-request-id header is sent with each traced request so that the spans can be found in the
+   * Azure storage analytics logs.
+   *
+   * \param tracer Tracer (not owned, must outlive the requests sent while it is set), nullptr to disable tracing (default)
+   */
+  void setTracer(QAzureStorageTracer* tracer);
+  QAzureStorageTracer* tracer() const;
+
+  /*!
+   * \brief setUploadBandwidthLimit Limit the bandwidth used by all the uploads (can be changed while uploading)
+   *
+   * The uploaded content is paced by a token bucket (no burst then stall). Each upload job can also have its own limit
+   * (see \s QAzureStorageUploadJob::setBandwidthLimit), the bytes are only sent if both limits allow them.
+   *
+   * \param bytesPerSecond Max upload bandwidth (unlimited if 0 or negative, default: unlimited)
+   */
+  void setUploadBandwidthLimit(const qint64& bytesPerSecond);
+  qint64 uploadBandwidthLimit() const;
+
+  /*!
+   * \brief setDownloadBandwidthLimit Limit the bandwidth used by all the download jobs (can be changed while downloading)
+   *
+   * The received content is only read as fast as allowed, Qt then stops reading the connections (TCP flow control).
+   * Only the download jobs (\s downloadFileToPath, \s downloadPageBlobToPath) are limited: the replies of the other
+   * requests are read by the caller. Each download job can also have its own limit (see \s QAzureStorageDownloadJob::setBandwidthLimit).
+   *
+   * \param bytesPerSecond Max download bandwidth (unlimited if 0 or negative, default: unlimited)
+   */
+  void setDownloadBandwidthLimit(const qint64& bytesPerSecond);
+  qint64 downloadBandwidthLimit() const;
+
+  //! Global limiters (parents of the limiters of the jobs)
+  QAzureStorageBandwidthLimiter* uploadBandwidthLimiter();
+  QAzureStorageBandwidthLimiter* downloadBandwidthLimiter();
+
   // ------------------------------------- PUBLIC HELPER -------------------------------------
   /*!
    * \brief generateUrl Generate URL for user to download a file
@@ -82,17 +288,68 @@ public:
    * \param prefix (optional) Prefix to filter results
    * \param maxResults (optional, default: default Azure REST API number of results) Max number of elements
    * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer (in sec)
+   * \param delimiter (optional) Delimiter of virtual "folders" (usually "/"): files in sub folders of \p prefix are not listed,
+   *        each sub folder is listed once as a BlobPrefix instead
+   * \param include (optional) Additional information to get with each file (metadata, tags, ...) without requesting each file
    *
    * \return Reply from Azure (XML encoded file list if QNetworkReply::isFinished() is
    *         triggered with isErrorCodeSuccess(QNetworkReply::error())
    *         Return value can be nullptr if invalid request
    *         It is possible to decode the reply from Azure with \s QAzureStorageRestApi::parseFileList
    */
-  QNetworkReply* listFiles(const QString& container, const QString& marker = QString(), const QString& prefix = QString(), const int& maxResults = -1, const int& timeoutInSec = -1);
+  QNetworkReply* listFiles(const QString& container, const QString& marker = QString(), const QString& prefix = QString(), const int& maxResults = -1, const int& timeoutInSec = -1,
+                           const QString& delimiter = QString(), const ListIncludeOptions& include = ListIncludeOptions());
+
+  /*!
+   * \brief walkFiles List the files of an azure storage container by exploring its virtual "folders" in parallel
+   *
+   * Each virtual "folder" is listed with \p delimiter (only the files directly in the folder and its sub folders are received),
+   * then its sub folders are listed the same way, so listing a folder never lists the whole container.
+   * Results are received page by page with \s QAzureStorageListJob::filesListed and \s QAzureStorageListJob::folderFound.
+   *
+   * \param container Container to list
+   * \param prefix (optional) Virtual "folder" to list, ending with \p delimiter (whole container if empty)
+   * \param delimiter (optional) Delimiter of virtual "folders" (flat listing of \p prefix if empty)
+   * \param maxDepth (optional) Max depth of sub "folders" explored (0: only the files directly in \p prefix, -1: no limit)
+   * \param maxParallelListings (optional) Max number of listing requests sent at the same time
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer of each request (in sec)
+   *
+   * \return List job (All files listed when QAzureStorageJob::finished will be
+   *         triggered with isErrorCodeSuccess(errorCode)), the job must be deleted by the caller (deleteLater)
+   *         Return value can be nullptr if invalid request
+   */
+  QAzureStorageListJob* walkFiles(const QString& container, const QString& prefix = QString(), const QString& delimiter = "/",
+                                  const int& maxDepth = -1, const int& maxParallelListings = 4, const int& timeoutInSec = -1);
+
+  /*!
+   * \brief listFilesParallel List the files of a huge azure storage container with parallel listings of partitions of the names
+   *
+   * One listing of Azure is sequential (NextMarker), so the names are split in partitions (prefixes) listed in parallel.
+   * The partitions are the prefix followed by each character of \p partitionAlphabet (all file names after \p prefix must start
+   * with one of them, the listing is not complete otherwise, see \s QAzureStoragePartitionedListJob::isComplete), or the
+   * virtual "folders" found by listing \p prefix with \p delimiter if no alphabet is provided (always complete).
+   * Results are received with \s QAzureStoragePartitionedListJob::filesListed in lexicographic order.
+   *
+   * \param container Container to list
+   * \param prefix (optional) Prefix of the files to list (whole container if empty)
+   * \param partitionAlphabet (optional) Characters following \p prefix in the file names (for example "0123456789abcdef")
+   * \param delimiter (optional) Delimiter used to find the partitions if no alphabet is provided
+   * \param maxParallelListings (optional) Max number of listing requests sent at the same time
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer of each request (in sec)
+   *
+   * \return List job (All files listed when QAzureStorageJob::finished will be
+   *         triggered with isErrorCodeSuccess(errorCode)), the job must be deleted by the caller (deleteLater)
+   *         Return value can be nullptr if invalid request
+   */
+  QAzureStoragePartitionedListJob* listFilesParallel(const QString& container, const QString& prefix = QString(), const QString& partitionAlphabet = QString(),
+                                                     const QString& delimiter = "/", const int& maxParallelListings = 8, const int& timeoutInSec = -1);
 
   /*!
    * \brief uploadFile Upload a file from local directory into azure storage (remote path: \s container/\s blobName)
    *
+   * With \s setContentCompression, the content is compressed in the calling thread before sending the request
+   * (use \s uploadFileInBlocks to compress big files in worker threads).
+   *
    * Full details: https://learn.microsoft.com/en-us/rest/api/storageservices/put-blob?tabs=microsoft-entra-id
    *
    * \param filePath Absolute path of the local file to upload
@@ -110,6 +367,9 @@ public:
   /*!
    * \brief uploadFileQByteArray Upload a file from QByteArray into azure storage (remote path: \s container/\s blobName)
    *
+   * With \s setContentCompression, the content is compressed in the calling thread before sending the request
+   * (use \s uploadFileInBlocks to compress big files in worker threads).
+   *
    * Full details: https://learn.microsoft.com/en-us/rest/api/storageservices/put-blob?tabs=microsoft-entra-id
    *
    * \param fileContent Content of the file to upload
@@ -124,6 +384,196 @@ public:
    */
   QNetworkReply* uploadFileQByteArray(const QByteArray& fileContent, const QString& container, const QString& blobName, const QString& blobType = "BlockBlob", const int& timeoutInSec = -1);
 
+  /*!
+   * \brief uploadBlock Upload a block (not yet part of the file) of a block blob into azure storage (remote path: \s container/\s blobName)
+   *
+   * Full details: https://learn.microsoft.com/en-us/rest/api/storageservices/put-block?tabs=microsoft-entra-id
+   *
+   * \param container Container to put the file into
+   * \param blobName Name of the file (blob) the block belongs to
+   * \param blockId Base64 block ID (all block IDs of a blob must have the same length)
+   * \param blockContent Content of the block
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer (in sec)
+   * \param bandwidthLimiter (optional) Bandwidth limiter of the transfer (global upload limiter if nullptr)
+   *
+   * \return Reply from Azure (Uploaded with success if QNetworkReply::isFinished() is
+   *         triggered with isErrorCodeSuccess(QNetworkReply::error())
+   *         Return value can be nullptr if invalid request
+   */
+  QNetworkReply* uploadBlock(const QString& container, const QString& blobName, const QString& blockId, const QByteArray& blockContent, const int& timeoutInSec = -1,
+                             QAzureStorageBandwidthLimiter* bandwidthLimiter = nullptr);
+
+  /*!
+   * \brief commitBlockList Create the file (block blob) from its uploaded blocks (remote path: \s container/\s blobName)
+   *
+   * Full details: https://learn.microsoft.com/en-us/rest/api/storageservices/put-block-list?tabs=microsoft-entra-id
+   *
+   * \param container Container to put the file into
+   * \param blobName Name of the file (blob) to create
+   * \param blockIds Ordered list of the base64 block IDs making the file
+   * \param blobContentEncoding (optional) Content-Encoding of the file (e.g. "gzip" if the blocks are compressed)
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer (in sec)
+   *
+   * \return Reply from Azure (File created if QNetworkReply::isFinished() is
+   *         triggered with isErrorCodeSuccess(QNetworkReply::error())
+   *         Return value can be nullptr if invalid request
+   */
+  QNetworkReply* commitBlockList(const QString& container, const QString& blobName, const QStringList& blockIds,
+                                 const QString& blobContentEncoding = QString(), const int& timeoutInSec = -1);
+
+  /*!
+   * \brief getBlockList Get the list of blocks of a block blob (remote path: \s container/\s blobName)
+   *
+   * Full details: https://learn.microsoft.com/en-us/rest/api/storageservices/get-block-list?tabs=microsoft-entra-id
+   *
+   * \param container Container of the file
+   * \param blobName Name of the file (blob)
+   * \param blockListType (optional) Blocks to list: "committed", "uncommitted" or "all"
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer (in sec)
+   *
+   * \return Reply from Azure (XML encoded block list if QNetworkReply::isFinished() is
+   *         triggered with isErrorCodeSuccess(QNetworkReply::error())
+   *         Return value can be nullptr if invalid request
+   *         It is possible to decode the reply from Azure with \s QAzureStorageRestApi::parseBlockList
+   */
+  QNetworkReply* getBlockList(const QString& container, const QString& blobName, const QString& blockListType = "all", const int& timeoutInSec = -1);
+
+  /*!
+   * \brief createAppendBlob Create an empty append blob (replaced if it already exists) in azure storage (remote path: \s container/\s blobName)
+   *
+   * Full details: https://learn.microsoft.com/en-us/rest/api/storageservices/put-blob?tabs=microsoft-entra-id
+   *
+   * \param container Container to put the file into
+   * \param blobName Name of the file (append blob) to create
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer (in sec)
+   *
+   * \return Reply from Azure (Created with success if QNetworkReply::isFinished() is
+   *         triggered with isErrorCodeSuccess(QNetworkReply::error())
+   *         Return value can be nullptr if invalid request
+   */
+  QNetworkReply* createAppendBlob(const QString& container, const QString& blobName, const int& timeoutInSec = -1);
+
+  /*!
+   * \brief appendBlock Append content at the end of an append blob (remote path: \s container/\s blobName)
+   *
+   * Full details: https://learn.microsoft.com/en-us/rest/api/storageservices/append-block?tabs=microsoft-entra-id
+   *
+   * \param container Container of the file
+   * \param blobName Name of the file (append blob) to append content to
+   * \param blockContent Content to append (4 MiB max)
+   * \param appendPosition (optional) Expected size of the blob before appending (x-ms-blob-condition-appendpos),
+   *        the request fails with error 412 if the blob has another size (ignored if negative)
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer (in sec)
+   *
+   * \return Reply from Azure (Appended with success if QNetworkReply::isFinished() is
+   *         triggered with isErrorCodeSuccess(QNetworkReply::error())
+   *         Return value can be nullptr if invalid request
+   */
+  QNetworkReply* appendBlock(const QString& container, const QString& blobName, const QByteArray& blockContent,
+                             const qint64& appendPosition = -1, const int& timeoutInSec = -1);
+
+  /*!
+   * \brief uploadFileInBlocks Upload a big file from local directory into azure storage (remote path: \s container/\s blobName) using parallel blocks
+   *
+   * Only the blocks being uploaded are kept in memory. If \p journalPath is provided, the uploaded blocks are
+   * written in this local journal so that an interrupted upload (crash, restart, ...) only uploads the missing blocks.
+   *
+   * \param filePath Absolute path of the local file to upload
+   * \param container Container to put the file into
+   * \param blobName Name of the file (block blob) to create
+   * \param blockSizeInBytes (optional) Size of each block
+   * \param maxParallelBlocks (optional) Max number of blocks uploaded at the same time
+   * \param journalPath (optional) Local journal of the uploaded blocks (no journal if empty)
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer of each request (in sec)
+   *
+   * \return Upload job (File will be uploaded when QAzureStorageJob::finished will be
+   *         triggered with isErrorCodeSuccess(errorCode)), the job must be deleted by the caller (deleteLater)
+   *         Return value can be nullptr if invalid request or filePath is invalid
+   */
+  QAzureStorageUploadJob* uploadFileInBlocks(const QString& filePath, const QString& container, const QString& blobName,
+                                             const qint64& blockSizeInBytes = 4 * 1024 * 1024, const int& maxParallelBlocks = 4,
+                                             const QString& journalPath = QString(), const int& timeoutInSec = -1);
+
+  /*!
+   * \brief createPageBlob Create a page blob filled with zeros (replaced if it already exists) in azure storage (remote path: \s container/\s blobName)
+   *
+   * Full details: https://learn.microsoft.com/en-us/rest/api/storageservices/put-blob?tabs=microsoft-entra-id
+   *
+   * \param container Container to put the file into
+   * \param blobName Name of the file (page blob) to create
+   * \param blobSizeInBytes Size of the page blob (multiple of 512 bytes)
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer (in sec)
+   *
+   * \return Reply from Azure (Created with success if QNetworkReply::isFinished() is
+   *         triggered with isErrorCodeSuccess(QNetworkReply::error())
+   *         Return value can be nullptr if invalid request
+   */
+  QNetworkReply* createPageBlob(const QString& container, const QString& blobName, const qint64& blobSizeInBytes, const int& timeoutInSec = -1);
+
+  /*!
+   * \brief uploadPages Write pages into a page blob (remote path: \s container/\s blobName)
+   *
+   * Full details: https://learn.microsoft.com/en-us/rest/api/storageservices/put-page?tabs=microsoft-entra-id
+   *
+   * \param container Container of the file
+   * \param blobName Name of the file (page blob) to write into
+   * \param offset Offset of the first page in the blob (multiple of 512 bytes)
+   * \param pagesContent Content of the pages (multiple of 512 bytes, 4 MiB max)
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer (in sec)
+   * \param bandwidthLimiter (optional) Bandwidth limiter of the transfer (global upload limiter if nullptr)
+   *
+   * \return Reply from Azure (Written with success if QNetworkReply::isFinished() is
+   *         triggered with isErrorCodeSuccess(QNetworkReply::error())
+   *         Return value can be nullptr if invalid request
+   */
+  QNetworkReply* uploadPages(const QString& container, const QString& blobName, const qint64& offset, const QByteArray& pagesContent,
+                             const int& timeoutInSec = -1, QAzureStorageBandwidthLimiter* bandwidthLimiter = nullptr);
+
+  /*!
+   * \brief uploadFileAsPageBlob Upload a file (disk image, ...) from local directory into azure storage as a page blob (remote path: \s container/\s blobName)
+   *
+   * The file is read in 512 bytes pages and only the pages which are not filled with zeros are uploaded
+   * (the page blob is created filled with zeros), using parallel Put Page requests.
+   * The page blob size is the file size rounded up to a multiple of 512 bytes.
+   *
+   * \param filePath Absolute path of the local file to upload
+   * \param container Container to put the file into
+   * \param blobName Name of the file (page blob) to create
+   * \param maxParallelRanges (optional) Max number of page ranges uploaded at the same time
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer of each request (in sec)
+   *
+   * \return Upload job (File will be uploaded when QAzureStorageJob::finished will be
+   *         triggered with isErrorCodeSuccess(errorCode)), the job must be deleted by the caller (deleteLater)
+   *         Return value can be nullptr if invalid request or filePath is invalid
+   */
+  QAzureStoragePageBlobUploadJob* uploadFileAsPageBlob(const QString& filePath, const QString& container, const QString& blobName,
+                                                       const int& maxParallelRanges = 4, const int& timeoutInSec = -1);
+
+  /*!
+   * \brief uploadDirectory Upload all the files of a local directory (and its sub directories) into azure storage (remote path: \s container/\s prefix/relative path)
+   *
+   * The files are uploaded in parallel: files up to \p singlePutMaxSizeInBytes with a single Put Blob request each,
+   * bigger files with parallel blocks (biggest files first). A failed file does not stop the other files
+   * (see \s QAzureStorageDirectoryUploadJob::fileUploaded and \s QAzureStorageDirectoryUploadJob::failedFiles).
+   *
+   * \param localPath Local directory to upload
+   * \param container Container to put the files into
+   * \param prefix (optional) Virtual "folder" of the files in the container (container root if empty)
+   * \param maxParallelRequests (optional) Max number of requests sent at the same time (a big file uses \p maxParallelBlocks of them)
+   * \param singlePutMaxSizeInBytes (optional) Files up to this size are uploaded with a single request
+   * \param blockSizeInBytes (optional) Size of the blocks of the bigger files
+   * \param maxParallelBlocks (optional) Max number of blocks of a big file uploaded at the same time
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer of each request (in sec)
+   *
+   * \return Upload job (Files will be uploaded when QAzureStorageJob::finished will be
+   *         triggered with isErrorCodeSuccess(errorCode)), the job must be deleted by the caller (deleteLater)
+   *         Return value can be nullptr if invalid request or localPath is not a directory
+   */
+  QAzureStorageDirectoryUploadJob* uploadDirectory(const QString& localPath, const QString& container, const QString& prefix = QString(),
+                                                   const int& maxParallelRequests = 16, const qint64& singlePutMaxSizeInBytes = 4 * 1024 * 1024,
+                                                   const qint64& blockSizeInBytes = 4 * 1024 * 1024, const int& maxParallelBlocks = 4,
+                                                   const int& timeoutInSec = -1);
+
   /*!
    * \brief deleteFile Delete a file from azure storage (remote path: \s container/\s blobName)
    *
@@ -154,6 +604,245 @@ public:
    */
   QNetworkReply* downloadFile(const QString& container, const QString& blobName, const int& timeoutInSec = -1);
 
+  /*!
+   * \brief downloadFileRange Download a range of bytes of a file from azure storage (remote path: \s container/\s blobName)
+   *
+   * Full details: https://learn.microsoft.com/en-us/rest/api/storageservices/specifying-the-range-header-for-blob-service-operations
+   *
+   * \param container Container to take the file from
+   * \param blobName File (any kind of blob) to download
+   * \param offset First byte of the range to download
+   * \param length Number of bytes to download from \p offset
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer (in sec)
+   *
+   * \return Reply from Azure (Range will be available when QNetworkReply::isFinished() will
+   *         triggered with isErrorCodeSuccess(QNetworkReply::error())
+   *         Return value can be nullptr if invalid request
+   */
+  QNetworkReply* downloadFileRange(const QString& container, const QString& blobName, const qint64& offset, const qint64& length, const int& timeoutInSec = -1);
+
+  /*!
+   * \brief getFileProperties Get the properties of a file from azure storage without its content (remote path: \s container/\s blobName)
+   *
+   * Full details: https://learn.microsoft.com/en-us/rest/api/storageservices/get-blob-properties?tabs=microsoft-entra-id
+   *
+   * \param container Container to take the file properties from
+   * \param blobName File (any kind of blob) to check
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer (in sec)
+   *
+   * \return Reply from Azure (Properties (Content-Length, Content-MD5, x-ms-blob-type, ...) will be available
+   *         in the reply headers when QNetworkReply::isFinished() will triggered with isErrorCodeSuccess(QNetworkReply::error())
+   *         Return value can be nullptr if invalid request
+   */
+  QNetworkReply* getFileProperties(const QString& container, const QString& blobName, const int& timeoutInSec = -1);
+
+  /*!
+   * \brief setFileTags Set (replace) the index tags of a file in azure storage (remote path: \s container/\s blobName)
+   *
+   * Full details: https://learn.microsoft.com/en-us/rest/api/storageservices/set-blob-tags?tabs=microsoft-entra-id
+   *
+   * \param container Container of the file
+   * \param blobName Name of the file (blob)
+   * \param tags Index tags of the file (10 max, all previous tags are removed if empty)
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer (in sec)
+   *
+   * \return Reply from Azure (Tags set with success if QNetworkReply::isFinished() is
+   *         triggered with isErrorCodeSuccess(QNetworkReply::error())
+   *         Return value can be nullptr if invalid request
+   */
+  QNetworkReply* setFileTags(const QString& container, const QString& blobName, const QMap<QString,QString>& tags, const int& timeoutInSec = -1);
+
+  /*!
+   * \brief getFileTags Get the index tags of a file from azure storage (remote path: \s container/\s blobName)
+   *
+   * Full details: https://learn.microsoft.com/en-us/rest/api/storageservices/get-blob-tags?tabs=microsoft-entra-id
+   *
+   * \param container Container of the file
+   * \param blobName Name of the file (blob)
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer (in sec)
+   *
+   * \return Reply from Azure (XML encoded tags if QNetworkReply::isFinished() is
+   *         triggered with isErrorCodeSuccess(QNetworkReply::error())
+   *         Return value can be nullptr if invalid request
+   *         It is possible to decode the reply from Azure with \s QAzureStorageRestApi::parseTags
+   */
+  QNetworkReply* getFileTags(const QString& container, const QString& blobName, const int& timeoutInSec = -1);
+
+  /*!
+   * \brief findFilesByTags Find the files whose index tags match an expression (filtered by Azure, without listing the files)
+   *
+   * Full details: https://learn.microsoft.com/en-us/rest/api/storageservices/find-blobs-by-tags?tabs=microsoft-entra-id
+   *
+   * \param whereExpression Index tags expression (for example "\"tenant\" = 'abc' AND \"date\" >= '2023-11-01'")
+   * \param container (optional) Container to search in (whole account if empty)
+   * \param marker (optional) Marker received in the previous answer to get the next files
+   * \param maxResults (optional, default: default Azure REST API number of results) Max number of elements
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer (in sec)
+   *
+   * \return Reply from Azure (XML encoded file list if QNetworkReply::isFinished() is
+   *         triggered with isErrorCodeSuccess(QNetworkReply::error())
+   *         Return value can be nullptr if invalid request
+   *         It is possible to decode the reply from Azure with \s QAzureStorageRestApi::parseFileList
+   *         (Name, ContainerName and the matching tags as "Tags:<key>")
+   */
+  QNetworkReply* findFilesByTags(const QString& whereExpression, const QString& container = QString(), const QString& marker = QString(),
+                                 const int& maxResults = -1, const int& timeoutInSec = -1);
+
+  /*!
+   * \brief findAllFilesByTags Find all the files whose index tags match an expression, following all result pages
+   *
+   * Results are received page by page with \s QAzureStorageFindByTagsJob::filesFound.
+   *
+   * \param whereExpression Index tags expression (for example "\"tenant\" = 'abc' AND \"status\" = 'done'")
+   * \param container (optional) Container to search in (whole account if empty)
+   * \param maxResultsPerPage (optional, default: default Azure REST API number of results) Max number of files per result page
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer of each request (in sec)
+   *
+   * \return Find job (All files found when QAzureStorageJob::finished will be
+   *         triggered with isErrorCodeSuccess(errorCode)), the job must be deleted by the caller (deleteLater)
+   *         Return value can be nullptr if invalid request
+   */
+  QAzureStorageFindByTagsJob* findAllFilesByTags(const QString& whereExpression, const QString& container = QString(),
+                                                 const int& maxResultsPerPage = -1, const int& timeoutInSec = -1);
+
+  /*!
+   * \brief downloadFileToPath Download a file from azure storage (remote path: \s container/\s blobName) into a local file
+   *
+   * The local file is pre-sized to the blob size and each range (downloaded in parallel) is written
+   * directly at its offset when received, so the memory used does not depend on the blob size.
+   *
+   * \param container Container to take the file from
+   * \param blobName File (any kind of blob) to download
+   * \param filePath Absolute path of the local file to write (created if needed)
+   * \param rangeSizeInBytes (optional) Size of each range requested to Azure
+   * \param maxParallelRanges (optional) Max number of ranges downloaded at the same time
+   * \param journalPath (optional) Local journal of the downloaded ranges used to resume an interrupted download (no journal if empty)
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer of each request (in sec)
+   *
+   * \return Download job (File will be available when QAzureStorageJob::finished will be
+   *         triggered with isErrorCodeSuccess(errorCode)), the job must be deleted by the caller (deleteLater)
+   *         Return value can be nullptr if invalid request
+   */
+  QAzureStorageDownloadJob* downloadFileToPath(const QString& container, const QString& blobName, const QString& filePath,
+                                               const qint64& rangeSizeInBytes = 4 * 1024 * 1024, const int& maxParallelRanges = 4,
+                                               const QString& journalPath = QString(), const int& timeoutInSec = -1);
+
+  /*!
+   * \brief getPageRanges Get the page ranges of a page blob (remote path: \s container/\s blobName) which contain data
+   *
+   * Full details: https://learn.microsoft.com/en-us/rest/api/storageservices/get-page-ranges?tabs=microsoft-entra-id
+   *
+   * \param container Container of the file
+   * \param blobName Name of the file (page blob)
+   * \param prevSnapshot (optional) Snapshot (DateTime) to compare with: only the pages changed since this snapshot are listed
+   *        (as page ranges if written, as clear ranges if cleared)
+   * \param marker (optional) Marker received in the previous answer to get the next page ranges
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer (in sec)
+   *
+   * \return Reply from Azure (XML encoded page ranges if QNetworkReply::isFinished() is
+   *         triggered with isErrorCodeSuccess(QNetworkReply::error())
+   *         Return value can be nullptr if invalid request
+   *         It is possible to decode the reply from Azure with \s QAzureStorageRestApi::parsePageRanges
+   */
+  QNetworkReply* getPageRanges(const QString& container, const QString& blobName, const QString& prevSnapshot = QString(),
+                               const QString& marker = QString(), const int& timeoutInSec = -1);
+
+  /*!
+   * \brief downloadPageBlobToPath Download a page blob (disk image, ...) from azure storage (remote path: \s container/\s blobName)
+   *        into a sparse local file
+   *
+   * Only the page ranges containing data (\s getPageRanges) are downloaded, the other parts of the local file are left
+   * as holes. If \p prevSnapshot is provided, the local file must contain the blob as it was in this snapshot: only the
+   * pages changed since this snapshot are downloaded and the cleared pages are written with zeros.
+   *
+   * \param container Container to take the file from
+   * \param blobName File (page blob) to download
+   * \param filePath Absolute path of the local file to write (created if needed)
+   * \param prevSnapshot (optional) Snapshot (DateTime) already in the local file (full download if empty)
+   * \param rangeSizeInBytes (optional) Max size of each range requested to Azure
+   * \param maxParallelRanges (optional) Max number of ranges downloaded at the same time
+   * \param journalPath (optional) Local journal of the downloaded ranges used to resume an interrupted download (no journal if empty)
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer of each request (in sec)
+   *
+   * \return Download job (File will be available when QAzureStorageJob::finished will be
+   *         triggered with isErrorCodeSuccess(errorCode)), the job must be deleted by the caller (deleteLater)
+   *         Return value can be nullptr if invalid request
+   */
+  QAzureStorageDownloadJob* downloadPageBlobToPath(const QString& container, const QString& blobName, const QString& filePath,
+                                                   const QString& prevSnapshot = QString(), const qint64& rangeSizeInBytes = 4 * 1024 * 1024,
+                                                   const int& maxParallelRanges = 4, const QString& journalPath = QString(),
+                                                   const int& timeoutInSec = -1);
+
+  /*!
+   * \brief downloadPrefix Download all the files of a virtual "folder" of azure storage (remote path: \s container/\s prefix) into a local directory
+   *
+   * The files are downloaded in parallel as soon as their listing page is received (the listing goes on meanwhile):
+   * files up to \p singleGetMaxSizeInBytes with a single Get Blob request each, bigger files with parallel ranges.
+   * The virtual "folders" are created as local directories. A failed file does not stop the other files
+   * (see \s QAzureStorageDirectoryDownloadJob::fileDownloaded and \s QAzureStorageDirectoryDownloadJob::failedFiles).
+   *
+   * \param container Container to download from
+   * \param prefix Virtual "folder" to download (whole container if empty)
+   * \param localPath Local directory to download the files into (created if needed)
+   * \param maxParallelRequests (optional) Max number of download requests sent at the same time (a big file uses \p maxParallelRanges of them)
+   * \param singleGetMaxSizeInBytes (optional) Files up to this size are downloaded with a single request
+   * \param rangeSizeInBytes (optional) Size of the ranges of the bigger files
+   * \param maxParallelRanges (optional) Max number of ranges of a big file downloaded at the same time
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer of each request (in sec)
+   *
+   * \return Download job (Files will be downloaded when QAzureStorageJob::finished will be
+   *         triggered with isErrorCodeSuccess(errorCode)), the job must be deleted by the caller (deleteLater)
+   *         Return value can be nullptr if invalid request
+   */
+  QAzureStorageDirectoryDownloadJob* downloadPrefix(const QString& container, const QString& prefix, const QString& localPath,
+                                                    const int& maxParallelRequests = 16, const qint64& singleGetMaxSizeInBytes = 4 * 1024 * 1024,
+                                                    const qint64& rangeSizeInBytes = 4 * 1024 * 1024, const int& maxParallelRanges = 4,
+                                                    const int& timeoutInSec = -1);
+
+  /*!
+   * \brief sync Synchronize a local directory with a virtual "folder" of azure storage (remote path: \s container/\s prefix):
+   *        only the new and changed files are transferred
+   *
+   * A file is unchanged if it has the same size and: the same state as after the last synchronization (manifest), or the same MD5
+   * as the Content-MD5 of the blob (the local file is hashed only if needed), or (blob without MD5) it is not more recent on the reference side.
+   * A failed file does not stop the other files (see \s QAzureStorageSyncJob::fileSynced and \s QAzureStorageSyncJob::failedFiles).
+   *
+   * \param localPath Local directory to synchronize (must exist for \s SyncUpload, created if needed for \s SyncDownload)
+   * \param container Container to synchronize
+   * \param prefix Virtual "folder" to synchronize (whole container if empty)
+   * \param direction Side which is the reference (the other side is updated)
+   * \param isDeletingExtraneous (optional) Delete the files of the updated side which are not on the reference side
+   * \param manifestPath (optional) Local manifest of the last synchronization used to skip unchanged files without hashing them (no manifest if empty)
+   * \param maxParallelRequests (optional) Max number of requests sent at the same time
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer of each request (in sec)
+   *
+   * \return Sync job (Files will be synchronized when QAzureStorageJob::finished will be
+   *         triggered with isErrorCodeSuccess(errorCode)), the job must be deleted by the caller (deleteLater)
+   *         Return value can be nullptr if invalid request
+   */
+  QAzureStorageSyncJob* sync(const QString& localPath, const QString& container, const QString& prefix, const SyncDirection& direction,
+                             const bool& isDeletingExtraneous = false, const QString& manifestPath = QString(),
+                             const int& maxParallelRequests = 16, const int& timeoutInSec = -1);
+
+  /*!
+   * \brief readChangeFeed Read the events of the change feed of the storage account (creation, deletion, properties of the blobs)
+   *        since the last read: the cost is proportional to the changes, not to the number of files in the containers
+   *
+   * The change feed must be enabled on the storage account. Events are read from the $blobchangefeed container
+   * (Avro files decoded while downloaded) and the position already read is kept in a local cursor file.
+   * \s QAzureStorageChangeFeedJob::filesChanged can be applied directly to a \s QAzureStorageInventory.
+   *
+   * Full details: https://learn.microsoft.com/en-us/azure/storage/blobs/storage-blob-change-feed
+   *
+   * \param cursorPath Local cursor of the events already read (created if needed, change feed always read from its start if empty)
+   * \param container (optional) Only report the events of this container (all containers if empty)
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer of each request (in sec)
+   *
+   * \return Change feed job (Events will be read when QAzureStorageJob::finished will be
+   *         triggered with isErrorCodeSuccess(errorCode)), the job must be deleted by the caller (deleteLater)
+   */
+  QAzureStorageChangeFeedJob* readChangeFeed(const QString& cursorPath, const QString& container = QString(), const int& timeoutInSec = -1);
+
   /*!
    * \brief createContainer Create a container
    *
@@ -204,10 +893,72 @@ public:
    * \param prefix (optional) Prefix to filter results
    * \param maxResults (optional, default: default Azure REST API number of results) Max number of elements
    * \param timeoutInSec (optional) Max time to wait answer (in sec)
+   * \param delimiter (optional) Delimiter of virtual "folders" (usually "/")
+   * \param[out] foundBlobPrefixes (optional) Virtual "folders" found (only when listing with a delimiter)
+   * \param include (optional) Additional information to get with each file (metadata, tags, ...)
+   *
+   * \return isErrorCodeSuccess(QNetworkReply::NetworkError) if list retrieved successfully on time
+   */
+  QNetworkReply::NetworkError listFilesSynchronous(const QString& container, QList< QMap<QString,QString> >& foundListOfFiles, const QString& marker = QString(), const QString& prefix = QString(), const int& maxResults = -1, const int& timeoutInSec = 30, const bool& forceTimeoutOnApi = false,
+                                                   const QString& delimiter = QString(), QStringList* foundBlobPrefixes = nullptr,
+                                                   const ListIncludeOptions& include = ListIncludeOptions());
+
+  /*!
+   * \brief walkFilesSynchronous Synchronous method to list the files of an azure storage container by exploring its virtual "folders" in parallel
+   *
+   * \param container Container to list
+   * \param[out] foundListOfFiles List of files retrieved from Azure API (if no error)
+   * \param[out] foundFolders (optional) Virtual "folders" found
+   * \param prefix (optional) Virtual "folder" to list, ending with \p delimiter (whole container if empty)
+   * \param delimiter (optional) Delimiter of virtual "folders" (flat listing of \p prefix if empty)
+   * \param maxDepth (optional) Max depth of sub "folders" explored (0: only the files directly in \p prefix, -1: no limit)
+   * \param maxParallelListings (optional) Max number of listing requests sent at the same time
+   * \param timeoutInSec (optional) Max time to wait the full listing (in sec)
+   *
+   * \return isErrorCodeSuccess(QNetworkReply::NetworkError) if list retrieved successfully on time
+   */
+  QNetworkReply::NetworkError walkFilesSynchronous(const QString& container, QList< QMap<QString,QString> >& foundListOfFiles, QStringList* foundFolders = nullptr,
+                                                   const QString& prefix = QString(), const QString& delimiter = "/", const int& maxDepth = -1,
+                                                   const int& maxParallelListings = 4, const int& timeoutInSec = 300, const bool& forceTimeoutOnApi = false);
+
+  /*!
+   * \brief listFilesParallelSynchronous Synchronous method to list the files of a huge azure storage container with parallel listings of partitions of the names
+   *
+   * \param container Container to list
+   * \param[out] foundListOfFiles List of files retrieved from Azure API in lexicographic order (if no error)
+   * \param[out] isComplete (optional) Set to true only if \p foundListOfFiles is known to contain all the files of \p prefix
+   *             (never with a partition alphabet, see \s QAzureStoragePartitionedListJob::isComplete)
+   * \param prefix (optional) Prefix of the files to list (whole container if empty)
+   * \param partitionAlphabet (optional) Characters following \p prefix in the file names (for example "0123456789abcdef")
+   * \param delimiter (optional) Delimiter used to find the partitions if no alphabet is provided
+   * \param maxParallelListings (optional) Max number of listing requests sent at the same time
+   * \param timeoutInSec (optional) Max time to wait the full listing (in sec)
    *
    * \return isErrorCodeSuccess(QNetworkReply::NetworkError) if list retrieved successfully on time
    */
-  QNetworkReply::NetworkError listFilesSynchronous(const QString& container, QList< QMap<QString,QString> >& foundListOfFiles, const QString& marker = QString(), const QString& prefix = QString(), const int& maxResults = -1, const int& timeoutInSec = 30, const bool& forceTimeoutOnApi = false);
+  QNetworkReply::NetworkError listFilesParallelSynchronous(const QString& container, QList< QMap<QString,QString> >& foundListOfFiles, bool* isComplete = nullptr,
+                                                           const QString& prefix = QString(), const QString& partitionAlphabet = QString(),
+                                                           const QString& delimiter = "/", const int& maxParallelListings = 8,
+                                                           const int& timeoutInSec = 300, const bool& forceTimeoutOnApi = false);
+
+  /*!
+   * \brief refreshInventorySynchronous Synchronous method to list a prefix of the container of a local inventory and replace its files in the inventory
+   *
+   * Only the files under \p prefix are listed (virtual "folders" of \p prefix listed in parallel): a refresh of a part
+   * of the container is as fast as listing this part, the other files of the inventory are kept.
+   * The files of \p prefix are only replaced by a complete listing, so no partition alphabet is used
+   * (files outside the alphabet would not be listed and would be removed from the inventory).
+   *
+   * \param inventory Inventory to refresh (opened with its container, see \s QAzureStorageInventory::open)
+   * \param prefix (optional) Prefix of the files to refresh (whole container if empty)
+   * \param maxParallelListings (optional) Max number of listing requests sent at the same time
+   * \param timeoutInSec (optional) Max time to wait the full listing (in sec)
+   *
+   * \return isErrorCodeSuccess(QNetworkReply::NetworkError) if the prefix was listed and the inventory written successfully on time
+   */
+  QNetworkReply::NetworkError refreshInventorySynchronous(QAzureStorageInventory& inventory, const QString& prefix = QString(),
+                                                          const int& maxParallelListings = 8, const int& timeoutInSec = 300,
+                                                          const bool& forceTimeoutOnApi = false);
 
   /*!
    * \brief uploadFileSynchronous Synchronous method to upload a file from local directory into azure storage (remote path: \s container/\s blobName)
@@ -235,6 +986,57 @@ public:
    */
   QNetworkReply::NetworkError uploadFileQByteArraySynchronous(const QByteArray& fileContent, const QString& container, const QString& blobName, const QString& blobType = "BlockBlob", const int& timeoutInSec = 30, const bool& forceTimeoutOnApi = false);
 
+  /*!
+   * \brief uploadFileInBlocksSynchronous Synchronous method to upload a big file from local directory into azure storage (remote path: \s container/\s blobName) using parallel blocks
+   *
+   * \param filePath Absolute path of the local file to upload
+   * \param container Container to put the file into
+   * \param blobName Name of the file (block blob) to create
+   * \param blockSizeInBytes (optional) Size of each block
+   * \param maxParallelBlocks (optional) Max number of blocks uploaded at the same time
+   * \param journalPath (optional) Local journal of the uploaded blocks used to resume an interrupted upload (no journal if empty)
+   * \param timeoutInSec (optional) Max time to wait the full upload (in sec)
+   *
+   * \return isErrorCodeSuccess(QNetworkReply::NetworkError) if uploaded successfully on time
+   */
+  QNetworkReply::NetworkError uploadFileInBlocksSynchronous(const QString& filePath, const QString& container, const QString& blobName,
+                                                            const qint64& blockSizeInBytes = 4 * 1024 * 1024, const int& maxParallelBlocks = 4,
+                                                            const QString& journalPath = QString(), const int& timeoutInSec = 300,
+                                                            const bool& forceTimeoutOnApi = false);
+
+  /*!
+   * \brief uploadFileAsPageBlobSynchronous Synchronous method to upload a file from local directory into azure storage as a page blob
+   *        (remote path: \s container/\s blobName) skipping the pages filled with zeros
+   *
+   * \param filePath Absolute path of the local file to upload
+   * \param container Container to put the file into
+   * \param blobName Name of the file (page blob) to create
+   * \param maxParallelRanges (optional) Max number of page ranges uploaded at the same time
+   * \param timeoutInSec (optional) Max time to wait the full upload (in sec)
+   *
+   * \return isErrorCodeSuccess(QNetworkReply::NetworkError) if uploaded successfully on time
+   */
+  QNetworkReply::NetworkError uploadFileAsPageBlobSynchronous(const QString& filePath, const QString& container, const QString& blobName,
+                                                              const int& maxParallelRanges = 4, const int& timeoutInSec = 300,
+                                                              const bool& forceTimeoutOnApi = false);
+
+  /*!
+   * \brief uploadDirectorySynchronous Synchronous method to upload all the files of a local directory (and its sub directories) into azure storage
+   *
+   * \param localPath Local directory to upload
+   * \param container Container to put the files into
+   * \param prefix (optional) Virtual "folder" of the files in the container (container root if empty)
+   * \param failedFiles (optional) Files which could not be uploaded (path relative to \p localPath, error)
+   * \param maxParallelRequests (optional) Max number of requests sent at the same time
+   * \param timeoutInSec (optional) Max time to wait the full upload (in sec)
+   *
+   * \return isErrorCodeSuccess(QNetworkReply::NetworkError) if all the files were uploaded successfully on time
+   */
+  QNetworkReply::NetworkError uploadDirectorySynchronous(const QString& localPath, const QString& container, const QString& prefix = QString(),
+                                                         QMap<QString, QNetworkReply::NetworkError>* failedFiles = nullptr,
+                                                         const int& maxParallelRequests = 16, const int& timeoutInSec = 3600,
+                                                         const bool& forceTimeoutOnApi = false);
+
   /*!
    * \brief deleteFileSynchronous Synchronous method to delete a file from azure storage (remote path: \s container/\s blobName)
    *
@@ -258,6 +1060,134 @@ public:
    */
   QNetworkReply::NetworkError downloadFileSynchronous(const QString& container, const QString& blobName, QByteArray& downloadedFile, const int& timeoutInSec = 30, const bool& forceTimeoutOnApi = false);
 
+  /*!
+   * \brief downloadFileToPathSynchronous Synchronous method to download a file from azure storage (remote path: \s container/\s blobName) into a local file
+   *
+   * \param container Container to take the file from
+   * \param blobName File (any kind of blob) to download
+   * \param filePath Absolute path of the local file to write (created if needed)
+   * \param rangeSizeInBytes (optional) Size of each range requested to Azure
+   * \param maxParallelRanges (optional) Max number of ranges downloaded at the same time
+   * \param journalPath (optional) Local journal of the downloaded ranges used to resume an interrupted download (no journal if empty)
+   * \param timeoutInSec (optional) Max time to wait the full download (in sec)
+   *
+   * \return isErrorCodeSuccess(QNetworkReply::NetworkError) if downloaded successfully on time
+   */
+  QNetworkReply::NetworkError downloadFileToPathSynchronous(const QString& container, const QString& blobName, const QString& filePath,
+                                                            const qint64& rangeSizeInBytes = 4 * 1024 * 1024, const int& maxParallelRanges = 4,
+                                                            const QString& journalPath = QString(), const int& timeoutInSec = 300,
+                                                            const bool& forceTimeoutOnApi = false);
+
+  /*!
+   * \brief downloadPageBlobToPathSynchronous Synchronous method to download a page blob from azure storage (remote path: \s container/\s blobName)
+   *        into a sparse local file (only the page ranges containing data are downloaded)
+   *
+   * \param container Container to take the file from
+   * \param blobName File (page blob) to download
+   * \param filePath Absolute path of the local file to write (created if needed)
+   * \param prevSnapshot (optional) Snapshot (DateTime) already in the local file (full download if empty)
+   * \param rangeSizeInBytes (optional) Max size of each range requested to Azure
+   * \param maxParallelRanges (optional) Max number of ranges downloaded at the same time
+   * \param journalPath (optional) Local journal of the downloaded ranges used to resume an interrupted download (no journal if empty)
+   * \param timeoutInSec (optional) Max time to wait the full download (in sec)
+   *
+   * \return isErrorCodeSuccess(QNetworkReply::NetworkError) if downloaded successfully on time
+   */
+  QNetworkReply::NetworkError downloadPageBlobToPathSynchronous(const QString& container, const QString& blobName, const QString& filePath,
+                                                                const QString& prevSnapshot = QString(), const qint64& rangeSizeInBytes = 4 * 1024 * 1024,
+                                                                const int& maxParallelRanges = 4, const QString& journalPath = QString(),
+                                                                const int& timeoutInSec = 300, const bool& forceTimeoutOnApi = false);
+
+  /*!
+   * \brief downloadPrefixSynchronous Synchronous method to download all the files of a virtual "folder" of azure storage into a local directory
+   *
+   * \param container Container to download from
+   * \param prefix Virtual "folder" to download (whole container if empty)
+   * \param localPath Local directory to download the files into (created if needed)
+   * \param failedFiles (optional) Files which could not be downloaded (blob name, error)
+   * \param maxParallelRequests (optional) Max number of download requests sent at the same time
+   * \param timeoutInSec (optional) Max time to wait the full download (in sec)
+   *
+   * \return isErrorCodeSuccess(QNetworkReply::NetworkError) if all the files were downloaded successfully on time
+   */
+  QNetworkReply::NetworkError downloadPrefixSynchronous(const QString& container, const QString& prefix, const QString& localPath,
+                                                        QMap<QString, QNetworkReply::NetworkError>* failedFiles = nullptr,
+                                                        const int& maxParallelRequests = 16, const int& timeoutInSec = 3600,
+                                                        const bool& forceTimeoutOnApi = false);
+
+  /*!
+   * \brief syncSynchronous Synchronous method to synchronize a local directory with a virtual "folder" of azure storage
+   *
+   * \param localPath Local directory to synchronize
+   * \param container Container to synchronize
+   * \param prefix Virtual "folder" to synchronize (whole container if empty)
+   * \param direction Side which is the reference (the other side is updated)
+   * \param isDeletingExtraneous (optional) Delete the files of the updated side which are not on the reference side
+   * \param manifestPath (optional) Local manifest of the last synchronization (no manifest if empty)
+   * \param failedFiles (optional) Files which could not be transferred or deleted (relative path, error)
+   * \param timeoutInSec (optional) Max time to wait the full synchronization (in sec)
+   *
+   * \return isErrorCodeSuccess(QNetworkReply::NetworkError) if all the files were synchronized successfully on time
+   */
+  QNetworkReply::NetworkError syncSynchronous(const QString& localPath, const QString& container, const QString& prefix, const SyncDirection& direction,
+                                              const bool& isDeletingExtraneous = false, const QString& manifestPath = QString(),
+                                              QMap<QString, QNetworkReply::NetworkError>* failedFiles = nullptr,
+                                              const int& timeoutInSec = 3600, const bool& forceTimeoutOnApi = false);
+
+  /*!
+   * \brief readChangeFeedSynchronous Synchronous method to read the events of the change feed since the last read
+   *
+   * \param cursorPath Local cursor of the events already read (change feed read from its start if empty)
+   * \param[out] events Events read (Avro records of the change feed: "eventType", "subject", "eventTime", "data", ...)
+   * \param container (optional) Only report the events of this container (all containers if empty)
+   * \param timeoutInSec (optional) Max time to wait the events (in sec)
+   *
+   * \return isErrorCodeSuccess(QNetworkReply::NetworkError) if all the consumable events were read successfully on time
+   */
+  QNetworkReply::NetworkError readChangeFeedSynchronous(const QString& cursorPath, QList<QVariantMap>& events, const QString& container = QString(),
+                                                        const int& timeoutInSec = 300, const bool& forceTimeoutOnApi = false);
+
+  /*!
+   * \brief setFileTagsSynchronous Synchronous method to set (replace) the index tags of a file in azure storage (remote path: \s container/\s blobName)
+   *
+   * \param container Container of the file
+   * \param blobName Name of the file (blob)
+   * \param tags Index tags of the file (10 max, all previous tags are removed if empty)
+   * \param timeoutInSec (optional) Max time to wait answer (in sec)
+   *
+   * \return isErrorCodeSuccess(QNetworkReply::NetworkError) if tags set successfully on time
+   */
+  QNetworkReply::NetworkError setFileTagsSynchronous(const QString& container, const QString& blobName, const QMap<QString,QString>& tags,
+                                                     const int& timeoutInSec = 30, const bool& forceTimeoutOnApi = false);
+
+  /*!
+   * \brief getFileTagsSynchronous Synchronous method to get the index tags of a file from azure storage (remote path: \s container/\s blobName)
+   *
+   * \param container Container of the file
+   * \param blobName Name of the file (blob)
+   * \param[out] tags Index tags of the file retrieved from Azure API (if no error)
+   * \param timeoutInSec (optional) Max time to wait answer (in sec)
+   *
+   * \return isErrorCodeSuccess(QNetworkReply::NetworkError) if tags retrieved successfully on time
+   */
+  QNetworkReply::NetworkError getFileTagsSynchronous(const QString& container, const QString& blobName, QMap<QString,QString>& tags,
+                                                     const int& timeoutInSec = 30, const bool& forceTimeoutOnApi = false);
+
+  /*!
+   * \brief findFilesByTagsSynchronous Synchronous method to find all the files whose index tags match an expression (all result pages)
+   *
+   * \param whereExpression Index tags expression (for example "\"tenant\" = 'abc' AND \"status\" = 'done'")
+   * \param[out] foundListOfFiles Files found by Azure (Name, ContainerName and the matching tags as "Tags:<key>") (if no error)
+   * \param container (optional) Container to search in (whole account if empty)
+   * \param maxResultsPerPage (optional, default: default Azure REST API number of results) Max number of files per result page
+   * \param timeoutInSec (optional) Max time to wait all the result pages (in sec)
+   *
+   * \return isErrorCodeSuccess(QNetworkReply::NetworkError) if files found successfully on time
+   */
+  QNetworkReply::NetworkError findFilesByTagsSynchronous(const QString& whereExpression, QList< QMap<QString,QString> >& foundListOfFiles,
+                                                         const QString& container = QString(), const int& maxResultsPerPage = -1,
+                                                         const int& timeoutInSec = 300, const bool& forceTimeoutOnApi = false);
+
   /*!
    * \brief createContainer Create a container
    *
@@ -295,28 +1225,109 @@ public:
    *
    * \param xmlFileList XML file list received using \s QAzureStorageRestApi::listFiles
    * \param NextMarker (optional) Marker to list specific informations only
+   * \param BlobPrefixes (optional) Virtual "folders" (BlobPrefix) found in the list (only when listing with a delimiter)
    *
    * \return List of files with all available information on files (name, type, md5, ...)
+   *         Metadata and index tags (if included in the listing) are returned with "Metadata:<name>" and "Tags:<key>" keys
    */
-  static QList< QMap<QString,QString> > parseFileList(const QByteArray& xmlFileList, QString* NextMarker = nullptr);
+  static QList< QMap<QString,QString> > parseFileList(const QByteArray& xmlFileList, QString* NextMarker = nullptr, QStringList* BlobPrefixes = nullptr);
+
+  /*!
+   * \brief parseBlockList Helper to convert XML block list received from Azure into Qt compatible format
+   *
+   * \param xmlBlockList XML block list received using \s QAzureStorageRestApi::getBlockList
+   *
+   * \return List of blocks (Name, Size and Type: "Committed" or "Uncommitted")
+   */
+  static QList< QMap<QString,QString> > parseBlockList(const QByteArray& xmlBlockList);
+
+  /*!
+   * \brief parsePageRanges Helper to convert XML page ranges received from Azure into Qt compatible format
+   *
+   * \param xmlPageRanges XML page ranges received using \s QAzureStorageRestApi::getPageRanges
+   * \param NextMarker (optional) Marker to get the next page ranges (empty if all page ranges were received)
+   *
+   * \return List of page ranges (Start, End (included) and Type: "PageRange" or "ClearRange")
+   */
+  static QList< QMap<QString,QString> > parsePageRanges(const QByteArray& xmlPageRanges, QString* NextMarker = nullptr);
+
+  /*!
+   * \brief parseTags Helper to convert XML index tags received from Azure into Qt compatible format
+   *
+   * \param xmlTags XML index tags received using \s QAzureStorageRestApi::getFileTags
+   *
+   * \return Index tags of the file (tag value by tag key)
+   */
+  static QMap<QString,QString> parseTags(const QByteArray& xmlTags);
+
+  /*!
+   * \brief parseDateTime Helper to convert a date received from Azure (RFC 1123, for example the "Last-Modified" of \s parseFileList) into a QDateTime
+   *
+   * \param httpDate Date such as "Wed, 09 Sep 2009 09:20:02 GMT"
+   *
+   * \return UTC date (invalid if \p httpDate is not a valid date)
+   */
+  static QDateTime parseDateTime(const QString& httpDate);
+
+signals:
+  /*!
+   * \brief requestFinished Emitted when a request sent to Azure is finished (successfully, with an error or aborted)
+   *
+   * Requests are only measured while something is connected to this signal, the metrics are enabled or a tracer is set (no overhead otherwise).
+   * Jobs and synchronous methods send several requests: each one is reported separately.
+   *
+   * \param metrics Timings and result of the request
+   */
+  void requestFinished(const QAzureStorageRestApi::RequestMetrics& metrics);
 
 private:
   QString generateCurrentTimeUTC();
   QString generateHeader(const QString&, const QString&, const QString&, const QString&, const QString&, const QString&, const QString&,
                          const QString&, const QString&, const QString&, const QString&, const QString&, const QString&, const QString&);
-  QString generateAutorizationHeader(const QString& httpVerb, const QString& container, const QString& blobName,
-                                     const QString& currentDateTime, const long& contentLength,
-                                     const QStringList additionnalCanonicalHeaders = QStringList(),
-                                     const QStringList additionnalCanonicalRessources = QStringList());
+  QByteArray generateAutorizationHeader(const QString& httpVerb, const QString& resourcePath,
+                                        const QString& currentDateTime, const qint64& contentLength,
+                                        const QStringList additionnalCanonicalHeaders = QStringList(),
+                                        const QStringList additionnalCanonicalRessources = QStringList(),
+                                        const QString& contentMd5 = QString());
   void updateRequestToAddAuthentication(QNetworkRequest* request);
-  static QList< QMap<QString,QString> > parseObjectList(const char* tag, const QByteArray& xml, QString* NextMarker);
+  QNetworkAccessManager* nextNetworkAccessManager();
+  QNetworkReply* sendRequest(const QString& operation, const QByteArray& httpVerb, const QNetworkRequest& request, const QByteArray& content = QByteArray(),
+                             QAzureStorageBandwidthLimiter* uploadLimiter = nullptr);
+  void measureRequest(QNetworkReply* reply, const QString& operation, const QByteArray& httpVerb, const QNetworkRequest& request, const qint64& bytesSent);
+  QNetworkReply::NetworkError waitForJob(QAzureStorageJob* job, const int& timeoutInSec);
+  QNetworkReply::NetworkError waitForReply(QNetworkReply* reply, const int& timeoutInSec, QByteArray* content = nullptr);
+  QNetworkRequest generateRequest(const QString& httpVerb, const QString& container, const QString& blobName,
+                                  const QMap<QString,QString>& urlParameters, const QMap<QString,QString>& msHeaders,
+                                  const qint64& contentLength, const int& timeoutInSec, const QString& contentMd5 = QString());
+  void addTransactionalChecksum(const QByteArray& content, QMap<QString,QString>& msHeaders, QString& contentMd5) const;
+  static QList< QMap<QString,QString> > parseObjectList(const char* tag, const QByteArray& xml, QString* NextMarker, QStringList* BlobPrefixes = nullptr);
 
 private:
-  QString m_version = "2021-04-10"; //!< Azure Storage API currently used by this library
+  QByteArray m_version = "2021-04-10"; //!< Azure Storage API currently used by this library (x-ms-version header)
   QString m_accountName;
-  QString m_accountKey;
+  QByteArray m_accountKey;             //!< Decoded account key (empty if SAS credentials are used)
+  QByteArray m_authorizationPrefix;    //!< "SharedKey <account name>:" of the Authorization header
   QString m_sasKey;
-  QNetworkAccessManager* m_manager;
+  QString m_blobEndpoint;                 //!< "https://<account name>.blob.core.windows.net/"
+  QString m_canonicalizedResourcePrefix;  //!< "/<account name>/" of the signed canonicalized resource
+  QString m_sasQuery;                     //!< SAS credentials added to the URL parameters (empty if account key is used)
+  TransactionalChecksum m_transactionalChecksum = NoChecksum;
+  bool m_contentCompression = false;
+  bool m_http2Allowed = (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)); //!< Same default as Qt
+  int m_maxConnectionsPerHost = 0;
+  QList<QNetworkAccessManager*> m_managers;  //!< Managers used in turn (only the first m_managerCount ones)
+  int m_managerCount = 1;
+  int m_nextManager = 0;
+  QTimer* m_keepWarmTimer = nullptr;
+  int m_keepWarmConnectionCount = 1;
+  bool m_isIdle = true;                       //!< No request sent since the last idle check
+  QScopedPointer<QAzureStorageMetrics> m_metrics;  //!< Created when enabled for the first time
+  bool m_metricsEnabled = false;
+  QAzureStorageTracer* m_tracer = nullptr;
+  QAzureStorageBandwidthLimiter m_uploadBandwidthLimiter;
+  QAzureStorageBandwidthLimiter m_downloadBandwidthLimiter;
 };
 
+Q_DECLARE_METATYPE(QAzureStorageRestApi::RequestMetrics)
+
 #endif // QAZURESTORAGERESTAPI_H
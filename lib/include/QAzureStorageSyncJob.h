@@ -0,0 +1,153 @@
+/*
+ * \brief Synchronize a local directory with an Azure storage virtual "folder" (only the changed files are transferred)
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#ifndef QAZURESTORAGESYNCJOB_H
+#define QAZURESTORAGESYNCJOB_H
+
+#include <QMap>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+#include <QtNetwork>
+
+#include "QAzureStorageRestApi_global.h"
+#include "QAzureStorageRestApi.h"
+#include "QAzureStorageJob.h"
+#include "QAzureStorageSyncManifest.h"
+
+class QAzureStorageListJob;
+
+class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStorageSyncJob : public QAzureStorageJob
+{
+  Q_OBJECT
+
+public:
+  //! Result of the comparison of a local file with its blob
+  enum Comparison
+  {
+    Changed,        //!< The file must be transferred
+    Unchanged,      //!< The file is the same on both sides
+    NeedsLocalMd5   //!< Same size, the MD5 of the local file is needed to compare it with the Content-MD5 of the blob
+  };
+
+  /*!
+   * \brief QAzureStorageSyncJob Synchronize a local directory with the files of a container under \p prefix
+   *
+   * Use \s QAzureStorageRestApi::sync instead of creating the job manually.
+   *
+   * \param api Azure storage API used to send the requests
+   * \param localPath Local directory to synchronize
+   * \param container Container to synchronize
+   * \param prefix Virtual "folder" to synchronize (a "/" is added if missing, whole container if empty)
+   * \param direction Side which is the reference (the other side is updated)
+   * \param isDeletingExtraneous Delete the files of the updated side which are not on the reference side
+   * \param manifestPath Local manifest of the last synchronization (no manifest if empty)
+   * \param maxParallelRequests Max number of requests sent at the same time
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer of each request (in sec)
+   * \param parent (optional) QObject parent
+   */
+  QAzureStorageSyncJob(QAzureStorageRestApi* api, const QString& localPath, const QString& container, const QString& prefix,
+                       const QAzureStorageRestApi::SyncDirection& direction, const bool& isDeletingExtraneous, const QString& manifestPath,
+                       const int& maxParallelRequests, const int& timeoutInSec = -1, QObject* parent = nullptr);
+
+  //! Number of files transferred successfully
+  qint64 transferredFileCount() const;
+  //! Number of files skipped because they did not change
+  qint64 unchangedFileCount() const;
+  //! Number of extraneous files deleted successfully
+  qint64 deletedFileCount() const;
+  //! Files which could not be transferred or deleted (path relative to the synchronized directory, error)
+  QMap<QString, QNetworkReply::NetworkError> failedFiles() const;
+
+  /*!
+   * \brief compare Compare a local file with its blob
+   *
+   * The sizes are compared first, then the manifest tells if nothing changed on both sides since the last synchronization,
+   * then the MD5 are compared if Azure has the MD5 of the blob. Without MD5 (blob uploaded in blocks), the most recent side wins.
+   *
+   * \param direction Side which is the reference
+   * \param localFile Local file (md5 can be empty if not computed yet)
+   * \param remoteFile Blob (from the listing: size, Last-Modified, Content-MD5 and ETag)
+   * \param manifestEntry State of the file after the last synchronization (size -1 if none)
+   */
+  static Comparison compare(const QAzureStorageRestApi::SyncDirection& direction, const QAzureStorageSyncManifest::Entry& localFile,
+                            const QAzureStorageSyncManifest::Entry& remoteFile, const QAzureStorageSyncManifest::Entry& manifestEntry);
+
+public slots:
+  /*!
+   * \brief start Scan the local directory, list the prefix, compare them then transfer the changed files and delete the extraneous ones
+   *
+   * A file which can not be transferred or deleted does not stop the other files: it is reported by \s fileSynced and \s failedFiles,
+   * the job finishes once all the files are done, with the error of the first failed file (if any). A listing error stops the job.
+   * The manifest (if any) is saved at the end with the files which are the same on both sides.
+   */
+  void start() override;
+
+signals:
+  //! Emitted when a changed file is transferred or an extraneous file is deleted (done if isErrorCodeSuccess(errorCode))
+  void fileSynced(const QString& relativePath, bool isDeleted, QNetworkReply::NetworkError errorCode);
+
+  //! Emitted from a worker thread when the MD5 of a local file is computed (empty if the file could not be read)
+  void fileHashed(const QString& relativePath, const QString& md5, QPrivateSignal);
+
+protected:
+  void cleanup() override;
+
+private:
+  class HashTask;
+
+  void scanLocalFiles();
+  void onFilesListed(const QList< QMap<QString,QString> >& files);
+  void onListingFinished(const QNetworkReply::NetworkError& errorCode);
+  void compareFile(const QString& relativePath);
+  void onFileHashed(const QString& relativePath, const QString& md5);
+  void startTransfers();
+  void onFileTransferred(const QString& relativePath, const QNetworkReply::NetworkError& errorCode, const QString& uploadedEtag = QString());
+  void startDeletes();
+  void startNextDeletes();
+  void onDeleteFinished(QNetworkReply* reply);
+  void onFileDone(const QString& relativePath, const bool& isDeleted, const QNetworkReply::NetworkError& errorCode,
+                  const QAzureStorageSyncManifest::Entry& syncedFile = QAzureStorageSyncManifest::Entry());
+  void finishSync();
+  QString localFilePath(const QString& relativePath) const;
+
+private:
+  QAzureStorageRestApi* m_api;
+  QString m_localPath;
+  QString m_container;
+  QString m_prefix;
+  QAzureStorageRestApi::SyncDirection m_direction;
+  bool m_isDeletingExtraneous;
+  int m_maxParallelRequests;
+  int m_timeoutInSec;
+
+  QAzureStorageSyncManifest m_manifest;
+  QMap<QString, QAzureStorageSyncManifest::Entry> m_localFiles;
+  QMap<QString, QAzureStorageSyncManifest::Entry> m_remoteFiles;
+  QAzureStorageListJob* m_listJob = nullptr;
+  QSet<QString> m_hashingFiles;
+  QStringList m_filesToTransfer;
+  QMap<QString, QAzureStorageSyncManifest::Entry> m_syncedFiles;  //!< Files which are the same on both sides (saved in the manifest)
+  QAzureStorageJob* m_transferJob = nullptr;
+  QStringList m_pendingDeletes;
+  QMap<QNetworkReply*, QString> m_runningDeletes;
+  qint64 m_transferredFileCount = 0;
+  qint64 m_unchangedFileCount = 0;
+  qint64 m_deletedFileCount = 0;
+  QMap<QString, QNetworkReply::NetworkError> m_failedFiles;
+  QNetworkReply::NetworkError m_firstError = QNetworkReply::NetworkError::NoError;
+
+  bool m_isStarted = false;
+
+  //! Hash of the local files (declared last so that it waits the end of the running hashes before the other members are destroyed)
+  QThreadPool m_hashPool;
+};
+
+#endif // QAZURESTORAGESYNCJOB_H
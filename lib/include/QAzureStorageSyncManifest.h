@@ -0,0 +1,81 @@
+/*
+ * \brief Local manifest of the files of a synchronization with Azure storage (used to skip unchanged files quickly)
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#ifndef QAZURESTORAGESYNCMANIFEST_H
+#define QAZURESTORAGESYNCMANIFEST_H
+
+#include <QMap>
+#include <QString>
+
+#include "QAzureStorageRestApi_global.h"
+
+/*!
+ * \brief The QAzureStorageSyncManifest class keeps in a small local file the state of each file after the last synchronization
+ *        (local size, modification time and MD5, ETag of the blob) so that unchanged files are neither hashed nor transferred again.
+ *
+ * The manifest is written in a temporary file renamed once complete: a crash while saving keeps the previous manifest.
+ */
+class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStorageSyncManifest
+{
+public:
+  //! State of a file (local file or blob)
+  struct Entry
+  {
+    Entry() :
+      size(-1), modifiedInMs(-1)
+    {
+    }
+
+    qint64 size;          //!< Size in bytes (-1 if unknown)
+    qint64 modifiedInMs;  //!< Last modification (ms since epoch, -1 if unknown)
+    QString md5;          //!< Base64 MD5 of the content (empty if unknown)
+    QString etag;         //!< ETag of the blob (empty if unknown)
+  };
+
+  /*!
+   * \brief QAzureStorageSyncManifest Manifest of a synchronization
+   * \param manifestPath (optional) Path of the local manifest file (manifest disabled if empty)
+   */
+  explicit QAzureStorageSyncManifest(const QString& manifestPath = QString());
+
+  bool isEnabled() const;
+  QString manifestPath() const;
+
+  /*!
+   * \brief load Load the manifest if it was written for the same synchronization, otherwise start an empty manifest
+   *
+   * \param identity Description of the synchronization (local directory, container, prefix, direction),
+   *                 entries of a manifest written with another identity are discarded
+   *
+   * \return true if a manifest of the same synchronization was loaded
+   */
+  bool load(const QString& identity);
+
+  /*!
+   * \brief save Replace the manifest file by the current entries
+   *
+   * \return false if the manifest is disabled or could not be written
+   */
+  bool save();
+
+  //! Entries by path relative to the synchronized directory
+  QMap<QString, Entry> entries() const;
+  //! Entry of \p relativePath (size -1 if none)
+  Entry entry(const QString& relativePath) const;
+  void setEntry(const QString& relativePath, const Entry& entry);
+  void clear();
+
+private:
+  QString m_manifestPath;
+  QString m_identity;
+  QMap<QString, Entry> m_entries;
+};
+
+#endif // QAZURESTORAGESYNCMANIFEST_H
@@ -0,0 +1,69 @@
+/*
+ * \brief Interface to trace the requests sent to Azure storage (one span per request, OpenTelemetry compatible)
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#ifndef QAZURESTORAGETRACER_H
+#define QAZURESTORAGETRACER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+#include <QVariantMap>
+
+#include "QAzureStorageRestApi_global.h"
+
+/*!
+ * \brief The QAzureStorageTracer class receives a span for each request sent to Azure (see \s QAzureStorageRestApi::setTracer)
+ *
+ * Implement it to forward the spans to your tracing system (OpenTelemetry, ...). The spans are started and ended
+ * in the thread of the \s QAzureStorageRestApi, each started span is ended exactly once (even if the request is aborted).
+ *
+ * Attributes set when the span is started:
+ *  - "http.request.method": HTTP verb
+ *  - "az.storage.container" and "az.storage.blob": Container and file of the request (if any)
+ *  - "az.client_request_id": x-ms-client-request-id sent with the request (also in Azure storage analytics logs)
+ *  - "http.request.body.size": Size of the request content
+ *
+ * Attributes added when the span is ended:
+ *  - "http.response.status_code": HTTP status of the response (if any)
+ *  - "az.service_request_id": x-ms-request-id of the response (if any)
+ *  - "http.response.body.size": Size of the response content
+ *  - "az.storage.time_to_first_byte_us": Time from the send until the response headers (if received)
+ *  - "error.type": Qt network error (only if the request failed)
+ */
+class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStorageTracer
+{
+public:
+  //! Span of a request sent to Azure
+  struct Span
+  {
+    Span() :
+      startTimeInUs(0), endTimeInUs(0), isError(false)
+    {
+    }
+
+    QString name;                //!< Azure REST API operation ("GetBlob", "PutBlock", ...)
+    QByteArray clientRequestId;  //!< x-ms-client-request-id sent with the request
+    qint64 startTimeInUs;        //!< Time when the request was sent (since epoch)
+    qint64 endTimeInUs;          //!< Time when the request finished (since epoch, 0 until the span is ended)
+    QVariantMap attributes;
+    bool isError;                //!< The request failed (network error or HTTP error status)
+    QVariant context;            //!< Free for the tracer (for example its own span object, kept from \s startSpan to \s endSpan)
+  };
+
+  virtual ~QAzureStorageTracer() {}
+
+  //! Called just after the request was sent
+  virtual void startSpan(Span& span) = 0;
+
+  //! Called when the request is finished (successfully, with an error or aborted)
+  virtual void endSpan(Span& span) = 0;
+};
+
+#endif // QAZURESTORAGETRACER_H
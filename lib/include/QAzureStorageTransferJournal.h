@@ -0,0 +1,93 @@
+/*
+ * \brief Local journal of the completed parts of a transfer to/from Azure storage (used to resume a transfer)
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#ifndef QAZURESTORAGETRANSFERJOURNAL_H
+#define QAZURESTORAGETRANSFERJOURNAL_H
+
+#include <QFile>
+#include <QMap>
+#include <QStringList>
+
+#include "QAzureStorageRestApi_global.h"
+
+/*!
+ * \brief The QAzureStorageTransferJournal class keeps in a small local file the blocks (upload) or ranges (download)
+ *        already transferred so that a transfer interrupted by a crash or a restart can skip them.
+ *
+ * Each completed part is appended (and flushed) as one line, an incomplete last line (crash while writing) is ignored.
+ */
+class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStorageTransferJournal
+{
+public:
+  /*!
+   * \brief QAzureStorageTransferJournal Journal of a transfer
+   * \param journalPath (optional) Path of the local journal file (journal disabled if empty)
+   */
+  explicit QAzureStorageTransferJournal(const QString& journalPath = QString());
+
+  bool isEnabled() const;
+  QString journalPath() const;
+
+  /*!
+   * \brief open Load the journal if it was written for the same transfer, otherwise start a new (empty) journal
+   *
+   * \param identity Description of the transfer (source, destination, size, version, part size, ...),
+   *                 completed parts of a journal written with another identity are discarded
+   *
+   * \return true if a journal of the same transfer was loaded (completed parts can be skipped)
+   */
+  bool open(const QString& identity);
+
+  /*!
+   * \brief reset Start a new (empty) journal even if the previous one was written for the same transfer
+   *        (e.g. local file of a download deleted or changed: its completed parts are no longer valid)
+   *
+   * \param identity Description of the transfer (see \s open)
+   *
+   * \return false if the journal is disabled or could not be written
+   */
+  bool reset(const QString& identity);
+
+  /*!
+   * \brief openForLocalFile Same as \s open for a download: the completed parts are only kept if the local file
+   *        still has its expected size, otherwise the journal is reset (its ranges are not in the local file anymore)
+   *
+   * \param identity Description of the transfer (see \s open)
+   * \param localFilePath Local file written by the transfer
+   * \param expectedSize Size of the local file once pre-sized by the transfer
+   *
+   * \return true if the completed parts of the same transfer can be skipped
+   */
+  bool openForLocalFile(const QString& identity, const QString& localFilePath, const qint64& expectedSize);
+
+  QStringList completedBlocks() const;
+  //! Completed ranges (offset -> length)
+  QMap<qint64,qint64> completedRanges() const;
+
+  bool addCompletedBlock(const QString& blockId);
+  bool addCompletedRange(const qint64& offset, const qint64& length);
+
+  /*!
+   * \brief remove Close and delete the journal file (to call once the transfer is fully completed)
+   */
+  void remove();
+
+private:
+  Q_DISABLE_COPY(QAzureStorageTransferJournal)
+
+  bool appendLine(const QByteArray& line);
+
+private:
+  QFile m_file;
+  QStringList m_completedBlocks;
+  QMap<qint64,qint64> m_completedRanges;
+};
+
+#endif // QAZURESTORAGETRANSFERJOURNAL_H
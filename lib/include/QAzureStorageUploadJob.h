@@ -0,0 +1,126 @@
+/*
+ * \brief Upload a local file into Azure storage (block blob) using parallel blocks
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#ifndef QAZURESTORAGEUPLOADJOB_H
+#define QAZURESTORAGEUPLOADJOB_H
+
+#include <QFile>
+#include <QMap>
+#include <QSet>
+#include <QThreadPool>
+#include <QtNetwork>
+
+#include "QAzureStorageRestApi_global.h"
+#include "QAzureStorageJob.h"
+#include "QAzureStorageTransferJournal.h"
+#include "QAzureStorageBandwidthLimiter.h"
+
+class QAzureStorageRestApi;
+
+class QAZURESTORAGERESTAPISHARED_EXPORT QAzureStorageUploadJob : public QAzureStorageJob
+{
+  Q_OBJECT
+
+public:
+  /*!
+   * \brief QAzureStorageUploadJob Upload a local file into Azure storage using parallel blocks (Put Block + Put Block List)
+   *
+   * Use \s QAzureStorageRestApi::uploadFileInBlocks instead of creating the job manually.
+   *
+   * \param api Azure storage API used to send the requests
+   * \param filePath Absolute path of the local file to upload
+   * \param container Container to put the file into
+   * \param blobName Name of the file (blob) to create
+   * \param blockSizeInBytes Size of each block (increased if needed to stay under the Azure max number of blocks)
+   * \param maxParallelBlocks Max number of blocks uploaded at the same time
+   * \param journalPath (optional) Local journal of the uploaded blocks used to resume an interrupted upload (no journal if empty)
+   * \param timeoutInSec (optional) Max time specified to Azure REST API to wait answer of each request (in sec)
+   * \param parent (optional) QObject parent
+   */
+  QAzureStorageUploadJob(QAzureStorageRestApi* api, const QString& filePath, const QString& container, const QString& blobName,
+                         const qint64& blockSizeInBytes, const int& maxParallelBlocks, const QString& journalPath = QString(),
+                         const int& timeoutInSec = -1, QObject* parent = nullptr);
+
+  //! Size of the local file (-1 until the job is started)
+  qint64 fileSize() const;
+  //! Number of bytes already uploaded (including the blocks skipped thanks to the journal)
+  qint64 bytesUploaded() const;
+  //! ETag header of the committed blob (empty until the job finished successfully)
+  QString etag() const;
+
+  /*!
+   * \brief setBandwidthLimit Limit the bandwidth used by this upload (can be changed while uploading)
+   *
+   * The global upload limit of the API (\s QAzureStorageRestApi::setUploadBandwidthLimit) still applies.
+   *
+   * \param bytesPerSecond Max bandwidth of this upload (unlimited if 0 or negative, default: unlimited)
+   */
+  void setBandwidthLimit(const qint64& bytesPerSecond);
+  qint64 bandwidthLimit() const;
+
+  /*!
+   * \brief blockId Block ID used for the block \p blockIndex (same length for all blocks of a blob as requested by Azure)
+   */
+  static QString blockId(const int& blockIndex);
+
+public slots:
+  /*!
+   * \brief start Upload all blocks (not already uploaded according to the journal and Azure) then commit the block list
+   */
+  void start() override;
+
+protected:
+  void cleanup() override;
+
+signals:
+  //! Emitted from a worker thread when a block is compressed
+  void blockCompressed(int blockIndex, const QByteArray& compressedContent, QPrivateSignal);
+
+private:
+  class CompressionTask;
+
+  void onBlockListFinished(QNetworkReply* reply);
+  void startNextBlocks();
+  void onBlockCompressed(int blockIndex, const QByteArray& compressedContent);
+  void uploadBlock(const int& blockIndex, const QByteArray& blockContent);
+  void onBlockFinished(QNetworkReply* reply);
+  void onCommitFinished(QNetworkReply* reply);
+
+private:
+  static const int MAX_BLOCKS_PER_BLOB = 50000;
+
+  QAzureStorageRestApi* m_api;
+  QString m_container;
+  QString m_blobName;
+  qint64 m_blockSizeInBytes;
+  int m_maxParallelBlocks;
+  int m_timeoutInSec;
+
+  QFile m_file;
+  QAzureStorageTransferJournal m_journal;
+  QAzureStorageBandwidthLimiter m_bandwidthLimiter;  //!< Limit of this upload (child of the global upload limiter)
+  qint64 m_fileSize = -1;
+  qint64 m_bytesUploaded = 0;
+  QString m_etag;
+  int m_blockCount = 0;
+  QList<int> m_pendingBlocks;
+  QMap<QNetworkReply*, int> m_runningBlocks;
+  QSet<int> m_compressingBlocks;
+  bool m_compressContent = false;
+  QNetworkReply* m_blockListReply = nullptr;
+  QNetworkReply* m_commitReply = nullptr;
+
+  bool m_isStarted = false;
+
+  //! Compression of the blocks (declared last so that it waits the end of the running compressions before the other members are destroyed)
+  QThreadPool m_compressionPool;
+};
+
+#endif // QAZURESTORAGEUPLOADJOB_H
@@ -14,11 +14,56 @@ else:CONFIG(debug, debug|release): TARGET = QAzureStorageRestApid
 TEMPLATE = lib
 
 SOURCES += \
-           src/QAzureStorageRestApi.cpp
+           src/QAzureStorageRestApi.cpp \
+           src/QAzureStorageJob.cpp \
+           src/QAzureStorageDownloadJob.cpp \
+           src/QAzureStorageUploadJob.cpp \
+           src/QAzureStorageAppendBlobWriter.cpp \
+           src/QAzureStoragePageBlobUploadJob.cpp \
+           src/QAzureStorageDirectoryUploadJob.cpp \
+           src/QAzureStorageDirectoryDownloadJob.cpp \
+           src/QAzureStorageSyncManifest.cpp \
+           src/QAzureStorageSyncJob.cpp \
+           src/QAzureStorageInventory.cpp \
+           src/QAzureStorageAvroReader.cpp \
+           src/QAzureStorageChangeFeedCursor.cpp \
+           src/QAzureStorageChangeFeedJob.cpp \
+           src/QAzureStorageListJob.cpp \
+           src/QAzureStoragePartitionedListJob.cpp \
+           src/QAzureStorageFindByTagsJob.cpp \
+           src/QAzureStorageTransferJournal.cpp \
+           src/QAzureStorageChecksum.cpp \
+           src/QAzureStorageCompression.cpp \
+           src/QAzureStorageMetrics.cpp \
+           src/QAzureStorageLogging.cpp \
+           src/QAzureStorageBandwidthLimiter.cpp
 
 HEADERS += \
            include/QAzureStorageRestApi.h \
-           include/QAzureStorageRestApi_global.h
+           include/QAzureStorageRestApi_global.h \
+           include/QAzureStorageJob.h \
+           include/QAzureStorageDownloadJob.h \
+           include/QAzureStorageUploadJob.h \
+           include/QAzureStorageAppendBlobWriter.h \
+           include/QAzureStoragePageBlobUploadJob.h \
+           include/QAzureStorageDirectoryUploadJob.h \
+           include/QAzureStorageDirectoryDownloadJob.h \
+           include/QAzureStorageSyncManifest.h \
+           include/QAzureStorageSyncJob.h \
+           include/QAzureStorageInventory.h \
+           include/QAzureStorageAvroReader.h \
+           include/QAzureStorageChangeFeedCursor.h \
+           include/QAzureStorageChangeFeedJob.h \
+           include/QAzureStorageListJob.h \
+           include/QAzureStoragePartitionedListJob.h \
+           include/QAzureStorageFindByTagsJob.h \
+           include/QAzureStorageTransferJournal.h \
+           include/QAzureStorageChecksum.h \
+           include/QAzureStorageCompression.h \
+           include/QAzureStorageMetrics.h \
+           include/QAzureStorageLogging.h \
+           include/QAzureStorageTracer.h \
+           include/QAzureStorageBandwidthLimiter.h
 
 INCLUDEPATH += \
            include/
@@ -0,0 +1,326 @@
+/*
+ * \brief Append content to an append blob of Azure storage by coalescing small writes into Append Block requests
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#include "QAzureStorageAppendBlobWriter.h"
+#include "QAzureStorageRestApi.h"
+#include "QAzureStorageLogging.h"
+
+#include <QDebug>
+
+namespace
+{
+  //! Number of times a block is sent before giving up
+  const int maxAppendAttempts = 3;
+}
+
+const int QAzureStorageAppendBlobWriter::maxAppendBlockSizeInBytes;
+
+// ------------------------------------- CONSTRUCTOR & INIT -------------------------------------
+
+QAzureStorageAppendBlobWriter::QAzureStorageAppendBlobWriter(QAzureStorageRestApi* api, const QString& container, const QString& blobName,
+                                                             const bool& createIfNeeded, const int& flushIntervalInMs,
+                                                             const int& maxBlockSizeInBytes, const int& timeoutInSec, QObject* parent) :
+  QObject(parent),
+  m_api(api),
+  m_container(container),
+  m_blobName(blobName),
+  m_createIfNeeded(createIfNeeded),
+  m_maxBlockSizeInBytes(qBound(1, maxBlockSizeInBytes, static_cast<int>(maxAppendBlockSizeInBytes))),
+  m_timeoutInSec(timeoutInSec)
+{
+  m_flushTimer.setSingleShot(true);
+  m_flushTimer.setInterval(qMax(0, flushIntervalInMs));
+  QObject::connect(&m_flushTimer, &QTimer::timeout, this, [this]()
+  {
+    m_isFlushDue = true;
+    sendNextBlock();
+  });
+}
+
+qint64 QAzureStorageAppendBlobWriter::blobSize() const
+{
+  return m_blobSize;
+}
+
+qint64 QAzureStorageAppendBlobWriter::pendingBytes() const
+{
+  return m_buffer.size() + m_sendingBlock.size();
+}
+
+bool QAzureStorageAppendBlobWriter::isFailed() const
+{
+  return m_isFailed;
+}
+
+// ------------------------------------- PUBLIC SLOTS -------------------------------------
+
+void QAzureStorageAppendBlobWriter::write(const QByteArray& content)
+{
+  if (m_isFailed || content.isEmpty())
+  {
+    return;
+  }
+
+  m_buffer.append(content);
+
+  if (!m_isStarted)
+  {
+    start();
+  }
+
+  if (m_buffer.size() >= m_maxBlockSizeInBytes)
+  {
+    sendNextBlock();
+  }
+  else if (!m_flushTimer.isActive() && !m_isFlushDue)
+  {
+    m_flushTimer.start();
+  }
+}
+
+void QAzureStorageAppendBlobWriter::flush()
+{
+  if (m_isFailed)
+  {
+    return;
+  }
+
+  if (pendingBytes() == 0)
+  {
+    emit idle();
+    return;
+  }
+
+  m_isFlushRequested = true;
+  sendNextBlock();
+}
+
+// ------------------------------------- PRIVATE -------------------------------------
+
+void QAzureStorageAppendBlobWriter::start()
+{
+  m_isStarted = true;
+
+  // The blob size is needed to make each Append Block request conditional on the expected append position
+  m_reply = m_api->getFileProperties(m_container, m_blobName, m_timeoutInSec);
+  if (m_reply == nullptr)
+  {
+    fail(QNetworkReply::NetworkError::UnknownNetworkError);
+    return;
+  }
+
+  QNetworkReply* reply = m_reply;
+  QObject::connect(reply, &QNetworkReply::finished, this, [this, reply]() { onPropertiesFinished(reply); });
+}
+
+void QAzureStorageAppendBlobWriter::sendNextBlock()
+{
+  if (m_isFailed || m_reply != nullptr || m_blobSize < 0 || m_buffer.isEmpty())
+  {
+    return;
+  }
+
+  if (!m_isFlushRequested && !m_isFlushDue && m_buffer.size() < m_maxBlockSizeInBytes)
+  {
+    return;
+  }
+
+  m_isFlushDue = false;
+  m_flushTimer.stop();
+
+  m_sendingBlock = m_buffer.left(m_maxBlockSizeInBytes);
+  m_buffer.remove(0, m_sendingBlock.size());
+
+  // The append position makes Azure reject the block if the blob was modified by somebody else
+  m_reply = m_api->appendBlock(m_container, m_blobName, m_sendingBlock, m_blobSize, m_timeoutInSec);
+  if (m_reply == nullptr)
+  {
+    fail(QNetworkReply::NetworkError::UnknownNetworkError);
+    return;
+  }
+
+  QNetworkReply* reply = m_reply;
+  QObject::connect(reply, &QNetworkReply::finished, this, [this, reply]() { onAppendFinished(reply); });
+}
+
+void QAzureStorageAppendBlobWriter::onPropertiesFinished(QNetworkReply* reply)
+{
+  reply->deleteLater();
+  if (reply != m_reply)
+  {
+    return;
+  }
+  m_reply = nullptr;
+
+  if (reply->error() == QNetworkReply::NetworkError::ContentNotFoundError && m_createIfNeeded)
+  {
+    m_reply = m_api->createAppendBlob(m_container, m_blobName, m_timeoutInSec);
+    if (m_reply == nullptr)
+    {
+      fail(QNetworkReply::NetworkError::UnknownNetworkError);
+      return;
+    }
+
+    QNetworkReply* createReply = m_reply;
+    QObject::connect(createReply, &QNetworkReply::finished, this, [this, createReply]() { onCreateFinished(createReply); });
+    return;
+  }
+
+  if (!QAzureStorageRestApi::isErrorCodeSuccess(reply->error()))
+  {
+    fail(reply->error());
+    return;
+  }
+
+  if (reply->rawHeader("x-ms-blob-type") != "AppendBlob")
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageAppendBlobWriter]" << m_container + "/" + m_blobName << "is not an append blob";
+    fail(QNetworkReply::NetworkError::ContentOperationNotPermittedError);
+    return;
+  }
+
+  bool isValidSize = false;
+  m_blobSize = reply->header(QNetworkRequest::ContentLengthHeader).toLongLong(&isValidSize);
+  if (!isValidSize || m_blobSize < 0)
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageAppendBlobWriter] No valid Content-Length received for" << m_container + "/" + m_blobName;
+    m_blobSize = -1;
+    fail(QNetworkReply::NetworkError::UnknownContentError);
+    return;
+  }
+
+  sendNextBlock();
+}
+
+void QAzureStorageAppendBlobWriter::onCreateFinished(QNetworkReply* reply)
+{
+  reply->deleteLater();
+  if (reply != m_reply)
+  {
+    return;
+  }
+  m_reply = nullptr;
+
+  if (!QAzureStorageRestApi::isErrorCodeSuccess(reply->error()))
+  {
+    fail(reply->error());
+    return;
+  }
+
+  m_blobSize = 0;
+  sendNextBlock();
+}
+
+void QAzureStorageAppendBlobWriter::onAppendFinished(QNetworkReply* reply)
+{
+  reply->deleteLater();
+  if (reply != m_reply)
+  {
+    return;
+  }
+  m_reply = nullptr;
+
+  QNetworkReply::NetworkError appendError = reply->error();
+  if (QAzureStorageRestApi::isErrorCodeSuccess(appendError))
+  {
+    onBlockAppended();
+    return;
+  }
+
+  // The block may have been appended even if the answer was lost: the blob size tells what happened
+  m_reply = m_api->getFileProperties(m_container, m_blobName, m_timeoutInSec);
+  if (m_reply == nullptr)
+  {
+    fail(appendError);
+    return;
+  }
+
+  QNetworkReply* resyncReply = m_reply;
+  QObject::connect(resyncReply, &QNetworkReply::finished, this, [this, resyncReply, appendError]() { onResyncFinished(resyncReply, appendError); });
+}
+
+void QAzureStorageAppendBlobWriter::onResyncFinished(QNetworkReply* reply, const QNetworkReply::NetworkError& appendError)
+{
+  reply->deleteLater();
+  if (reply != m_reply)
+  {
+    return;
+  }
+  m_reply = nullptr;
+
+  if (!QAzureStorageRestApi::isErrorCodeSuccess(reply->error()))
+  {
+    fail(appendError);
+    return;
+  }
+
+  qint64 currentBlobSize = reply->header(QNetworkRequest::ContentLengthHeader).toLongLong();
+  if (currentBlobSize == m_blobSize + m_sendingBlock.size())
+  {
+    onBlockAppended();
+    return;
+  }
+
+  if (currentBlobSize != m_blobSize)
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageAppendBlobWriter]" << m_container + "/" + m_blobName << "was modified by another writer (size"
+                                      << currentBlobSize << "instead of" << m_blobSize << ")";
+    fail(appendError);
+    return;
+  }
+
+  m_failedAttempts++;
+  if (m_failedAttempts >= maxAppendAttempts)
+  {
+    fail(appendError);
+    return;
+  }
+
+  // The block was not appended: send it again before the content written afterwards
+  if (m_api->isMetricsEnabled())
+  {
+    m_api->metrics()->recordRetry();
+  }
+  m_buffer.prepend(m_sendingBlock);
+  m_sendingBlock.clear();
+  m_isFlushDue = true;
+  sendNextBlock();
+}
+
+void QAzureStorageAppendBlobWriter::onBlockAppended()
+{
+  m_blobSize += m_sendingBlock.size();
+  m_sendingBlock.clear();
+  m_failedAttempts = 0;
+  emit appended(m_blobSize);
+
+  sendNextBlock();
+  if (m_isFailed || m_reply != nullptr)
+  {
+    return;
+  }
+
+  if (m_buffer.isEmpty())
+  {
+    m_isFlushRequested = false;
+    emit idle();
+  }
+  else if (!m_flushTimer.isActive())
+  {
+    m_flushTimer.start();
+  }
+}
+
+void QAzureStorageAppendBlobWriter::fail(const QNetworkReply::NetworkError& error)
+{
+  m_isFailed = true;
+  m_flushTimer.stop();
+  emit failed(error);
+}
@@ -0,0 +1,479 @@
+/*
+ * \brief Streaming decoder of Avro object container files (format of the Azure storage change feed)
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#include "QAzureStorageAvroReader.h"
+#include "QAzureStorageLogging.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtEndian>
+#include <QDebug>
+
+#include <cstring>
+
+namespace
+{
+  const QByteArray AVRO_MAGIC("Obj\x01", 4);
+  const int SYNC_MARKER_SIZE = 16;
+
+  //! Max nesting of the decoded values (recursive schemas)
+  const int MAX_DEPTH = 64;
+}
+
+bool QAzureStorageAvroReader::append(const QByteArray& data)
+{
+  if (hasError())
+  {
+    return false;
+  }
+  m_buffer.append(data);
+
+  bool isIncomplete = false;
+  if (!m_isHeaderRead && !readHeader(isIncomplete))
+  {
+    return false;
+  }
+
+  while (m_isHeaderRead && !isIncomplete && !m_buffer.isEmpty())
+  {
+    if (!readBlock(isIncomplete))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+QList<QVariant> QAzureStorageAvroReader::takeRecords()
+{
+  QList<QVariant> records;
+  records.swap(m_records);
+  return records;
+}
+
+bool QAzureStorageAvroReader::isHeaderRead() const
+{
+  return m_isHeaderRead;
+}
+
+bool QAzureStorageAvroReader::isComplete() const
+{
+  return !hasError() && m_isHeaderRead && m_buffer.isEmpty();
+}
+
+bool QAzureStorageAvroReader::hasError() const
+{
+  return !m_errorString.isEmpty();
+}
+
+QString QAzureStorageAvroReader::errorString() const
+{
+  return m_errorString;
+}
+
+// ------------------------------------- PRIVATE -------------------------------------
+
+bool QAzureStorageAvroReader::readHeader(bool& isIncomplete)
+{
+  // Header: magic, metadata (map of bytes), sync marker
+  isIncomplete = true;
+  const int magicSize = qMin(m_buffer.size(), AVRO_MAGIC.size());
+  if (m_buffer.left(magicSize) != AVRO_MAGIC.left(magicSize))
+  {
+    return setError("Not an Avro object container file");
+  }
+  if (m_buffer.size() < AVRO_MAGIC.size())
+  {
+    return true;
+  }
+
+  Input input = { m_buffer.constData() + AVRO_MAGIC.size(), m_buffer.constData() + m_buffer.size() };
+  QMap<QString, QByteArray> metadata;
+  qint64 count = 0;
+  do
+  {
+    qint64 blockSize = 0;
+    if (!readLong(input, count) || (count < 0 && !readLong(input, blockSize)))
+    {
+      return true;
+    }
+
+    for (qint64 i = 0; i < qAbs(count); ++i)
+    {
+      QByteArray key;
+      QByteArray value;
+      if (!readBytes(input, key) || !readBytes(input, value))
+      {
+        return true;
+      }
+      metadata.insert(QString::fromUtf8(key), value);
+    }
+  } while (count != 0);
+
+  if (input.end - input.position < SYNC_MARKER_SIZE)
+  {
+    return true;
+  }
+  m_syncMarker = QByteArray(input.position, SYNC_MARKER_SIZE);
+  input.position += SYNC_MARKER_SIZE;
+
+  const QByteArray codec = metadata.value("avro.codec", "null");
+  if (codec != "null")
+  {
+    return setError("Unsupported Avro codec: " + QString::fromUtf8(codec));
+  }
+  if (!parseSchema(metadata.value("avro.schema")))
+  {
+    return setError("Invalid Avro schema");
+  }
+
+  m_buffer.remove(0, static_cast<int>(input.position - m_buffer.constData()));
+  m_isHeaderRead = true;
+  isIncomplete = false;
+  return true;
+}
+
+bool QAzureStorageAvroReader::readBlock(bool& isIncomplete)
+{
+  // Block: number of records, size in bytes, records, sync marker
+  isIncomplete = true;
+  Input input = { m_buffer.constData(), m_buffer.constData() + m_buffer.size() };
+  qint64 count = 0;
+  qint64 size = 0;
+  if (!readLong(input, count) || !readLong(input, size))
+  {
+    return true;
+  }
+  if (count < 0 || size < 0)
+  {
+    return setError("Invalid Avro block");
+  }
+  if (input.end - input.position - SYNC_MARKER_SIZE < size)
+  {
+    return true;
+  }
+
+  Input block = { input.position, input.position + size };
+  QList<QVariant> records;
+  for (qint64 i = 0; i < count; ++i)
+  {
+    QVariant record;
+    if (!decodeValue(m_schema, block, record, 0))
+    {
+      return setError("Invalid Avro record");
+    }
+    records.append(record);
+  }
+
+  if (block.position != block.end || std::memcmp(block.end, m_syncMarker.constData(), SYNC_MARKER_SIZE) != 0)
+  {
+    return setError("Invalid Avro block");
+  }
+
+  m_records.append(records);
+  m_buffer.remove(0, static_cast<int>(block.end + SYNC_MARKER_SIZE - m_buffer.constData()));
+  isIncomplete = false;
+  return true;
+}
+
+bool QAzureStorageAvroReader::parseSchema(const QByteArray& schema)
+{
+  // Primitive schema (JSON string), not supported by QJsonDocument
+  const QByteArray trimmedSchema = schema.trimmed();
+  if (trimmedSchema.size() >= 2 && trimmedSchema.startsWith('"') && trimmedSchema.endsWith('"'))
+  {
+    m_schema = QString::fromUtf8(trimmedSchema.mid(1, trimmedSchema.size() - 2));
+    return true;
+  }
+
+  QJsonParseError parseError;
+  const QJsonDocument document = QJsonDocument::fromJson(trimmedSchema, &parseError);
+  if (parseError.error != QJsonParseError::NoError)
+  {
+    return false;
+  }
+
+  m_schema = document.isArray() ? QJsonValue(document.array()) : QJsonValue(document.object());
+  registerNamedTypes(m_schema, QString());
+  return true;
+}
+
+void QAzureStorageAvroReader::registerNamedTypes(const QJsonValue& schema, const QString& parentNamespace)
+{
+  if (schema.isArray())
+  {
+    const QJsonArray types = schema.toArray();
+    for (const QJsonValue& type : types)
+    {
+      registerNamedTypes(type, parentNamespace);
+    }
+    return;
+  }
+  if (!schema.isObject())
+  {
+    return;
+  }
+
+  // Records, enums and fixed can be referenced by their name (or full name) in the rest of the schema
+  const QJsonObject object = schema.toObject();
+  const QString type = object.value("type").toString();
+  QString currentNamespace = object.contains("namespace") ? object.value("namespace").toString() : parentNamespace;
+  if (object.contains("name") && (type == "record" || type == "error" || type == "enum" || type == "fixed"))
+  {
+    const QString name = object.value("name").toString();
+    m_namedTypes.insert(name, object);
+    if (name.contains('.'))
+    {
+      currentNamespace = name.left(name.lastIndexOf('.'));
+      m_namedTypes.insert(name.mid(name.lastIndexOf('.') + 1), object);
+    }
+    else if (!currentNamespace.isEmpty())
+    {
+      m_namedTypes.insert(currentNamespace + "." + name, object);
+    }
+  }
+
+  if (type == "record" || type == "error")
+  {
+    const QJsonArray fields = object.value("fields").toArray();
+    for (const QJsonValue& field : fields)
+    {
+      registerNamedTypes(field.toObject().value("type"), currentNamespace);
+    }
+  }
+  else if (type == "array")
+  {
+    registerNamedTypes(object.value("items"), currentNamespace);
+  }
+  else if (type == "map")
+  {
+    registerNamedTypes(object.value("values"), currentNamespace);
+  }
+  else
+  {
+    registerNamedTypes(object.value("type"), currentNamespace);
+  }
+}
+
+bool QAzureStorageAvroReader::decodeValue(const QJsonValue& schema, Input& input, QVariant& value, const int& depth) const
+{
+  if (depth > MAX_DEPTH)
+  {
+    return false;
+  }
+
+  // Union: index of the type then value
+  if (schema.isArray())
+  {
+    const QJsonArray types = schema.toArray();
+    qint64 index = 0;
+    if (!readLong(input, index) || index < 0 || index >= types.size())
+    {
+      return false;
+    }
+    return decodeValue(types.at(static_cast<int>(index)), input, value, depth + 1);
+  }
+
+  if (schema.isObject())
+  {
+    const QJsonObject object = schema.toObject();
+    const QString type = object.value("type").toString();
+
+    if (type == "record" || type == "error")
+    {
+      QVariantMap record;
+      const QJsonArray fields = object.value("fields").toArray();
+      for (const QJsonValue& field : fields)
+      {
+        QVariant fieldValue;
+        if (!decodeValue(field.toObject().value("type"), input, fieldValue, depth + 1))
+        {
+          return false;
+        }
+        record.insert(field.toObject().value("name").toString(), fieldValue);
+      }
+      value = record;
+      return true;
+    }
+
+    if (type == "enum")
+    {
+      const QJsonArray symbols = object.value("symbols").toArray();
+      qint64 index = 0;
+      if (!readLong(input, index) || index < 0 || index >= symbols.size())
+      {
+        return false;
+      }
+      value = symbols.at(static_cast<int>(index)).toString();
+      return true;
+    }
+
+    if (type == "array" || type == "map")
+    {
+      // Blocks of items ended by an empty block (negative count: followed by the size of the block in bytes)
+      QVariantList items;
+      QVariantMap values;
+      qint64 count = 0;
+      do
+      {
+        qint64 blockSize = 0;
+        if (!readLong(input, count) || (count < 0 && !readLong(input, blockSize)) || qAbs(count) > input.end - input.position)
+        {
+          return false;
+        }
+
+        for (qint64 i = 0; i < qAbs(count); ++i)
+        {
+          QByteArray key;
+          QVariant item;
+          if ((type == "map" && !readBytes(input, key)) ||
+              !decodeValue(object.value(type == "map" ? "values" : "items"), input, item, depth + 1))
+          {
+            return false;
+          }
+
+          if (type == "map")
+          {
+            values.insert(QString::fromUtf8(key), item);
+          }
+          else
+          {
+            items.append(item);
+          }
+        }
+      } while (count != 0);
+
+      value = (type == "map") ? QVariant(values) : QVariant(items);
+      return true;
+    }
+
+    if (type == "fixed")
+    {
+      const int size = object.value("size").toInt(-1);
+      if (size < 0 || input.end - input.position < size)
+      {
+        return false;
+      }
+      value = QByteArray(input.position, size);
+      input.position += size;
+      return true;
+    }
+
+    // Primitive type with attributes (logical types are decoded as their underlying type)
+    return decodeValue(object.value("type"), input, value, depth + 1);
+  }
+
+  const QString type = schema.toString();
+  if (type == "null")
+  {
+    value = QVariant();
+    return true;
+  }
+  if (type == "boolean")
+  {
+    if (input.position >= input.end)
+    {
+      return false;
+    }
+    value = (*input.position++ != 0);
+    return true;
+  }
+  if (type == "int" || type == "long")
+  {
+    qint64 number = 0;
+    if (!readLong(input, number))
+    {
+      return false;
+    }
+    value = (type == "int") ? QVariant(static_cast<int>(number)) : QVariant(number);
+    return true;
+  }
+  if (type == "float" || type == "double")
+  {
+    const int size = (type == "float") ? 4 : 8;
+    if (input.end - input.position < size)
+    {
+      return false;
+    }
+    if (type == "float")
+    {
+      const quint32 bits = qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(input.position));
+      float number = 0;
+      std::memcpy(&number, &bits, sizeof(number));
+      value = number;
+    }
+    else
+    {
+      const quint64 bits = qFromLittleEndian<quint64>(reinterpret_cast<const uchar*>(input.position));
+      double number = 0;
+      std::memcpy(&number, &bits, sizeof(number));
+      value = number;
+    }
+    input.position += size;
+    return true;
+  }
+  if (type == "bytes" || type == "string")
+  {
+    QByteArray bytes;
+    if (!readBytes(input, bytes))
+    {
+      return false;
+    }
+    value = (type == "string") ? QVariant(QString::fromUtf8(bytes)) : QVariant(bytes);
+    return true;
+  }
+
+  // Reference to a named type
+  if (m_namedTypes.contains(type))
+  {
+    return decodeValue(m_namedTypes.value(type), input, value, depth + 1);
+  }
+  return false;
+}
+
+bool QAzureStorageAvroReader::setError(const QString& errorString)
+{
+  qCDebug(lcAzureStorageParse) << "[QAzureStorageAvroReader]" << errorString;
+  m_errorString = errorString;
+  m_records.clear();
+  return false;
+}
+
+bool QAzureStorageAvroReader::readLong(Input& input, qint64& value)
+{
+  // Variable-length zig-zag encoding
+  quint64 encoded = 0;
+  for (int shift = 0; shift < 64 && input.position < input.end; shift += 7)
+  {
+    const quint8 byte = static_cast<quint8>(*input.position++);
+    encoded |= static_cast<quint64>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0)
+    {
+      value = static_cast<qint64>(encoded >> 1) ^ -static_cast<qint64>(encoded & 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool QAzureStorageAvroReader::readBytes(Input& input, QByteArray& value)
+{
+  qint64 size = 0;
+  if (!readLong(input, size) || size < 0 || size > input.end - input.position)
+  {
+    return false;
+  }
+
+  value = QByteArray(input.position, static_cast<int>(size));
+  input.position += size;
+  return true;
+}
@@ -0,0 +1,203 @@
+/*
+ * \brief Token bucket limiting the bandwidth used by the transfers with Azure storage
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#include "QAzureStorageBandwidthLimiter.h"
+
+#include <QTimer>
+
+#include <cstring>
+#include <limits>
+
+namespace
+{
+  //! Smallest bucket (very low rates would otherwise grant a few bytes at a time)
+  const qint64 minBucketSize = 4096;
+
+  //! Upload content read by the network access manager only as fast as the limiter allows
+  class ThrottledDevice : public QIODevice
+  {
+  public:
+    ThrottledDevice(const QByteArray& content, QAzureStorageBandwidthLimiter* limiter, QObject* parent) :
+      QIODevice(parent),
+      m_content(content),
+      m_limiter(limiter)
+    {
+      open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    }
+
+    bool isSequential() const override
+    {
+      return true;
+    }
+
+    qint64 bytesAvailable() const override
+    {
+      return m_content.size() - m_position;
+    }
+
+    bool atEnd() const override
+    {
+      return m_position >= m_content.size();
+    }
+
+  protected:
+    qint64 readData(char* data, qint64 maxSize) override
+    {
+      const qint64 remaining = m_content.size() - m_position;
+      if (remaining <= 0)
+      {
+        return -1;
+      }
+
+      const qint64 granted = m_limiter->acquire(qMin(maxSize, remaining));
+      if (granted == 0)
+      {
+        // Read again (readyRead) once the limiter allows more bytes
+        if (!m_isWaiting)
+        {
+          m_isWaiting = true;
+          QTimer::singleShot(m_limiter->waitTimeInMs(remaining), this, [this]()
+          {
+            m_isWaiting = false;
+            emit readyRead();
+          });
+        }
+        return 0;
+      }
+
+      std::memcpy(data, m_content.constData() + m_position, static_cast<size_t>(granted));
+      m_position += granted;
+      return granted;
+    }
+
+    qint64 writeData(const char*, qint64) override
+    {
+      return -1;
+    }
+
+  private:
+    QByteArray m_content;
+    QAzureStorageBandwidthLimiter* m_limiter;
+    qint64 m_position = 0;
+    bool m_isWaiting = false;
+  };
+}
+
+// ------------------------------------- CONSTRUCTOR & INIT -------------------------------------
+
+QAzureStorageBandwidthLimiter::QAzureStorageBandwidthLimiter(const qint64& bytesPerSecond, QAzureStorageBandwidthLimiter* parentLimiter) :
+  m_rate(bytesPerSecond > 0 ? bytesPerSecond : 0),
+  m_parentLimiter(parentLimiter)
+{
+  m_tokens = bucketSize();
+  m_refillTimer.start();
+}
+
+void QAzureStorageBandwidthLimiter::setRate(const qint64& bytesPerSecond)
+{
+  refill();
+  m_rate = bytesPerSecond > 0 ? bytesPerSecond : 0;
+  m_tokens = qMin(m_tokens, bucketSize());
+}
+
+qint64 QAzureStorageBandwidthLimiter::rate() const
+{
+  return m_rate;
+}
+
+bool QAzureStorageBandwidthLimiter::isLimited() const
+{
+  return m_rate > 0 || (m_parentLimiter != nullptr && m_parentLimiter->isLimited());
+}
+
+// ------------------------------------- PUBLIC -------------------------------------
+
+qint64 QAzureStorageBandwidthLimiter::acquire(const qint64& maxBytes)
+{
+  qint64 granted = maxBytes;
+  for (QAzureStorageBandwidthLimiter* limiter = this; limiter != nullptr; limiter = limiter->m_parentLimiter)
+  {
+    if (limiter->m_rate > 0)
+    {
+      limiter->refill();
+      granted = qMin(granted, limiter->m_tokens);
+    }
+  }
+
+  if (granted <= 0)
+  {
+    return 0;
+  }
+
+  for (QAzureStorageBandwidthLimiter* limiter = this; limiter != nullptr; limiter = limiter->m_parentLimiter)
+  {
+    if (limiter->m_rate > 0)
+    {
+      limiter->m_tokens -= granted;
+    }
+  }
+  return granted;
+}
+
+int QAzureStorageBandwidthLimiter::waitTimeInMs(const qint64& maxBytes)
+{
+  qint64 waitTimeInMs = 0;
+  for (QAzureStorageBandwidthLimiter* limiter = this; limiter != nullptr; limiter = limiter->m_parentLimiter)
+  {
+    if (limiter->m_rate <= 0)
+    {
+      continue;
+    }
+
+    // Wait for a full bucket (or the whole content if smaller) instead of waking up for a few bytes
+    limiter->refill();
+    const qint64 missingTokens = qMin(maxBytes, limiter->bucketSize()) - limiter->m_tokens;
+    if (missingTokens > 0)
+    {
+      waitTimeInMs = qMax(waitTimeInMs, (missingTokens * 1000 + limiter->m_rate - 1) / limiter->m_rate);
+    }
+  }
+  return static_cast<int>(qMin(waitTimeInMs, static_cast<qint64>(std::numeric_limits<int>::max())));
+}
+
+QIODevice* QAzureStorageBandwidthLimiter::createThrottledDevice(const QByteArray& content, QObject* parent)
+{
+  return new ThrottledDevice(content, this, parent);
+}
+
+// ------------------------------------- PRIVATE -------------------------------------
+
+void QAzureStorageBandwidthLimiter::refill()
+{
+  const qint64 nowInNs = m_refillTimer.nsecsElapsed();
+  const qint64 elapsedInNs = nowInNs - m_lastRefillInNs;
+  if (m_rate <= 0 || elapsedInNs >= 1000000000)
+  {
+    // The bucket holds less than 1 second of bandwidth: it is full
+    m_tokens = bucketSize();
+    m_lastRefillInNs = nowInNs;
+    return;
+  }
+
+  // Only the whole bytes are added: the time of the remaining fraction is kept for the next refill
+  const qint64 newTokens = elapsedInNs * m_rate / 1000000000;
+  if (newTokens <= 0)
+  {
+    return;
+  }
+
+  m_tokens = qMin(m_tokens + newTokens, bucketSize());
+  m_lastRefillInNs += newTokens * 1000000000 / m_rate;
+}
+
+qint64 QAzureStorageBandwidthLimiter::bucketSize() const
+{
+  return qMax(minBucketSize, m_rate / 10);
+}
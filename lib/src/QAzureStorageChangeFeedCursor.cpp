@@ -0,0 +1,144 @@
+/*
+ * \brief Local cursor of the events of the Azure storage change feed already consumed (used to resume the change feed)
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#include "QAzureStorageChangeFeedCursor.h"
+#include "QAzureStorageLogging.h"
+
+#include <QFile>
+#include <QList>
+#include <QSaveFile>
+#include <QUrl>
+#include <QDebug>
+
+namespace
+{
+  const QByteArray CURSOR_HEADER = "QAzureStorageChangeFeedCursor 1";
+  const QByteArray SEGMENT_PREFIX = "segment ";
+  const QByteArray SHARD_PREFIX = "shard ";
+}
+
+QAzureStorageChangeFeedCursor::QAzureStorageChangeFeedCursor(const QString& cursorPath) :
+  m_cursorPath(cursorPath)
+{
+}
+
+bool QAzureStorageChangeFeedCursor::isEnabled() const
+{
+  return !m_cursorPath.isEmpty();
+}
+
+QString QAzureStorageChangeFeedCursor::cursorPath() const
+{
+  return m_cursorPath;
+}
+
+bool QAzureStorageChangeFeedCursor::load()
+{
+  m_segmentPath.clear();
+  m_isSegmentDone = false;
+  m_shards.clear();
+  if (!isEnabled())
+  {
+    return false;
+  }
+
+  QFile file(m_cursorPath);
+  if (!file.open(QIODevice::ReadOnly))
+  {
+    return false;
+  }
+
+  // segment <segment path> <done: 0/1>
+  const QList<QByteArray> lines = file.readAll().split('\n');
+  const QList<QByteArray> segment = (lines.size() >= 2 && lines[1].startsWith(SEGMENT_PREFIX)) ? lines[1].mid(SEGMENT_PREFIX.size()).split(' ') : QList<QByteArray>();
+  if (lines[0] != CURSOR_HEADER || segment.size() != 2)
+  {
+    qCDebug(lcAzureStorageParse) << "[QAzureStorageChangeFeedCursor] Invalid cursor" << m_cursorPath;
+    return false;
+  }
+  m_segmentPath = QUrl::fromPercentEncoding(segment[0]);
+  m_isSegmentDone = (segment[1] == "1");
+
+  for (int i = 2; i < lines.size(); ++i)
+  {
+    if (!lines[i].startsWith(SHARD_PREFIX))
+    {
+      continue;
+    }
+
+    // shard <shard path> <chunk path> <event count>
+    const QList<QByteArray> values = lines[i].mid(SHARD_PREFIX.size()).split(' ');
+    bool isValidCount = false;
+    const qint64 eventCount = (values.size() == 3) ? values[2].toLongLong(&isValidCount) : -1;
+    if (!isValidCount || eventCount < 0)
+    {
+      qCDebug(lcAzureStorageParse) << "[QAzureStorageChangeFeedCursor] Invalid line" << i << "in" << m_cursorPath;
+      continue;
+    }
+    m_shards.insert(QUrl::fromPercentEncoding(values[0]), qMakePair(QUrl::fromPercentEncoding(values[1]), eventCount));
+  }
+
+  return true;
+}
+
+bool QAzureStorageChangeFeedCursor::save()
+{
+  if (!isEnabled())
+  {
+    return false;
+  }
+
+  QByteArray content = CURSOR_HEADER + '\n' + SEGMENT_PREFIX + QUrl::toPercentEncoding(m_segmentPath) + ' ' + (m_isSegmentDone ? "1" : "0") + '\n';
+  for (QMap<QString, QPair<QString, qint64> >::const_iterator it = m_shards.constBegin(); it != m_shards.constEnd(); ++it)
+  {
+    content.append(SHARD_PREFIX + QUrl::toPercentEncoding(it.key()) + ' ' + QUrl::toPercentEncoding(it.value().first) + ' '
+                   + QByteArray::number(it.value().second) + '\n');
+  }
+
+  QSaveFile file(m_cursorPath);
+  if (!file.open(QIODevice::WriteOnly) || file.write(content) != content.size() || !file.commit())
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageChangeFeedCursor] Failed to write cursor" << m_cursorPath << ":" << file.errorString();
+    return false;
+  }
+  return true;
+}
+
+QString QAzureStorageChangeFeedCursor::segmentPath() const
+{
+  return m_segmentPath;
+}
+
+bool QAzureStorageChangeFeedCursor::isSegmentDone() const
+{
+  return m_isSegmentDone;
+}
+
+void QAzureStorageChangeFeedCursor::setSegment(const QString& segmentPath, const bool& isDone)
+{
+  if (segmentPath != m_segmentPath)
+  {
+    m_shards.clear();
+  }
+  m_segmentPath = segmentPath;
+  m_isSegmentDone = isDone;
+}
+
+void QAzureStorageChangeFeedCursor::shardPosition(const QString& shardPath, QString& chunkPath, qint64& eventCount) const
+{
+  const QPair<QString, qint64> position = m_shards.value(shardPath, qMakePair(QString(), qint64(0)));
+  chunkPath = position.first;
+  eventCount = position.second;
+}
+
+void QAzureStorageChangeFeedCursor::setShardPosition(const QString& shardPath, const QString& chunkPath, const qint64& eventCount)
+{
+  m_shards.insert(shardPath, qMakePair(chunkPath, eventCount));
+}
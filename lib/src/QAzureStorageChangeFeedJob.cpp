@@ -0,0 +1,490 @@
+/*
+ * \brief Read the events of the Azure storage change feed since the last read (cost proportional to the changes, not to the containers)
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#include "QAzureStorageChangeFeedJob.h"
+#include "QAzureStorageRestApi.h"
+#include "QAzureStorageListJob.h"
+#include "QAzureStorageLogging.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocale>
+#include <QTimeZone>
+#include <QDebug>
+
+namespace
+{
+  // Layout of the change feed: https://learn.microsoft.com/en-us/azure/storage/blobs/storage-blob-change-feed#specifications
+  const QString CHANGE_FEED_CONTAINER = "$blobchangefeed";
+  const QString SEGMENTS_PREFIX = "idx/segments/";
+
+  //! Hour of the events of a segment ("idx/segments/YYYY/MM/DD/hhmm/meta.json", invalid if not a segment)
+  QDateTime segmentTime(const QString& segmentPath)
+  {
+    const QStringList parts = segmentPath.mid(SEGMENTS_PREFIX.size()).split('/');
+    if (!segmentPath.startsWith(SEGMENTS_PREFIX) || parts.size() != 5 || parts[4] != "meta.json" || parts[3].size() != 4)
+    {
+      return QDateTime();
+    }
+
+    const QDate date(parts[0].toInt(), parts[1].toInt(), parts[2].toInt());
+    const QTime time(parts[3].left(2).toInt(), parts[3].mid(2).toInt());
+    return (date.isValid() && time.isValid()) ? QDateTime(date, time, QTimeZone::utc()) : QDateTime();
+  }
+}
+
+// ------------------------------------- CONSTRUCTOR & INIT -------------------------------------
+
+QAzureStorageChangeFeedJob::QAzureStorageChangeFeedJob(QAzureStorageRestApi* api, const QString& cursorPath, const QString& container,
+                                                       const int& timeoutInSec, QObject* parent) :
+  QAzureStorageJob(parent),
+  m_api(api),
+  m_cursor(cursorPath),
+  m_container(container),
+  m_timeoutInSec(timeoutInSec)
+{
+}
+
+qint64 QAzureStorageChangeFeedJob::eventCount() const
+{
+  return m_eventCount;
+}
+
+QDateTime QAzureStorageChangeFeedJob::lastConsumable() const
+{
+  return m_lastConsumable;
+}
+
+bool QAzureStorageChangeFeedJob::parseSubject(const QString& subject, QString& container, QString& blobName)
+{
+  const QString containersPart = "/containers/";
+  const QString blobsPart = "/blobs/";
+  const int containerStart = subject.indexOf(containersPart);
+  const int blobsStart = (containerStart < 0) ? -1 : subject.indexOf(blobsPart, containerStart + containersPart.size());
+  if (blobsStart < 0)
+  {
+    return false;
+  }
+
+  container = subject.mid(containerStart + containersPart.size(), blobsStart - containerStart - containersPart.size());
+  blobName = subject.mid(blobsStart + blobsPart.size());
+  return !container.isEmpty() && !blobName.isEmpty();
+}
+
+// ------------------------------------- PUBLIC SLOTS -------------------------------------
+
+void QAzureStorageChangeFeedJob::start()
+{
+  if (m_isStarted || isFinished())
+  {
+    return;
+  }
+  m_isStarted = true;
+
+  // No (valid) cursor: the change feed is read from its start
+  m_cursor.load();
+
+  // Segments can only be read until the last consumable time
+  m_runningReply = requestFile("meta/segments.json");
+  if (m_runningReply != nullptr)
+  {
+    QNetworkReply* reply = m_runningReply;
+    QObject::connect(reply, &QNetworkReply::finished, this, [this, reply]() { onSegmentsMetaFinished(reply); });
+  }
+}
+
+// ------------------------------------- PRIVATE -------------------------------------
+
+QNetworkReply* QAzureStorageChangeFeedJob::requestFile(const QString& blobName)
+{
+  QNetworkReply* reply = m_api->downloadFile(CHANGE_FEED_CONTAINER, blobName, m_timeoutInSec);
+  if (reply == nullptr)
+  {
+    finish(QNetworkReply::NetworkError::UnknownNetworkError);
+  }
+  return reply;
+}
+
+void QAzureStorageChangeFeedJob::onSegmentsMetaFinished(QNetworkReply* reply)
+{
+  reply->deleteLater();
+  if (isFinished() || reply != m_runningReply)
+  {
+    return;
+  }
+  m_runningReply = nullptr;
+
+  if (!QAzureStorageRestApi::isErrorCodeSuccess(reply->error()))
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageChangeFeedJob] Failed to read the change feed metadata, is the change feed enabled ? (error code" << reply->error() << ")";
+    finish(reply->error());
+    return;
+  }
+
+  m_lastConsumable = QDateTime::fromString(QJsonDocument::fromJson(reply->readAll()).object().value("lastConsumable").toString(), Qt::ISODate);
+  if (!m_lastConsumable.isValid())
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageChangeFeedJob] Invalid change feed metadata";
+    finish(QNetworkReply::NetworkError::UnknownContentError);
+    return;
+  }
+
+  // Only the years after the cursor are listed (segments are sorted by time)
+  const QDateTime cursorTime = segmentTime(m_cursor.segmentPath());
+  if (!cursorTime.isValid())
+  {
+    m_segmentPrefixes.append(SEGMENTS_PREFIX);
+  }
+  else
+  {
+    for (int year = cursorTime.date().year(); year <= m_lastConsumable.toUTC().date().year(); ++year)
+    {
+      m_segmentPrefixes.append(SEGMENTS_PREFIX + QString::number(year) + "/");
+    }
+  }
+
+  listNextSegments();
+}
+
+void QAzureStorageChangeFeedJob::listNextSegments()
+{
+  if (m_segmentPrefixes.isEmpty())
+  {
+    m_segmentCount = m_segments.size();
+    emit progress(m_segmentsDone, m_segmentCount);
+    startNextSegment();
+    return;
+  }
+
+  m_listJob = new QAzureStorageListJob(m_api, CHANGE_FEED_CONTAINER, m_segmentPrefixes.takeFirst(), QString(), -1, 1, m_timeoutInSec, this);
+  QObject::connect(m_listJob, &QAzureStorageListJob::filesListed, this, [this](const QString&, const QList< QMap<QString,QString> >& files) { onSegmentsListed(files); });
+  QObject::connect(m_listJob, &QAzureStorageJob::finished, this, [this](QNetworkReply::NetworkError errorCode) { onListingFinished(errorCode, true); });
+  m_listJob->start();
+}
+
+void QAzureStorageChangeFeedJob::onSegmentsListed(const QList< QMap<QString,QString> >& files)
+{
+  if (isFinished())
+  {
+    return;
+  }
+
+  for (const QMap<QString,QString>& file : files)
+  {
+    // Segments not consumable yet are read next time, the segments before the cursor were already read
+    const QString segmentPath = file.value("Name");
+    const QDateTime time = segmentTime(segmentPath);
+    if (!time.isValid() || time > m_lastConsumable || segmentPath < m_cursor.segmentPath() ||
+        (segmentPath == m_cursor.segmentPath() && m_cursor.isSegmentDone()))
+    {
+      continue;
+    }
+    m_segments.append(segmentPath);
+  }
+}
+
+void QAzureStorageChangeFeedJob::startNextSegment()
+{
+  if (m_segments.isEmpty())
+  {
+    finish(QNetworkReply::NetworkError::NoError);
+    return;
+  }
+
+  m_currentSegment = m_segments.takeFirst();
+  if (m_cursor.segmentPath() != m_currentSegment)
+  {
+    m_cursor.setSegment(m_currentSegment, false);
+  }
+
+  m_runningReply = requestFile(m_currentSegment);
+  if (m_runningReply != nullptr)
+  {
+    QNetworkReply* reply = m_runningReply;
+    QObject::connect(reply, &QNetworkReply::finished, this, [this, reply]() { onSegmentMetaFinished(reply); });
+  }
+}
+
+void QAzureStorageChangeFeedJob::onSegmentMetaFinished(QNetworkReply* reply)
+{
+  reply->deleteLater();
+  if (isFinished() || reply != m_runningReply)
+  {
+    return;
+  }
+  m_runningReply = nullptr;
+
+  if (!QAzureStorageRestApi::isErrorCodeSuccess(reply->error()))
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageChangeFeedJob] Failed to read segment" << m_currentSegment << "(error code" << reply->error() << ")";
+    finish(reply->error());
+    return;
+  }
+
+  // One shard per partition of the account, each shard is a sequence of chunks (Avro files)
+  const QJsonArray chunkFilePaths = QJsonDocument::fromJson(reply->readAll()).object().value("chunkFilePaths").toArray();
+  m_shards.clear();
+  for (const QJsonValue& chunkFilePath : chunkFilePaths)
+  {
+    QString shardPath = chunkFilePath.toString();
+    if (shardPath.startsWith(CHANGE_FEED_CONTAINER + "/"))
+    {
+      shardPath.remove(0, CHANGE_FEED_CONTAINER.size() + 1);
+    }
+    if (!shardPath.isEmpty())
+    {
+      m_shards.append(shardPath);
+    }
+  }
+
+  startNextShard();
+}
+
+void QAzureStorageChangeFeedJob::startNextShard()
+{
+  if (m_shards.isEmpty())
+  {
+    m_cursor.setSegment(m_currentSegment, true);
+    m_cursor.save();
+    emit progress(++m_segmentsDone, m_segmentCount);
+    startNextSegment();
+    return;
+  }
+
+  m_currentShard = m_shards.takeFirst();
+  m_chunks.clear();
+  m_listJob = new QAzureStorageListJob(m_api, CHANGE_FEED_CONTAINER, m_currentShard, QString(), -1, 1, m_timeoutInSec, this);
+  QObject::connect(m_listJob, &QAzureStorageListJob::filesListed, this, [this](const QString&, const QList< QMap<QString,QString> >& files) { onChunksListed(files); });
+  QObject::connect(m_listJob, &QAzureStorageJob::finished, this, [this](QNetworkReply::NetworkError errorCode) { onListingFinished(errorCode, false); });
+  m_listJob->start();
+}
+
+void QAzureStorageChangeFeedJob::onChunksListed(const QList< QMap<QString,QString> >& files)
+{
+  if (isFinished())
+  {
+    return;
+  }
+
+  for (const QMap<QString,QString>& file : files)
+  {
+    if (file.value("Name").endsWith(".avro"))
+    {
+      m_chunks.append(file.value("Name"));
+    }
+  }
+}
+
+void QAzureStorageChangeFeedJob::onListingFinished(const QNetworkReply::NetworkError& errorCode, const bool& isListingSegments)
+{
+  if (m_listJob != nullptr)
+  {
+    m_listJob->deleteLater();
+    m_listJob = nullptr;
+  }
+  if (isFinished())
+  {
+    return;
+  }
+
+  if (!QAzureStorageRestApi::isErrorCodeSuccess(errorCode))
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageChangeFeedJob] Failed to list" << (isListingSegments ? "segments" : m_currentShard) << "(error code" << errorCode << ")";
+    finish(errorCode);
+    return;
+  }
+
+  if (isListingSegments)
+  {
+    listNextSegments();
+  }
+  else
+  {
+    startNextChunk();
+  }
+}
+
+void QAzureStorageChangeFeedJob::startNextChunk()
+{
+  // Chunks before the cursor were already read, the chunk of the cursor is read again without its events already read
+  QString cursorChunk;
+  qint64 cursorEventCount = 0;
+  m_cursor.shardPosition(m_currentShard, cursorChunk, cursorEventCount);
+  while (!m_chunks.isEmpty() && m_chunks.first() < cursorChunk)
+  {
+    m_chunks.removeFirst();
+  }
+
+  if (m_chunks.isEmpty())
+  {
+    startNextShard();
+    return;
+  }
+
+  m_currentChunk = m_chunks.takeFirst();
+  m_chunkEventIndex = 0;
+  m_chunkEventsToSkip = (m_currentChunk == cursorChunk) ? cursorEventCount : 0;
+  m_avroReader = QAzureStorageAvroReader();
+
+  m_runningReply = requestFile(m_currentChunk);
+  if (m_runningReply != nullptr)
+  {
+    QNetworkReply* reply = m_runningReply;
+    QObject::connect(reply, &QNetworkReply::readyRead, this, [this, reply]() { onChunkDataReceived(reply); });
+    QObject::connect(reply, &QNetworkReply::finished, this, [this, reply]() { onChunkFinished(reply); });
+  }
+}
+
+void QAzureStorageChangeFeedJob::onChunkDataReceived(QNetworkReply* reply)
+{
+  if (isFinished() || reply != m_runningReply || !QAzureStorageRestApi::isErrorCodeSuccess(reply->error()))
+  {
+    return;
+  }
+
+  // Decoded while downloading: only the incomplete Avro block is kept in memory
+  if (!m_avroReader.append(reply->readAll()))
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageChangeFeedJob] Invalid chunk" << m_currentChunk << ":" << m_avroReader.errorString();
+    finish(QNetworkReply::NetworkError::UnknownContentError);
+    return;
+  }
+  reportEvents(m_avroReader.takeRecords());
+}
+
+void QAzureStorageChangeFeedJob::onChunkFinished(QNetworkReply* reply)
+{
+  reply->deleteLater();
+  if (isFinished() || reply != m_runningReply)
+  {
+    return;
+  }
+
+  if (!QAzureStorageRestApi::isErrorCodeSuccess(reply->error()))
+  {
+    m_runningReply = nullptr;
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageChangeFeedJob] Failed to read chunk" << m_currentChunk << "(error code" << reply->error() << ")";
+    finish(reply->error());
+    return;
+  }
+
+  onChunkDataReceived(reply);
+  m_runningReply = nullptr;
+  if (isFinished())
+  {
+    return;
+  }
+  if (!m_avroReader.isComplete())
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageChangeFeedJob] Truncated chunk" << m_currentChunk;
+    finish(QNetworkReply::NetworkError::UnknownContentError);
+    return;
+  }
+
+  m_cursor.save();
+  startNextChunk();
+}
+
+void QAzureStorageChangeFeedJob::reportEvents(const QList<QVariant>& records)
+{
+  QList<QVariantMap> events;
+  for (const QVariant& record : records)
+  {
+    if (m_chunkEventIndex++ < m_chunkEventsToSkip)
+    {
+      continue;
+    }
+
+    const QVariantMap event = record.toMap();
+    QString container;
+    QString blobName;
+    if (m_container.isEmpty() || (parseSubject(event.value("subject").toString(), container, blobName) && container == m_container))
+    {
+      events.append(event);
+    }
+  }
+
+  // Events of other containers are consumed too
+  m_cursor.setShardPosition(m_currentShard, m_currentChunk, qMax(m_chunkEventIndex, m_chunkEventsToSkip));
+  if (events.isEmpty())
+  {
+    return;
+  }
+
+  m_eventCount += events.size();
+  emit eventsReceived(events);
+  reportFiles(events);
+}
+
+void QAzureStorageChangeFeedJob::reportFiles(const QList<QVariantMap>& events)
+{
+  // Last event of each file (the events of a file are in the same shard, in order)
+  QMap<QString, QMap<QString, QVariantMap> > lastEvents;
+  for (const QVariantMap& event : events)
+  {
+    const QString eventType = event.value("eventType").toString();
+    QString container;
+    QString blobName;
+    if ((eventType != "BlobCreated" && eventType != "BlobDeleted") || !event.value("data").toMap().value("snapshot").toString().isEmpty() ||
+        !parseSubject(event.value("subject").toString(), container, blobName))
+    {
+      continue;
+    }
+    lastEvents[container].insert(blobName, event);
+  }
+
+  for (QMap<QString, QMap<QString, QVariantMap> >::const_iterator containerIt = lastEvents.constBegin(); containerIt != lastEvents.constEnd(); ++containerIt)
+  {
+    QList< QMap<QString,QString> > updatedFiles;
+    QStringList deletedNames;
+    for (QMap<QString, QVariantMap>::const_iterator it = containerIt.value().constBegin(); it != containerIt.value().constEnd(); ++it)
+    {
+      if (it.value().value("eventType").toString() == "BlobDeleted")
+      {
+        deletedNames.append(it.key());
+        continue;
+      }
+
+      const QVariantMap data = it.value().value("data").toMap();
+      const QDateTime eventTime = QDateTime::fromString(it.value().value("eventTime").toString(), Qt::ISODate).toUTC();
+      QMap<QString,QString> file;
+      file.insert("Name", it.key());
+      file.insert("Content-Length", data.value("contentLength").toString());
+      file.insert("Last-Modified", QLocale(QLocale::English).toString(eventTime, "ddd, dd MMM yyyy hh:mm:ss").append(" GMT"));
+      file.insert("Etag", data.value("etag").toString());
+      file.insert("BlobType", data.value("blobType").toString());
+      updatedFiles.append(file);
+    }
+
+    emit filesChanged(containerIt.key(), updatedFiles, deletedNames);
+  }
+}
+
+void QAzureStorageChangeFeedJob::cleanup()
+{
+  // Stop the running request (its finished signal is ignored since the job is finished)
+  QNetworkReply* runningReply = m_runningReply;
+  m_runningReply = nullptr;
+  if (runningReply != nullptr)
+  {
+    runningReply->abort();
+  }
+  if (m_listJob != nullptr)
+  {
+    m_listJob->abort();
+  }
+
+  // The events already reported are not read again
+  if (m_isStarted)
+  {
+    m_cursor.save();
+  }
+}
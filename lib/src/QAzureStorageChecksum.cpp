@@ -0,0 +1,144 @@
+/*
+ * \brief Checksums (CRC64, MD5) used by Azure storage to check the integrity of the transferred content
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#include "QAzureStorageChecksum.h"
+
+#include <QCryptographicHash>
+
+namespace
+{
+  //! Reflected polynomial of the CRC64 used by Azure storage (same as CRC-64/NVME)
+  const quint64 CRC64_POLYNOMIAL = Q_UINT64_C(0x9A6C9329AC4BC9B5);
+
+  //! Reflected polynomial of the CRC32 used by gzip
+  const quint32 CRC32_POLYNOMIAL = 0xEDB88320u;
+
+  struct Crc32Table
+  {
+    quint32 values[256];
+
+    Crc32Table()
+    {
+      for (int i = 0; i < 256; ++i)
+      {
+        quint32 crc = static_cast<quint32>(i);
+        for (int bit = 0; bit < 8; ++bit)
+        {
+          crc = (crc & 1) ? (crc >> 1) ^ CRC32_POLYNOMIAL : (crc >> 1);
+        }
+        values[i] = crc;
+      }
+    }
+  };
+
+  //! Tables to compute the CRC 8 bytes at a time ("slicing-by-8")
+  struct Crc64Tables
+  {
+    quint64 values[8][256];
+
+    Crc64Tables()
+    {
+      for (int i = 0; i < 256; ++i)
+      {
+        quint64 crc = static_cast<quint64>(i);
+        for (int bit = 0; bit < 8; ++bit)
+        {
+          crc = (crc & 1) ? (crc >> 1) ^ CRC64_POLYNOMIAL : (crc >> 1);
+        }
+        values[0][i] = crc;
+      }
+
+      for (int slice = 1; slice < 8; ++slice)
+      {
+        for (int i = 0; i < 256; ++i)
+        {
+          values[slice][i] = (values[slice - 1][i] >> 8) ^ values[0][values[slice - 1][i] & 0xFF];
+        }
+      }
+    }
+  };
+}
+
+quint64 QAzureStorageChecksum::crc64(const char* data, const qint64& size, const quint64& previousCrc)
+{
+  static const Crc64Tables tables;
+  const quint64 (*table)[256] = tables.values;
+
+  const uchar* bytes = reinterpret_cast<const uchar*>(data);
+  qint64 remaining = size;
+  quint64 crc = ~previousCrc;
+
+  while (remaining >= 8)
+  {
+    quint64 word = 0;
+    for (int i = 0; i < 8; ++i)
+    {
+      word |= static_cast<quint64>(bytes[i]) << (8 * i);
+    }
+    crc ^= word;
+
+    crc = table[7][crc & 0xFF] ^ table[6][(crc >> 8) & 0xFF] ^
+          table[5][(crc >> 16) & 0xFF] ^ table[4][(crc >> 24) & 0xFF] ^
+          table[3][(crc >> 32) & 0xFF] ^ table[2][(crc >> 40) & 0xFF] ^
+          table[1][(crc >> 48) & 0xFF] ^ table[0][crc >> 56];
+
+    bytes += 8;
+    remaining -= 8;
+  }
+
+  while (remaining > 0)
+  {
+    crc = table[0][(crc ^ *bytes) & 0xFF] ^ (crc >> 8);
+    ++bytes;
+    --remaining;
+  }
+
+  return ~crc;
+}
+
+quint64 QAzureStorageChecksum::crc64(const QByteArray& data, const quint64& previousCrc)
+{
+  return crc64(data.constData(), data.size(), previousCrc);
+}
+
+quint32 QAzureStorageChecksum::crc32(const char* data, const qint64& size, const quint32& previousCrc)
+{
+  static const Crc32Table table;
+
+  const uchar* bytes = reinterpret_cast<const uchar*>(data);
+  quint32 crc = ~previousCrc;
+  for (qint64 i = 0; i < size; ++i)
+  {
+    crc = table.values[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+  }
+
+  return ~crc;
+}
+
+quint32 QAzureStorageChecksum::crc32(const QByteArray& data, const quint32& previousCrc)
+{
+  return crc32(data.constData(), data.size(), previousCrc);
+}
+
+QString QAzureStorageChecksum::crc64ToBase64(const quint64& crc)
+{
+  QByteArray littleEndianCrc(8, '\0');
+  for (int i = 0; i < 8; ++i)
+  {
+    littleEndianCrc[i] = static_cast<char>((crc >> (8 * i)) & 0xFF);
+  }
+
+  return QString::fromLatin1(littleEndianCrc.toBase64());
+}
+
+QString QAzureStorageChecksum::md5ToBase64(const QByteArray& data)
+{
+  return QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Md5).toBase64());
+}
@@ -0,0 +1,205 @@
+/*
+ * \brief Gzip compression of the content transferred to/from Azure storage (Content-Encoding: gzip)
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#include "QAzureStorageCompression.h"
+#include "QAzureStorageChecksum.h"
+
+namespace
+{
+  // gzip format: https://www.rfc-editor.org/rfc/rfc1952
+  const int GZIP_HEADER_SIZE = 10;
+  const int GZIP_TRAILER_SIZE = 8;
+  const char GZIP_FLAG_EXTRA = 0x04;
+
+  // Extra field added to each member: adler32 (big endian, as in zlib) + deflate size (little endian)
+  const char EXTRA_SUBFIELD_ID[] = {'Q', 'A'};
+  const int EXTRA_SUBFIELD_DATA_SIZE = 8;
+  const int EXTRA_FIELD_SIZE = 4 + EXTRA_SUBFIELD_DATA_SIZE;
+
+  // qCompress format: expected size (big endian) + zlib header + deflate + adler32 (big endian)
+  const int QCOMPRESS_PREFIX_SIZE = 4;
+  const int ZLIB_HEADER_SIZE = 2;
+  const int ZLIB_TRAILER_SIZE = 4;
+
+  void appendLittleEndian(QByteArray& data, const quint32& value, const int& size)
+  {
+    for (int i = 0; i < size; ++i)
+    {
+      data.append(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+  }
+
+  void appendBigEndian32(QByteArray& data, const quint32& value)
+  {
+    for (int i = 3; i >= 0; --i)
+    {
+      data.append(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+  }
+
+  quint32 readLittleEndian(const QByteArray& data, const int& offset, const int& size)
+  {
+    quint32 value = 0;
+    for (int i = 0; i < size; ++i)
+    {
+      value |= static_cast<quint32>(static_cast<uchar>(data[offset + i])) << (8 * i);
+    }
+    return value;
+  }
+
+  quint32 readBigEndian32(const QByteArray& data, const int& offset)
+  {
+    quint32 value = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+      value = (value << 8) | static_cast<uchar>(data[offset + i]);
+    }
+    return value;
+  }
+}
+
+// ------------------------------------- COMPRESSION -------------------------------------
+
+QByteArray QAzureStorageCompression::gzip(const QByteArray& data, const int& compressionLevel)
+{
+  QByteArray zlibData = qCompress(data, compressionLevel);
+  if (zlibData.size() < QCOMPRESS_PREFIX_SIZE + ZLIB_HEADER_SIZE + ZLIB_TRAILER_SIZE)
+  {
+    return QByteArray();
+  }
+
+  const int deflateSize = zlibData.size() - QCOMPRESS_PREFIX_SIZE - ZLIB_HEADER_SIZE - ZLIB_TRAILER_SIZE;
+  const quint32 adler32 = readBigEndian32(zlibData, zlibData.size() - ZLIB_TRAILER_SIZE);
+
+  QByteArray member;
+  member.reserve(GZIP_HEADER_SIZE + 2 + EXTRA_FIELD_SIZE + deflateSize + GZIP_TRAILER_SIZE);
+
+  // --- Header (no file name, no modification time, unknown OS) ---
+  member.append('\x1f');
+  member.append('\x8b');
+  member.append('\x08');
+  member.append(GZIP_FLAG_EXTRA);
+  appendLittleEndian(member, 0, 4);
+  member.append('\x00');
+  member.append('\xff');
+  // ------------------------
+
+  // --- Extra field needed to decompress the member with qUncompress ---
+  appendLittleEndian(member, EXTRA_FIELD_SIZE, 2);
+  member.append(EXTRA_SUBFIELD_ID[0]);
+  member.append(EXTRA_SUBFIELD_ID[1]);
+  appendLittleEndian(member, EXTRA_SUBFIELD_DATA_SIZE, 2);
+  appendBigEndian32(member, adler32);
+  appendLittleEndian(member, static_cast<quint32>(deflateSize), 4);
+  // ------------------------
+
+  member.append(zlibData.constData() + QCOMPRESS_PREFIX_SIZE + ZLIB_HEADER_SIZE, deflateSize);
+
+  // --- Trailer ---
+  appendLittleEndian(member, QAzureStorageChecksum::crc32(data), 4);
+  appendLittleEndian(member, static_cast<quint32>(data.size()), 4);
+  // ------------------------
+
+  return member;
+}
+
+// ------------------------------------- DECOMPRESSION -------------------------------------
+
+bool QAzureStorageGzipDecoder::decode(const QByteArray& compressedData, QByteArray& decompressedData)
+{
+  m_buffer.append(compressedData);
+
+  while (m_buffer.size() >= GZIP_HEADER_SIZE + 2)
+  {
+    // --- Check the member header ---
+    if (m_buffer[0] != '\x1f' || m_buffer[1] != '\x8b' || m_buffer[2] != '\x08')
+    {
+      return false;
+    }
+    if ((m_buffer[3] & ~0x01) != GZIP_FLAG_EXTRA)
+    {
+      m_isStandardGzip = !m_hasDecodedMember;
+      return false;
+    }
+
+    const int extraFieldSize = static_cast<int>(readLittleEndian(m_buffer, GZIP_HEADER_SIZE, 2));
+    const int headerSize = GZIP_HEADER_SIZE + 2 + extraFieldSize;
+    if (m_buffer.size() < headerSize)
+    {
+      return true;
+    }
+    // ------------------------
+
+    // --- Find the extra subfield added by QAzureStorageCompression::gzip ---
+    int subfieldDataOffset = -1;
+    for (int offset = GZIP_HEADER_SIZE + 2; offset + 4 <= headerSize; )
+    {
+      const int subfieldSize = static_cast<int>(readLittleEndian(m_buffer, offset + 2, 2));
+      if (m_buffer[offset] == EXTRA_SUBFIELD_ID[0] && m_buffer[offset + 1] == EXTRA_SUBFIELD_ID[1] &&
+          subfieldSize == EXTRA_SUBFIELD_DATA_SIZE && offset + 4 + subfieldSize <= headerSize)
+      {
+        subfieldDataOffset = offset + 4;
+        break;
+      }
+      offset += 4 + subfieldSize;
+    }
+
+    if (subfieldDataOffset < 0)
+    {
+      m_isStandardGzip = !m_hasDecodedMember;
+      return false;
+    }
+
+    const quint32 adler32 = readBigEndian32(m_buffer, subfieldDataOffset);
+    const qint64 deflateSize = readLittleEndian(m_buffer, subfieldDataOffset + 4, 4);
+    const qint64 memberSize = headerSize + deflateSize + GZIP_TRAILER_SIZE;
+    if (m_buffer.size() < memberSize)
+    {
+      return true;
+    }
+    // ------------------------
+
+    // --- Decompress the member (converted into qCompress format) ---
+    const int trailerOffset = static_cast<int>(headerSize + deflateSize);
+    const quint32 expectedCrc32 = readLittleEndian(m_buffer, trailerOffset, 4);
+    const quint32 expectedSize = readLittleEndian(m_buffer, trailerOffset + 4, 4);
+
+    QByteArray zlibData;
+    zlibData.reserve(QCOMPRESS_PREFIX_SIZE + ZLIB_HEADER_SIZE + deflateSize + ZLIB_TRAILER_SIZE);
+    appendBigEndian32(zlibData, expectedSize);
+    zlibData.append('\x78');
+    zlibData.append('\x9c');
+    zlibData.append(m_buffer.constData() + headerSize, static_cast<int>(deflateSize));
+    appendBigEndian32(zlibData, adler32);
+
+    QByteArray member = qUncompress(zlibData);
+    if (static_cast<quint32>(member.size()) != expectedSize || QAzureStorageChecksum::crc32(member) != expectedCrc32)
+    {
+      return false;
+    }
+
+    decompressedData.append(member);
+    m_buffer.remove(0, static_cast<int>(memberSize));
+    m_hasDecodedMember = true;
+    // ------------------------
+  }
+
+  return true;
+}
+
+bool QAzureStorageGzipDecoder::isComplete() const
+{
+  return m_buffer.isEmpty();
+}
+
+bool QAzureStorageGzipDecoder::isStandardGzip() const
+{
+  return m_isStandardGzip;
+}
@@ -0,0 +1,383 @@
+/*
+ * \brief Download all the files of an Azure storage virtual "folder" into a local directory while listing them
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#include "QAzureStorageDirectoryDownloadJob.h"
+#include "QAzureStorageRestApi.h"
+#include "QAzureStorageListJob.h"
+#include "QAzureStorageDownloadJob.h"
+#include "QAzureStorageLogging.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDebug>
+
+// ------------------------------------- CONSTRUCTOR & INIT -------------------------------------
+
+QAzureStorageDirectoryDownloadJob::QAzureStorageDirectoryDownloadJob(QAzureStorageRestApi* api, const QString& container, const QString& prefix, const QString& localPath,
+                                                                     const int& maxParallelRequests, const qint64& singleGetMaxSizeInBytes, const qint64& rangeSizeInBytes,
+                                                                     const int& maxParallelRanges, const int& timeoutInSec, QObject* parent) :
+  QAzureStorageJob(parent),
+  m_api(api),
+  m_container(container),
+  m_prefix(prefix),
+  m_localPath(QDir::cleanPath(localPath)),
+  m_maxParallelRequests(maxParallelRequests),
+  m_singleGetMaxSizeInBytes(singleGetMaxSizeInBytes),
+  m_rangeSizeInBytes(rangeSizeInBytes),
+  m_maxParallelRanges(maxParallelRanges),
+  m_timeoutInSec(timeoutInSec)
+{
+  if (!m_prefix.isEmpty() && !m_prefix.endsWith('/'))
+  {
+    m_prefix.append('/');
+  }
+}
+
+qint64 QAzureStorageDirectoryDownloadJob::fileCount() const
+{
+  return m_fileCount;
+}
+
+qint64 QAzureStorageDirectoryDownloadJob::downloadedFileCount() const
+{
+  return m_downloadedFileCount;
+}
+
+bool QAzureStorageDirectoryDownloadJob::isListingFinished() const
+{
+  return m_isListingFinished;
+}
+
+QMap<QString, QNetworkReply::NetworkError> QAzureStorageDirectoryDownloadJob::failedFiles() const
+{
+  return m_failedFiles;
+}
+
+void QAzureStorageDirectoryDownloadJob::setFiles(const QList< QMap<QString,QString> >& files)
+{
+  m_files = files;
+  m_isFileListSet = true;
+}
+
+QString QAzureStorageDirectoryDownloadJob::localFilePath(const QString& blobName) const
+{
+  if (!blobName.startsWith(m_prefix) || blobName.size() == m_prefix.size())
+  {
+    return QString();
+  }
+
+  // Blob names are free text: "../" must not write outside of the local directory
+  const QString filePath = QDir::cleanPath(m_localPath + "/" + blobName.mid(m_prefix.size()));
+  if (!filePath.startsWith(m_localPath + "/"))
+  {
+    return QString();
+  }
+
+  return filePath;
+}
+
+// ------------------------------------- PUBLIC SLOTS -------------------------------------
+
+void QAzureStorageDirectoryDownloadJob::start()
+{
+  if (m_isStarted || isFinished())
+  {
+    return;
+  }
+  m_isStarted = true;
+
+  if (!QDir().mkpath(m_localPath))
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageDirectoryDownloadJob] Failed to create local directory" << m_localPath;
+    finish(QNetworkReply::NetworkError::UnknownContentError);
+    return;
+  }
+
+  if (m_isFileListSet)
+  {
+    onFilesListed(m_files);
+    onListingFinished(QNetworkReply::NetworkError::NoError);
+    return;
+  }
+
+  // Flat listing (no delimiter): each page is downloaded while the next one is listed
+  m_listJob = new QAzureStorageListJob(m_api, m_container, m_prefix, QString(), -1, 1, m_timeoutInSec, this);
+  QObject::connect(m_listJob, &QAzureStorageListJob::filesListed, this, [this](const QString&, const QList< QMap<QString,QString> >& files) { onFilesListed(files); });
+  QObject::connect(m_listJob, &QAzureStorageJob::finished, this, [this](QNetworkReply::NetworkError errorCode) { onListingFinished(errorCode); });
+  m_listJob->start();
+}
+
+// ------------------------------------- PRIVATE -------------------------------------
+
+void QAzureStorageDirectoryDownloadJob::onFilesListed(const QList< QMap<QString,QString> >& files)
+{
+  if (isFinished())
+  {
+    return;
+  }
+
+  for (const QMap<QString,QString>& listedFile : files)
+  {
+    // The virtual "folder" itself (hierarchical namespace) is the local directory
+    if (listedFile.value("Name") == m_prefix)
+    {
+      continue;
+    }
+
+    File file;
+    file.blobName = listedFile.value("Name");
+    file.size = listedFile.value("Content-Length").toLongLong();
+    m_totalBytes += file.size;
+    ++m_fileCount;
+
+    if (file.size <= m_singleGetMaxSizeInBytes)
+    {
+      m_pendingSmallFiles.append(file);
+    }
+    else
+    {
+      m_pendingBigFiles.append(file);
+    }
+  }
+
+  emitProgress();
+  startNextFiles();
+}
+
+void QAzureStorageDirectoryDownloadJob::onListingFinished(const QNetworkReply::NetworkError& errorCode)
+{
+  if (m_listJob != nullptr)
+  {
+    m_listJob->deleteLater();
+    m_listJob = nullptr;
+  }
+  if (isFinished())
+  {
+    return;
+  }
+
+  // Without the full listing, some files would silently be missing
+  if (!QAzureStorageRestApi::isErrorCodeSuccess(errorCode))
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageDirectoryDownloadJob] Failed to list" << m_container + "/" + m_prefix << "(error code" << errorCode << ")";
+    finish(errorCode);
+    return;
+  }
+
+  m_isListingFinished = true;
+  emitProgress();
+  startNextFiles();
+}
+
+void QAzureStorageDirectoryDownloadJob::startNextFiles()
+{
+  while (!isFinished())
+  {
+    // Big files first, the small files use the requests left (a big file always fits once another one is done)
+    if (!m_pendingBigFiles.isEmpty() && m_runningRequests + requestsOfBigFile() <= m_maxParallelRequests)
+    {
+      startBigFile(m_pendingBigFiles.takeFirst());
+    }
+    else if (!m_pendingSmallFiles.isEmpty() && m_runningRequests < m_maxParallelRequests)
+    {
+      startSmallFile(m_pendingSmallFiles.takeFirst());
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  if (!isFinished() && m_isListingFinished && m_pendingBigFiles.isEmpty() && m_pendingSmallFiles.isEmpty() &&
+      m_runningSmallFiles.isEmpty() && m_runningBigFiles.isEmpty())
+  {
+    finish(m_firstError);
+  }
+}
+
+void QAzureStorageDirectoryDownloadJob::startSmallFile(const File& file)
+{
+  QString localPath;
+  if (!prepareLocalDirectory(file, localPath))
+  {
+    return;
+  }
+
+  // Virtual "folder" created explicitly (hierarchical namespace, empty marker blob)
+  if (file.blobName.endsWith('/'))
+  {
+    onFileDone(file, QDir().mkpath(localPath) ? QNetworkReply::NetworkError::NoError : QNetworkReply::NetworkError::UnknownContentError);
+    return;
+  }
+
+  QNetworkReply* reply = m_api->downloadFile(m_container, file.blobName, m_timeoutInSec);
+  if (reply == nullptr)
+  {
+    onFileDone(file, QNetworkReply::NetworkError::UnknownNetworkError);
+    return;
+  }
+
+  ++m_runningRequests;
+  m_runningSmallFiles.insert(reply, file);
+  QObject::connect(reply, &QNetworkReply::finished, this, [this, reply]() { onSmallFileFinished(reply); });
+}
+
+void QAzureStorageDirectoryDownloadJob::startBigFile(const File& file)
+{
+  QString localPath;
+  if (!prepareLocalDirectory(file, localPath))
+  {
+    return;
+  }
+
+  QAzureStorageDownloadJob* job = new QAzureStorageDownloadJob(m_api, m_container, file.blobName, localPath, m_rangeSizeInBytes, requestsOfBigFile(),
+                                                               QString(), m_timeoutInSec, this);
+
+  m_runningRequests += requestsOfBigFile();
+  m_runningBigFiles.insert(job, file);
+  m_runningBigFilesProgress.insert(job, 0);
+  QObject::connect(job, &QAzureStorageJob::progress, this, [this, job](qint64 bytesDone, qint64)
+  {
+    if (!isFinished() && m_runningBigFilesProgress.contains(job))
+    {
+      m_runningBigFilesProgress[job] = bytesDone;
+      emitProgress();
+    }
+  });
+  QObject::connect(job, &QAzureStorageJob::finished, this, [this, job](QNetworkReply::NetworkError errorCode) { onBigFileFinished(job, errorCode); });
+
+  // Started from the event loop (a job failing right away must not finish while the next files are started)
+  QMetaObject::invokeMethod(job, "start", Qt::QueuedConnection);
+}
+
+void QAzureStorageDirectoryDownloadJob::onSmallFileFinished(QNetworkReply* reply)
+{
+  reply->deleteLater();
+  if (isFinished() || !m_runningSmallFiles.contains(reply))
+  {
+    return;
+  }
+
+  --m_runningRequests;
+  const File file = m_runningSmallFiles.take(reply);
+  QNetworkReply::NetworkError errorCode = reply->error();
+
+  // Written in a temporary file renamed at the end: an interrupted download never leaves a truncated file
+  if (QAzureStorageRestApi::isErrorCodeSuccess(errorCode))
+  {
+    QSaveFile localFile(localFilePath(file.blobName));
+    if (!localFile.open(QIODevice::WriteOnly) || localFile.write(reply->readAll()) < 0 || !localFile.commit())
+    {
+      qCWarning(lcAzureStorageTransfer) << "[QAzureStorageDirectoryDownloadJob] Failed to write local file" << localFile.fileName() << ":" << localFile.errorString();
+      errorCode = QNetworkReply::NetworkError::UnknownContentError;
+    }
+  }
+
+  onFileDone(file, errorCode);
+  startNextFiles();
+}
+
+void QAzureStorageDirectoryDownloadJob::onBigFileFinished(QAzureStorageDownloadJob* job, const QNetworkReply::NetworkError& errorCode)
+{
+  job->deleteLater();
+  if (isFinished() || !m_runningBigFiles.contains(job))
+  {
+    return;
+  }
+
+  m_runningRequests -= requestsOfBigFile();
+  m_runningBigFilesProgress.remove(job);
+  onFileDone(m_runningBigFiles.take(job), errorCode);
+  startNextFiles();
+}
+
+void QAzureStorageDirectoryDownloadJob::onFileDone(const File& file, const QNetworkReply::NetworkError& errorCode)
+{
+  if (QAzureStorageRestApi::isErrorCodeSuccess(errorCode))
+  {
+    ++m_downloadedFileCount;
+  }
+  else
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageDirectoryDownloadJob] Failed to download" << m_container + "/" + file.blobName << "(error code" << errorCode << ")";
+    m_failedFiles.insert(file.blobName, errorCode);
+    if (m_firstError == QNetworkReply::NetworkError::NoError)
+    {
+      m_firstError = errorCode;
+    }
+  }
+
+  m_bytesDone += file.size;
+  emit fileDownloaded(file.blobName, localFilePath(file.blobName), errorCode);
+  emitProgress();
+}
+
+void QAzureStorageDirectoryDownloadJob::emitProgress()
+{
+  qint64 bytesDone = m_bytesDone;
+  for (QMap<QAzureStorageDownloadJob*, qint64>::const_iterator it = m_runningBigFilesProgress.constBegin(); it != m_runningBigFilesProgress.constEnd(); ++it)
+  {
+    bytesDone += it.value();
+  }
+  emit progress(bytesDone, m_isListingFinished ? m_totalBytes : -1);
+}
+
+bool QAzureStorageDirectoryDownloadJob::prepareLocalDirectory(const File& file, QString& localPath)
+{
+  localPath = localFilePath(file.blobName);
+  if (localPath.isEmpty())
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageDirectoryDownloadJob]" << file.blobName << "can not be written in" << m_localPath;
+    onFileDone(file, QNetworkReply::NetworkError::ContentOperationNotPermittedError);
+    return false;
+  }
+
+  if (!QDir().mkpath(QFileInfo(localPath).absolutePath()))
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageDirectoryDownloadJob] Failed to create local directory of" << localPath;
+    onFileDone(file, QNetworkReply::NetworkError::UnknownContentError);
+    return false;
+  }
+
+  return true;
+}
+
+int QAzureStorageDirectoryDownloadJob::requestsOfBigFile() const
+{
+  return qMax(1, qMin(m_maxParallelRanges, m_maxParallelRequests));
+}
+
+void QAzureStorageDirectoryDownloadJob::cleanup()
+{
+  m_pendingSmallFiles.clear();
+  m_pendingBigFiles.clear();
+
+  // Stop the listing, the remaining requests and jobs (their finished signal is ignored since the job is finished)
+  const QList<QNetworkReply*> runningReplies = m_runningSmallFiles.keys();
+  const QList<QAzureStorageDownloadJob*> runningJobs = m_runningBigFiles.keys();
+  m_runningSmallFiles.clear();
+  m_runningBigFiles.clear();
+  m_runningBigFilesProgress.clear();
+  m_runningRequests = 0;
+
+  if (m_listJob != nullptr)
+  {
+    m_listJob->abort();
+  }
+  for (QNetworkReply* reply : runningReplies)
+  {
+    reply->abort();
+  }
+  for (QAzureStorageDownloadJob* job : runningJobs)
+  {
+    job->abort();
+  }
+}
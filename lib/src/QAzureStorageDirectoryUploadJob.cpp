@@ -0,0 +1,293 @@
+/*
+ * \brief Upload a local directory (all its files, recursively) into Azure storage with parallel files
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#include "QAzureStorageDirectoryUploadJob.h"
+#include "QAzureStorageRestApi.h"
+#include "QAzureStorageUploadJob.h"
+#include "QAzureStorageLogging.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QDebug>
+
+#include <algorithm>
+
+// ------------------------------------- CONSTRUCTOR & INIT -------------------------------------
+
+QAzureStorageDirectoryUploadJob::QAzureStorageDirectoryUploadJob(QAzureStorageRestApi* api, const QString& localPath, const QString& container, const QString& prefix,
+                                                                 const int& maxParallelRequests, const qint64& singlePutMaxSizeInBytes, const qint64& blockSizeInBytes,
+                                                                 const int& maxParallelBlocks, const int& timeoutInSec, QObject* parent) :
+  QAzureStorageJob(parent),
+  m_api(api),
+  m_localPath(localPath),
+  m_container(container),
+  m_prefix(prefix),
+  m_maxParallelRequests(maxParallelRequests),
+  m_singlePutMaxSizeInBytes(singlePutMaxSizeInBytes),
+  m_blockSizeInBytes(blockSizeInBytes),
+  m_maxParallelBlocks(maxParallelBlocks),
+  m_timeoutInSec(timeoutInSec)
+{
+  if (!m_prefix.isEmpty() && !m_prefix.endsWith('/'))
+  {
+    m_prefix.append('/');
+  }
+}
+
+qint64 QAzureStorageDirectoryUploadJob::fileCount() const
+{
+  return m_fileCount;
+}
+
+qint64 QAzureStorageDirectoryUploadJob::uploadedFileCount() const
+{
+  return m_uploadedFileCount;
+}
+
+QMap<QString, QNetworkReply::NetworkError> QAzureStorageDirectoryUploadJob::failedFiles() const
+{
+  return m_failedFiles;
+}
+
+void QAzureStorageDirectoryUploadJob::setFiles(const QStringList& relativePaths)
+{
+  m_files = relativePaths;
+  m_isFileListSet = true;
+}
+
+QString QAzureStorageDirectoryUploadJob::blobName(const QString& relativePath) const
+{
+  return m_prefix + QDir::fromNativeSeparators(relativePath);
+}
+
+// ------------------------------------- PUBLIC SLOTS -------------------------------------
+
+void QAzureStorageDirectoryUploadJob::start()
+{
+  if (m_isStarted || isFinished())
+  {
+    return;
+  }
+  m_isStarted = true;
+
+  const QDir directory(m_localPath);
+  if (!directory.exists())
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageDirectoryUploadJob] Local directory" << m_localPath << "does not exist";
+    finish(QNetworkReply::NetworkError::UnknownContentError);
+    return;
+  }
+
+  // --- List the local files (sizes needed for the total progress) ---
+  if (m_isFileListSet)
+  {
+    for (const QString& relativePath : m_files)
+    {
+      File file;
+      file.relativePath = relativePath;
+      file.size = QFileInfo(directory.filePath(relativePath)).size();
+      addPendingFile(file);
+    }
+  }
+  else
+  {
+    QDirIterator it(m_localPath, QDir::Files | QDir::Hidden | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (it.hasNext())
+    {
+      it.next();
+
+      File file;
+      file.relativePath = directory.relativeFilePath(it.filePath());
+      file.size = it.fileInfo().size();
+      addPendingFile(file);
+    }
+  }
+  m_fileCount = m_pendingSmallFiles.size() + m_pendingBigFiles.size();
+  // ------------------------
+
+  // The biggest files are started first so that the upload does not end with one big file uploaded alone
+  std::sort(m_pendingBigFiles.begin(), m_pendingBigFiles.end(), [](const File& a, const File& b) { return a.size > b.size; });
+
+  emit progress(0, m_totalBytes);
+  startNextFiles();
+}
+
+// ------------------------------------- PRIVATE -------------------------------------
+
+void QAzureStorageDirectoryUploadJob::addPendingFile(const File& file)
+{
+  m_totalBytes += file.size;
+  if (file.size <= m_singlePutMaxSizeInBytes)
+  {
+    m_pendingSmallFiles.append(file);
+  }
+  else
+  {
+    m_pendingBigFiles.append(file);
+  }
+}
+
+void QAzureStorageDirectoryUploadJob::startNextFiles()
+{
+  while (!isFinished())
+  {
+    // Big files first, the small files use the requests left (a big file always fits once another one is done)
+    if (!m_pendingBigFiles.isEmpty() && m_runningRequests + requestsOfBigFile() <= m_maxParallelRequests)
+    {
+      startBigFile(m_pendingBigFiles.takeFirst());
+    }
+    else if (!m_pendingSmallFiles.isEmpty() && m_runningRequests < m_maxParallelRequests)
+    {
+      startSmallFile(m_pendingSmallFiles.takeFirst());
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  if (!isFinished() && m_pendingBigFiles.isEmpty() && m_pendingSmallFiles.isEmpty() && m_runningSmallFiles.isEmpty() && m_runningBigFiles.isEmpty())
+  {
+    finish(m_firstError);
+  }
+}
+
+void QAzureStorageDirectoryUploadJob::startSmallFile(const File& file)
+{
+  // Only the files being uploaded are kept in memory
+  QFile localFile(QDir(m_localPath).filePath(file.relativePath));
+  if (!localFile.open(QIODevice::ReadOnly))
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageDirectoryUploadJob] Failed to open local file" << localFile.fileName() << ":" << localFile.errorString();
+    onFileDone(file, QNetworkReply::NetworkError::UnknownContentError);
+    return;
+  }
+
+  QNetworkReply* reply = m_api->uploadFileQByteArray(localFile.readAll(), m_container, blobName(file.relativePath), "BlockBlob", m_timeoutInSec);
+  if (reply == nullptr)
+  {
+    onFileDone(file, QNetworkReply::NetworkError::UnknownNetworkError);
+    return;
+  }
+
+  ++m_runningRequests;
+  m_runningSmallFiles.insert(reply, file);
+  QObject::connect(reply, &QNetworkReply::finished, this, [this, reply]() { onSmallFileFinished(reply); });
+}
+
+void QAzureStorageDirectoryUploadJob::startBigFile(const File& file)
+{
+  QAzureStorageUploadJob* job = new QAzureStorageUploadJob(m_api, QDir(m_localPath).filePath(file.relativePath), m_container, blobName(file.relativePath),
+                                                           m_blockSizeInBytes, requestsOfBigFile(), QString(), m_timeoutInSec, this);
+
+  m_runningRequests += requestsOfBigFile();
+  m_runningBigFiles.insert(job, file);
+  m_runningBigFilesProgress.insert(job, 0);
+  QObject::connect(job, &QAzureStorageJob::progress, this, [this, job](qint64 bytesDone, qint64)
+  {
+    if (!isFinished() && m_runningBigFilesProgress.contains(job))
+    {
+      m_runningBigFilesProgress[job] = bytesDone;
+      emitProgress();
+    }
+  });
+  QObject::connect(job, &QAzureStorageJob::finished, this, [this, job](QNetworkReply::NetworkError errorCode) { onBigFileFinished(job, errorCode); });
+
+  // Started from the event loop (a job failing right away must not finish while the next files are started)
+  QMetaObject::invokeMethod(job, "start", Qt::QueuedConnection);
+}
+
+void QAzureStorageDirectoryUploadJob::onSmallFileFinished(QNetworkReply* reply)
+{
+  reply->deleteLater();
+  if (isFinished() || !m_runningSmallFiles.contains(reply))
+  {
+    return;
+  }
+
+  --m_runningRequests;
+  onFileDone(m_runningSmallFiles.take(reply), reply->error(), QString::fromLatin1(reply->rawHeader("ETag")));
+  startNextFiles();
+}
+
+void QAzureStorageDirectoryUploadJob::onBigFileFinished(QAzureStorageUploadJob* job, const QNetworkReply::NetworkError& errorCode)
+{
+  job->deleteLater();
+  if (isFinished() || !m_runningBigFiles.contains(job))
+  {
+    return;
+  }
+
+  m_runningRequests -= requestsOfBigFile();
+  m_runningBigFilesProgress.remove(job);
+  onFileDone(m_runningBigFiles.take(job), errorCode, job->etag());
+  startNextFiles();
+}
+
+void QAzureStorageDirectoryUploadJob::onFileDone(const File& file, const QNetworkReply::NetworkError& errorCode, const QString& etag)
+{
+  if (QAzureStorageRestApi::isErrorCodeSuccess(errorCode))
+  {
+    ++m_uploadedFileCount;
+  }
+  else
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageDirectoryUploadJob] Failed to upload" << file.relativePath << "(error code" << errorCode << ")";
+    m_failedFiles.insert(file.relativePath, errorCode);
+    if (m_firstError == QNetworkReply::NetworkError::NoError)
+    {
+      m_firstError = errorCode;
+    }
+  }
+
+  m_bytesDone += file.size;
+  emit fileUploaded(file.relativePath, blobName(file.relativePath), errorCode, etag);
+  emitProgress();
+}
+
+void QAzureStorageDirectoryUploadJob::emitProgress()
+{
+  qint64 bytesDone = m_bytesDone;
+  for (QMap<QAzureStorageUploadJob*, qint64>::const_iterator it = m_runningBigFilesProgress.constBegin(); it != m_runningBigFilesProgress.constEnd(); ++it)
+  {
+    bytesDone += it.value();
+  }
+  emit progress(bytesDone, m_totalBytes);
+}
+
+int QAzureStorageDirectoryUploadJob::requestsOfBigFile() const
+{
+  return qMax(1, qMin(m_maxParallelBlocks, m_maxParallelRequests));
+}
+
+void QAzureStorageDirectoryUploadJob::cleanup()
+{
+  m_pendingSmallFiles.clear();
+  m_pendingBigFiles.clear();
+
+  // Stop the remaining requests and jobs (their finished signal is ignored since the job is finished)
+  const QList<QNetworkReply*> runningReplies = m_runningSmallFiles.keys();
+  const QList<QAzureStorageUploadJob*> runningJobs = m_runningBigFiles.keys();
+  m_runningSmallFiles.clear();
+  m_runningBigFiles.clear();
+  m_runningBigFilesProgress.clear();
+  m_runningRequests = 0;
+
+  for (QNetworkReply* reply : runningReplies)
+  {
+    reply->abort();
+  }
+  for (QAzureStorageUploadJob* job : runningJobs)
+  {
+    job->abort();
+  }
+}
@@ -0,0 +1,607 @@
+/*
+ * \brief Download a file (blob in container) from Azure storage into a local file using parallel ranges
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#include "QAzureStorageDownloadJob.h"
+#include "QAzureStorageRestApi.h"
+#include "QAzureStorageChecksum.h"
+#include "QAzureStorageLogging.h"
+
+#include <QTimer>
+#include <QDebug>
+
+namespace
+{
+  //! Read buffer of the replies of a bandwidth limited download (the rest waits in the connection)
+  const qint64 throttledReadBufferSize = 64 * 1024;
+}
+
+// ------------------------------------- CONSTRUCTOR & INIT -------------------------------------
+
+QAzureStorageDownloadJob::QAzureStorageDownloadJob(QAzureStorageRestApi* api, const QString& container, const QString& blobName, const QString& filePath,
+                                                   const qint64& rangeSizeInBytes, const int& maxParallelRanges, const QString& journalPath,
+                                                   const int& timeoutInSec, QObject* parent) :
+  QAzureStorageJob(parent),
+  m_api(api),
+  m_container(container),
+  m_blobName(blobName),
+  m_rangeSizeInBytes(rangeSizeInBytes),
+  m_maxParallelRanges(maxParallelRanges),
+  m_timeoutInSec(timeoutInSec),
+  m_file(filePath),
+  m_journal(journalPath),
+  m_bandwidthLimiter(0, api->downloadBandwidthLimiter())
+{
+}
+
+qint64 QAzureStorageDownloadJob::fileSize() const
+{
+  return m_fileSize;
+}
+
+qint64 QAzureStorageDownloadJob::bytesWritten() const
+{
+  return m_bytesWritten;
+}
+
+void QAzureStorageDownloadJob::setBandwidthLimit(const qint64& bytesPerSecond)
+{
+  m_bandwidthLimiter.setRate(bytesPerSecond);
+}
+
+qint64 QAzureStorageDownloadJob::bandwidthLimit() const
+{
+  return m_bandwidthLimiter.rate();
+}
+
+void QAzureStorageDownloadJob::setPageRangesOnly(const bool& isEnabled, const QString& prevSnapshot)
+{
+  m_isPageRangesOnly = isEnabled;
+  m_prevSnapshot = isEnabled ? prevSnapshot : QString();
+}
+
+// ------------------------------------- PUBLIC SLOTS -------------------------------------
+
+void QAzureStorageDownloadJob::start()
+{
+  if (m_isStarted || isFinished())
+  {
+    return;
+  }
+  m_isStarted = true;
+
+  // The blob size is needed to pre-size the local file and split the download in ranges
+  m_propertiesReply = m_api->getFileProperties(m_container, m_blobName, m_timeoutInSec);
+  if (m_propertiesReply == nullptr)
+  {
+    finish(QNetworkReply::NetworkError::UnknownNetworkError);
+    return;
+  }
+
+  QNetworkReply* reply = m_propertiesReply;
+  QObject::connect(reply, &QNetworkReply::finished, this, [this, reply]() { onPropertiesFinished(reply); });
+}
+
+// ------------------------------------- PRIVATE -------------------------------------
+
+void QAzureStorageDownloadJob::onPropertiesFinished(QNetworkReply* reply)
+{
+  reply->deleteLater();
+  if (isFinished() || reply != m_propertiesReply)
+  {
+    return;
+  }
+  m_propertiesReply = nullptr;
+
+  if (!QAzureStorageRestApi::isErrorCodeSuccess(reply->error()))
+  {
+    finish(reply->error());
+    return;
+  }
+
+  bool isValidSize = false;
+  m_fileSize = reply->header(QNetworkRequest::ContentLengthHeader).toLongLong(&isValidSize);
+  if (!isValidSize || m_fileSize < 0)
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageDownloadJob] No valid Content-Length received for" << m_container + "/" + m_blobName;
+    finish(QNetworkReply::NetworkError::UnknownContentError);
+    return;
+  }
+
+  if (m_isPageRangesOnly && reply->rawHeader("x-ms-blob-type") != "PageBlob")
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageDownloadJob]" << m_container + "/" + m_blobName << "is not a page blob";
+    finish(QNetworkReply::NetworkError::ContentOperationNotPermittedError);
+    return;
+  }
+
+  m_etag = QString::fromLatin1(reply->rawHeader("ETag"));
+
+  // Compressed content is decompressed in order, so it is received as one range (without journal)
+  if (!m_isPageRangesOnly && m_api->isContentCompressionEnabled() && reply->rawHeader("Content-Encoding").trimmed().toLower() == "gzip")
+  {
+    m_isDecompressing = true;
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+      qCWarning(lcAzureStorageTransfer) << "[QAzureStorageDownloadJob] Failed to prepare local file" << m_file.fileName() << ":" << m_file.errorString();
+      finish(QNetworkReply::NetworkError::UnknownContentError);
+      return;
+    }
+
+    m_bytesToWrite = m_fileSize;
+    if (m_fileSize > 0)
+    {
+      Range range;
+      range.offset = 0;
+      range.length = m_fileSize;
+      range.written = 0;
+      range.crc64 = 0;
+      m_pendingRanges.append(range);
+    }
+
+    emit progress(m_bytesWritten, m_bytesToWrite);
+    startNextRanges();
+    return;
+  }
+
+  startRangedDownload();
+}
+
+void QAzureStorageDownloadJob::startRangedDownload()
+{
+  // Ranges of the journal are only skipped if the blob did not change and the local file is still there
+  bool isResuming = false;
+  if (m_journal.isEnabled())
+  {
+    QString identity = QString("download\n%1/%2\n%3\n%4\n%5\n%6").arg(m_container, m_blobName, QString::number(m_fileSize), m_etag,
+                                                                      QString::number(m_rangeSizeInBytes), m_file.fileName());
+    if (m_isPageRangesOnly)
+    {
+      identity += "\npages " + m_prevSnapshot;
+    }
+
+    if (m_journal.openForLocalFile(identity, m_file.fileName(), m_fileSize))
+    {
+      isResuming = true;
+      m_completedRanges = m_journal.completedRanges();
+    }
+  }
+
+  // Pre-size the local file so that each range can be written at its offset as soon as it is received
+  // (the file is not truncated first so that an interrupted download can be resumed, except for a full
+  // page ranges download where the truncated file only contains holes where no page range is written)
+  QIODevice::OpenMode openMode = QIODevice::ReadWrite;
+  if (m_isPageRangesOnly && m_prevSnapshot.isEmpty() && !isResuming)
+  {
+    openMode |= QIODevice::Truncate;
+  }
+
+  if (!m_file.open(openMode) || !m_file.resize(m_fileSize))
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageDownloadJob] Failed to prepare local file" << m_file.fileName() << ":" << m_file.errorString();
+    finish(QNetworkReply::NetworkError::UnknownContentError);
+    return;
+  }
+
+  if (m_isPageRangesOnly)
+  {
+    requestPageRanges(QString());
+    return;
+  }
+
+  addPendingRanges(0, m_fileSize);
+  emit progress(m_bytesWritten, m_bytesToWrite);
+  startNextRanges();
+}
+
+void QAzureStorageDownloadJob::requestPageRanges(const QString& marker)
+{
+  m_pageRangesReply = m_api->getPageRanges(m_container, m_blobName, m_prevSnapshot, marker, m_timeoutInSec);
+  if (m_pageRangesReply == nullptr)
+  {
+    finish(QNetworkReply::NetworkError::UnknownNetworkError);
+    return;
+  }
+
+  QNetworkReply* reply = m_pageRangesReply;
+  QObject::connect(reply, &QNetworkReply::finished, this, [this, reply]() { onPageRangesFinished(reply); });
+}
+
+void QAzureStorageDownloadJob::onPageRangesFinished(QNetworkReply* reply)
+{
+  reply->deleteLater();
+  if (isFinished() || reply != m_pageRangesReply)
+  {
+    return;
+  }
+  m_pageRangesReply = nullptr;
+
+  if (!QAzureStorageRestApi::isErrorCodeSuccess(reply->error()))
+  {
+    finish(reply->error());
+    return;
+  }
+
+  QString nextMarker;
+  QList< QMap<QString,QString> > pageRanges = QAzureStorageRestApi::parsePageRanges(reply->readAll(), &nextMarker);
+  for (const QMap<QString,QString>& pageRange : pageRanges)
+  {
+    qint64 start = pageRange.value("Start").toLongLong();
+    qint64 length = pageRange.value("End").toLongLong() - start + 1;
+    if (start < 0 || length <= 0 || start + length > m_fileSize)
+    {
+      qCWarning(lcAzureStorageTransfer) << "[QAzureStorageDownloadJob] Invalid page range received for" << m_container + "/" + m_blobName << ":" << pageRange;
+      finish(QNetworkReply::NetworkError::UnknownContentError);
+      return;
+    }
+
+    if (pageRange.value("Type") == "PageRange")
+    {
+      addPendingRanges(start, length);
+    }
+    else if (!writeZeros(start, length))
+    {
+      qCWarning(lcAzureStorageTransfer) << "[QAzureStorageDownloadJob] Failed to clear pages in local file" << m_file.fileName() << ":" << m_file.errorString();
+      finish(QNetworkReply::NetworkError::UnknownContentError);
+      return;
+    }
+  }
+
+  // Big page blobs may have their page ranges listed in several answers
+  if (!nextMarker.isEmpty())
+  {
+    requestPageRanges(nextMarker);
+    return;
+  }
+
+  emit progress(m_bytesWritten, m_bytesToWrite);
+  startNextRanges();
+}
+
+void QAzureStorageDownloadJob::addPendingRanges(const qint64& offset, const qint64& length)
+{
+  m_bytesToWrite += length;
+
+  for (qint64 rangeOffset = offset; rangeOffset < offset + length; rangeOffset += m_rangeSizeInBytes)
+  {
+    Range range;
+    range.offset = rangeOffset;
+    range.length = qMin(m_rangeSizeInBytes, offset + length - rangeOffset);
+    range.written = 0;
+    range.crc64 = 0;
+
+    if (m_completedRanges.value(range.offset, -1) == range.length)
+    {
+      m_bytesWritten += range.length;
+    }
+    else
+    {
+      m_pendingRanges.append(range);
+    }
+  }
+}
+
+void QAzureStorageDownloadJob::downloadCompressedContent(QNetworkReply* reply)
+{
+  // gzip content not created by this library cannot be decompressed with qUncompress: it is downloaded
+  // as is (as without content compression) with the usual parallel ranges, checksums and journal
+  qCDebug(lcAzureStorageTransfer) << "[QAzureStorageDownloadJob]" << m_container + "/" + m_blobName << "is standard gzip content, downloaded without decompression";
+
+  m_runningRanges.remove(reply);
+  reply->abort();
+
+  m_isDecompressing = false;
+  m_decoder = QAzureStorageGzipDecoder();
+  m_pendingRanges.clear();
+  m_bytesToWrite = 0;
+  m_bytesWritten = 0;
+  m_file.close();
+
+  startRangedDownload();
+}
+
+bool QAzureStorageDownloadJob::writeZeros(const qint64& offset, const qint64& length)
+{
+  QByteArray zeros(static_cast<int>(qMin(length, m_rangeSizeInBytes)), '\0');
+  if (!m_file.seek(offset))
+  {
+    return false;
+  }
+
+  for (qint64 remaining = length; remaining > 0; remaining -= zeros.size())
+  {
+    qint64 size = qMin(remaining, static_cast<qint64>(zeros.size()));
+    if (m_file.write(zeros.constData(), size) != size)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void QAzureStorageDownloadJob::startNextRanges()
+{
+  while (!isFinished() && !m_pendingRanges.isEmpty() && m_runningRanges.count() < m_maxParallelRanges)
+  {
+    Range range = m_pendingRanges.takeFirst();
+    if (m_api->transactionalChecksum() == QAzureStorageRestApi::Md5Checksum)
+    {
+      range.md5 = QSharedPointer<QCryptographicHash>(new QCryptographicHash(QCryptographicHash::Md5));
+    }
+
+    QNetworkReply* reply = m_api->downloadFileRange(m_container, m_blobName, range.offset, range.length, m_timeoutInSec);
+    if (reply == nullptr)
+    {
+      finish(QNetworkReply::NetworkError::UnknownNetworkError);
+      return;
+    }
+
+    // Qt stops reading the connection when its buffer is full: the download is really paced by the bandwidth limit
+    if (m_bandwidthLimiter.isLimited())
+    {
+      reply->setReadBufferSize(throttledReadBufferSize);
+    }
+
+    m_runningRanges.insert(reply, range);
+    QObject::connect(reply, &QNetworkReply::readyRead, this, [this, reply]() { onRangeReadyRead(reply); });
+    QObject::connect(reply, &QNetworkReply::finished, this, [this, reply]() { onRangeFinished(reply); });
+  }
+
+  if (!isFinished() && m_pendingRanges.isEmpty() && m_runningRanges.isEmpty())
+  {
+    m_file.close();
+    m_journal.remove();
+    finish(QNetworkReply::NetworkError::NoError);
+  }
+}
+
+void QAzureStorageDownloadJob::onRangeReadyRead(QNetworkReply* reply)
+{
+  if (isFinished() || !m_runningRanges.contains(reply))
+  {
+    return;
+  }
+
+  // Error answers contain an XML description of the error, not the file content
+  int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+  if (httpStatus != 200 && httpStatus != 206)
+  {
+    return;
+  }
+
+  Range& range = m_runningRanges[reply];
+  QByteArray data;
+  if (m_bandwidthLimiter.isLimited())
+  {
+    // The rest is read once the bandwidth limit allows it
+    data = reply->read(m_bandwidthLimiter.acquire(reply->bytesAvailable()));
+    if (reply->bytesAvailable() > 0)
+    {
+      scheduleDrain();
+    }
+  }
+  else
+  {
+    data = reply->readAll();
+  }
+  if (data.size() > range.length - range.written)
+  {
+    data.truncate(range.length - range.written);
+  }
+
+  if (data.isEmpty())
+  {
+    return;
+  }
+
+  bool isWritten = false;
+  if (m_isDecompressing)
+  {
+    QByteArray decompressedData;
+    if (!m_decoder.decode(data, decompressedData))
+    {
+      if (m_decoder.isStandardGzip())
+      {
+        downloadCompressedContent(reply);
+        return;
+      }
+      qCWarning(lcAzureStorageTransfer) << "[QAzureStorageDownloadJob] Failed to decompress" << m_container + "/" + m_blobName << "(not compressed by this library?)";
+      finish(QNetworkReply::NetworkError::UnknownContentError);
+      return;
+    }
+    isWritten = m_file.write(decompressedData) == decompressedData.size();
+  }
+  else
+  {
+    isWritten = m_file.seek(range.offset + range.written) && m_file.write(data) == data.size();
+  }
+
+  if (!isWritten)
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageDownloadJob] Failed to write in local file" << m_file.fileName() << ":" << m_file.errorString();
+    finish(QNetworkReply::NetworkError::UnknownContentError);
+    return;
+  }
+
+  // Checksum computed on the fly (no additional pass on the file)
+  if (m_api->transactionalChecksum() == QAzureStorageRestApi::Crc64Checksum)
+  {
+    range.crc64 = QAzureStorageChecksum::crc64(data, range.crc64);
+  }
+  else if (!range.md5.isNull())
+  {
+    range.md5->addData(data);
+  }
+
+  range.written += data.size();
+  m_bytesWritten += data.size();
+  emit progress(m_bytesWritten, m_bytesToWrite);
+}
+
+void QAzureStorageDownloadJob::onRangeFinished(QNetworkReply* reply)
+{
+  if (isFinished() || !m_runningRanges.contains(reply))
+  {
+    reply->deleteLater();
+    return;
+  }
+
+  QNetworkReply::NetworkError errorCode = reply->error();
+  if (QAzureStorageRestApi::isErrorCodeSuccess(errorCode))
+  {
+    // Write the remaining data received with the end of the reply (the reply may be dropped if the content is kept compressed)
+    onRangeReadyRead(reply);
+    if (isFinished() || !m_runningRanges.contains(reply))
+    {
+      reply->deleteLater();
+      return;
+    }
+
+    // Bandwidth limited: the end of the range is written later (this method is called again by the drain)
+    if (reply->bytesAvailable() > 0)
+    {
+      return;
+    }
+  }
+
+  reply->deleteLater();
+  Range range = m_runningRanges.take(reply);
+  if (!QAzureStorageRestApi::isErrorCodeSuccess(errorCode))
+  {
+    finish(errorCode);
+    return;
+  }
+
+  if (range.written != range.length || (m_isDecompressing && !m_decoder.isComplete()))
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageDownloadJob] Incomplete range received at offset" << range.offset << "(" << range.written << "/" << range.length << "bytes)";
+    finish(QNetworkReply::NetworkError::UnknownContentError);
+    return;
+  }
+
+  if (!isRangeChecksumValid(reply, range))
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageDownloadJob] Corrupted range received at offset" << range.offset << "(checksum mismatch)";
+    finish(QNetworkReply::NetworkError::UnknownContentError);
+    return;
+  }
+
+  // The range is only journaled once its content is handed to the system
+  if (m_journal.isEnabled() && (!m_file.flush() || !m_journal.addCompletedRange(range.offset, range.length)))
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageDownloadJob] Failed to journal range at offset" << range.offset;
+  }
+
+  startNextRanges();
+}
+
+void QAzureStorageDownloadJob::scheduleDrain()
+{
+  if (m_isDrainScheduled)
+  {
+    return;
+  }
+  m_isDrainScheduled = true;
+
+  qint64 bytesAvailable = 0;
+  for (QMap<QNetworkReply*, Range>::const_iterator it = m_runningRanges.constBegin(); it != m_runningRanges.constEnd(); ++it)
+  {
+    bytesAvailable += it.key()->bytesAvailable();
+  }
+
+  QTimer::singleShot(m_bandwidthLimiter.waitTimeInMs(bytesAvailable), this, [this]()
+  {
+    m_isDrainScheduled = false;
+    drainRanges();
+  });
+}
+
+void QAzureStorageDownloadJob::drainRanges()
+{
+  const QList<QNetworkReply*> replies = m_runningRanges.keys();
+  for (QNetworkReply* reply : replies)
+  {
+    if (isFinished())
+    {
+      return;
+    }
+    if (!m_runningRanges.contains(reply) || reply->bytesAvailable() == 0)
+    {
+      continue;
+    }
+
+    if (reply->isFinished())
+    {
+      onRangeFinished(reply);
+    }
+    else
+    {
+      onRangeReadyRead(reply);
+    }
+  }
+}
+
+bool QAzureStorageDownloadJob::isRangeChecksumValid(QNetworkReply* reply, const Range& range) const
+{
+  // Azure does not return any checksum for ranges bigger than 4 MiB
+  QByteArray expectedCrc64 = reply->rawHeader("x-ms-content-crc64");
+  if (m_api->transactionalChecksum() == QAzureStorageRestApi::Crc64Checksum && !expectedCrc64.isEmpty())
+  {
+    return QAzureStorageChecksum::crc64ToBase64(range.crc64) == QString::fromLatin1(expectedCrc64);
+  }
+
+  QByteArray expectedMd5 = reply->rawHeader("Content-MD5");
+  if (!range.md5.isNull() && !expectedMd5.isEmpty())
+  {
+    return range.md5->result().toBase64() == expectedMd5;
+  }
+
+  return true;
+}
+
+void QAzureStorageDownloadJob::cleanup()
+{
+  m_pendingRanges.clear();
+
+  // Stop the remaining requests (their finished signal is ignored since the job is finished)
+  if (m_propertiesReply != nullptr)
+  {
+    QNetworkReply* reply = m_propertiesReply;
+    m_propertiesReply = nullptr;
+    reply->abort();
+  }
+
+  if (m_pageRangesReply != nullptr)
+  {
+    QNetworkReply* reply = m_pageRangesReply;
+    m_pageRangesReply = nullptr;
+    reply->abort();
+  }
+
+  QList<QNetworkReply*> runningReplies = m_runningRanges.keys();
+  m_runningRanges.clear();
+  for (QNetworkReply* reply : runningReplies)
+  {
+    // Finished replies still read at the bandwidth limit will not emit finished again
+    if (reply->isFinished())
+    {
+      reply->deleteLater();
+    }
+    else
+    {
+      reply->abort();
+    }
+  }
+
+  if (m_file.isOpen())
+  {
+    m_file.close();
+  }
+}
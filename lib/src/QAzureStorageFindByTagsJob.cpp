@@ -0,0 +1,109 @@
+/*
+ * \brief Find the files of an Azure storage account (or container) matching an index tags expression following all result pages
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#include "QAzureStorageFindByTagsJob.h"
+#include "QAzureStorageRestApi.h"
+
+// ------------------------------------- CONSTRUCTOR & INIT -------------------------------------
+
+QAzureStorageFindByTagsJob::QAzureStorageFindByTagsJob(QAzureStorageRestApi* api, const QString& whereExpression, const QString& container,
+                                                       const int& maxResultsPerPage, const int& timeoutInSec, QObject* parent) :
+  QAzureStorageJob(parent),
+  m_api(api),
+  m_whereExpression(whereExpression),
+  m_container(container),
+  m_maxResultsPerPage(maxResultsPerPage),
+  m_timeoutInSec(timeoutInSec)
+{
+}
+
+qint64 QAzureStorageFindByTagsJob::fileCount() const
+{
+  return m_fileCount;
+}
+
+// ------------------------------------- PUBLIC SLOTS -------------------------------------
+
+void QAzureStorageFindByTagsJob::start()
+{
+  if (m_isStarted || isFinished())
+  {
+    return;
+  }
+  m_isStarted = true;
+
+  requestPage(QString());
+}
+
+// ------------------------------------- PRIVATE -------------------------------------
+
+void QAzureStorageFindByTagsJob::requestPage(const QString& marker)
+{
+  m_pageReply = m_api->findFilesByTags(m_whereExpression, m_container, marker, m_maxResultsPerPage, m_timeoutInSec);
+  if (m_pageReply == nullptr)
+  {
+    finish(QNetworkReply::NetworkError::UnknownNetworkError);
+    return;
+  }
+
+  QNetworkReply* reply = m_pageReply;
+  QObject::connect(reply, &QNetworkReply::finished, this, [this, reply]() { onPageFinished(reply); });
+}
+
+void QAzureStorageFindByTagsJob::onPageFinished(QNetworkReply* reply)
+{
+  reply->deleteLater();
+  if (isFinished() || reply != m_pageReply)
+  {
+    return;
+  }
+  m_pageReply = nullptr;
+
+  if (!QAzureStorageRestApi::isErrorCodeSuccess(reply->error()))
+  {
+    finish(reply->error());
+    return;
+  }
+
+  QString nextMarker;
+  QList< QMap<QString,QString> > files = QAzureStorageRestApi::parseFileList(reply->readAll(), &nextMarker);
+
+  m_fileCount += files.count();
+  if (!files.isEmpty())
+  {
+    emit filesFound(files);
+  }
+  emit progress(m_fileCount, -1);
+
+  // The job may have been aborted by a slot connected to filesFound
+  if (isFinished())
+  {
+    return;
+  }
+
+  if (nextMarker.isEmpty())
+  {
+    finish(QNetworkReply::NetworkError::NoError);
+    return;
+  }
+
+  requestPage(nextMarker);
+}
+
+void QAzureStorageFindByTagsJob::cleanup()
+{
+  // Stop the remaining request (its finished signal is ignored since the job is finished)
+  if (m_pageReply != nullptr)
+  {
+    QNetworkReply* reply = m_pageReply;
+    m_pageReply = nullptr;
+    reply->abort();
+  }
+}
@@ -0,0 +1,464 @@
+/*
+ * \brief Local memory-mapped index of the files of an Azure storage container (instant queries without listing the container)
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#include "QAzureStorageInventory.h"
+#include "QAzureStorageRestApi.h"
+#include "QAzureStorageLogging.h"
+
+#include <QSaveFile>
+#include <QSet>
+#include <QtEndian>
+#include <QDebug>
+
+#include <cstring>
+
+namespace
+{
+  // Header: magic then 12 little-endian 64 bits values (count, then offset/size of each section)
+  const QByteArray INVENTORY_MAGIC = "QAZSINV1";
+  enum HeaderField
+  {
+    Count, ContainerOffset, ContainerSize, NameOffsetsOffset, NamesOffset, NamesSize,
+    SizesOffset, CumulativeSizesOffset, ModifiedOffset, EtagOffsetsOffset, EtagsOffset, EtagsSize,
+    HeaderFieldCount
+  };
+  const qint64 HEADER_SIZE = 8 + HeaderFieldCount * 8;
+
+  void appendValue(QByteArray& section, const qint64& value)
+  {
+    uchar bytes[8];
+    qToLittleEndian<qint64>(value, bytes);
+    section.append(reinterpret_cast<const char*>(bytes), 8);
+  }
+
+  //! Sections are aligned on 8 bytes
+  quint64 appendSection(QByteArray& content, const QByteArray& section)
+  {
+    const quint64 offset = content.size();
+    content.append(section);
+    content.append(QByteArray((8 - content.size() % 8) % 8, '\0'));
+    return offset;
+  }
+
+  bool isSectionValid(const quint64& offset, const quint64& size, const quint64& fileSize)
+  {
+    return offset <= fileSize && size <= fileSize - offset;
+  }
+}
+
+QAzureStorageInventory::QAzureStorageInventory(const QString& inventoryPath) :
+  m_file(inventoryPath)
+{
+}
+
+QAzureStorageInventory::~QAzureStorageInventory()
+{
+  close();
+}
+
+bool QAzureStorageInventory::isEnabled() const
+{
+  return !m_file.fileName().isEmpty();
+}
+
+QString QAzureStorageInventory::inventoryPath() const
+{
+  return m_file.fileName();
+}
+
+bool QAzureStorageInventory::open(const QString& container)
+{
+  close();
+  m_container = container;
+  if (!isEnabled() || !m_file.open(QIODevice::ReadOnly))
+  {
+    return false;
+  }
+
+  // Nothing is read at startup: the pages of the file are loaded by the system when queried
+  m_dataSize = m_file.size();
+  m_data = (m_dataSize >= HEADER_SIZE) ? m_file.map(0, m_dataSize) : nullptr;
+  if (m_data == nullptr || std::memcmp(m_data, INVENTORY_MAGIC.constData(), INVENTORY_MAGIC.size()) != 0)
+  {
+    qCDebug(lcAzureStorageParse) << "[QAzureStorageInventory] Invalid inventory" << m_file.fileName();
+    close();
+    return false;
+  }
+
+  quint64 header[HeaderFieldCount];
+  for (int i = 0; i < HeaderFieldCount; ++i)
+  {
+    header[i] = qFromLittleEndian<quint64>(m_data + 8 + i * 8);
+  }
+
+  const quint64 fileSize = m_dataSize;
+  const quint64 count = header[Count];
+  const bool isValid = (count < fileSize / 8) &&
+                       isSectionValid(header[ContainerOffset], header[ContainerSize], fileSize) &&
+                       isSectionValid(header[NameOffsetsOffset], (count + 1) * 8, fileSize) &&
+                       isSectionValid(header[NamesOffset], header[NamesSize], fileSize) &&
+                       isSectionValid(header[SizesOffset], count * 8, fileSize) &&
+                       isSectionValid(header[CumulativeSizesOffset], (count + 1) * 8, fileSize) &&
+                       isSectionValid(header[ModifiedOffset], count * 8, fileSize) &&
+                       isSectionValid(header[EtagOffsetsOffset], (count + 1) * 8, fileSize) &&
+                       isSectionValid(header[EtagsOffset], header[EtagsSize], fileSize);
+  if (!isValid)
+  {
+    qCDebug(lcAzureStorageParse) << "[QAzureStorageInventory] Invalid inventory" << m_file.fileName();
+    close();
+    return false;
+  }
+
+  // An inventory of another container is replaced at the next refresh
+  if (QString::fromUtf8(reinterpret_cast<const char*>(m_data + header[ContainerOffset]), static_cast<int>(header[ContainerSize])) != container)
+  {
+    close();
+    return false;
+  }
+
+  m_count = count;
+  m_nameOffsetsOffset = header[NameOffsetsOffset];
+  m_namesOffset = header[NamesOffset];
+  m_namesSize = header[NamesSize];
+  m_sizesOffset = header[SizesOffset];
+  m_cumulativeSizesOffset = header[CumulativeSizesOffset];
+  m_modifiedOffset = header[ModifiedOffset];
+  m_etagOffsetsOffset = header[EtagOffsetsOffset];
+  m_etagsOffset = header[EtagsOffset];
+  m_etagsSize = header[EtagsSize];
+  return true;
+}
+
+void QAzureStorageInventory::close()
+{
+  if (m_data != nullptr)
+  {
+    m_file.unmap(const_cast<uchar*>(m_data));
+    m_data = nullptr;
+  }
+  m_file.close();
+  m_dataSize = 0;
+  m_count = 0;
+}
+
+bool QAzureStorageInventory::isOpen() const
+{
+  return m_data != nullptr;
+}
+
+QString QAzureStorageInventory::container() const
+{
+  return m_container;
+}
+
+qint64 QAzureStorageInventory::count() const
+{
+  return m_count;
+}
+
+QAzureStorageInventory::Entry QAzureStorageInventory::entryAt(const qint64& index) const
+{
+  Entry entry;
+  if (index < 0 || index >= m_count)
+  {
+    return entry;
+  }
+
+  entry.name = QString::fromUtf8(readString(m_nameOffsetsOffset, m_namesOffset, m_namesSize, index));
+  entry.size = readValue(m_sizesOffset, index);
+  entry.modifiedInMs = readValue(m_modifiedOffset, index);
+  entry.etag = QString::fromUtf8(readString(m_etagOffsetsOffset, m_etagsOffset, m_etagsSize, index));
+  return entry;
+}
+
+bool QAzureStorageInventory::find(const QString& name, Entry* entry) const
+{
+  const QByteArray key = name.toUtf8();
+  const qint64 index = lowerBound(key, false);
+  if (index >= m_count || compareName(index, key, false) != 0)
+  {
+    return false;
+  }
+
+  if (entry != nullptr)
+  {
+    *entry = entryAt(index);
+  }
+  return true;
+}
+
+QList<QAzureStorageInventory::Entry> QAzureStorageInventory::filesWithPrefix(const QString& prefix, const int& maxResults) const
+{
+  const QByteArray key = prefix.toUtf8();
+  const qint64 from = lowerBound(key, true);
+  qint64 to = upperBound(key, true);
+  if (maxResults >= 0)
+  {
+    to = qMin(to, from + maxResults);
+  }
+  return entries(from, to);
+}
+
+qint64 QAzureStorageInventory::fileCount(const QString& prefix) const
+{
+  const QByteArray key = prefix.toUtf8();
+  return upperBound(key, true) - lowerBound(key, true);
+}
+
+qint64 QAzureStorageInventory::totalSize(const QString& prefix) const
+{
+  if (!isOpen())
+  {
+    return 0;
+  }
+
+  const QByteArray key = prefix.toUtf8();
+  return readValue(m_cumulativeSizesOffset, upperBound(key, true)) - readValue(m_cumulativeSizesOffset, lowerBound(key, true));
+}
+
+bool QAzureStorageInventory::replacePrefix(const QString& prefix, const QList< QMap<QString,QString> >& files)
+{
+  if (!isEnabled())
+  {
+    return false;
+  }
+
+  // Sorted by UTF-8 bytes (order of the inventory), the last listed file wins if listed twice
+  QMap<QByteArray, Entry> listedFiles;
+  for (const QMap<QString,QString>& file : files)
+  {
+    const Entry entry = toEntry(file);
+    if (entry.name.startsWith(prefix))
+    {
+      listedFiles.insert(entry.name.toUtf8(), entry);
+    }
+  }
+
+  // The files under the prefix are contiguous in the inventory
+  const QByteArray key = prefix.toUtf8();
+  QList<Entry> newEntries = entries(0, lowerBound(key, true));
+  newEntries.append(listedFiles.values());
+  newEntries.append(entries(upperBound(key, true), m_count));
+  return write(newEntries);
+}
+
+bool QAzureStorageInventory::applyChanges(const QList< QMap<QString,QString> >& updatedFiles, const QStringList& deletedNames)
+{
+  if (!isEnabled())
+  {
+    return false;
+  }
+
+  QMap<QByteArray, Entry> changes;
+  for (const QMap<QString,QString>& file : updatedFiles)
+  {
+    const Entry entry = toEntry(file);
+    changes.insert(entry.name.toUtf8(), entry);
+  }
+
+  QSet<QByteArray> deleted;
+  for (const QString& name : deletedNames)
+  {
+    deleted.insert(name.toUtf8());
+  }
+
+  // Merge of the changes (sorted) with the inventory (sorted), a file both updated and deleted is deleted
+  QList<Entry> newEntries;
+  QMap<QByteArray, Entry>::const_iterator change = changes.constBegin();
+  for (qint64 i = 0; i < m_count; ++i)
+  {
+    const QByteArray name = readString(m_nameOffsetsOffset, m_namesOffset, m_namesSize, i);
+    for (; change != changes.constEnd() && change.key() < name; ++change)
+    {
+      if (!deleted.contains(change.key()))
+      {
+        newEntries.append(change.value());
+      }
+    }
+
+    // Updated file: the change is added instead
+    if ((change != changes.constEnd() && change.key() == name) || deleted.contains(name))
+    {
+      continue;
+    }
+    newEntries.append(entryAt(i));
+  }
+  for (; change != changes.constEnd(); ++change)
+  {
+    if (!deleted.contains(change.key()))
+    {
+      newEntries.append(change.value());
+    }
+  }
+
+  return write(newEntries);
+}
+
+QAzureStorageInventory::Entry QAzureStorageInventory::toEntry(const QMap<QString,QString>& file)
+{
+  Entry entry;
+  entry.name = file.value("Name");
+  entry.size = file.value("Content-Length").toLongLong();
+  const QDateTime lastModified = QAzureStorageRestApi::parseDateTime(file.value("Last-Modified"));
+  entry.modifiedInMs = lastModified.isValid() ? lastModified.toMSecsSinceEpoch() : -1;
+  entry.etag = file.value("Etag");
+  return entry;
+}
+
+// ------------------------------------- PRIVATE -------------------------------------
+
+qint64 QAzureStorageInventory::readValue(const quint64& sectionOffset, const qint64& index) const
+{
+  return qFromLittleEndian<qint64>(m_data + sectionOffset + index * 8);
+}
+
+QByteArray QAzureStorageInventory::readString(const quint64& offsetsOffset, const quint64& stringsOffset, const quint64& stringsSize, const qint64& index) const
+{
+  const qint64 start = readValue(offsetsOffset, index);
+  const qint64 end = readValue(offsetsOffset, index + 1);
+  if (start < 0 || end < start || static_cast<quint64>(end) > stringsSize)
+  {
+    return QByteArray();
+  }
+
+  return QByteArray(reinterpret_cast<const char*>(m_data + stringsOffset + start), static_cast<int>(end - start));
+}
+
+int QAzureStorageInventory::compareName(const qint64& index, const QByteArray& key, const bool& isPrefix) const
+{
+  const qint64 start = readValue(m_nameOffsetsOffset, index);
+  const qint64 end = readValue(m_nameOffsetsOffset, index + 1);
+  const bool isValidName = (start >= 0 && end >= start && static_cast<quint64>(end) <= m_namesSize);
+  const qint64 nameSize = isValidName ? end - start : 0;
+
+  // Compared in the mapped file (no allocation during the binary searches)
+  const uchar* name = m_data + m_namesOffset + (isValidName ? start : 0);
+  const int result = std::memcmp(name, key.constData(), static_cast<size_t>(qMin<qint64>(nameSize, key.size())));
+  if (result != 0)
+  {
+    return result;
+  }
+  if (nameSize == key.size() || (isPrefix && nameSize > key.size()))
+  {
+    return 0;
+  }
+  return (nameSize < key.size()) ? -1 : 1;
+}
+
+qint64 QAzureStorageInventory::lowerBound(const QByteArray& key, const bool& isPrefix) const
+{
+  // First file not before key
+  qint64 first = 0;
+  qint64 last = m_count;
+  while (first < last)
+  {
+    const qint64 middle = first + (last - first) / 2;
+    if (compareName(middle, key, isPrefix) < 0)
+    {
+      first = middle + 1;
+    }
+    else
+    {
+      last = middle;
+    }
+  }
+  return first;
+}
+
+qint64 QAzureStorageInventory::upperBound(const QByteArray& key, const bool& isPrefix) const
+{
+  // First file after key
+  qint64 first = 0;
+  qint64 last = m_count;
+  while (first < last)
+  {
+    const qint64 middle = first + (last - first) / 2;
+    if (compareName(middle, key, isPrefix) <= 0)
+    {
+      first = middle + 1;
+    }
+    else
+    {
+      last = middle;
+    }
+  }
+  return first;
+}
+
+QList<QAzureStorageInventory::Entry> QAzureStorageInventory::entries(const qint64& from, const qint64& to) const
+{
+  QList<Entry> result;
+  for (qint64 i = qMax<qint64>(0, from); i < qMin(to, m_count); ++i)
+  {
+    result.append(entryAt(i));
+  }
+  return result;
+}
+
+bool QAzureStorageInventory::write(const QList<Entry>& sortedEntries)
+{
+  QByteArray names;
+  QByteArray etags;
+  QByteArray nameOffsets;
+  QByteArray sizes;
+  QByteArray cumulativeSizes;
+  QByteArray modified;
+  QByteArray etagOffsets;
+
+  qint64 cumulativeSize = 0;
+  appendValue(nameOffsets, 0);
+  appendValue(cumulativeSizes, 0);
+  appendValue(etagOffsets, 0);
+  for (const Entry& entry : sortedEntries)
+  {
+    names.append(entry.name.toUtf8());
+    etags.append(entry.etag.toUtf8());
+    cumulativeSize += qMax<qint64>(0, entry.size);
+
+    appendValue(nameOffsets, names.size());
+    appendValue(sizes, entry.size);
+    appendValue(cumulativeSizes, cumulativeSize);
+    appendValue(modified, entry.modifiedInMs);
+    appendValue(etagOffsets, etags.size());
+  }
+
+  const QByteArray container = m_container.toUtf8();
+  QByteArray content = INVENTORY_MAGIC + QByteArray(HEADER_SIZE - INVENTORY_MAGIC.size(), '\0');
+  quint64 header[HeaderFieldCount];
+  header[Count] = sortedEntries.size();
+  header[ContainerSize] = container.size();
+  header[NamesSize] = names.size();
+  header[EtagsSize] = etags.size();
+  header[ContainerOffset] = appendSection(content, container);
+  header[NameOffsetsOffset] = appendSection(content, nameOffsets);
+  header[SizesOffset] = appendSection(content, sizes);
+  header[CumulativeSizesOffset] = appendSection(content, cumulativeSizes);
+  header[ModifiedOffset] = appendSection(content, modified);
+  header[EtagOffsetsOffset] = appendSection(content, etagOffsets);
+  header[NamesOffset] = appendSection(content, names);
+  header[EtagsOffset] = appendSection(content, etags);
+  for (int i = 0; i < HeaderFieldCount; ++i)
+  {
+    qToLittleEndian<quint64>(header[i], reinterpret_cast<uchar*>(content.data() + 8 + i * 8));
+  }
+
+  // Unmapped first: a mapped file can not be replaced on every system
+  close();
+
+  QSaveFile file(m_file.fileName());
+  if (!file.open(QIODevice::WriteOnly) || file.write(content) != content.size() || !file.commit())
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageInventory] Failed to write inventory" << m_file.fileName() << ":" << file.errorString();
+    open(m_container);
+    return false;
+  }
+
+  return open(m_container);
+}
@@ -0,0 +1,46 @@
+/*
+ * \brief Base class of the transfers (jobs made of several requests) to/from Azure storage
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#include "QAzureStorageJob.h"
+
+QAzureStorageJob::QAzureStorageJob(QObject* parent) :
+  QObject(parent)
+{
+}
+
+bool QAzureStorageJob::isFinished() const
+{
+  return m_isFinished;
+}
+
+QNetworkReply::NetworkError QAzureStorageJob::error() const
+{
+  return m_error;
+}
+
+void QAzureStorageJob::abort()
+{
+  finish(QNetworkReply::NetworkError::OperationCanceledError);
+}
+
+void QAzureStorageJob::finish(const QNetworkReply::NetworkError& errorCode)
+{
+  if (m_isFinished)
+  {
+    return;
+  }
+  m_isFinished = true;
+  m_error = errorCode;
+
+  // Finished signals of the aborted requests are ignored by the jobs since isFinished() is already true
+  cleanup();
+
+  emit finished(m_error);
+}
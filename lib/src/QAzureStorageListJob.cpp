@@ -0,0 +1,144 @@
+/*
+ * \brief List the files of an Azure storage container by walking its virtual "folders" with parallel listings
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#include "QAzureStorageListJob.h"
+#include "QAzureStorageRestApi.h"
+
+// ------------------------------------- CONSTRUCTOR & INIT -------------------------------------
+
+QAzureStorageListJob::QAzureStorageListJob(QAzureStorageRestApi* api, const QString& container, const QString& prefix, const QString& delimiter,
+                                           const int& maxDepth, const int& maxParallelListings, const int& timeoutInSec, QObject* parent) :
+  QAzureStorageJob(parent),
+  m_api(api),
+  m_container(container),
+  m_prefix(prefix),
+  m_delimiter(delimiter),
+  m_maxDepth(maxDepth),
+  m_maxParallelListings(maxParallelListings),
+  m_timeoutInSec(timeoutInSec)
+{
+}
+
+qint64 QAzureStorageListJob::fileCount() const
+{
+  return m_fileCount;
+}
+
+qint64 QAzureStorageListJob::folderCount() const
+{
+  return m_folderCount;
+}
+
+// ------------------------------------- PUBLIC SLOTS -------------------------------------
+
+void QAzureStorageListJob::start()
+{
+  if (m_isStarted || isFinished())
+  {
+    return;
+  }
+  m_isStarted = true;
+
+  Listing listing;
+  listing.prefix = m_prefix;
+  listing.depth = 0;
+  m_pendingListings.append(listing);
+
+  startNextListings();
+}
+
+// ------------------------------------- PRIVATE -------------------------------------
+
+void QAzureStorageListJob::startNextListings()
+{
+  while (!isFinished() && !m_pendingListings.isEmpty() && m_runningListings.count() < m_maxParallelListings)
+  {
+    Listing listing = m_pendingListings.takeFirst();
+
+    QNetworkReply* reply = m_api->listFiles(m_container, listing.marker, listing.prefix, -1, m_timeoutInSec, m_delimiter);
+    if (reply == nullptr)
+    {
+      finish(QNetworkReply::NetworkError::UnknownNetworkError);
+      return;
+    }
+
+    m_runningListings.insert(reply, listing);
+    QObject::connect(reply, &QNetworkReply::finished, this, [this, reply]() { onListingFinished(reply); });
+  }
+
+  if (!isFinished() && m_pendingListings.isEmpty() && m_runningListings.isEmpty())
+  {
+    finish(QNetworkReply::NetworkError::NoError);
+  }
+}
+
+void QAzureStorageListJob::onListingFinished(QNetworkReply* reply)
+{
+  reply->deleteLater();
+  if (isFinished() || !m_runningListings.contains(reply))
+  {
+    return;
+  }
+
+  Listing listing = m_runningListings.take(reply);
+  if (!QAzureStorageRestApi::isErrorCodeSuccess(reply->error()))
+  {
+    finish(reply->error());
+    return;
+  }
+
+  QString nextMarker;
+  QStringList folders;
+  QList< QMap<QString,QString> > files = QAzureStorageRestApi::parseFileList(reply->readAll(), &nextMarker, &folders);
+
+  // The next page of the same "folder" is requested first so that its files keep coming in order
+  if (!nextMarker.isEmpty())
+  {
+    Listing nextListing = listing;
+    nextListing.marker = nextMarker;
+    m_pendingListings.prepend(nextListing);
+  }
+
+  for (const QString& folder : folders)
+  {
+    m_folderCount++;
+    emit folderFound(folder, listing.depth + 1);
+
+    if (m_maxDepth < 0 || listing.depth < m_maxDepth)
+    {
+      Listing folderListing;
+      folderListing.prefix = folder;
+      folderListing.depth = listing.depth + 1;
+      m_pendingListings.append(folderListing);
+    }
+  }
+
+  m_fileCount += files.count();
+  if (!files.isEmpty())
+  {
+    emit filesListed(listing.prefix, files);
+  }
+  emit progress(m_fileCount, -1);
+
+  startNextListings();
+}
+
+void QAzureStorageListJob::cleanup()
+{
+  m_pendingListings.clear();
+
+  // Stop the remaining requests (their finished signal is ignored since the job is finished)
+  QList<QNetworkReply*> runningReplies = m_runningListings.keys();
+  m_runningListings.clear();
+  for (QNetworkReply* reply : runningReplies)
+  {
+    reply->abort();
+  }
+}
@@ -0,0 +1,28 @@
+/*
+ * \brief Logging categories of the Azure storage library (enable/disable them with QLoggingCategory::setFilterRules)
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#include "QAzureStorageLogging.h"
+
+#include <QRegularExpression>
+
+Q_LOGGING_CATEGORY(lcAzureStorageUrl, "qazurestorage.url", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcAzureStorageAuth, "qazurestorage.auth", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcAzureStorageTransfer, "qazurestorage.transfer", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcAzureStorageParse, "qazurestorage.parse", QtInfoMsg)
+
+QString QAzureStorageLogging::redactSasSignature(const QString& urlOrSasCredentials)
+{
+  // Only called while logging: the expression is not built if the logs are disabled
+  static const QRegularExpression signatureExpression("(^|[?&])sig=[^&]*");
+
+  QString redacted = urlOrSasCredentials;
+  redacted.replace(signatureExpression, "\\1sig=REDACTED");
+  return redacted;
+}
@@ -0,0 +1,311 @@
+/*
+ * \brief Aggregated metrics (latency histograms, bytes, in-flight requests, retries, throttling) of the requests sent to Azure storage
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#include "QAzureStorageMetrics.h"
+
+#include <QtAlgorithms>
+#include <QtMath>
+
+namespace
+{
+  //! Operations sent by QAzureStorageRestApi ("Other" must stay the last one)
+  const char* const operationNames[] =
+  {
+    "ListContainers", "CreateContainer", "DeleteContainer", "ListBlobs", "FindBlobsByTags",
+    "GetBlob", "GetBlobProperties", "GetBlobTags", "SetBlobTags", "PutBlob", "PutBlock", "PutBlockList",
+    "GetBlockList", "AppendBlock", "PutPage", "GetPageRanges", "DeleteBlob", "Other"
+  };
+
+  const char* const statusClassNames[] = { "2xx", "3xx", "4xx", "5xx", "none" };
+
+  //! Histograms: 1 bucket below 1 ms, 4 buckets per power of two from 2^10 to 2^27 us, 1 bucket above
+  const int firstExponent = 10;
+  const int lastExponent = 26;
+  const int subBucketBits = 2;
+}
+
+// ------------------------------------- CONSTRUCTOR & INIT -------------------------------------
+
+QAzureStorageMetrics::QAzureStorageMetrics()
+{
+  Q_STATIC_ASSERT(sizeof(operationNames) / sizeof(operationNames[0]) == operationCount);
+  Q_STATIC_ASSERT(sizeof(statusClassNames) / sizeof(statusClassNames[0]) == statusClassCount);
+  Q_STATIC_ASSERT(bucketCount == 2 + (lastExponent - firstExponent + 1) * (1 << subBucketBits));
+}
+
+// ------------------------------------- PUBLIC -------------------------------------
+
+void QAzureStorageMetrics::recordRequestStarted()
+{
+  m_inFlightRequests.fetchAndAddRelaxed(1);
+}
+
+void QAzureStorageMetrics::recordRequestFinished(const QString& operation, const int& httpStatus, const qint64& durationInUs,
+                                                 const qint64& bytesSent, const qint64& bytesReceived)
+{
+  const int operationId = operationIndex(operation);
+  const int statusClass = statusClassIndex(httpStatus);
+
+  m_latencyBuckets[operationId][statusClass][bucketIndex(durationInUs)].fetchAndAddRelaxed(1);
+  m_latencySumInUs[operationId][statusClass].fetchAndAddRelaxed(durationInUs);
+  m_sentBytes.fetchAndAddRelaxed(bytesSent);
+  m_receivedBytes.fetchAndAddRelaxed(bytesReceived);
+  if (httpStatus == 503 || httpStatus == 429)
+  {
+    m_throttledRequests.fetchAndAddRelaxed(1);
+  }
+  m_inFlightRequests.fetchAndSubRelaxed(1);
+}
+
+void QAzureStorageMetrics::recordRetry()
+{
+  m_retries.fetchAndAddRelaxed(1);
+}
+
+void QAzureStorageMetrics::reset()
+{
+  for (int operationId = 0; operationId < operationCount; ++operationId)
+  {
+    for (int statusClass = 0; statusClass < statusClassCount; ++statusClass)
+    {
+      for (int bucket = 0; bucket < bucketCount; ++bucket)
+      {
+        m_latencyBuckets[operationId][statusClass][bucket] = 0;
+      }
+      m_latencySumInUs[operationId][statusClass] = 0;
+    }
+  }
+  m_sentBytes = 0;
+  m_receivedBytes = 0;
+  m_retries = 0;
+  m_throttledRequests = 0;
+}
+
+qint64 QAzureStorageMetrics::requestCount(const QString& operation) const
+{
+  qint64 count = 0;
+  for (int operationId = 0; operationId < operationCount; ++operationId)
+  {
+    if (!operation.isEmpty() && operationId != operationIndex(operation))
+    {
+      continue;
+    }
+    for (int bucket = 0; bucket < bucketCount; ++bucket)
+    {
+      count += bucketCountOf(operationId, bucket);
+    }
+  }
+  return count;
+}
+
+qint64 QAzureStorageMetrics::sentBytes() const
+{
+  return m_sentBytes;
+}
+
+qint64 QAzureStorageMetrics::receivedBytes() const
+{
+  return m_receivedBytes;
+}
+
+qint64 QAzureStorageMetrics::inFlightRequests() const
+{
+  return m_inFlightRequests;
+}
+
+qint64 QAzureStorageMetrics::retryCount() const
+{
+  return m_retries;
+}
+
+qint64 QAzureStorageMetrics::throttledCount() const
+{
+  return m_throttledRequests;
+}
+
+qint64 QAzureStorageMetrics::latencyPercentileInUs(const double& percentile, const QString& operation) const
+{
+  // Merge the histograms of the requested operation(s)
+  qint64 buckets[bucketCount] = {};
+  qint64 total = 0;
+  for (int operationId = 0; operationId < operationCount; ++operationId)
+  {
+    if (!operation.isEmpty() && operationId != operationIndex(operation))
+    {
+      continue;
+    }
+    for (int bucket = 0; bucket < bucketCount; ++bucket)
+    {
+      qint64 count = bucketCountOf(operationId, bucket);
+      buckets[bucket] += count;
+      total += count;
+    }
+  }
+
+  if (total == 0)
+  {
+    return -1;
+  }
+
+  const qint64 rank = qMax(Q_INT64_C(1), static_cast<qint64>(qCeil(qBound(0.0, percentile, 100.0) * total / 100.0)));
+  qint64 cumulativeCount = 0;
+  for (int bucket = 0; bucket < bucketCount - 1; ++bucket)
+  {
+    cumulativeCount += buckets[bucket];
+    if (cumulativeCount >= rank)
+    {
+      return bucketUpperBoundInUs(bucket);
+    }
+  }
+
+  // Slower than the last bucket bound: the bound is the best known value
+  return bucketUpperBoundInUs(bucketCount - 2);
+}
+
+QByteArray QAzureStorageMetrics::toPrometheusText(const QString& metricPrefix) const
+{
+  const QByteArray prefix = metricPrefix.toUtf8();
+  QByteArray text;
+
+  // --- Latency histograms (one per operation and status class with requests) ---
+  const QByteArray durationName = prefix + "_request_duration_seconds";
+  text.append("# HELP " + durationName + " Duration of the requests sent to Azure storage (from the send until the end of the response).\n");
+  text.append("# TYPE " + durationName + " histogram\n");
+  for (int operationId = 0; operationId < operationCount; ++operationId)
+  {
+    for (int statusClass = 0; statusClass < statusClassCount; ++statusClass)
+    {
+      qint64 buckets[bucketCount];
+      qint64 total = 0;
+      for (int bucket = 0; bucket < bucketCount; ++bucket)
+      {
+        buckets[bucket] = m_latencyBuckets[operationId][statusClass][bucket];
+        total += buckets[bucket];
+      }
+      if (total == 0)
+      {
+        continue;
+      }
+
+      const QByteArray labels = QByteArray("operation=\"") + operationNames[operationId] + "\",status=\"" + statusClassNames[statusClass] + "\"";
+      qint64 cumulativeCount = 0;
+      for (int bucket = 0; bucket < bucketCount - 1; ++bucket)
+      {
+        cumulativeCount += buckets[bucket];
+        text.append(durationName + "_bucket{" + labels + ",le=\"" + QByteArray::number(bucketUpperBoundInUs(bucket) / 1000000.0, 'g', 10) + "\"} "
+                    + QByteArray::number(cumulativeCount) + "\n");
+      }
+      text.append(durationName + "_bucket{" + labels + ",le=\"+Inf\"} " + QByteArray::number(total) + "\n");
+      text.append(durationName + "_sum{" + labels + "} "
+                  + QByteArray::number(m_latencySumInUs[operationId][statusClass] / 1000000.0, 'g', 15) + "\n");
+      text.append(durationName + "_count{" + labels + "} " + QByteArray::number(total) + "\n");
+    }
+  }
+  // ------------------------
+
+  // --- Counters and gauge ---
+  const struct
+  {
+    const char* name;
+    const char* type;
+    const char* help;
+    qint64 value;
+  } values[] =
+  {
+    { "_sent_bytes_total", "counter", "Bytes of content sent to Azure storage.", sentBytes() },
+    { "_received_bytes_total", "counter", "Bytes of content received from Azure storage.", receivedBytes() },
+    { "_in_flight_requests", "gauge", "Requests sent to Azure storage and not finished yet.", inFlightRequests() },
+    { "_retries_total", "counter", "Requests sent again after a failure.", retryCount() },
+    { "_throttled_requests_total", "counter", "Requests throttled by Azure storage (HTTP 503 or 429).", throttledCount() }
+  };
+  for (const auto& value : values)
+  {
+    const QByteArray name = prefix + value.name;
+    text.append("# HELP " + name + " " + value.help + "\n");
+    text.append("# TYPE " + name + " " + value.type + "\n");
+    text.append(name + " " + QByteArray::number(value.value) + "\n");
+  }
+  // ------------------------
+
+  return text;
+}
+
+QStringList QAzureStorageMetrics::operations()
+{
+  QStringList names;
+  for (int operationId = 0; operationId < operationCount; ++operationId)
+  {
+    names.append(operationNames[operationId]);
+  }
+  return names;
+}
+
+// ------------------------------------- PRIVATE -------------------------------------
+
+int QAzureStorageMetrics::operationIndex(const QString& operation)
+{
+  for (int operationId = 0; operationId < operationCount - 1; ++operationId)
+  {
+    if (operation == QLatin1String(operationNames[operationId]))
+    {
+      return operationId;
+    }
+  }
+  return operationCount - 1;
+}
+
+int QAzureStorageMetrics::statusClassIndex(const int& httpStatus)
+{
+  if (httpStatus < 200 || httpStatus > 599)
+  {
+    return statusClassCount - 1;
+  }
+  return httpStatus / 100 - 2;
+}
+
+int QAzureStorageMetrics::bucketIndex(const qint64& durationInUs)
+{
+  if (durationInUs < (Q_INT64_C(1) << firstExponent))
+  {
+    return 0;
+  }
+
+  const int exponent = 63 - qCountLeadingZeroBits(static_cast<quint64>(durationInUs));
+  if (exponent > lastExponent)
+  {
+    return bucketCount - 1;
+  }
+
+  // The bits following the highest one select the sub bucket
+  const int subBucket = static_cast<int>((durationInUs >> (exponent - subBucketBits)) & ((1 << subBucketBits) - 1));
+  return 1 + ((exponent - firstExponent) << subBucketBits) + subBucket;
+}
+
+qint64 QAzureStorageMetrics::bucketUpperBoundInUs(const int& bucket)
+{
+  if (bucket == 0)
+  {
+    return Q_INT64_C(1) << firstExponent;
+  }
+
+  const int exponent = firstExponent + ((bucket - 1) >> subBucketBits);
+  const int subBucket = (bucket - 1) & ((1 << subBucketBits) - 1);
+  return static_cast<qint64>((1 << subBucketBits) + subBucket + 1) << (exponent - subBucketBits);
+}
+
+qint64 QAzureStorageMetrics::bucketCountOf(const int& operation, const int& bucket) const
+{
+  qint64 count = 0;
+  for (int statusClass = 0; statusClass < statusClassCount; ++statusClass)
+  {
+    count += m_latencyBuckets[operation][statusClass][bucket];
+  }
+  return count;
+}
@@ -0,0 +1,280 @@
+/*
+ * \brief Upload a local file (disk image, ...) into Azure storage as a page blob skipping the pages filled with zeros
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#include "QAzureStoragePageBlobUploadJob.h"
+#include "QAzureStorageRestApi.h"
+#include "QAzureStorageLogging.h"
+
+#include <QTimer>
+#include <QDebug>
+
+#include <cstring>
+
+namespace
+{
+  //! Max number of bytes scanned before giving the hand back to the event loop (huge empty disk images)
+  const qint64 maxScannedBytesPerIteration = 64 * 1024 * 1024;
+}
+
+const int QAzureStoragePageBlobUploadJob::pageSizeInBytes;
+const int QAzureStoragePageBlobUploadJob::maxPutPageSizeInBytes;
+
+// ------------------------------------- CONSTRUCTOR & INIT -------------------------------------
+
+QAzureStoragePageBlobUploadJob::QAzureStoragePageBlobUploadJob(QAzureStorageRestApi* api, const QString& filePath, const QString& container, const QString& blobName,
+                                                               const int& maxParallelRanges, const int& timeoutInSec, QObject* parent) :
+  QAzureStorageJob(parent),
+  m_api(api),
+  m_container(container),
+  m_blobName(blobName),
+  m_maxParallelRanges(maxParallelRanges),
+  m_timeoutInSec(timeoutInSec),
+  m_file(filePath),
+  m_bandwidthLimiter(0, api->uploadBandwidthLimiter())
+{
+}
+
+qint64 QAzureStoragePageBlobUploadJob::fileSize() const
+{
+  return m_fileSize;
+}
+
+qint64 QAzureStoragePageBlobUploadJob::bytesDone() const
+{
+  return qMin(m_scanOffset, qMax(m_fileSize, static_cast<qint64>(0))) - m_bytesRunning;
+}
+
+qint64 QAzureStoragePageBlobUploadJob::bytesUploaded() const
+{
+  return m_bytesUploaded;
+}
+
+void QAzureStoragePageBlobUploadJob::setBandwidthLimit(const qint64& bytesPerSecond)
+{
+  m_bandwidthLimiter.setRate(bytesPerSecond);
+}
+
+qint64 QAzureStoragePageBlobUploadJob::bandwidthLimit() const
+{
+  return m_bandwidthLimiter.rate();
+}
+
+bool QAzureStoragePageBlobUploadJob::isZero(const char* data, const qint64& size)
+{
+  if (size <= 0)
+  {
+    return true;
+  }
+
+  // Comparing the data with itself shifted by one byte uses the vectorized memcmp of the C library
+  // (all bytes are equal to the first one, which is zero)
+  return data[0] == 0 && std::memcmp(data, data + 1, static_cast<size_t>(size - 1)) == 0;
+}
+
+// ------------------------------------- PUBLIC SLOTS -------------------------------------
+
+void QAzureStoragePageBlobUploadJob::start()
+{
+  if (m_isStarted || isFinished())
+  {
+    return;
+  }
+  m_isStarted = true;
+
+  if (!m_file.open(QIODevice::ReadOnly))
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStoragePageBlobUploadJob] Failed to open local file" << m_file.fileName() << ":" << m_file.errorString();
+    finish(QNetworkReply::NetworkError::UnknownContentError);
+    return;
+  }
+
+  m_fileSize = m_file.size();
+  m_blobSize = ((m_fileSize + pageSizeInBytes - 1) / pageSizeInBytes) * pageSizeInBytes;
+
+  // The page blob is created filled with zeros: only the other pages have to be uploaded
+  m_createReply = m_api->createPageBlob(m_container, m_blobName, m_blobSize, m_timeoutInSec);
+  if (m_createReply == nullptr)
+  {
+    finish(QNetworkReply::NetworkError::UnknownNetworkError);
+    return;
+  }
+
+  QNetworkReply* reply = m_createReply;
+  QObject::connect(reply, &QNetworkReply::finished, this, [this, reply]() { onCreateFinished(reply); });
+}
+
+// ------------------------------------- PRIVATE -------------------------------------
+
+void QAzureStoragePageBlobUploadJob::onCreateFinished(QNetworkReply* reply)
+{
+  reply->deleteLater();
+  if (isFinished() || reply != m_createReply)
+  {
+    return;
+  }
+  m_createReply = nullptr;
+
+  if (!QAzureStorageRestApi::isErrorCodeSuccess(reply->error()))
+  {
+    finish(reply->error());
+    return;
+  }
+
+  emit progress(bytesDone(), m_fileSize);
+  startNextRanges();
+}
+
+bool QAzureStoragePageBlobUploadJob::loadChunk()
+{
+  m_chunkOffset = m_scanOffset;
+  qint64 chunkSize = qMin(static_cast<qint64>(maxPutPageSizeInBytes), m_fileSize - m_chunkOffset);
+
+  if (!m_file.seek(m_chunkOffset))
+  {
+    m_chunk.clear();
+    return false;
+  }
+
+  m_chunk = m_file.read(chunkSize);
+  if (m_chunk.size() != chunkSize)
+  {
+    m_chunk.clear();
+    return false;
+  }
+
+  // The last page of the file is completed with zeros
+  if (m_chunk.size() % pageSizeInBytes != 0)
+  {
+    m_chunk.append(QByteArray(pageSizeInBytes - m_chunk.size() % pageSizeInBytes, '\0'));
+  }
+
+  return true;
+}
+
+void QAzureStoragePageBlobUploadJob::startNextRanges()
+{
+  qint64 scannedBytes = 0;
+  while (!isFinished() && m_runningRanges.count() < m_maxParallelRanges && m_scanOffset < m_fileSize)
+  {
+    if (scannedBytes >= maxScannedBytesPerIteration)
+    {
+      if (!m_isScanScheduled)
+      {
+        m_isScanScheduled = true;
+        QTimer::singleShot(0, this, [this]()
+        {
+          m_isScanScheduled = false;
+          startNextRanges();
+        });
+      }
+      return;
+    }
+
+    if (m_scanOffset >= m_chunkOffset + m_chunk.size() && !loadChunk())
+    {
+      qCWarning(lcAzureStorageTransfer) << "[QAzureStoragePageBlobUploadJob] Failed to read local file" << m_file.fileName() << ":" << m_file.errorString();
+      finish(QNetworkReply::NetworkError::UnknownContentError);
+      return;
+    }
+
+    // Skip the pages filled with zeros then take all following pages which are not (in the same chunk)
+    const char* chunkData = m_chunk.constData();
+    qint64 rangeStart = m_scanOffset - m_chunkOffset;
+    while (rangeStart < m_chunk.size() && isZero(chunkData + rangeStart, pageSizeInBytes))
+    {
+      rangeStart += pageSizeInBytes;
+    }
+
+    qint64 rangeEnd = rangeStart;
+    while (rangeEnd < m_chunk.size() && !isZero(chunkData + rangeEnd, pageSizeInBytes))
+    {
+      rangeEnd += pageSizeInBytes;
+    }
+
+    scannedBytes += rangeEnd - (m_scanOffset - m_chunkOffset);
+    m_scanOffset = m_chunkOffset + rangeEnd;
+
+    if (rangeEnd == rangeStart)
+    {
+      continue;
+    }
+
+    QNetworkReply* reply = m_api->uploadPages(m_container, m_blobName, m_chunkOffset + rangeStart,
+                                              m_chunk.mid(static_cast<int>(rangeStart), static_cast<int>(rangeEnd - rangeStart)), m_timeoutInSec, &m_bandwidthLimiter);
+    if (reply == nullptr)
+    {
+      finish(QNetworkReply::NetworkError::UnknownNetworkError);
+      return;
+    }
+
+    m_runningRanges.insert(reply, rangeEnd - rangeStart);
+    m_bytesRunning += rangeEnd - rangeStart;
+    QObject::connect(reply, &QNetworkReply::finished, this, [this, reply]() { onRangeFinished(reply); });
+  }
+
+  if (isFinished())
+  {
+    return;
+  }
+
+  emit progress(bytesDone(), m_fileSize);
+
+  if (m_scanOffset >= m_fileSize && m_runningRanges.isEmpty())
+  {
+    m_file.close();
+    finish(QNetworkReply::NetworkError::NoError);
+  }
+}
+
+void QAzureStoragePageBlobUploadJob::onRangeFinished(QNetworkReply* reply)
+{
+  reply->deleteLater();
+  if (isFinished() || !m_runningRanges.contains(reply))
+  {
+    return;
+  }
+
+  qint64 rangeSize = m_runningRanges.take(reply);
+  m_bytesRunning -= rangeSize;
+
+  if (!QAzureStorageRestApi::isErrorCodeSuccess(reply->error()))
+  {
+    finish(reply->error());
+    return;
+  }
+
+  m_bytesUploaded += rangeSize;
+  startNextRanges();
+}
+
+void QAzureStoragePageBlobUploadJob::cleanup()
+{
+  m_chunk.clear();
+
+  // Stop the remaining requests (their finished signal is ignored since the job is finished)
+  if (m_createReply != nullptr)
+  {
+    QNetworkReply* reply = m_createReply;
+    m_createReply = nullptr;
+    reply->abort();
+  }
+
+  QList<QNetworkReply*> runningReplies = m_runningRanges.keys();
+  m_runningRanges.clear();
+  for (QNetworkReply* reply : runningReplies)
+  {
+    reply->abort();
+  }
+
+  if (m_file.isOpen())
+  {
+    m_file.close();
+  }
+}
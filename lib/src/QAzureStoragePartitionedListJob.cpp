@@ -0,0 +1,335 @@
+/*
+ * \brief List the files of a huge Azure storage container with parallel listings of prefix partitions merged in lexicographic order
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#include "QAzureStoragePartitionedListJob.h"
+#include "QAzureStorageRestApi.h"
+
+#include <algorithm>
+
+// ------------------------------------- CONSTRUCTOR & INIT -------------------------------------
+
+QAzureStoragePartitionedListJob::QAzureStoragePartitionedListJob(QAzureStorageRestApi* api, const QString& container, const QString& prefix,
+                                                                 const QString& partitionAlphabet, const QString& delimiter,
+                                                                 const int& maxParallelListings, const int& timeoutInSec, QObject* parent) :
+  QAzureStorageJob(parent),
+  m_api(api),
+  m_container(container),
+  m_prefix(prefix),
+  m_partitionAlphabet(partitionAlphabet),
+  m_delimiter(delimiter),
+  m_maxParallelListings(maxParallelListings),
+  m_timeoutInSec(timeoutInSec)
+{
+}
+
+qint64 QAzureStoragePartitionedListJob::fileCount() const
+{
+  return m_fileCount;
+}
+
+bool QAzureStoragePartitionedListJob::isComplete() const
+{
+  // Names whose character after the prefix is not in the alphabet are in no partition
+  return isFinished() && QAzureStorageRestApi::isErrorCodeSuccess(error()) && m_partitionAlphabet.isEmpty();
+}
+
+int QAzureStoragePartitionedListJob::partitionCount() const
+{
+  int count = 0;
+  for (const Partition& partition : m_partitions)
+  {
+    if (!partition.isFile)
+    {
+      count++;
+    }
+  }
+  return count;
+}
+
+QStringList QAzureStoragePartitionedListJob::partitionPrefixes(const QString& prefix, const QString& partitionAlphabet)
+{
+  QStringList prefixes;
+  for (const QChar& character : partitionAlphabet)
+  {
+    QString partitionPrefix = prefix + character;
+    if (!prefixes.contains(partitionPrefix))
+    {
+      prefixes.append(partitionPrefix);
+    }
+  }
+
+  std::sort(prefixes.begin(), prefixes.end(), &QAzureStoragePartitionedListJob::isListedBefore);
+  return prefixes;
+}
+
+bool QAzureStoragePartitionedListJob::isListedBefore(const QString& name1, const QString& name2)
+{
+  return name1.toUtf8() < name2.toUtf8();
+}
+
+// ------------------------------------- PUBLIC SLOTS -------------------------------------
+
+void QAzureStoragePartitionedListJob::start()
+{
+  if (m_isStarted || isFinished())
+  {
+    return;
+  }
+  m_isStarted = true;
+
+  if (m_partitionAlphabet.isEmpty())
+  {
+    requestProbe(QString());
+    return;
+  }
+
+  for (const QString& partitionPrefix : partitionPrefixes(m_prefix, m_partitionAlphabet))
+  {
+    Partition partition;
+    partition.key = partitionPrefix;
+    partition.isFile = false;
+    partition.isDone = false;
+    m_partitions.append(partition);
+  }
+
+  // The file named exactly like the prefix is in no partition: it is the first name of the prefix (if it exists)
+  m_probeReply = m_api->listFiles(m_container, QString(), m_prefix, 1, m_timeoutInSec);
+  if (m_probeReply == nullptr)
+  {
+    finish(QNetworkReply::NetworkError::UnknownNetworkError);
+    return;
+  }
+
+  QNetworkReply* reply = m_probeReply;
+  QObject::connect(reply, &QNetworkReply::finished, this, [this, reply]() { onExactPrefixFinished(reply); });
+}
+
+// ------------------------------------- PRIVATE -------------------------------------
+
+void QAzureStoragePartitionedListJob::onExactPrefixFinished(QNetworkReply* reply)
+{
+  reply->deleteLater();
+  if (isFinished() || reply != m_probeReply)
+  {
+    return;
+  }
+  m_probeReply = nullptr;
+
+  if (!QAzureStorageRestApi::isErrorCodeSuccess(reply->error()))
+  {
+    finish(reply->error());
+    return;
+  }
+
+  const QList< QMap<QString,QString> > files = QAzureStorageRestApi::parseFileList(reply->readAll());
+  if (!files.isEmpty() && files.first().value("Name") == m_prefix)
+  {
+    Partition partition;
+    partition.key = m_prefix;
+    partition.isFile = true;
+    partition.isDone = true;
+    partition.bufferedFiles.append(files.first());
+    m_partitions.append(partition);
+    m_fileCount++;
+  }
+
+  startPartitions();
+}
+
+void QAzureStoragePartitionedListJob::requestProbe(const QString& marker)
+{
+  m_probeReply = m_api->listFiles(m_container, marker, m_prefix, -1, m_timeoutInSec, m_delimiter);
+  if (m_probeReply == nullptr)
+  {
+    finish(QNetworkReply::NetworkError::UnknownNetworkError);
+    return;
+  }
+
+  QNetworkReply* reply = m_probeReply;
+  QObject::connect(reply, &QNetworkReply::finished, this, [this, reply]() { onProbeFinished(reply); });
+}
+
+void QAzureStoragePartitionedListJob::onProbeFinished(QNetworkReply* reply)
+{
+  reply->deleteLater();
+  if (isFinished() || reply != m_probeReply)
+  {
+    return;
+  }
+  m_probeReply = nullptr;
+
+  if (!QAzureStorageRestApi::isErrorCodeSuccess(reply->error()))
+  {
+    finish(reply->error());
+    return;
+  }
+
+  // Each virtual "folder" is a partition, the files directly in the prefix are already listed
+  QString nextMarker;
+  QStringList folders;
+  QList< QMap<QString,QString> > files = QAzureStorageRestApi::parseFileList(reply->readAll(), &nextMarker, &folders);
+
+  for (const QMap<QString,QString>& file : files)
+  {
+    Partition partition;
+    partition.key = file.value("Name");
+    partition.isFile = true;
+    partition.isDone = true;
+    partition.bufferedFiles.append(file);
+    m_partitions.append(partition);
+  }
+  m_fileCount += files.count();
+
+  for (const QString& folder : folders)
+  {
+    Partition partition;
+    partition.key = folder;
+    partition.isFile = false;
+    partition.isDone = false;
+    m_partitions.append(partition);
+  }
+
+  if (!nextMarker.isEmpty())
+  {
+    requestProbe(nextMarker);
+    return;
+  }
+
+  startPartitions();
+}
+
+void QAzureStoragePartitionedListJob::startPartitions()
+{
+  // Partitions do not overlap: listing them in the order of their prefix gives all files in lexicographic order
+  std::stable_sort(m_partitions.begin(), m_partitions.end(),
+                   [](const Partition& partition1, const Partition& partition2) { return isListedBefore(partition1.key, partition2.key); });
+
+  for (int partitionIndex = 0; partitionIndex < m_partitions.count(); ++partitionIndex)
+  {
+    if (!m_partitions[partitionIndex].isDone)
+    {
+      m_pendingPartitions.append(partitionIndex);
+    }
+  }
+
+  emit progress(m_fileCount, -1);
+  startNextListings();
+}
+
+void QAzureStoragePartitionedListJob::startNextListings()
+{
+  // Partitions are started in order so that the first ones (emitted first) are not delayed by the next ones
+  while (!isFinished() && !m_pendingPartitions.isEmpty() && m_runningListings.count() < m_maxParallelListings)
+  {
+    int partitionIndex = m_pendingPartitions.takeFirst();
+    const Partition& partition = m_partitions[partitionIndex];
+
+    QNetworkReply* reply = m_api->listFiles(m_container, partition.marker, partition.key, -1, m_timeoutInSec);
+    if (reply == nullptr)
+    {
+      finish(QNetworkReply::NetworkError::UnknownNetworkError);
+      return;
+    }
+
+    m_runningListings.insert(reply, partitionIndex);
+    QObject::connect(reply, &QNetworkReply::finished, this, [this, reply]() { onListingFinished(reply); });
+  }
+
+  if (isFinished())
+  {
+    return;
+  }
+
+  emitReadyFiles();
+
+  if (!isFinished() && m_nextPartitionToEmit >= m_partitions.count() && m_pendingPartitions.isEmpty() && m_runningListings.isEmpty())
+  {
+    finish(QNetworkReply::NetworkError::NoError);
+  }
+}
+
+void QAzureStoragePartitionedListJob::onListingFinished(QNetworkReply* reply)
+{
+  reply->deleteLater();
+  if (isFinished() || !m_runningListings.contains(reply))
+  {
+    return;
+  }
+
+  int partitionIndex = m_runningListings.take(reply);
+  if (!QAzureStorageRestApi::isErrorCodeSuccess(reply->error()))
+  {
+    finish(reply->error());
+    return;
+  }
+
+  QString nextMarker;
+  QList< QMap<QString,QString> > files = QAzureStorageRestApi::parseFileList(reply->readAll(), &nextMarker);
+
+  Partition& partition = m_partitions[partitionIndex];
+  partition.bufferedFiles.append(files);
+  m_fileCount += files.count();
+
+  // The next page of the partition is requested before the other partitions (Azure listing is sequential)
+  if (nextMarker.isEmpty())
+  {
+    partition.isDone = true;
+  }
+  else
+  {
+    partition.marker = nextMarker;
+    m_pendingPartitions.prepend(partitionIndex);
+  }
+
+  emit progress(m_fileCount, -1);
+  startNextListings();
+}
+
+void QAzureStoragePartitionedListJob::emitReadyFiles()
+{
+  QList< QMap<QString,QString> > readyFiles;
+  while (m_nextPartitionToEmit < m_partitions.count())
+  {
+    Partition& partition = m_partitions[m_nextPartitionToEmit];
+    readyFiles.append(partition.bufferedFiles);
+    partition.bufferedFiles.clear();
+
+    if (!partition.isDone)
+    {
+      break;
+    }
+    m_nextPartitionToEmit++;
+  }
+
+  if (!readyFiles.isEmpty())
+  {
+    emit filesListed(readyFiles);
+  }
+}
+
+void QAzureStoragePartitionedListJob::cleanup()
+{
+  m_pendingPartitions.clear();
+
+  // Stop the remaining requests (their finished signal is ignored since the job is finished)
+  if (m_probeReply != nullptr)
+  {
+    QNetworkReply* reply = m_probeReply;
+    m_probeReply = nullptr;
+    reply->abort();
+  }
+
+  QList<QNetworkReply*> runningReplies = m_runningListings.keys();
+  m_runningListings.clear();
+  for (QNetworkReply* reply : runningReplies)
+  {
+    reply->abort();
+  }
+}
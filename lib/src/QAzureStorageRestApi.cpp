@@ -9,25 +9,303 @@
  */
 
 #include "QAzureStorageRestApi.h"
+#include "QAzureStorageDownloadJob.h"
+#include "QAzureStorageUploadJob.h"
+#include "QAzureStoragePageBlobUploadJob.h"
+#include "QAzureStorageDirectoryUploadJob.h"
+#include "QAzureStorageDirectoryDownloadJob.h"
+#include "QAzureStorageSyncJob.h"
+#include "QAzureStorageInventory.h"
+#include "QAzureStorageChangeFeedJob.h"
+#include "QAzureStorageListJob.h"
+#include "QAzureStoragePartitionedListJob.h"
+#include "QAzureStorageFindByTagsJob.h"
+#include "QAzureStorageChecksum.h"
+#include "QAzureStorageCompression.h"
+#include "QAzureStorageLogging.h"
 
 #include <QEventLoop>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QSharedPointer>
+#include <QMetaMethod>
+#include <QUuid>
+#include <QTimeZone>
 #include <QDebug>
 
+namespace
+{
+  //! Names of the headers sent with every request (not rebuilt for each request)
+  const QByteArray authorizationHeaderName("Authorization");
+  const QByteArray msDateHeaderName("x-ms-date");
+  const QByteArray msVersionHeaderName("x-ms-version");
+  const QByteArray contentLengthHeaderName("Content-Length");
+  const QByteArray contentMd5HeaderName("Content-MD5");
+  const QByteArray msRequestIdHeaderName("x-ms-request-id");
+  const QByteArray msClientRequestIdHeaderName("x-ms-client-request-id");
+
+  //! Time spent in generateRequest (in us), read back when the request is sent
+  const QNetworkRequest::Attribute buildTimeAttribute = static_cast<QNetworkRequest::Attribute>(QNetworkRequest::User + 1);
+
+  //! Timings of a request being measured (shared by the slots connected to its reply)
+  struct RequestMeasure
+  {
+    QElapsedTimer timer;
+    QAzureStorageRestApi::RequestMetrics metrics;
+    qint64 connectStartInUs = -1;
+    bool isCountedInMetrics = false;
+    QAzureStorageTracer* tracer = nullptr;
+    QAzureStorageTracer::Span span;
+
+    qint64 elapsedInUs() const
+    {
+      return timer.nsecsElapsed() / 1000;
+    }
+
+    void markStarted()
+    {
+      if (metrics.queuedTimeInUs < 0)
+      {
+        metrics.queuedTimeInUs = elapsedInUs();
+      }
+    }
+  };
+}
+
 // ------------------------------------- CONSTRUCTOR & INIT -------------------------------------
 
 QAzureStorageRestApi::QAzureStorageRestApi(const QString& accountName, const QString& accountKeyOrSasCredentials, QObject* parent, const bool isAccountKey) :
   QObject(parent)
 {
+  qRegisterMetaType<QAzureStorageRestApi::RequestMetrics>("QAzureStorageRestApi::RequestMetrics");
   updateCredentials(accountName, accountKeyOrSasCredentials, isAccountKey);
-  m_manager = new QNetworkAccessManager(this);
+  m_managers.append(new QNetworkAccessManager(this));
 }
 
 void QAzureStorageRestApi::updateCredentials(const QString&accountName, const QString& accountKeyOrSasCredentials, const bool isAccountKey)
 {
   m_accountName = accountName;
-  m_accountKey = isAccountKey ? accountKeyOrSasCredentials : QString();
+  m_accountKey = isAccountKey ? QByteArray::fromBase64(accountKeyOrSasCredentials.toLatin1()) : QByteArray();
+  m_authorizationPrefix = "SharedKey " + accountName.toUtf8() + ":";
   m_sasKey = isAccountKey ? QString() : accountKeyOrSasCredentials;
+
+  // Parts of the requests which only depend on the credentials
+  m_blobEndpoint = QString("https://%1.blob.core.windows.net/").arg(m_accountName);
+  m_canonicalizedResourcePrefix = QString("/%1/").arg(m_accountName);
+  m_sasQuery = (m_sasKey.isEmpty() || m_sasKey.contains("sig=")) ? m_sasKey : "sig=" + m_sasKey;
+
+  qCDebug(lcAzureStorageAuth) << "[QAzureStorageRestApi] Credentials of" << m_accountName << "updated:"
+                              << (isAccountKey ? "account key" : "SAS credentials");
+}
+
+void QAzureStorageRestApi::setTransactionalChecksum(const TransactionalChecksum& checksum)
+{
+  m_transactionalChecksum = checksum;
+}
+
+QAzureStorageRestApi::TransactionalChecksum QAzureStorageRestApi::transactionalChecksum() const
+{
+  return m_transactionalChecksum;
+}
+
+void QAzureStorageRestApi::setContentCompression(const bool& isEnabled)
+{
+  m_contentCompression = isEnabled;
+}
+
+bool QAzureStorageRestApi::isContentCompressionEnabled() const
+{
+  return m_contentCompression;
+}
+
+void QAzureStorageRestApi::setHttp2Allowed(const bool& isAllowed)
+{
+  m_http2Allowed = isAllowed;
+}
+
+bool QAzureStorageRestApi::isHttp2Allowed() const
+{
+  return m_http2Allowed;
+}
+
+void QAzureStorageRestApi::setMaxConnectionsPerHost(const int& maxConnectionsPerHost)
+{
+#if QT_VERSION < QT_VERSION_CHECK(6, 5, 0)
+  if (maxConnectionsPerHost > 0)
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] The number of connections per host can only be changed with Qt 6.5 or newer (use setNetworkAccessManagerCount instead).";
+  }
+#endif
+
+  m_maxConnectionsPerHost = maxConnectionsPerHost;
+}
+
+int QAzureStorageRestApi::maxConnectionsPerHost() const
+{
+  return m_maxConnectionsPerHost;
+}
+
+void QAzureStorageRestApi::setNetworkAccessManagerCount(const int& count)
+{
+  if (count <= 0)
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Invalid parameter: count should be positive.";
+    return;
+  }
+
+  // The managers are never deleted: the replies they own may still be running
+  while (m_managers.count() < count)
+  {
+    m_managers.append(new QNetworkAccessManager(this));
+  }
+  m_managerCount = count;
+}
+
+int QAzureStorageRestApi::networkAccessManagerCount() const
+{
+  return m_managerCount;
+}
+
+void QAzureStorageRestApi::warmUp(const int& connectionCount)
+{
+#ifndef QT_NO_SSL
+  const QString host = QUrl(m_blobEndpoint).host();
+  for (int connectionIndex = 0; connectionIndex < connectionCount; ++connectionIndex)
+  {
+    m_managers[connectionIndex % m_managerCount]->connectToHostEncrypted(host);
+  }
+#else
+  Q_UNUSED(connectionCount)
+  qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Connections can not be warmed up without SSL support.";
+#endif
+}
+
+void QAzureStorageRestApi::setKeepWarmInterval(const int& intervalInMs, const int& connectionCount)
+{
+  m_keepWarmConnectionCount = connectionCount;
+
+  if (intervalInMs <= 0)
+  {
+    if (m_keepWarmTimer != nullptr)
+    {
+      m_keepWarmTimer->stop();
+    }
+    return;
+  }
+
+  if (m_keepWarmTimer == nullptr)
+  {
+    m_keepWarmTimer = new QTimer(this);
+    QObject::connect(m_keepWarmTimer, &QTimer::timeout, this, [this]()
+    {
+      if (m_isIdle)
+      {
+        warmUp(m_keepWarmConnectionCount);
+      }
+      m_isIdle = true;
+    });
+  }
+
+  m_isIdle = true;
+  m_keepWarmTimer->start(intervalInMs);
+}
+
+int QAzureStorageRestApi::keepWarmInterval() const
+{
+  return (m_keepWarmTimer != nullptr && m_keepWarmTimer->isActive()) ? m_keepWarmTimer->interval() : 0;
+}
+
+void QAzureStorageRestApi::setMetricsEnabled(const bool& isEnabled)
+{
+  if (isEnabled && m_metrics.isNull())
+  {
+    m_metrics.reset(new QAzureStorageMetrics());
+  }
+  m_metricsEnabled = isEnabled;
+}
+
+bool QAzureStorageRestApi::isMetricsEnabled() const
+{
+  return m_metricsEnabled;
+}
+
+QAzureStorageMetrics* QAzureStorageRestApi::metrics() const
+{
+  return m_metrics.data();
+}
+
+void QAzureStorageRestApi::setTracer(QAzureStorageTracer* tracer)
+{
+  m_tracer = tracer;
+}
+
+QAzureStorageTracer* QAzureStorageRestApi::tracer() const
+{
+  return m_tracer;
+}
+
+void QAzureStorageRestApi::setUploadBandwidthLimit(const qint64& bytesPerSecond)
+{
+  m_uploadBandwidthLimiter.setRate(bytesPerSecond);
+}
+
+qint64 QAzureStorageRestApi::uploadBandwidthLimit() const
+{
+  return m_uploadBandwidthLimiter.rate();
+}
+
+void QAzureStorageRestApi::setDownloadBandwidthLimit(const qint64& bytesPerSecond)
+{
+  m_downloadBandwidthLimiter.setRate(bytesPerSecond);
+}
+
+qint64 QAzureStorageRestApi::downloadBandwidthLimit() const
+{
+  return m_downloadBandwidthLimiter.rate();
+}
+
+QAzureStorageBandwidthLimiter* QAzureStorageRestApi::uploadBandwidthLimiter()
+{
+  return &m_uploadBandwidthLimiter;
+}
+
+QAzureStorageBandwidthLimiter* QAzureStorageRestApi::downloadBandwidthLimiter()
+{
+  return &m_downloadBandwidthLimiter;
+}
+
+QString QAzureStorageRestApi::ListIncludeOptions::toString() const
+{
+  QStringList values;
+  if (copy)
+  {
+    values.append("copy");
+  }
+  if (deleted)
+  {
+    values.append("deleted");
+  }
+  if (metadata)
+  {
+    values.append("metadata");
+  }
+  if (snapshots)
+  {
+    values.append("snapshots");
+  }
+  if (tags)
+  {
+    values.append("tags");
+  }
+  if (uncommittedBlobs)
+  {
+    values.append("uncommittedblobs");
+  }
+  if (versions)
+  {
+    values.append("versions");
+  }
+  return values.join(",");
 }
 
 // ------------------------------------- PUBLIC HELPER -------------------------------------
@@ -35,8 +313,7 @@ void QAzureStorageRestApi::updateCredentials(const QString&accountName, const QS
 QString QAzureStorageRestApi::generateUrl(const QString& container, const QString& blobName, const QString& additionnalParameters,
                                           const QString& marker, const int& timeoutInSec, const QString& sasKey)
 {
-  QString blobEndPoint = QString("https://%1.blob.core.windows.net/").arg(m_accountName);
-  QString url = blobEndPoint + container;
+  QString url = m_blobEndpoint + container;
   if (!blobName.isEmpty())
   {
       url.append("/" + QUrl::toPercentEncoding(blobName,"/"));
@@ -86,7 +363,7 @@ QString QAzureStorageRestApi::generateUrl(const QString& container, const QStrin
     url.append(allparams);
   }
 
-  qDebug() << "[QAzureStorageRestApi] Generated URL: " << url;
+  qCDebug(lcAzureStorageUrl) << "[QAzureStorageRestApi] Generated URL:" << QAzureStorageLogging::redactSasSignature(url);
 
   return url;
 }
@@ -95,249 +372,427 @@ QString QAzureStorageRestApi::generateUrl(const QString& container, const QStrin
 
 QNetworkReply* QAzureStorageRestApi::listContainers(const QString& marker, const int& timeoutInSec)
 {
-  QNetworkRequest request;
-
-  // --- Prepare the URL ---
-  QString additionalUrlParams = "comp=list";
-  QString url = generateUrl("", "", additionalUrlParams, marker, timeoutInSec, m_sasKey);
-  request.setUrl(QUrl(url));
-  // ------------------------
+  QMap<QString,QString> urlParameters;
+  urlParameters.insert("comp", "list");
 
-  // --- Adding Account key authentication if Account key enabled ---
-  QString currentDateTime = generateCurrentTimeUTC();
-  if (!m_accountKey.isEmpty())
+  // Marker to get the next results
+  if (!marker.isEmpty())
   {
-      QStringList additionnalCanonicalRessources;
-      additionnalCanonicalRessources.append("comp:list");
-
-      if (!marker.isEmpty())
-      {
-          additionnalCanonicalRessources.append("marker:"+marker);
-      }
-
-      QString authorization = generateAutorizationHeader("GET", "", "", currentDateTime, 0, QStringList(), additionnalCanonicalRessources);
-      request.setRawHeader(QByteArray("Authorization"), QByteArray(authorization.toStdString().c_str()));
+    urlParameters.insert("marker", marker);
   }
-  // ------------------------
 
-  // --- Adding common header info ---
-  request.setRawHeader(QByteArray("x-ms-date"), QByteArray(currentDateTime.toStdString().c_str()));
-  request.setRawHeader(QByteArray("x-ms-version"), QByteArray(m_version.toStdString().c_str()));
-  request.setRawHeader(QByteArray("Content-Length"), QByteArray("0"));
-  // ------------------------
+  QNetworkRequest request = generateRequest("GET", "", "", urlParameters, QMap<QString,QString>(), 0, timeoutInSec);
 
   // Sending the request
-  return m_manager->get(request);
+  return sendRequest("ListContainers", "GET", request);
 }
 
-QNetworkReply* QAzureStorageRestApi::listFiles(const QString& container, const QString& marker, const QString& prefix, const int& maxResults, const int& timeoutInSec)
+QNetworkReply* QAzureStorageRestApi::listFiles(const QString& container, const QString& marker, const QString& prefix, const int& maxResults, const int& timeoutInSec,
+                                               const QString& delimiter, const ListIncludeOptions& include)
 {
-  QNetworkRequest request;
+  QMap<QString,QString> urlParameters;
+  urlParameters.insert("restype", "container");
+  urlParameters.insert("comp", "list");
 
-  // --- Prepare the URL ---
-  QString additionalUrlParams = "restype=container&comp=list";
+  // Marker to get the next results
+  if (!marker.isEmpty())
+  {
+    urlParameters.insert("marker", marker);
+  }
 
   // Prefix listing
   if (!prefix.isEmpty())
   {
-      additionalUrlParams += "&prefix=" + prefix;
+    urlParameters.insert("prefix", prefix);
+  }
+
+  // Hierarchical listing (blobs in sub "folders" are returned as one BlobPrefix)
+  if (!delimiter.isEmpty())
+  {
+    urlParameters.insert("delimiter", delimiter);
   }
 
   // Max results
   if (maxResults > 0)
   {
-      additionalUrlParams += "&maxresults=" + prefix;
+    urlParameters.insert("maxresults", QString::number(maxResults));
   }
 
-  QString url = generateUrl(container, "", additionalUrlParams, marker, timeoutInSec, m_sasKey);
-  request.setUrl(QUrl(url));
-  // ------------------------
-
-  // --- Adding Account key authentication if Account key enabled ---
-  QString currentDateTime = generateCurrentTimeUTC();
-  if (!m_accountKey.isEmpty())
+  // Additional information (avoids requesting the properties of each file)
+  QString includeValue = include.toString();
+  if (!includeValue.isEmpty())
   {
-    QStringList additionnalCanonicalRessources;
-    additionnalCanonicalRessources.append("comp:list");
-
-    if (!marker.isEmpty())
-    {
-      additionnalCanonicalRessources.append("marker:"+marker);
-    }
-    additionnalCanonicalRessources.append("restype:container");
-
-    QString authorization = generateAutorizationHeader("GET", container, "", currentDateTime, 0, QStringList(), additionnalCanonicalRessources);
-    request.setRawHeader(QByteArray("Authorization"), QByteArray(authorization.toStdString().c_str()));
+    urlParameters.insert("include", includeValue);
   }
-  // ------------------------
 
-  // --- Adding common header info ---
-  request.setRawHeader(QByteArray("x-ms-date"), QByteArray(currentDateTime.toStdString().c_str()));
-  request.setRawHeader(QByteArray("x-ms-version"), QByteArray(m_version.toStdString().c_str()));
-  request.setRawHeader(QByteArray("Content-Length"), QByteArray("0"));
-  // ------------------------
+  QNetworkRequest request = generateRequest("GET", container, "", urlParameters, QMap<QString,QString>(), 0, timeoutInSec);
 
   // Sending the request
-  return m_manager->get(request);
+  return sendRequest("ListBlobs", "GET", request);
 }
 
 QNetworkReply* QAzureStorageRestApi::downloadFile(const QString& container, const QString& blobName, const int& timeoutInSec)
 {
-  QNetworkRequest request;
+  QNetworkRequest request = generateRequest("GET", container, blobName, QMap<QString,QString>(), QMap<QString,QString>(), 0, timeoutInSec);
 
-  // --- Prepare the URL ---
-  QString url = generateUrl(container, blobName, "", "", timeoutInSec, m_sasKey);
-  request.setUrl(QUrl(url));
-  // ------------------------
+  // Sending the request
+  return sendRequest("GetBlob", "GET", request);
+}
 
-  // --- Adding Account key authentication if Account key enabled ---
-  QString currentDateTime = generateCurrentTimeUTC();
-  if (!m_accountKey.isEmpty())
+QNetworkReply* QAzureStorageRestApi::downloadFileRange(const QString& container, const QString& blobName, const qint64& offset, const qint64& length, const int& timeoutInSec)
+{
+  if (container.isEmpty() || blobName.isEmpty() || offset < 0 || length <= 0)
   {
-    QString authorization = generateAutorizationHeader("GET", container, blobName, currentDateTime, 0);
-    request.setRawHeader(QByteArray("Authorization"), QByteArray(authorization.toStdString().c_str()));
+    return nullptr;
   }
-  // ------------------------
 
-  // --- Adding common header info ---
-  request.setRawHeader(QByteArray("x-ms-date"), QByteArray(currentDateTime.toStdString().c_str()));
-  request.setRawHeader(QByteArray("x-ms-version"), QByteArray(m_version.toStdString().c_str()));
-  request.setRawHeader(QByteArray("Content-Length"), QByteArray("0"));
-  // ------------------------
+  QMap<QString,QString> msHeaders;
+  msHeaders.insert("x-ms-range", QString("bytes=%1-%2").arg(offset).arg(offset + length - 1));
+
+  // Azure only returns the checksum of ranges up to 4 MiB
+  if (length <= 4 * 1024 * 1024)
+  {
+    if (m_transactionalChecksum == Crc64Checksum)
+    {
+      msHeaders.insert("x-ms-range-get-content-crc64", "true");
+    }
+    else if (m_transactionalChecksum == Md5Checksum)
+    {
+      msHeaders.insert("x-ms-range-get-content-md5", "true");
+    }
+  }
+
+  QNetworkRequest request = generateRequest("GET", container, blobName, QMap<QString,QString>(), msHeaders, 0, timeoutInSec);
+
+  // A range of a compressed file must not be decompressed by Qt (QAzureStorageGzipDecoder handles it if needed)
+  request.setRawHeader(QByteArray("Accept-Encoding"), QByteArray("identity"));
 
   // Sending the request
-  return m_manager->get(request);
+  return sendRequest("GetBlob", "GET", request);
 }
 
-QNetworkReply* QAzureStorageRestApi::createContainer(const QString& container, const int& timeoutInSec)
+QNetworkReply* QAzureStorageRestApi::getFileProperties(const QString& container, const QString& blobName, const int& timeoutInSec)
 {
-  if (container.isEmpty())
+  if (container.isEmpty() || blobName.isEmpty())
   {
     return nullptr;
   }
 
-  QNetworkRequest request;
-
-  // --- Prepare the URL ---
-  QString additionalUrlParams = "restype=container";
-  QString url = generateUrl(container, "", additionalUrlParams, "", timeoutInSec, m_sasKey);
-  request.setUrl(QUrl(url));
-  // ------------------------
+  QNetworkRequest request = generateRequest("HEAD", container, blobName, QMap<QString,QString>(), QMap<QString,QString>(), 0, timeoutInSec);
 
+  // Sending the request
+  return sendRequest("GetBlobProperties", "HEAD", request);
+}
 
-  // --- Adding Account key authentication if Account key enabled ---
-  QString currentDateTime = generateCurrentTimeUTC();
-
-  if (!m_accountKey.isEmpty())
+QNetworkReply* QAzureStorageRestApi::setFileTags(const QString& container, const QString& blobName, const QMap<QString,QString>& tags, const int& timeoutInSec)
+{
+  if (container.isEmpty() || blobName.isEmpty())
   {
-    QStringList additionnalCanonicalRessources;
-    additionnalCanonicalRessources.append("restype:container");
+    return nullptr;
+  }
 
+  if (tags.count() > 10)
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Invalid parameter: a file can not have more than 10 index tags.";
+    return nullptr;
+  }
 
-    QString authorization = generateAutorizationHeader("PUT", container, "", currentDateTime, 0, QStringList(), additionnalCanonicalRessources);
-    request.setRawHeader(QByteArray("Authorization"), QByteArray(authorization.toStdString().c_str()));
+  // --- Prepare the tag set ---
+  QByteArray tagSet("<?xml version=\"1.0\" encoding=\"utf-8\"?><Tags><TagSet>");
+  for (QMap<QString,QString>::const_iterator it = tags.constBegin(); it != tags.constEnd(); ++it)
+  {
+    tagSet.append("<Tag><Key>" + it.key().toHtmlEscaped().toUtf8() + "</Key><Value>" + it.value().toHtmlEscaped().toUtf8() + "</Value></Tag>");
   }
+  tagSet.append("</TagSet></Tags>");
   // ------------------------
 
-  // --- Adding common header info ---
-  request.setRawHeader(QByteArray("x-ms-date"),QByteArray(currentDateTime.toStdString().c_str()));
-  request.setRawHeader(QByteArray("x-ms-version"),QByteArray(m_version.toStdString().c_str()));
-  // ------------------------
+  QMap<QString,QString> urlParameters;
+  urlParameters.insert("comp", "tags");
+
+  QMap<QString,QString> msHeaders;
+  QString contentMd5;
+  addTransactionalChecksum(tagSet, msHeaders, contentMd5);
+
+  QNetworkRequest request = generateRequest("PUT", container, blobName, urlParameters, msHeaders, tagSet.size(), timeoutInSec, contentMd5);
 
   // Sending the request
-  return m_manager->put(request, QByteArray());
+  return sendRequest("SetBlobTags", "PUT", request, tagSet);
 }
 
-QNetworkReply* QAzureStorageRestApi::deleteContainer(const QString& container, const QString& leaseId, const int& timeoutInSec)
+QNetworkReply* QAzureStorageRestApi::getFileTags(const QString& container, const QString& blobName, const int& timeoutInSec)
 {
-  if (container.isEmpty())
+  if (container.isEmpty() || blobName.isEmpty())
   {
     return nullptr;
   }
 
-  QNetworkRequest request;
-
-  // --- Prepare the URL ---
-  QString additionalUrlParams = "restype=container";
-  QString url = generateUrl(container, "", additionalUrlParams, "", timeoutInSec, m_sasKey);
-  request.setUrl(QUrl(url));
-  // ------------------------
+  QMap<QString,QString> urlParameters;
+  urlParameters.insert("comp", "tags");
 
+  QNetworkRequest request = generateRequest("GET", container, blobName, urlParameters, QMap<QString,QString>(), 0, timeoutInSec);
 
-  // --- Adding Account key authentication if Account key enabled ---
-  QString currentDateTime = generateCurrentTimeUTC();
+  // Sending the request
+  return sendRequest("GetBlobTags", "GET", request);
+}
 
-  if (!m_accountKey.isEmpty())
+QNetworkReply* QAzureStorageRestApi::findFilesByTags(const QString& whereExpression, const QString& container, const QString& marker,
+                                                     const int& maxResults, const int& timeoutInSec)
+{
+  if (whereExpression.isEmpty())
   {
-    QStringList additionnalCanonicalRessources;
-    additionnalCanonicalRessources.append("restype:container");
+    return nullptr;
+  }
 
+  // Whole account if no container
+  QMap<QString,QString> urlParameters;
+  if (!container.isEmpty())
+  {
+    urlParameters.insert("restype", "container");
+  }
+  urlParameters.insert("comp", "blobs");
+  urlParameters.insert("where", whereExpression);
 
-    QString authorization = generateAutorizationHeader("DELETE", container, "", currentDateTime, 0, QStringList(), additionnalCanonicalRessources);
-    request.setRawHeader(QByteArray("Authorization"), QByteArray(authorization.toStdString().c_str()));
+  // Marker to get the next results
+  if (!marker.isEmpty())
+  {
+    urlParameters.insert("marker", marker);
   }
-  // ------------------------
-  if (!leaseId.isEmpty())
+
+  // Max results
+  if (maxResults > 0)
   {
-    request.setRawHeader(QByteArray("x-ms-lease-id"),QByteArray(leaseId.toStdString().c_str()));
+    urlParameters.insert("maxresults", QString::number(maxResults));
   }
 
-  // --- Adding common header info ---
-  request.setRawHeader(QByteArray("x-ms-date"),QByteArray(currentDateTime.toStdString().c_str()));
-  request.setRawHeader(QByteArray("x-ms-version"),QByteArray(m_version.toStdString().c_str()));
-  // ------------------------
+  QNetworkRequest request = generateRequest("GET", container, "", urlParameters, QMap<QString,QString>(), 0, timeoutInSec);
 
   // Sending the request
-  return m_manager->deleteResource(request);
+  return sendRequest("FindBlobsByTags", "GET", request);
 }
 
-QNetworkReply* QAzureStorageRestApi::uploadFileQByteArray(const QByteArray& fileContent, const QString& container, const QString& blobName, const QString& blobType, const int& timeoutInSec)
+QAzureStorageFindByTagsJob* QAzureStorageRestApi::findAllFilesByTags(const QString& whereExpression, const QString& container,
+                                                                    const int& maxResultsPerPage, const int& timeoutInSec)
 {
-  QNetworkRequest request;
+  if (whereExpression.isEmpty())
+  {
+    return nullptr;
+  }
 
-  // --- Prepare the URL ---
-  QString url = generateUrl(container, blobName, "", "", timeoutInSec, m_sasKey);
-  request.setUrl(QUrl(url));
-  // ------------------------
+  QAzureStorageFindByTagsJob* job = new QAzureStorageFindByTagsJob(this, whereExpression, container, maxResultsPerPage, timeoutInSec, this);
 
+  // Started from the event loop so that the caller can connect to the job signals first
+  QMetaObject::invokeMethod(job, "start", Qt::QueuedConnection);
 
-  // --- Adding Account key authentication if Account key enabled ---
-  QString currentDateTime = generateCurrentTimeUTC();
-  int contentLength = fileContent.size();
+  return job;
+}
 
-  if (!m_accountKey.isEmpty())
+QAzureStorageDownloadJob* QAzureStorageRestApi::downloadFileToPath(const QString& container, const QString& blobName, const QString& filePath,
+                                                                  const qint64& rangeSizeInBytes, const int& maxParallelRanges,
+                                                                  const QString& journalPath, const int& timeoutInSec)
+{
+  if (container.isEmpty() || blobName.isEmpty() || filePath.isEmpty() || rangeSizeInBytes <= 0 || maxParallelRanges <= 0)
   {
-    QStringList additionalCanonicalHeaders;
-    additionalCanonicalHeaders.append(QString("x-ms-blob-type:%1").arg(blobType));
-
-    QString authorization = generateAutorizationHeader("PUT", container, blobName, currentDateTime, contentLength, additionalCanonicalHeaders, QStringList());
-    request.setRawHeader(QByteArray("Authorization"), QByteArray(authorization.toStdString().c_str()));
+    return nullptr;
   }
-  // ------------------------
 
-  // --- Adding file size header info ---
-  request.setRawHeader(QByteArray("Content-Length"),QByteArray(QString::number(contentLength).toStdString().c_str()));
-  // ------------------------
+  QAzureStorageDownloadJob* job = new QAzureStorageDownloadJob(this, container, blobName, filePath, rangeSizeInBytes, maxParallelRanges, journalPath, timeoutInSec, this);
 
-  // --- Adding common header info ---
-  request.setRawHeader(QByteArray("x-ms-date"),QByteArray(currentDateTime.toStdString().c_str()));
-  request.setRawHeader(QByteArray("x-ms-version"),QByteArray(m_version.toStdString().c_str()));
-  request.setRawHeader(QByteArray("x-ms-blob-type"),QByteArray(blobType.toStdString().c_str()));
-  // ------------------------
+  // Started from the event loop so that the caller can connect to the job signals first
+  QMetaObject::invokeMethod(job, "start", Qt::QueuedConnection);
 
-  // Sending the request
-  return m_manager->put(request, fileContent);
+  return job;
 }
 
-QNetworkReply* QAzureStorageRestApi::uploadFile(const QString& filePath, const QString& container, const QString& blobName, const QString& blobType, const int& timeoutInSec)
+QNetworkReply* QAzureStorageRestApi::getPageRanges(const QString& container, const QString& blobName, const QString& prevSnapshot,
+                                                   const QString& marker, const int& timeoutInSec)
 {
-  // --- Getting file content ---
-  QByteArray fileContent;
-  QFile file(filePath);
-
-  if (file.open(QIODevice::ReadOnly))
+  if (container.isEmpty() || blobName.isEmpty())
   {
-    fileContent = file.readAll();
+    return nullptr;
+  }
+
+  QMap<QString,QString> urlParameters;
+  urlParameters.insert("comp", "pagelist");
+  if (!prevSnapshot.isEmpty())
+  {
+    urlParameters.insert("prevsnapshot", prevSnapshot);
+  }
+  if (!marker.isEmpty())
+  {
+    urlParameters.insert("marker", marker);
+  }
+
+  QNetworkRequest request = generateRequest("GET", container, blobName, urlParameters, QMap<QString,QString>(), 0, timeoutInSec);
+
+  // Sending the request
+  return sendRequest("GetPageRanges", "GET", request);
+}
+
+QAzureStorageDownloadJob* QAzureStorageRestApi::downloadPageBlobToPath(const QString& container, const QString& blobName, const QString& filePath,
+                                                                      const QString& prevSnapshot, const qint64& rangeSizeInBytes,
+                                                                      const int& maxParallelRanges, const QString& journalPath, const int& timeoutInSec)
+{
+  if (container.isEmpty() || blobName.isEmpty() || filePath.isEmpty() || rangeSizeInBytes <= 0 || maxParallelRanges <= 0)
+  {
+    return nullptr;
+  }
+
+  QAzureStorageDownloadJob* job = new QAzureStorageDownloadJob(this, container, blobName, filePath, rangeSizeInBytes, maxParallelRanges, journalPath, timeoutInSec, this);
+  job->setPageRangesOnly(true, prevSnapshot);
+
+  // Started from the event loop so that the caller can connect to the job signals first
+  QMetaObject::invokeMethod(job, "start", Qt::QueuedConnection);
+
+  return job;
+}
+
+QAzureStorageDirectoryDownloadJob* QAzureStorageRestApi::downloadPrefix(const QString& container, const QString& prefix, const QString& localPath,
+                                                                        const int& maxParallelRequests, const qint64& singleGetMaxSizeInBytes,
+                                                                        const qint64& rangeSizeInBytes, const int& maxParallelRanges, const int& timeoutInSec)
+{
+  if (container.isEmpty() || localPath.isEmpty() || maxParallelRequests <= 0 || singleGetMaxSizeInBytes < 0 || rangeSizeInBytes <= 0 || maxParallelRanges <= 0)
+  {
+    return nullptr;
+  }
+
+  QAzureStorageDirectoryDownloadJob* job = new QAzureStorageDirectoryDownloadJob(this, container, prefix, localPath, maxParallelRequests, singleGetMaxSizeInBytes,
+                                                                                 rangeSizeInBytes, maxParallelRanges, timeoutInSec, this);
+
+  // Started from the event loop so that the caller can connect to the job signals first
+  QMetaObject::invokeMethod(job, "start", Qt::QueuedConnection);
+
+  return job;
+}
+
+QAzureStorageSyncJob* QAzureStorageRestApi::sync(const QString& localPath, const QString& container, const QString& prefix, const SyncDirection& direction,
+                                                 const bool& isDeletingExtraneous, const QString& manifestPath,
+                                                 const int& maxParallelRequests, const int& timeoutInSec)
+{
+  if (container.isEmpty() || localPath.isEmpty() || maxParallelRequests <= 0 || (direction == SyncUpload && !QFileInfo(localPath).isDir()))
+  {
+    return nullptr;
+  }
+
+  QAzureStorageSyncJob* job = new QAzureStorageSyncJob(this, localPath, container, prefix, direction, isDeletingExtraneous, manifestPath,
+                                                       maxParallelRequests, timeoutInSec, this);
+
+  // Started from the event loop so that the caller can connect to the job signals first
+  QMetaObject::invokeMethod(job, "start", Qt::QueuedConnection);
+
+  return job;
+}
+
+QAzureStorageChangeFeedJob* QAzureStorageRestApi::readChangeFeed(const QString& cursorPath, const QString& container, const int& timeoutInSec)
+{
+  QAzureStorageChangeFeedJob* job = new QAzureStorageChangeFeedJob(this, cursorPath, container, timeoutInSec, this);
+
+  // Started from the event loop so that the caller can connect to the job signals first
+  QMetaObject::invokeMethod(job, "start", Qt::QueuedConnection);
+
+  return job;
+}
+
+QNetworkReply* QAzureStorageRestApi::createContainer(const QString& container, const int& timeoutInSec)
+{
+  if (container.isEmpty())
+  {
+    return nullptr;
+  }
+
+  QMap<QString,QString> urlParameters;
+  urlParameters.insert("restype", "container");
+
+  QNetworkRequest request = generateRequest("PUT", container, "", urlParameters, QMap<QString,QString>(), 0, timeoutInSec);
+
+  // Sending the request
+  return sendRequest("CreateContainer", "PUT", request);
+}
+
+QNetworkReply* QAzureStorageRestApi::deleteContainer(const QString& container, const QString& leaseId, const int& timeoutInSec)
+{
+  if (container.isEmpty())
+  {
+    return nullptr;
+  }
+
+  QMap<QString,QString> urlParameters;
+  urlParameters.insert("restype", "container");
+
+  QMap<QString,QString> msHeaders;
+  if (!leaseId.isEmpty())
+  {
+    msHeaders.insert("x-ms-lease-id", leaseId);
+  }
+
+  QNetworkRequest request = generateRequest("DELETE", container, "", urlParameters, msHeaders, 0, timeoutInSec);
+
+  // Sending the request
+  return sendRequest("DeleteContainer", "DELETE", request);
+}
+
+QNetworkReply* QAzureStorageRestApi::uploadFileQByteArray(const QByteArray& fileContent, const QString& container, const QString& blobName, const QString& blobType, const int& timeoutInSec)
+{
+  // --- Compress the content if requested (in this thread: the reply must be returned with the request already sent) ---
+  const bool isCompressed = m_contentCompression && blobType == "BlockBlob" && !fileContent.isEmpty();
+  const QByteArray content = isCompressed ? QAzureStorageCompression::gzip(fileContent) : fileContent;
+  // ------------------------
+
+  QMap<QString,QString> msHeaders;
+  QString contentMd5;
+  addTransactionalChecksum(content, msHeaders, contentMd5);
+  msHeaders.insert("x-ms-blob-type", blobType);
+  if (isCompressed)
+  {
+    msHeaders.insert("x-ms-blob-content-encoding", "gzip");
+  }
+
+  QNetworkRequest request = generateRequest("PUT", container, blobName, QMap<QString,QString>(), msHeaders, content.size(), timeoutInSec, contentMd5);
+
+  // Sending the request
+  return sendRequest("PutBlob", "PUT", request, content, &m_uploadBandwidthLimiter);
+}
+
+QAzureStorageListJob* QAzureStorageRestApi::walkFiles(const QString& container, const QString& prefix, const QString& delimiter,
+                                                     const int& maxDepth, const int& maxParallelListings, const int& timeoutInSec)
+{
+  if (container.isEmpty() || maxParallelListings <= 0)
+  {
+    return nullptr;
+  }
+
+  QAzureStorageListJob* job = new QAzureStorageListJob(this, container, prefix, delimiter, maxDepth, maxParallelListings, timeoutInSec, this);
+
+  // Started from the event loop so that the caller can connect to the job signals first
+  QMetaObject::invokeMethod(job, "start", Qt::QueuedConnection);
+
+  return job;
+}
+
+QAzureStoragePartitionedListJob* QAzureStorageRestApi::listFilesParallel(const QString& container, const QString& prefix, const QString& partitionAlphabet,
+                                                                        const QString& delimiter, const int& maxParallelListings, const int& timeoutInSec)
+{
+  if (container.isEmpty() || maxParallelListings <= 0)
+  {
+    return nullptr;
+  }
+
+  QAzureStoragePartitionedListJob* job = new QAzureStoragePartitionedListJob(this, container, prefix, partitionAlphabet, delimiter, maxParallelListings, timeoutInSec, this);
+
+  // Started from the event loop so that the caller can connect to the job signals first
+  QMetaObject::invokeMethod(job, "start", Qt::QueuedConnection);
+
+  return job;
+}
+
+QNetworkReply* QAzureStorageRestApi::uploadFile(const QString& filePath, const QString& container, const QString& blobName, const QString& blobType, const int& timeoutInSec)
+{
+  // --- Getting file content ---
+  QByteArray fileContent;
+  QFile file(filePath);
+
+  if (file.open(QIODevice::ReadOnly))
+  {
+    fileContent = file.readAll();
   }
   else
   {
@@ -349,32 +804,216 @@ QNetworkReply* QAzureStorageRestApi::uploadFile(const QString& filePath, const Q
   return uploadFileQByteArray(fileContent, container, blobName, blobType, timeoutInSec);
 }
 
-QNetworkReply* QAzureStorageRestApi::deleteFile(const QString& container, const QString& blobName, const int& timeoutInSec)
+QNetworkReply* QAzureStorageRestApi::uploadBlock(const QString& container, const QString& blobName, const QString& blockId, const QByteArray& blockContent, const int& timeoutInSec,
+                                                 QAzureStorageBandwidthLimiter* bandwidthLimiter)
 {
-  QNetworkRequest request;
+  if (container.isEmpty() || blobName.isEmpty() || blockId.isEmpty() || blockContent.isEmpty())
+  {
+    return nullptr;
+  }
 
-  // --- Prepare the URL ---
-  QString additionalUrlParams = QString();
-  QString url = generateUrl(container, blobName, "", "", timeoutInSec, m_sasKey);
-  request.setUrl(QUrl(url));
-  // ------------------------
+  QMap<QString,QString> urlParameters;
+  urlParameters.insert("comp", "block");
+  urlParameters.insert("blockid", blockId);
 
-  // --- Adding Account key authentication if Account key enabled ---
-  QString currentDateTime = generateCurrentTimeUTC();
-  if (!m_accountKey.isEmpty())
+  // Checksum computed on the block only (while the other blocks of the file are transferred)
+  QMap<QString,QString> msHeaders;
+  QString contentMd5;
+  addTransactionalChecksum(blockContent, msHeaders, contentMd5);
+
+  QNetworkRequest request = generateRequest("PUT", container, blobName, urlParameters, msHeaders, blockContent.size(), timeoutInSec, contentMd5);
+
+  // Sending the request
+  return sendRequest("PutBlock", "PUT", request, blockContent, bandwidthLimiter != nullptr ? bandwidthLimiter : &m_uploadBandwidthLimiter);
+}
+
+QNetworkReply* QAzureStorageRestApi::commitBlockList(const QString& container, const QString& blobName, const QStringList& blockIds,
+                                                     const QString& blobContentEncoding, const int& timeoutInSec)
+{
+  if (container.isEmpty() || blobName.isEmpty())
   {
-    QString authorization = generateAutorizationHeader("DELETE", container, blobName, currentDateTime, 0);
-    request.setRawHeader(QByteArray("Authorization"), QByteArray(authorization.toStdString().c_str()));
+    return nullptr;
   }
-  // ------------------------
 
-  // --- Adding common header info ---
-  request.setRawHeader(QByteArray("x-ms-date"),QByteArray(currentDateTime.toStdString().c_str()));
-  request.setRawHeader(QByteArray("x-ms-version"),QByteArray(m_version.toStdString().c_str()));
+  // --- Prepare the block list ---
+  QByteArray blockList("<?xml version=\"1.0\" encoding=\"utf-8\"?><BlockList>");
+  for (const QString& blockId : blockIds)
+  {
+    blockList.append("<Latest>" + blockId.toLatin1() + "</Latest>");
+  }
+  blockList.append("</BlockList>");
   // ------------------------
 
+  QMap<QString,QString> urlParameters;
+  urlParameters.insert("comp", "blocklist");
+
+  QMap<QString,QString> msHeaders;
+  if (!blobContentEncoding.isEmpty())
+  {
+    msHeaders.insert("x-ms-blob-content-encoding", blobContentEncoding);
+  }
+
+  QNetworkRequest request = generateRequest("PUT", container, blobName, urlParameters, msHeaders, blockList.size(), timeoutInSec);
+
+  // Sending the request
+  return sendRequest("PutBlockList", "PUT", request, blockList);
+}
+
+QNetworkReply* QAzureStorageRestApi::getBlockList(const QString& container, const QString& blobName, const QString& blockListType, const int& timeoutInSec)
+{
+  if (container.isEmpty() || blobName.isEmpty())
+  {
+    return nullptr;
+  }
+
+  QMap<QString,QString> urlParameters;
+  urlParameters.insert("comp", "blocklist");
+  urlParameters.insert("blocklisttype", blockListType);
+
+  QNetworkRequest request = generateRequest("GET", container, blobName, urlParameters, QMap<QString,QString>(), 0, timeoutInSec);
+
+  // Sending the request
+  return sendRequest("GetBlockList", "GET", request);
+}
+
+QNetworkReply* QAzureStorageRestApi::createAppendBlob(const QString& container, const QString& blobName, const int& timeoutInSec)
+{
+  if (container.isEmpty() || blobName.isEmpty())
+  {
+    return nullptr;
+  }
+
+  QMap<QString,QString> msHeaders;
+  msHeaders.insert("x-ms-blob-type", "AppendBlob");
+
+  QNetworkRequest request = generateRequest("PUT", container, blobName, QMap<QString,QString>(), msHeaders, 0, timeoutInSec);
+
+  // Sending the request
+  return sendRequest("PutBlob", "PUT", request);
+}
+
+QNetworkReply* QAzureStorageRestApi::appendBlock(const QString& container, const QString& blobName, const QByteArray& blockContent,
+                                                 const qint64& appendPosition, const int& timeoutInSec)
+{
+  if (container.isEmpty() || blobName.isEmpty() || blockContent.isEmpty())
+  {
+    return nullptr;
+  }
+
+  QMap<QString,QString> urlParameters;
+  urlParameters.insert("comp", "appendblock");
+
+  QMap<QString,QString> msHeaders;
+  QString contentMd5;
+  addTransactionalChecksum(blockContent, msHeaders, contentMd5);
+  if (appendPosition >= 0)
+  {
+    msHeaders.insert("x-ms-blob-condition-appendpos", QString::number(appendPosition));
+  }
+
+  QNetworkRequest request = generateRequest("PUT", container, blobName, urlParameters, msHeaders, blockContent.size(), timeoutInSec, contentMd5);
+
+  // Sending the request
+  return sendRequest("AppendBlock", "PUT", request, blockContent, &m_uploadBandwidthLimiter);
+}
+
+QAzureStorageUploadJob* QAzureStorageRestApi::uploadFileInBlocks(const QString& filePath, const QString& container, const QString& blobName,
+                                                                const qint64& blockSizeInBytes, const int& maxParallelBlocks,
+                                                                const QString& journalPath, const int& timeoutInSec)
+{
+  if (container.isEmpty() || blobName.isEmpty() || blockSizeInBytes <= 0 || maxParallelBlocks <= 0 || !QFileInfo(filePath).isFile())
+  {
+    return nullptr;
+  }
+
+  QAzureStorageUploadJob* job = new QAzureStorageUploadJob(this, filePath, container, blobName, blockSizeInBytes, maxParallelBlocks, journalPath, timeoutInSec, this);
+
+  // Started from the event loop so that the caller can connect to the job signals first
+  QMetaObject::invokeMethod(job, "start", Qt::QueuedConnection);
+
+  return job;
+}
+
+QNetworkReply* QAzureStorageRestApi::createPageBlob(const QString& container, const QString& blobName, const qint64& blobSizeInBytes, const int& timeoutInSec)
+{
+  if (container.isEmpty() || blobName.isEmpty() || blobSizeInBytes < 0 || blobSizeInBytes % 512 != 0)
+  {
+    return nullptr;
+  }
+
+  QMap<QString,QString> msHeaders;
+  msHeaders.insert("x-ms-blob-type", "PageBlob");
+  msHeaders.insert("x-ms-blob-content-length", QString::number(blobSizeInBytes));
+
+  QNetworkRequest request = generateRequest("PUT", container, blobName, QMap<QString,QString>(), msHeaders, 0, timeoutInSec);
+
+  // Sending the request
+  return sendRequest("PutBlob", "PUT", request);
+}
+
+QNetworkReply* QAzureStorageRestApi::uploadPages(const QString& container, const QString& blobName, const qint64& offset, const QByteArray& pagesContent,
+                                                 const int& timeoutInSec, QAzureStorageBandwidthLimiter* bandwidthLimiter)
+{
+  if (container.isEmpty() || blobName.isEmpty() || offset < 0 || offset % 512 != 0 || pagesContent.isEmpty() || pagesContent.size() % 512 != 0)
+  {
+    return nullptr;
+  }
+
+  QMap<QString,QString> urlParameters;
+  urlParameters.insert("comp", "page");
+
+  QMap<QString,QString> msHeaders;
+  QString contentMd5;
+  addTransactionalChecksum(pagesContent, msHeaders, contentMd5);
+  msHeaders.insert("x-ms-page-write", "update");
+  msHeaders.insert("x-ms-range", QString("bytes=%1-%2").arg(offset).arg(offset + pagesContent.size() - 1));
+
+  QNetworkRequest request = generateRequest("PUT", container, blobName, urlParameters, msHeaders, pagesContent.size(), timeoutInSec, contentMd5);
+
+  // Sending the request
+  return sendRequest("PutPage", "PUT", request, pagesContent, bandwidthLimiter != nullptr ? bandwidthLimiter : &m_uploadBandwidthLimiter);
+}
+
+QAzureStoragePageBlobUploadJob* QAzureStorageRestApi::uploadFileAsPageBlob(const QString& filePath, const QString& container, const QString& blobName,
+                                                                          const int& maxParallelRanges, const int& timeoutInSec)
+{
+  if (container.isEmpty() || blobName.isEmpty() || maxParallelRanges <= 0 || !QFileInfo(filePath).isFile())
+  {
+    return nullptr;
+  }
+
+  QAzureStoragePageBlobUploadJob* job = new QAzureStoragePageBlobUploadJob(this, filePath, container, blobName, maxParallelRanges, timeoutInSec, this);
+
+  // Started from the event loop so that the caller can connect to the job signals first
+  QMetaObject::invokeMethod(job, "start", Qt::QueuedConnection);
+
+  return job;
+}
+
+QAzureStorageDirectoryUploadJob* QAzureStorageRestApi::uploadDirectory(const QString& localPath, const QString& container, const QString& prefix,
+                                                                      const int& maxParallelRequests, const qint64& singlePutMaxSizeInBytes,
+                                                                      const qint64& blockSizeInBytes, const int& maxParallelBlocks, const int& timeoutInSec)
+{
+  if (container.isEmpty() || maxParallelRequests <= 0 || singlePutMaxSizeInBytes < 0 || blockSizeInBytes <= 0 || maxParallelBlocks <= 0 || !QFileInfo(localPath).isDir())
+  {
+    return nullptr;
+  }
+
+  QAzureStorageDirectoryUploadJob* job = new QAzureStorageDirectoryUploadJob(this, localPath, container, prefix, maxParallelRequests, singlePutMaxSizeInBytes,
+                                                                             blockSizeInBytes, maxParallelBlocks, timeoutInSec, this);
+
+  // Started from the event loop so that the caller can connect to the job signals first
+  QMetaObject::invokeMethod(job, "start", Qt::QueuedConnection);
+
+  return job;
+}
+
+QNetworkReply* QAzureStorageRestApi::deleteFile(const QString& container, const QString& blobName, const int& timeoutInSec)
+{
+  QNetworkRequest request = generateRequest("DELETE", container, blobName, QMap<QString,QString>(), QMap<QString,QString>(), 0, timeoutInSec);
+
   // Sending the request
-  return m_manager->deleteResource(request);
+  return sendRequest("DeleteBlob", "DELETE", request);
 }
 
 // ------------------------------------- PUBLIC SYNCHRONOUS -------------------------------------
@@ -395,14 +1034,14 @@ QNetworkReply::NetworkError QAzureStorageRestApi::listContainersSynchronous(QLis
 {
   if (timeoutInSec <= 0)
   {
-    qWarning() << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
     return QNetworkReply::NetworkError::UnknownNetworkError;
   }
 
   QNetworkReply* reply = listContainers(marker, forceTimeoutOnApi ? timeoutInSec : -1);
   if (reply == nullptr)
   {
-    qWarning() << "[QAzureStorageRestApi] No valid reply";
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] No valid reply";
     return QNetworkReply::NetworkError::UnknownNetworkError;
   }
 
@@ -419,7 +1058,7 @@ QNetworkReply::NetworkError QAzureStorageRestApi::listContainersSynchronous(QLis
                        }
 
                        result = reply->error();
-                       qDebug() <<"Returned code " << QString::number(result) << ", is valid answer: " << (isErrorCodeSuccess(result) ? "True" : "False");
+                       qCDebug(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Returned code" << result << "is valid answer:" << isErrorCodeSuccess(result);
 
                        try
                        {
@@ -427,7 +1066,7 @@ QNetworkReply::NetworkError QAzureStorageRestApi::listContainersSynchronous(QLis
                        }
                        catch (...)
                        {
-                          qWarning() << "[QAzureStorageRestApi] Failed to parse container list";
+                          qCWarning(lcAzureStorageParse) << "[QAzureStorageRestApi] Failed to parse container list";
 
                        }
 
@@ -447,18 +1086,19 @@ QNetworkReply::NetworkError QAzureStorageRestApi::listContainersSynchronous(QLis
   return result;
 }
 
-QNetworkReply::NetworkError QAzureStorageRestApi::listFilesSynchronous(const QString& container, QList< QMap<QString,QString> >& foundListOfFiles, const QString& marker, const QString& prefix, const int& maxResults, const int& timeoutInSec, const bool& forceTimeoutOnApi)
+QNetworkReply::NetworkError QAzureStorageRestApi::listFilesSynchronous(const QString& container, QList< QMap<QString,QString> >& foundListOfFiles, const QString& marker, const QString& prefix, const int& maxResults, const int& timeoutInSec, const bool& forceTimeoutOnApi,
+                                                                        const QString& delimiter, QStringList* foundBlobPrefixes, const ListIncludeOptions& include)
 {
   if (timeoutInSec <= 0)
   {
-    qWarning() << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
     return QNetworkReply::NetworkError::UnknownNetworkError;
   }
 
-  QNetworkReply* reply = listFiles(container, marker, prefix, maxResults, forceTimeoutOnApi ? timeoutInSec : -1);
+  QNetworkReply* reply = listFiles(container, marker, prefix, maxResults, forceTimeoutOnApi ? timeoutInSec : -1, delimiter, include);
   if (reply == nullptr)
   {
-    qWarning() << "[QAzureStorageRestApi] No valid reply";
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] No valid reply";
     return QNetworkReply::NetworkError::UnknownNetworkError;
   }
 
@@ -466,7 +1106,7 @@ QNetworkReply::NetworkError QAzureStorageRestApi::listFilesSynchronous(const QSt
   QNetworkReply::NetworkError result = QNetworkReply::NetworkError::TimeoutError;
 
   QObject::connect(reply, &QNetworkReply::finished,
-                   [&loop, &result, &reply, &foundListOfFiles]()
+                   [&loop, &result, &reply, &foundListOfFiles, foundBlobPrefixes]()
                    {
                        if (reply == nullptr) {
                            result = QNetworkReply::NetworkError::UnknownNetworkError;
@@ -475,15 +1115,15 @@ QNetworkReply::NetworkError QAzureStorageRestApi::listFilesSynchronous(const QSt
                        }
 
                        result = reply->error();
-                       qDebug() <<"Returned code " << QString::number(result) << ", is valid answer: " << (isErrorCodeSuccess(result) ? "True" : "False");
+                       qCDebug(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Returned code" << result << "is valid answer:" << isErrorCodeSuccess(result);
 
                        try
                        {
-                           foundListOfFiles = QAzureStorageRestApi::parseFileList(reply->readAll().data());
+                           foundListOfFiles = QAzureStorageRestApi::parseFileList(reply->readAll().data(), nullptr, foundBlobPrefixes);
                        }
                        catch (...)
                        {
-                          qWarning() << "[QAzureStorageRestApi] Failed to parse file list";
+                          qCWarning(lcAzureStorageParse) << "[QAzureStorageRestApi] Failed to parse file list";
                        }
 
                        reply->deleteLater();
@@ -502,54 +1142,134 @@ QNetworkReply::NetworkError QAzureStorageRestApi::listFilesSynchronous(const QSt
   return result;
 }
 
-QNetworkReply::NetworkError QAzureStorageRestApi::uploadFileSynchronous(const QString& filePath, const QString& container, const QString& blobName, const QString& blobType, const int& timeoutInSec, const bool& forceTimeoutOnApi)
+QNetworkReply::NetworkError QAzureStorageRestApi::walkFilesSynchronous(const QString& container, QList< QMap<QString,QString> >& foundListOfFiles, QStringList* foundFolders,
+                                                                        const QString& prefix, const QString& delimiter, const int& maxDepth,
+                                                                        const int& maxParallelListings, const int& timeoutInSec, const bool& forceTimeoutOnApi)
 {
-  // --- Getting file content ---
-  QByteArray fileContent;
-  QFile file(filePath);
+  if (timeoutInSec <= 0)
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
+    return QNetworkReply::NetworkError::UnknownNetworkError;
+  }
 
-  if (file.open(QIODevice::ReadOnly))
+  foundListOfFiles.clear();
+  if (foundFolders != nullptr)
   {
-    fileContent = file.readAll();
+    foundFolders->clear();
   }
-  else
+
+  QAzureStorageListJob* job = walkFiles(container, prefix, delimiter, maxDepth, maxParallelListings, forceTimeoutOnApi ? timeoutInSec : -1);
+  if (job != nullptr)
   {
-    return QNetworkReply::NetworkError::UnknownNetworkError;
+    QObject::connect(job, &QAzureStorageListJob::filesListed,
+                     [&foundListOfFiles](const QString&, const QList< QMap<QString,QString> >& files) { foundListOfFiles.append(files); });
+    QObject::connect(job, &QAzureStorageListJob::folderFound,
+                     [foundFolders](const QString& folder, int) { if (foundFolders != nullptr) { foundFolders->append(folder); } });
   }
-  // ------------------------
 
-  // Returning the upload result
-  return uploadFileQByteArraySynchronous(fileContent, container, blobName, blobType, forceTimeoutOnApi ? timeoutInSec : -1);
+  return waitForJob(job, timeoutInSec);
 }
 
-QNetworkReply::NetworkError QAzureStorageRestApi::uploadFileQByteArraySynchronous(const QByteArray& fileContent, const QString& container, const QString& blobName, const QString& blobType, const int& timeoutInSec, const bool& forceTimeoutOnApi)
+QNetworkReply::NetworkError QAzureStorageRestApi::listFilesParallelSynchronous(const QString& container, QList< QMap<QString,QString> >& foundListOfFiles, bool* isComplete,
+                                                                                const QString& prefix, const QString& partitionAlphabet,
+                                                                                const QString& delimiter, const int& maxParallelListings,
+                                                                                const int& timeoutInSec, const bool& forceTimeoutOnApi)
 {
   if (timeoutInSec <= 0)
   {
-    qWarning() << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
     return QNetworkReply::NetworkError::UnknownNetworkError;
   }
 
-  QNetworkReply* reply = uploadFileQByteArray(fileContent, container, blobName, blobType, forceTimeoutOnApi ? timeoutInSec : -1);
-  if (reply == nullptr)
+  foundListOfFiles.clear();
+  if (isComplete != nullptr)
   {
-    qWarning() << "[QAzureStorageRestApi] No valid reply";
-    return QNetworkReply::NetworkError::UnknownNetworkError;
+    *isComplete = false;
   }
 
-  QEventLoop loop;
-  QNetworkReply::NetworkError result = QNetworkReply::NetworkError::TimeoutError;
-  QObject::connect(reply, &QNetworkReply::finished,
-                   [&loop, &result, &reply]()
-                   {
-                       if (reply == nullptr) {
-                           result = QNetworkReply::NetworkError::UnknownNetworkError;
-                           loop.exit();
-                           return;
-                       }
+  QAzureStoragePartitionedListJob* job = listFilesParallel(container, prefix, partitionAlphabet, delimiter, maxParallelListings, forceTimeoutOnApi ? timeoutInSec : -1);
+  if (job != nullptr)
+  {
+    QObject::connect(job, &QAzureStoragePartitionedListJob::filesListed,
+                     [&foundListOfFiles](const QList< QMap<QString,QString> >& files) { foundListOfFiles.append(files); });
+    QObject::connect(job, &QAzureStorageJob::finished,
+                     [job, isComplete](QNetworkReply::NetworkError) { if (isComplete != nullptr) { *isComplete = job->isComplete(); } });
+  }
 
-                       result = reply->error();
-                       qDebug() <<"Returned code " << QString::number(result) << ", is valid answer: " << (isErrorCodeSuccess(result) ? "True" : "False");
+  return waitForJob(job, timeoutInSec);
+}
+
+QNetworkReply::NetworkError QAzureStorageRestApi::refreshInventorySynchronous(QAzureStorageInventory& inventory, const QString& prefix,
+                                                                               const int& maxParallelListings, const int& timeoutInSec,
+                                                                               const bool& forceTimeoutOnApi)
+{
+  if (!inventory.isEnabled() || inventory.container().isEmpty())
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Invalid parameter: inventory should be opened with its container.";
+    return QNetworkReply::NetworkError::UnknownNetworkError;
+  }
+
+  // A partial listing must never replace the files of the inventory (folder partitions found by Azure cover all the names,
+  // unlike the partitions of an alphabet)
+  QList< QMap<QString,QString> > files;
+  const QNetworkReply::NetworkError errorCode = listFilesParallelSynchronous(inventory.container(), files, nullptr, prefix, QString(), "/",
+                                                                             maxParallelListings, timeoutInSec, forceTimeoutOnApi);
+  if (!isErrorCodeSuccess(errorCode))
+  {
+    return errorCode;
+  }
+
+  return inventory.replacePrefix(prefix, files) ? errorCode : QNetworkReply::NetworkError::UnknownContentError;
+}
+
+QNetworkReply::NetworkError QAzureStorageRestApi::uploadFileSynchronous(const QString& filePath, const QString& container, const QString& blobName, const QString& blobType, const int& timeoutInSec, const bool& forceTimeoutOnApi)
+{
+  // --- Getting file content ---
+  QByteArray fileContent;
+  QFile file(filePath);
+
+  if (file.open(QIODevice::ReadOnly))
+  {
+    fileContent = file.readAll();
+  }
+  else
+  {
+    return QNetworkReply::NetworkError::UnknownNetworkError;
+  }
+  // ------------------------
+
+  // Returning the upload result
+  return uploadFileQByteArraySynchronous(fileContent, container, blobName, blobType, forceTimeoutOnApi ? timeoutInSec : -1);
+}
+
+QNetworkReply::NetworkError QAzureStorageRestApi::uploadFileQByteArraySynchronous(const QByteArray& fileContent, const QString& container, const QString& blobName, const QString& blobType, const int& timeoutInSec, const bool& forceTimeoutOnApi)
+{
+  if (timeoutInSec <= 0)
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
+    return QNetworkReply::NetworkError::UnknownNetworkError;
+  }
+
+  QNetworkReply* reply = uploadFileQByteArray(fileContent, container, blobName, blobType, forceTimeoutOnApi ? timeoutInSec : -1);
+  if (reply == nullptr)
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] No valid reply";
+    return QNetworkReply::NetworkError::UnknownNetworkError;
+  }
+
+  QEventLoop loop;
+  QNetworkReply::NetworkError result = QNetworkReply::NetworkError::TimeoutError;
+  QObject::connect(reply, &QNetworkReply::finished,
+                   [&loop, &result, &reply]()
+                   {
+                       if (reply == nullptr) {
+                           result = QNetworkReply::NetworkError::UnknownNetworkError;
+                           loop.exit();
+                           return;
+                       }
+
+                       result = reply->error();
+                       qCDebug(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Returned code" << result << "is valid answer:" << isErrorCodeSuccess(result);
 
                        reply->deleteLater();
                        reply = nullptr;
@@ -567,18 +1287,75 @@ QNetworkReply::NetworkError QAzureStorageRestApi::uploadFileQByteArraySynchronou
   return result;
 }
 
+QNetworkReply::NetworkError QAzureStorageRestApi::uploadFileInBlocksSynchronous(const QString& filePath, const QString& container, const QString& blobName,
+                                                                                const qint64& blockSizeInBytes, const int& maxParallelBlocks,
+                                                                                const QString& journalPath, const int& timeoutInSec,
+                                                                                const bool& forceTimeoutOnApi)
+{
+  if (timeoutInSec <= 0)
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
+    return QNetworkReply::NetworkError::UnknownNetworkError;
+  }
+
+  return waitForJob(uploadFileInBlocks(filePath, container, blobName, blockSizeInBytes, maxParallelBlocks, journalPath, forceTimeoutOnApi ? timeoutInSec : -1), timeoutInSec);
+}
+
+QNetworkReply::NetworkError QAzureStorageRestApi::uploadFileAsPageBlobSynchronous(const QString& filePath, const QString& container, const QString& blobName,
+                                                                                  const int& maxParallelRanges, const int& timeoutInSec,
+                                                                                  const bool& forceTimeoutOnApi)
+{
+  if (timeoutInSec <= 0)
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
+    return QNetworkReply::NetworkError::UnknownNetworkError;
+  }
+
+  return waitForJob(uploadFileAsPageBlob(filePath, container, blobName, maxParallelRanges, forceTimeoutOnApi ? timeoutInSec : -1), timeoutInSec);
+}
+
+QNetworkReply::NetworkError QAzureStorageRestApi::uploadDirectorySynchronous(const QString& localPath, const QString& container, const QString& prefix,
+                                                                             QMap<QString, QNetworkReply::NetworkError>* failedFiles,
+                                                                             const int& maxParallelRequests, const int& timeoutInSec,
+                                                                             const bool& forceTimeoutOnApi)
+{
+  if (timeoutInSec <= 0)
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
+    return QNetworkReply::NetworkError::UnknownNetworkError;
+  }
+
+  if (failedFiles != nullptr)
+  {
+    failedFiles->clear();
+  }
+
+  QAzureStorageDirectoryUploadJob* job = uploadDirectory(localPath, container, prefix, maxParallelRequests, 4 * 1024 * 1024, 4 * 1024 * 1024, 4,
+                                                         forceTimeoutOnApi ? timeoutInSec : -1);
+  if (job != nullptr)
+  {
+    QObject::connect(job, &QAzureStorageDirectoryUploadJob::fileUploaded,
+                     [failedFiles](const QString& relativePath, const QString&, QNetworkReply::NetworkError errorCode)
+                     {
+                         if (failedFiles != nullptr && !isErrorCodeSuccess(errorCode)) { failedFiles->insert(relativePath, errorCode); }
+                     });
+  }
+
+  return waitForJob(job, timeoutInSec);
+}
+
 QNetworkReply::NetworkError QAzureStorageRestApi::deleteFileSynchronous(const QString& container, const QString& blobName, const int& timeoutInSec, const bool& forceTimeoutOnApi)
 {
   if (timeoutInSec <= 0)
   {
-    qWarning() << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
     return QNetworkReply::NetworkError::UnknownNetworkError;
   }
 
   QNetworkReply* reply = deleteFile(container, blobName, forceTimeoutOnApi ? timeoutInSec : -1);
   if (reply == nullptr)
   {
-    qWarning() << "[QAzureStorageRestApi] No valid reply";
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] No valid reply";
     return QNetworkReply::NetworkError::UnknownNetworkError;
   }
 
@@ -595,7 +1372,7 @@ QNetworkReply::NetworkError QAzureStorageRestApi::deleteFileSynchronous(const QS
                        }
 
                        result = reply->error();
-                       qDebug() <<"Returned code " << QString::number(result) << ", is valid answer: " << (isErrorCodeSuccess(result) ? "True" : "False");
+                       qCDebug(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Returned code" << result << "is valid answer:" << isErrorCodeSuccess(result);
 
                        reply->deleteLater();
                        reply = nullptr;
@@ -617,14 +1394,14 @@ QNetworkReply::NetworkError QAzureStorageRestApi::downloadFileSynchronous(const
 {
   if (timeoutInSec <= 0)
   {
-    qWarning() << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
     return QNetworkReply::NetworkError::UnknownNetworkError;
   }
 
   QNetworkReply* reply = downloadFile(container, blobName, forceTimeoutOnApi ? timeoutInSec : -1);
   if (reply == nullptr)
   {
-    qWarning() << "[QAzureStorageRestApi] No valid reply";
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] No valid reply";
     return QNetworkReply::NetworkError::UnknownNetworkError;
   }
 
@@ -632,7 +1409,7 @@ QNetworkReply::NetworkError QAzureStorageRestApi::downloadFileSynchronous(const
   QNetworkReply::NetworkError result = QNetworkReply::NetworkError::TimeoutError;
 
   QObject::connect(reply, &QNetworkReply::finished,
-                   [&loop, &result, &reply, &downloadedFile]()
+                   [this, &loop, &result, &reply, &downloadedFile]()
                    {
                        if (reply == nullptr) {
                            result = QNetworkReply::NetworkError::UnknownNetworkError;
@@ -641,15 +1418,29 @@ QNetworkReply::NetworkError QAzureStorageRestApi::downloadFileSynchronous(const
                        }
 
                        result = reply->error();
-                       qDebug() <<"Returned code " << QString::number(result) << ", is valid answer: " << (isErrorCodeSuccess(result) ? "True" : "False");
+                       qCDebug(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Returned code" << result << "is valid answer:" << isErrorCodeSuccess(result);
 
                        try
                        {
-                           downloadedFile = reply->readAll().data();
+                           QByteArray content = reply->readAll();
+
+                           // Content-MD5 is only returned if Azure has the MD5 of the whole file, and it is the MD5 of the stored
+                           // bytes: content with a Content-Encoding (e.g. gzip) is already decoded by Qt and cannot be checked
+                           QByteArray expectedMd5 = reply->rawHeader("Content-MD5");
+                           QByteArray contentEncoding = reply->rawHeader("Content-Encoding").trimmed().toLower();
+                           bool isEncoded = !contentEncoding.isEmpty() && contentEncoding != "identity";
+                           if (m_transactionalChecksum != NoChecksum && isErrorCodeSuccess(result) && !expectedMd5.isEmpty() && !isEncoded &&
+                               QAzureStorageChecksum::md5ToBase64(content) != QString::fromLatin1(expectedMd5))
+                           {
+                               qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Downloaded file does not match its Content-MD5";
+                               result = QNetworkReply::NetworkError::UnknownContentError;
+                           }
+
+                           downloadedFile = content;
                        }
                        catch (...)
                        {
-                          qWarning() << "[QAzureStorageRestApi] Failed to read downloaded file";
+                          qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Failed to read downloaded file";
                        }
 
                        reply->deleteLater();
@@ -668,18 +1459,175 @@ QNetworkReply::NetworkError QAzureStorageRestApi::downloadFileSynchronous(const
   return result;
 }
 
+QNetworkReply::NetworkError QAzureStorageRestApi::downloadFileToPathSynchronous(const QString& container, const QString& blobName, const QString& filePath,
+                                                                                const qint64& rangeSizeInBytes, const int& maxParallelRanges,
+                                                                                const QString& journalPath, const int& timeoutInSec,
+                                                                                const bool& forceTimeoutOnApi)
+{
+  if (timeoutInSec <= 0)
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
+    return QNetworkReply::NetworkError::UnknownNetworkError;
+  }
+
+  return waitForJob(downloadFileToPath(container, blobName, filePath, rangeSizeInBytes, maxParallelRanges, journalPath, forceTimeoutOnApi ? timeoutInSec : -1), timeoutInSec);
+}
+
+QNetworkReply::NetworkError QAzureStorageRestApi::downloadPageBlobToPathSynchronous(const QString& container, const QString& blobName, const QString& filePath,
+                                                                                    const QString& prevSnapshot, const qint64& rangeSizeInBytes,
+                                                                                    const int& maxParallelRanges, const QString& journalPath,
+                                                                                    const int& timeoutInSec, const bool& forceTimeoutOnApi)
+{
+  if (timeoutInSec <= 0)
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
+    return QNetworkReply::NetworkError::UnknownNetworkError;
+  }
+
+  return waitForJob(downloadPageBlobToPath(container, blobName, filePath, prevSnapshot, rangeSizeInBytes, maxParallelRanges, journalPath,
+                                           forceTimeoutOnApi ? timeoutInSec : -1), timeoutInSec);
+}
+
+QNetworkReply::NetworkError QAzureStorageRestApi::downloadPrefixSynchronous(const QString& container, const QString& prefix, const QString& localPath,
+                                                                            QMap<QString, QNetworkReply::NetworkError>* failedFiles,
+                                                                            const int& maxParallelRequests, const int& timeoutInSec,
+                                                                            const bool& forceTimeoutOnApi)
+{
+  if (timeoutInSec <= 0)
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
+    return QNetworkReply::NetworkError::UnknownNetworkError;
+  }
+
+  if (failedFiles != nullptr)
+  {
+    failedFiles->clear();
+  }
+
+  QAzureStorageDirectoryDownloadJob* job = downloadPrefix(container, prefix, localPath, maxParallelRequests, 4 * 1024 * 1024, 4 * 1024 * 1024, 4,
+                                                          forceTimeoutOnApi ? timeoutInSec : -1);
+  if (job != nullptr)
+  {
+    QObject::connect(job, &QAzureStorageDirectoryDownloadJob::fileDownloaded,
+                     [failedFiles](const QString& blobName, const QString&, QNetworkReply::NetworkError errorCode)
+                     {
+                         if (failedFiles != nullptr && !isErrorCodeSuccess(errorCode)) { failedFiles->insert(blobName, errorCode); }
+                     });
+  }
+
+  return waitForJob(job, timeoutInSec);
+}
+
+QNetworkReply::NetworkError QAzureStorageRestApi::syncSynchronous(const QString& localPath, const QString& container, const QString& prefix,
+                                                                  const SyncDirection& direction, const bool& isDeletingExtraneous,
+                                                                  const QString& manifestPath, QMap<QString, QNetworkReply::NetworkError>* failedFiles,
+                                                                  const int& timeoutInSec, const bool& forceTimeoutOnApi)
+{
+  if (timeoutInSec <= 0)
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
+    return QNetworkReply::NetworkError::UnknownNetworkError;
+  }
+
+  if (failedFiles != nullptr)
+  {
+    failedFiles->clear();
+  }
+
+  QAzureStorageSyncJob* job = sync(localPath, container, prefix, direction, isDeletingExtraneous, manifestPath, 16, forceTimeoutOnApi ? timeoutInSec : -1);
+  if (job != nullptr)
+  {
+    QObject::connect(job, &QAzureStorageSyncJob::fileSynced,
+                     [failedFiles](const QString& relativePath, bool, QNetworkReply::NetworkError errorCode)
+                     {
+                         if (failedFiles != nullptr && !isErrorCodeSuccess(errorCode)) { failedFiles->insert(relativePath, errorCode); }
+                     });
+  }
+
+  return waitForJob(job, timeoutInSec);
+}
+
+QNetworkReply::NetworkError QAzureStorageRestApi::readChangeFeedSynchronous(const QString& cursorPath, QList<QVariantMap>& events, const QString& container,
+                                                                            const int& timeoutInSec, const bool& forceTimeoutOnApi)
+{
+  events.clear();
+  if (timeoutInSec <= 0)
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
+    return QNetworkReply::NetworkError::UnknownNetworkError;
+  }
+
+  QAzureStorageChangeFeedJob* job = readChangeFeed(cursorPath, container, forceTimeoutOnApi ? timeoutInSec : -1);
+  QObject::connect(job, &QAzureStorageChangeFeedJob::eventsReceived, [&events](const QList<QVariantMap>& receivedEvents) { events.append(receivedEvents); });
+
+  return waitForJob(job, timeoutInSec);
+}
+
+QNetworkReply::NetworkError QAzureStorageRestApi::setFileTagsSynchronous(const QString& container, const QString& blobName, const QMap<QString,QString>& tags,
+                                                                          const int& timeoutInSec, const bool& forceTimeoutOnApi)
+{
+  if (timeoutInSec <= 0)
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
+    return QNetworkReply::NetworkError::UnknownNetworkError;
+  }
+
+  return waitForReply(setFileTags(container, blobName, tags, forceTimeoutOnApi ? timeoutInSec : -1), timeoutInSec);
+}
+
+QNetworkReply::NetworkError QAzureStorageRestApi::getFileTagsSynchronous(const QString& container, const QString& blobName, QMap<QString,QString>& tags,
+                                                                          const int& timeoutInSec, const bool& forceTimeoutOnApi)
+{
+  if (timeoutInSec <= 0)
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
+    return QNetworkReply::NetworkError::UnknownNetworkError;
+  }
+
+  QByteArray content;
+  QNetworkReply::NetworkError result = waitForReply(getFileTags(container, blobName, forceTimeoutOnApi ? timeoutInSec : -1), timeoutInSec, &content);
+  if (isErrorCodeSuccess(result))
+  {
+    tags = parseTags(content);
+  }
+
+  return result;
+}
+
+QNetworkReply::NetworkError QAzureStorageRestApi::findFilesByTagsSynchronous(const QString& whereExpression, QList< QMap<QString,QString> >& foundListOfFiles,
+                                                                              const QString& container, const int& maxResultsPerPage,
+                                                                              const int& timeoutInSec, const bool& forceTimeoutOnApi)
+{
+  if (timeoutInSec <= 0)
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
+    return QNetworkReply::NetworkError::UnknownNetworkError;
+  }
+
+  foundListOfFiles.clear();
+
+  QAzureStorageFindByTagsJob* job = findAllFilesByTags(whereExpression, container, maxResultsPerPage, forceTimeoutOnApi ? timeoutInSec : -1);
+  if (job != nullptr)
+  {
+    QObject::connect(job, &QAzureStorageFindByTagsJob::filesFound,
+                     [&foundListOfFiles](const QList< QMap<QString,QString> >& files) { foundListOfFiles.append(files); });
+  }
+
+  return waitForJob(job, timeoutInSec);
+}
+
 QNetworkReply::NetworkError QAzureStorageRestApi::createContainerSynchronous(const QString& container, const int& timeoutInSec, const bool& forceTimeoutOnApi)
 {
   if (timeoutInSec <= 0)
   {
-    qWarning() << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
     return QNetworkReply::NetworkError::UnknownNetworkError;
   }
 
   QNetworkReply* reply = createContainer(container, forceTimeoutOnApi ? timeoutInSec : -1);
   if (reply == nullptr)
   {
-    qWarning() << "[QAzureStorageRestApi] No valid reply";
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] No valid reply";
     return QNetworkReply::NetworkError::UnknownNetworkError;
   }
 
@@ -696,7 +1644,7 @@ QNetworkReply::NetworkError QAzureStorageRestApi::createContainerSynchronous(con
                        }
 
                        result = reply->error();
-                       qDebug() <<"Returned code " << QString::number(result) << ", is valid answer: " << (isErrorCodeSuccess(result) ? "True" : "False");
+                       qCDebug(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Returned code" << result << "is valid answer:" << isErrorCodeSuccess(result);
 
                        reply->deleteLater();
                        reply = nullptr;
@@ -718,14 +1666,14 @@ QNetworkReply::NetworkError QAzureStorageRestApi::deleteContainerSynchronous(con
 {
   if (timeoutInSec <= 0)
   {
-    qWarning() << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Invalid parameter: timeoutInSec should be positive.";
     return QNetworkReply::NetworkError::UnknownNetworkError;
   }
 
   QNetworkReply* reply = deleteContainer(container, leaseId, forceTimeoutOnApi ? timeoutInSec : -1);
   if (reply == nullptr)
   {
-    qWarning() << "[QAzureStorageRestApi] No valid reply";
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] No valid reply";
     return QNetworkReply::NetworkError::UnknownNetworkError;
   }
 
@@ -742,7 +1690,7 @@ QNetworkReply::NetworkError QAzureStorageRestApi::deleteContainerSynchronous(con
                        }
 
                        result = reply->error();
-                       qDebug() <<"Returned code " << QString::number(result) << ", is valid answer: " << (isErrorCodeSuccess(result) ? "True" : "False");
+                       qCDebug(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Returned code" << result << "is valid answer:" << isErrorCodeSuccess(result);
 
                        reply->deleteLater();
                        reply = nullptr;
@@ -769,87 +1717,603 @@ QList< QMap<QString,QString> > QAzureStorageRestApi::parseContainerList(const QB
 }
 
 QList< QMap<QString,QString> > QAzureStorageRestApi::parseFileList(const QByteArray& xmlFileList,
-                                                                   QString* NextMarker)
+                                                                   QString* NextMarker, QStringList* BlobPrefixes)
 {
-  return parseObjectList("Blob", xmlFileList, NextMarker);
+  return parseObjectList("Blob", xmlFileList, NextMarker, BlobPrefixes);
+}
+
+QList< QMap<QString,QString> > QAzureStorageRestApi::parseBlockList(const QByteArray& xmlBlockList)
+{
+  QList< QMap<QString,QString> > blocks;
+  QMap<QString,QString> block;
+  QString blockType;
+  QXmlStreamReader xmlReader(xmlBlockList);
+
+  while(!xmlReader.atEnd() && !xmlReader.hasError())
+  {
+    QXmlStreamReader::TokenType token = xmlReader.readNext();
+    QString name = xmlReader.name().toString();
+
+    if (token == QXmlStreamReader::StartElement)
+    {
+      if (name == "CommittedBlocks")
+      {
+        blockType = "Committed";
+      }
+      else if (name == "UncommittedBlocks")
+      {
+        blockType = "Uncommitted";
+      }
+      else if (name == "Block")
+      {
+        block.clear();
+        block.insert("Type", blockType);
+      }
+      else if (name == "Name" || name == "Size")
+      {
+        block.insert(name, xmlReader.readElementText());
+      }
+    }
+    else if (token == QXmlStreamReader::EndElement && name == "Block")
+    {
+      blocks.append(block);
+    }
+  }
+
+  if (xmlReader.hasError())
+  {
+    qCDebug(lcAzureStorageParse) << "[QAzureStorageRestApi] Invalid block list:" << xmlReader.errorString();
+  }
+
+  return blocks;
+}
+
+QList< QMap<QString,QString> > QAzureStorageRestApi::parsePageRanges(const QByteArray& xmlPageRanges, QString* NextMarker)
+{
+  QList< QMap<QString,QString> > ranges;
+  QMap<QString,QString> range;
+  QXmlStreamReader xmlReader(xmlPageRanges);
+
+  while(!xmlReader.atEnd() && !xmlReader.hasError())
+  {
+    QXmlStreamReader::TokenType token = xmlReader.readNext();
+    QString name = xmlReader.name().toString();
+
+    if (token == QXmlStreamReader::StartElement)
+    {
+      if (name == "PageRange" || name == "ClearRange")
+      {
+        range.clear();
+        range.insert("Type", name);
+      }
+      else if (name == "Start" || name == "End")
+      {
+        range.insert(name, xmlReader.readElementText());
+      }
+      else if (name == "NextMarker" && NextMarker != nullptr)
+      {
+        *NextMarker = xmlReader.readElementText();
+      }
+    }
+    else if (token == QXmlStreamReader::EndElement && (name == "PageRange" || name == "ClearRange"))
+    {
+      ranges.append(range);
+    }
+  }
+
+  if (xmlReader.hasError())
+  {
+    qCDebug(lcAzureStorageParse) << "[QAzureStorageRestApi] Invalid page ranges:" << xmlReader.errorString();
+  }
+
+  return ranges;
+}
+
+QMap<QString,QString> QAzureStorageRestApi::parseTags(const QByteArray& xmlTags)
+{
+  QMap<QString,QString> tags;
+  QString tagKey;
+  QXmlStreamReader xmlReader(xmlTags);
+
+  while(!xmlReader.atEnd() && !xmlReader.hasError())
+  {
+    QXmlStreamReader::TokenType token = xmlReader.readNext();
+    QString name = xmlReader.name().toString();
+
+    if (token == QXmlStreamReader::StartElement)
+    {
+      if (name == "Key")
+      {
+        tagKey = xmlReader.readElementText();
+      }
+      else if (name == "Value")
+      {
+        tags.insert(tagKey, xmlReader.readElementText());
+      }
+    }
+  }
+
+  if (xmlReader.hasError())
+  {
+    qCDebug(lcAzureStorageParse) << "[QAzureStorageRestApi] Invalid index tags:" << xmlReader.errorString();
+  }
+
+  return tags;
+}
+
+QDateTime QAzureStorageRestApi::parseDateTime(const QString& httpDate)
+{
+  const QDateTime dateTime = QLocale(QLocale::English).toDateTime(httpDate, "ddd, dd MMM yyyy hh:mm:ss 'GMT'");
+  if (!dateTime.isValid())
+  {
+    return QDateTime();
+  }
+
+  return QDateTime(dateTime.date(), dateTime.time(), QTimeZone::utc());
 }
 
 // ------------------------------------- PRIVATE -------------------------------------
 
-QList< QMap<QString,QString> > QAzureStorageRestApi::parseObjectList(const char* tag, const QByteArray& data, QString* NextMarker)
+QList< QMap<QString,QString> > QAzureStorageRestApi::parseObjectList(const char* tag, const QByteArray& data, QString* NextMarker, QStringList* BlobPrefixes)
 {
   QList< QMap<QString,QString> > objs;
+  QMap<QString,QString> obj;
+  bool isInObject = false;
+  QString section;    // "Metadata" or "Tags" while reading their content
+  QString leafName;   // Element being read (if it has no child element)
+  QString leafText;
+  QString tagKey;
   QXmlStreamReader xmlReader(data);
 
   while(!xmlReader.atEnd() && !xmlReader.hasError())
   {
     QXmlStreamReader::TokenType token = xmlReader.readNext();
+    QString name = xmlReader.name().toString();
 
-    if(token == QXmlStreamReader::StartElement)
+    if (!isInObject)
     {
+      if (token != QXmlStreamReader::StartElement)
+      {
+        continue;
+      }
+
       // Enter in a object
-      if (xmlReader.name().toString().toStdString() == tag)
+      if (name == tag)
       {
-          QMap<QString, QString> obj;
+        isInObject = true;
+        obj.clear();
+        section.clear();
+        leafName.clear();
+      }
+      // Virtual "folder" (only received when listing with a delimiter)
+      else if (BlobPrefixes && name == "BlobPrefix")
+      {
+        while(!(xmlReader.tokenType() == QXmlStreamReader::EndElement && xmlReader.name().toString() == "BlobPrefix") &&
+              !xmlReader.atEnd() && !xmlReader.hasError())
+        {
+          xmlReader.readNext();
 
-          // Get all data in the object
-          while(!(xmlReader.tokenType() == QXmlStreamReader::EndElement &&
-                   xmlReader.name().toString().toStdString() == tag) &&
-                 xmlReader.tokenType() != QXmlStreamReader::TokenType::Invalid)
+          if (xmlReader.tokenType() == QXmlStreamReader::StartElement && xmlReader.name().toString() == "Name")
           {
-              xmlReader.readNext();
-
-              if (xmlReader.tokenType() == QXmlStreamReader::StartElement)
-              {
-                  if (xmlReader.name().toString().toStdString() != "Properties")
-                  {
-                      QString key = xmlReader.name().toString();
-                      QString content;
-
-                      xmlReader.readNext();
-
-                      while (xmlReader.tokenType() == QXmlStreamReader::StartElement)
-                      {
-                          key = xmlReader.name().toString();
-                          xmlReader.readNext();
-                      }
-
-                      if (xmlReader.tokenType() == QXmlStreamReader::Characters)
-                      {
-                          content = xmlReader.text().toString();
-                      }
-                      else if (xmlReader.tokenType() != QXmlStreamReader::EndElement)
-                      {
-                          return QList< QMap<QString,QString> >();
-                      }
-
-                      obj.insert(key, content);
-                  }
-              }
+            BlobPrefixes->append(xmlReader.readElementText());
           }
+        }
+      }
+      else if (NextMarker && name == "NextMarker")
+      {
+        *NextMarker = xmlReader.readElementText();
+      }
+      continue;
+    }
 
-          objs.append(obj);
+    // Properties are flattened in the object, metadata and tags are prefixed ("Metadata:<name>", "Tags:<key>")
+    if (token == QXmlStreamReader::StartElement)
+    {
+      if (name == "Metadata" || name == "Tags")
+      {
+        section = name;
+      }
+      leafName = name;
+      leafText.clear();
+    }
+    else if (token == QXmlStreamReader::Characters && !leafName.isEmpty())
+    {
+      leafText += xmlReader.text().toString();
+    }
+    else if (token == QXmlStreamReader::EndElement)
+    {
+      if (name == tag)
+      {
+        objs.append(obj);
+        isInObject = false;
       }
-      else if (NextMarker && xmlReader.name().toString().toStdString() == "NextMarker")
+      else if (name == section)
       {
-          while(!(xmlReader.tokenType() == QXmlStreamReader::EndElement &&
-                   xmlReader.name().toString().toStdString() == "NextMarker") &&
-                 xmlReader.tokenType() != QXmlStreamReader::TokenType::Invalid)
+        section.clear();
+      }
+      else if (name == leafName)
+      {
+        if (section == "Metadata")
+        {
+          obj.insert("Metadata:" + name, leafText);
+        }
+        else if (section == "Tags")
+        {
+          if (name == "Key")
           {
-              xmlReader.readNext();
-
-              if (xmlReader.tokenType() == QXmlStreamReader::Characters)
-              {
-                  *NextMarker = xmlReader.text().toString();
-              }
+            tagKey = leafText;
           }
+          else if (name == "Value")
+          {
+            obj.insert("Tags:" + tagKey, leafText);
+          }
+        }
+        else
+        {
+          obj.insert(name, leafText);
+        }
       }
+      leafName.clear();
     }
   }
 
+  if (xmlReader.hasError())
+  {
+    qCDebug(lcAzureStorageParse) << "[QAzureStorageRestApi] Invalid" << tag << "list:" << xmlReader.errorString();
+  }
+
   return objs;
 }
 
+QNetworkReply::NetworkError QAzureStorageRestApi::waitForJob(QAzureStorageJob* job, const int& timeoutInSec)
+{
+  if (job == nullptr)
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] No valid job";
+    return QNetworkReply::NetworkError::UnknownNetworkError;
+  }
+
+  QEventLoop loop;
+  QNetworkReply::NetworkError result = QNetworkReply::NetworkError::TimeoutError;
+
+  QObject::connect(job, &QAzureStorageJob::finished, &loop,
+                   [&loop, &result](QNetworkReply::NetworkError errorCode)
+                   {
+                       result = errorCode;
+                       qCDebug(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Returned code" << result << "is valid answer:" << isErrorCodeSuccess(result);
+                       loop.exit();
+                   }
+                   );
+
+  QTimer::singleShot(timeoutInSec * 1000, &loop, SLOT(exit()));
+  loop.exec();
+
+  // Stop the remaining requests if timeout reached (without overriding the timeout result)
+  QObject::disconnect(job, nullptr, &loop, nullptr);
+  job->abort();
+  job->deleteLater();
+
+  return result;
+}
+
+QNetworkReply::NetworkError QAzureStorageRestApi::waitForReply(QNetworkReply* reply, const int& timeoutInSec, QByteArray* content)
+{
+  if (reply == nullptr)
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageRestApi] No valid reply";
+    return QNetworkReply::NetworkError::UnknownNetworkError;
+  }
+
+  QEventLoop loop;
+  QNetworkReply::NetworkError result = QNetworkReply::NetworkError::TimeoutError;
+
+  QObject::connect(reply, &QNetworkReply::finished, &loop,
+                   [&loop, &result, reply, content]()
+                   {
+                       result = reply->error();
+                       qCDebug(lcAzureStorageTransfer) << "[QAzureStorageRestApi] Returned code" << result << "is valid answer:" << isErrorCodeSuccess(result);
+                       if (content != nullptr)
+                       {
+                         *content = reply->readAll();
+                       }
+                       loop.exit();
+                   }
+                   );
+
+  QTimer::singleShot(timeoutInSec * 1000, &loop, SLOT(exit()));
+  loop.exec();
+
+  // Stop the request if timeout reached (without overriding the timeout result)
+  QObject::disconnect(reply, nullptr, &loop, nullptr);
+  reply->abort();
+  reply->deleteLater();
+
+  return result;
+}
+
+QNetworkRequest QAzureStorageRestApi::generateRequest(const QString& httpVerb, const QString& container, const QString& blobName,
+                                                     const QMap<QString,QString>& urlParameters, const QMap<QString,QString>& msHeaders,
+                                                     const qint64& contentLength, const int& timeoutInSec, const QString& contentMd5)
+{
+  QElapsedTimer buildTimer;
+  buildTimer.start();
+  QNetworkRequest request;
+
+  // --- Prepare the URL (endpoint and SAS credentials prepared once in updateCredentials) ---
+  QString resourcePath = container;
+  if (!blobName.isEmpty())
+  {
+    resourcePath.append("/" + QUrl::toPercentEncoding(blobName, "/"));
+  }
+
+  // The timeout is a URL parameter like the others: it must be signed too
+  QMap<QString,QString> allUrlParameters = urlParameters;
+  if (timeoutInSec > 0)
+  {
+    allUrlParameters.insert("timeout", QString::number(timeoutInSec));
+  }
+
+  QStringList additionalUrlParams;
+  QStringList additionnalCanonicalRessources;
+  for (QMap<QString,QString>::const_iterator it = allUrlParameters.constBegin(); it != allUrlParameters.constEnd(); ++it)
+  {
+    additionalUrlParams.append(it.key() + "=" + QString(QUrl::toPercentEncoding(it.value())));
+    additionnalCanonicalRessources.append(it.key() + ":" + it.value());
+  }
+  if (!m_sasQuery.isEmpty())
+  {
+    additionalUrlParams.append(m_sasQuery);
+  }
+
+  QString url = m_blobEndpoint + resourcePath;
+  if (!additionalUrlParams.isEmpty())
+  {
+    url.append("?" + additionalUrlParams.join("&"));
+  }
+  request.setUrl(QUrl(url));
+  // ------------------------
+
+  // --- Adding the client request id of the traced requests (x-ms- header: signed like the others) ---
+  QMap<QString,QString> allMsHeaders = msHeaders;
+  if (m_tracer != nullptr)
+  {
+    allMsHeaders.insert(QString::fromLatin1(msClientRequestIdHeaderName), QUuid::createUuid().toString().mid(1, 36));
+  }
+  // ------------------------
+
+  // --- Adding Account key authentication if Account key enabled ---
+  QString currentDateTime = generateCurrentTimeUTC();
+  if (!m_accountKey.isEmpty())
+  {
+    QStringList additionalCanonicalHeaders;
+    for (QMap<QString,QString>::const_iterator it = allMsHeaders.constBegin(); it != allMsHeaders.constEnd(); ++it)
+    {
+      additionalCanonicalHeaders.append(it.key() + ":" + it.value());
+    }
+
+    QByteArray authorization = generateAutorizationHeader(httpVerb, resourcePath, currentDateTime, contentLength, additionalCanonicalHeaders, additionnalCanonicalRessources, contentMd5);
+    request.setRawHeader(authorizationHeaderName, authorization);
+    qCDebug(lcAzureStorageAuth) << "[QAzureStorageRestApi] Signed" << httpVerb << resourcePath << "with the account key";
+  }
+  // ------------------------
+
+  // --- Adding request specific header info ---
+  if (!contentMd5.isEmpty())
+  {
+    request.setRawHeader(contentMd5HeaderName, contentMd5.toLatin1());
+  }
+  for (QMap<QString,QString>::const_iterator it = allMsHeaders.constBegin(); it != allMsHeaders.constEnd(); ++it)
+  {
+    request.setRawHeader(it.key().toLatin1(), it.value().toUtf8());
+  }
+  // ------------------------
+
+  // --- Adding common header info ---
+  request.setRawHeader(msDateHeaderName, currentDateTime.toLatin1());
+  request.setRawHeader(msVersionHeaderName, m_version);
+  request.setRawHeader(contentLengthHeaderName, QByteArray::number(contentLength));
+  // ------------------------
+
+  // --- Adding connection configuration ---
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+  request.setAttribute(QNetworkRequest::Http2AllowedAttribute, m_http2Allowed);
+#endif
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+  if (m_maxConnectionsPerHost > 0)
+  {
+    QHttp1Configuration http1Configuration;
+    http1Configuration.setNumberOfConnectionsPerHost(static_cast<qsizetype>(m_maxConnectionsPerHost));
+    request.setHttp1Configuration(http1Configuration);
+  }
+#endif
+  // ------------------------
+
+  request.setAttribute(buildTimeAttribute, buildTimer.nsecsElapsed() / 1000);
+  return request;
+}
+
+QNetworkAccessManager* QAzureStorageRestApi::nextNetworkAccessManager()
+{
+  m_isIdle = false;
+
+  // Round robin: each manager has its own connections to Azure
+  m_nextManager = (m_nextManager + 1) % m_managerCount;
+  return m_managers[m_nextManager];
+}
+
+QNetworkReply* QAzureStorageRestApi::sendRequest(const QString& operation, const QByteArray& httpVerb, const QNetworkRequest& request, const QByteArray& content,
+                                                 QAzureStorageBandwidthLimiter* uploadLimiter)
+{
+  QNetworkAccessManager* manager = nextNetworkAccessManager();
+
+  QNetworkReply* reply = nullptr;
+  if (uploadLimiter != nullptr && uploadLimiter->isLimited() && !content.isEmpty())
+  {
+    // Content read from a paced device (not buffered by Qt, it would read it all at once)
+    QNetworkRequest throttledRequest = request;
+    throttledRequest.setAttribute(QNetworkRequest::DoNotBufferUploadDataAttribute, true);
+    QIODevice* contentDevice = uploadLimiter->createThrottledDevice(content);
+    reply = manager->sendCustomRequest(throttledRequest, httpVerb, contentDevice);
+    contentDevice->setParent(reply);
+  }
+  else if (httpVerb == "GET")
+  {
+    reply = manager->get(request);
+  }
+  else if (httpVerb == "HEAD")
+  {
+    reply = manager->head(request);
+  }
+  else if (httpVerb == "DELETE")
+  {
+    reply = manager->deleteResource(request);
+  }
+  else if (httpVerb == "PUT")
+  {
+    reply = manager->put(request, content);
+  }
+  else
+  {
+    reply = manager->sendCustomRequest(request, httpVerb, content);
+  }
+
+  // Only measured if needed (connected before the caller so that the metrics are complete when the caller handles the reply)
+  if (reply != nullptr && (m_metricsEnabled || m_tracer != nullptr || isSignalConnected(QMetaMethod::fromSignal(&QAzureStorageRestApi::requestFinished))))
+  {
+    measureRequest(reply, operation, httpVerb, request, content.size());
+  }
+
+  return reply;
+}
+
+void QAzureStorageRestApi::measureRequest(QNetworkReply* reply, const QString& operation, const QByteArray& httpVerb, const QNetworkRequest& request, const qint64& bytesSent)
+{
+  QSharedPointer<RequestMeasure> measure(new RequestMeasure());
+  measure->timer.start();
+  measure->metrics.operation = operation;
+  measure->metrics.httpVerb = httpVerb;
+  measure->metrics.resourcePath = request.url().path();
+  measure->metrics.buildTimeInUs = request.attribute(buildTimeAttribute, -1).toLongLong();
+  measure->metrics.bytesSent = bytesSent;
+  measure->isCountedInMetrics = m_metricsEnabled;
+  if (measure->isCountedInMetrics)
+  {
+    m_metrics->recordRequestStarted();
+  }
+
+  measure->tracer = m_tracer;
+  if (measure->tracer != nullptr)
+  {
+    QAzureStorageTracer::Span& span = measure->span;
+    span.name = operation;
+    span.clientRequestId = request.rawHeader(msClientRequestIdHeaderName);
+    span.startTimeInUs = QDateTime::currentMSecsSinceEpoch() * 1000;
+    span.attributes.insert("http.request.method", QString::fromLatin1(httpVerb));
+    const QString resourcePath = measure->metrics.resourcePath.mid(1);
+    const int blobSeparator = resourcePath.indexOf('/');
+    span.attributes.insert("az.storage.container", resourcePath.left(blobSeparator));
+    if (blobSeparator >= 0)
+    {
+      span.attributes.insert("az.storage.blob", resourcePath.mid(blobSeparator + 1));
+    }
+    span.attributes.insert("az.client_request_id", QString::fromLatin1(span.clientRequestId));
+    span.attributes.insert("http.request.body.size", bytesSent);
+    measure->tracer->startSpan(span);
+  }
+
+  // Qt does not tell when a request leaves the queue of its network access manager:
+  // the first event of the request (connection, upload or response) is used instead
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+  QObject::connect(reply, &QNetworkReply::socketStartedConnecting, this, [measure]()
+  {
+    measure->markStarted();
+    measure->connectStartInUs = measure->elapsedInUs();
+  });
+  QObject::connect(reply, &QNetworkReply::requestSent, this, [measure]() { measure->markStarted(); });
+#endif
+#ifndef QT_NO_SSL
+  QObject::connect(reply, &QNetworkReply::encrypted, this, [measure]()
+  {
+    if (measure->connectStartInUs >= 0 && measure->metrics.connectTimeInUs < 0)
+    {
+      measure->metrics.connectTimeInUs = measure->elapsedInUs() - measure->connectStartInUs;
+    }
+  });
+#endif
+  QObject::connect(reply, &QNetworkReply::uploadProgress, this, [measure](qint64 bytesUploaded, qint64)
+  {
+    if (bytesUploaded > 0)
+    {
+      measure->markStarted();
+    }
+  });
+  QObject::connect(reply, &QNetworkReply::metaDataChanged, this, [measure]()
+  {
+    measure->markStarted();
+    if (measure->metrics.timeToFirstByteInUs < 0)
+    {
+      measure->metrics.timeToFirstByteInUs = measure->elapsedInUs();
+    }
+  });
+  QObject::connect(reply, &QNetworkReply::downloadProgress, this, [measure](qint64 bytesReceived, qint64)
+  {
+    measure->metrics.bytesReceived = bytesReceived;
+  });
+  QObject::connect(reply, &QNetworkReply::finished, this, [this, measure, reply]()
+  {
+    RequestMetrics& metrics = measure->metrics;
+    metrics.totalTimeInUs = measure->elapsedInUs();
+    if (metrics.timeToFirstByteInUs >= 0)
+    {
+      metrics.transferTimeInUs = metrics.totalTimeInUs - metrics.timeToFirstByteInUs;
+    }
+    metrics.httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    metrics.requestId = reply->rawHeader(msRequestIdHeaderName);
+    metrics.error = reply->error();
+    if (measure->isCountedInMetrics)
+    {
+      m_metrics->recordRequestFinished(metrics.operation, metrics.httpStatus, metrics.totalTimeInUs, metrics.bytesSent, metrics.bytesReceived);
+    }
+    if (measure->tracer != nullptr)
+    {
+      QAzureStorageTracer::Span& span = measure->span;
+      span.endTimeInUs = span.startTimeInUs + metrics.totalTimeInUs;
+      if (metrics.httpStatus != 0)
+      {
+        span.attributes.insert("http.response.status_code", metrics.httpStatus);
+      }
+      if (!metrics.requestId.isEmpty())
+      {
+        span.attributes.insert("az.service_request_id", QString::fromLatin1(metrics.requestId));
+      }
+      span.attributes.insert("http.response.body.size", metrics.bytesReceived);
+      if (metrics.timeToFirstByteInUs >= 0)
+      {
+        span.attributes.insert("az.storage.time_to_first_byte_us", metrics.timeToFirstByteInUs);
+      }
+      span.isError = !isErrorCodeSuccess(metrics.error);
+      if (span.isError)
+      {
+        span.attributes.insert("error.type", static_cast<int>(metrics.error));
+      }
+      measure->tracer->endSpan(span);
+    }
+    emit requestFinished(metrics);
+  });
+}
+
+void QAzureStorageRestApi::addTransactionalChecksum(const QByteArray& content, QMap<QString,QString>& msHeaders, QString& contentMd5) const
+{
+  if (m_transactionalChecksum == Crc64Checksum)
+  {
+    msHeaders.insert("x-ms-content-crc64", QAzureStorageChecksum::crc64ToBase64(QAzureStorageChecksum::crc64(content)));
+  }
+  else if (m_transactionalChecksum == Md5Checksum)
+  {
+    contentMd5 = QAzureStorageChecksum::md5ToBase64(content);
+  }
+}
+
 QString QAzureStorageRestApi::generateCurrentTimeUTC()
 {
   return QLocale(QLocale::English).toString(QDateTime::currentDateTimeUtc(), "ddd, dd MMM yyyy hh:mm:ss").append(" GMT");
@@ -881,30 +2345,29 @@ QString QAzureStorageRestApi::generateHeader(
   return result;
 }
 
-QString QAzureStorageRestApi::generateAutorizationHeader(const QString& httpVerb, const QString& container,
-                                                         const QString& blobName, const QString& currentDateTime,
-                                                         const long& contentLength, const QStringList additionnalCanonicalHeaders,
-                                                         const QStringList additionnalCanonicalRessources)
+QByteArray QAzureStorageRestApi::generateAutorizationHeader(const QString& httpVerb, const QString& resourcePath, const QString& currentDateTime,
+                                                            const qint64& contentLength, const QStringList additionnalCanonicalHeaders,
+                                                            const QStringList additionnalCanonicalRessources, const QString& contentMd5)
 {
-  // Create canonicalized header
-  QString canonicalizedHeaders;
+  // Create canonicalized header (sorted by header name as requested by Azure)
+  QMap<QString,QString> sortedCanonicalHeaders;
   for (const QString& additionnalCanonicalHeader : additionnalCanonicalHeaders)
   {
-    canonicalizedHeaders.append(additionnalCanonicalHeader+"\n");
+    int separator = additionnalCanonicalHeader.indexOf(':');
+    sortedCanonicalHeaders.insert(additionnalCanonicalHeader.left(separator).toLower(), additionnalCanonicalHeader.mid(separator + 1));
   }
-  canonicalizedHeaders.append(QString("x-ms-date:%1\nx-ms-version:%2").arg(currentDateTime, m_version));
+  sortedCanonicalHeaders.insert("x-ms-date", currentDateTime);
+  sortedCanonicalHeaders.insert("x-ms-version", QString::fromLatin1(m_version));
 
-  // Create canonicalized ressource
-  QString canonicalizedResource;
-  if (blobName.isEmpty())
-  {
-    canonicalizedResource = QString("/%1/%2").arg(m_accountName, container);
-  }
-  else
+  QStringList canonicalizedHeadersList;
+  for (QMap<QString,QString>::const_iterator it = sortedCanonicalHeaders.constBegin(); it != sortedCanonicalHeaders.constEnd(); ++it)
   {
-    canonicalizedResource = QString("/%1/%2/%3").arg(m_accountName, container,
-                                                     QUrl::toPercentEncoding(blobName,"/"));
+    canonicalizedHeadersList.append(it.key() + ":" + it.value());
   }
+  QString canonicalizedHeaders = canonicalizedHeadersList.join("\n");
+
+  // Create canonicalized ressource
+  QString canonicalizedResource = m_canonicalizedResourcePrefix + resourcePath;
 
   for (const QString& additionnalCanonicalRessource : additionnalCanonicalRessources)
   {
@@ -913,15 +2376,11 @@ QString QAzureStorageRestApi::generateAutorizationHeader(const QString& httpVerb
 
   // Create signature
   QString signature = generateHeader(httpVerb, "", "", (contentLength==0 ? "" : QString::number(contentLength)),
-                                     "", "", "", "",
+                                     contentMd5, "", "", "",
                                      "", "", "", "", canonicalizedHeaders, canonicalizedResource);
 
   // Create authorization header
-  QByteArray authorizationHeader = QMessageAuthenticationCode::hash(
-        QByteArray(signature.toUtf8()),
-        QByteArray(QByteArray::fromBase64(m_accountKey.toStdString().c_str())),
-        QCryptographicHash::Sha256);
-  authorizationHeader = authorizationHeader.toBase64();
+  QByteArray authorizationHeader = QMessageAuthenticationCode::hash(signature.toUtf8(), m_accountKey, QCryptographicHash::Sha256);
 
-  return QString("SharedKey %1:%2").arg(m_accountName, QString(authorizationHeader));
+  return m_authorizationPrefix + authorizationHeader.toBase64();
 }
@@ -0,0 +1,574 @@
+/*
+ * \brief Synchronize a local directory with an Azure storage virtual "folder" (only the changed files are transferred)
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#include "QAzureStorageSyncJob.h"
+#include "QAzureStorageListJob.h"
+#include "QAzureStorageDirectoryUploadJob.h"
+#include "QAzureStorageDirectoryDownloadJob.h"
+#include "QAzureStorageLogging.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QDebug>
+
+// ------------------------------------- HASH TASK -------------------------------------
+
+class QAzureStorageSyncJob::HashTask : public QRunnable
+{
+public:
+  HashTask(QAzureStorageSyncJob* job, const QString& relativePath, const QString& filePath) :
+    m_job(job),
+    m_relativePath(relativePath),
+    m_filePath(filePath)
+  {
+  }
+
+  void run() override
+  {
+    QString md5;
+    QFile file(m_filePath);
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    if (file.open(QIODevice::ReadOnly) && hash.addData(&file))
+    {
+      md5 = QString::fromLatin1(hash.result().toBase64());
+    }
+
+    // Queued to the job thread (the job waits the end of the tasks before being destroyed)
+    emit m_job->fileHashed(m_relativePath, md5, QAzureStorageSyncJob::QPrivateSignal());
+  }
+
+private:
+  QAzureStorageSyncJob* m_job;
+  QString m_relativePath;
+  QString m_filePath;
+};
+
+// ------------------------------------- CONSTRUCTOR & INIT -------------------------------------
+
+QAzureStorageSyncJob::QAzureStorageSyncJob(QAzureStorageRestApi* api, const QString& localPath, const QString& container, const QString& prefix,
+                                           const QAzureStorageRestApi::SyncDirection& direction, const bool& isDeletingExtraneous, const QString& manifestPath,
+                                           const int& maxParallelRequests, const int& timeoutInSec, QObject* parent) :
+  QAzureStorageJob(parent),
+  m_api(api),
+  m_localPath(QDir::cleanPath(localPath)),
+  m_container(container),
+  m_prefix(prefix),
+  m_direction(direction),
+  m_isDeletingExtraneous(isDeletingExtraneous),
+  m_maxParallelRequests(maxParallelRequests),
+  m_timeoutInSec(timeoutInSec),
+  m_manifest(manifestPath)
+{
+  if (!m_prefix.isEmpty() && !m_prefix.endsWith('/'))
+  {
+    m_prefix.append('/');
+  }
+
+  QObject::connect(this, &QAzureStorageSyncJob::fileHashed, this, &QAzureStorageSyncJob::onFileHashed, Qt::QueuedConnection);
+}
+
+qint64 QAzureStorageSyncJob::transferredFileCount() const
+{
+  return m_transferredFileCount;
+}
+
+qint64 QAzureStorageSyncJob::unchangedFileCount() const
+{
+  return m_unchangedFileCount;
+}
+
+qint64 QAzureStorageSyncJob::deletedFileCount() const
+{
+  return m_deletedFileCount;
+}
+
+QMap<QString, QNetworkReply::NetworkError> QAzureStorageSyncJob::failedFiles() const
+{
+  return m_failedFiles;
+}
+
+QAzureStorageSyncJob::Comparison QAzureStorageSyncJob::compare(const QAzureStorageRestApi::SyncDirection& direction, const QAzureStorageSyncManifest::Entry& localFile,
+                                                               const QAzureStorageSyncManifest::Entry& remoteFile, const QAzureStorageSyncManifest::Entry& manifestEntry)
+{
+  if (localFile.size != remoteFile.size)
+  {
+    return Changed;
+  }
+
+  // Nothing changed on both sides since the last synchronization
+  if (manifestEntry.size == localFile.size && manifestEntry.modifiedInMs == localFile.modifiedInMs &&
+      !manifestEntry.etag.isEmpty() && manifestEntry.etag == remoteFile.etag)
+  {
+    return Unchanged;
+  }
+
+  if (!remoteFile.md5.isEmpty())
+  {
+    if (localFile.md5.isEmpty())
+    {
+      return NeedsLocalMd5;
+    }
+    return (localFile.md5 == remoteFile.md5) ? Unchanged : Changed;
+  }
+
+  // No MD5 of the blob (uploaded in blocks): the most recent side wins
+  if (direction == QAzureStorageRestApi::SyncUpload)
+  {
+    return (localFile.modifiedInMs > remoteFile.modifiedInMs) ? Changed : Unchanged;
+  }
+  return (remoteFile.modifiedInMs > localFile.modifiedInMs) ? Changed : Unchanged;
+}
+
+// ------------------------------------- PUBLIC SLOTS -------------------------------------
+
+void QAzureStorageSyncJob::start()
+{
+  if (m_isStarted || isFinished())
+  {
+    return;
+  }
+  m_isStarted = true;
+
+  // A manifest written for another synchronization is ignored
+  m_manifest.load(QString("%1\n%2/%3\n%4").arg(m_localPath, m_container, m_prefix,
+                                               (m_direction == QAzureStorageRestApi::SyncUpload) ? "upload" : "download"));
+
+  if (m_direction == QAzureStorageRestApi::SyncDownload && !QDir().mkpath(m_localPath))
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageSyncJob] Failed to create local directory" << m_localPath;
+    finish(QNetworkReply::NetworkError::UnknownContentError);
+    return;
+  }
+  if (!QFileInfo(m_localPath).isDir())
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageSyncJob]" << m_localPath << "is not a directory";
+    finish(QNetworkReply::NetworkError::UnknownContentError);
+    return;
+  }
+
+  scanLocalFiles();
+
+  // Flat listing (no delimiter): size, Last-Modified, Content-MD5 and ETag of all the files under the prefix
+  m_listJob = new QAzureStorageListJob(m_api, m_container, m_prefix, QString(), -1, 1, m_timeoutInSec, this);
+  QObject::connect(m_listJob, &QAzureStorageListJob::filesListed, this, [this](const QString&, const QList< QMap<QString,QString> >& files) { onFilesListed(files); });
+  QObject::connect(m_listJob, &QAzureStorageJob::finished, this, [this](QNetworkReply::NetworkError errorCode) { onListingFinished(errorCode); });
+  m_listJob->start();
+}
+
+// ------------------------------------- PRIVATE -------------------------------------
+
+void QAzureStorageSyncJob::scanLocalFiles()
+{
+  const QDir localDir(m_localPath);
+  const QString manifestPath = m_manifest.isEnabled() ? QFileInfo(m_manifest.manifestPath()).absoluteFilePath() : QString();
+
+  QDirIterator it(m_localPath, QDir::Files | QDir::Hidden | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+  while (it.hasNext())
+  {
+    it.next();
+    const QFileInfo fileInfo = it.fileInfo();
+
+    // The manifest can be stored in the synchronized directory
+    if (fileInfo.absoluteFilePath() == manifestPath)
+    {
+      continue;
+    }
+
+    QAzureStorageSyncManifest::Entry localFile;
+    localFile.size = fileInfo.size();
+    localFile.modifiedInMs = fileInfo.lastModified().toMSecsSinceEpoch();
+    m_localFiles.insert(localDir.relativeFilePath(fileInfo.filePath()), localFile);
+  }
+}
+
+void QAzureStorageSyncJob::onFilesListed(const QList< QMap<QString,QString> >& files)
+{
+  if (isFinished())
+  {
+    return;
+  }
+
+  for (const QMap<QString,QString>& listedFile : files)
+  {
+    // The virtual "folders" (hierarchical namespace) are local directories, not files
+    const QString blobName = listedFile.value("Name");
+    if (blobName.size() <= m_prefix.size() || blobName.endsWith('/'))
+    {
+      continue;
+    }
+
+    const QString relativePath = blobName.mid(m_prefix.size());
+    if (m_direction == QAzureStorageRestApi::SyncDownload && localFilePath(relativePath).isEmpty())
+    {
+      qCWarning(lcAzureStorageTransfer) << "[QAzureStorageSyncJob]" << blobName << "can not be written in" << m_localPath;
+      onFileDone(relativePath, false, QNetworkReply::NetworkError::ContentOperationNotPermittedError);
+      continue;
+    }
+
+    QAzureStorageSyncManifest::Entry remoteFile;
+    remoteFile.size = listedFile.value("Content-Length").toLongLong();
+    const QDateTime lastModified = QAzureStorageRestApi::parseDateTime(listedFile.value("Last-Modified"));
+    remoteFile.modifiedInMs = lastModified.isValid() ? lastModified.toMSecsSinceEpoch() : -1;
+    remoteFile.md5 = listedFile.value("Content-MD5");
+    remoteFile.etag = listedFile.value("Etag");
+    m_remoteFiles.insert(relativePath, remoteFile);
+  }
+}
+
+void QAzureStorageSyncJob::onListingFinished(const QNetworkReply::NetworkError& errorCode)
+{
+  if (m_listJob != nullptr)
+  {
+    m_listJob->deleteLater();
+    m_listJob = nullptr;
+  }
+  if (isFinished())
+  {
+    return;
+  }
+
+  // Without the full listing, existing files would be transferred again (or deleted)
+  if (!QAzureStorageRestApi::isErrorCodeSuccess(errorCode))
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageSyncJob] Failed to list" << m_container + "/" + m_prefix << "(error code" << errorCode << ")";
+    finish(errorCode);
+    return;
+  }
+
+  const bool isUpload = (m_direction == QAzureStorageRestApi::SyncUpload);
+  const QMap<QString, QAzureStorageSyncManifest::Entry>& referenceFiles = isUpload ? m_localFiles : m_remoteFiles;
+  const QMap<QString, QAzureStorageSyncManifest::Entry>& updatedFiles = isUpload ? m_remoteFiles : m_localFiles;
+
+  for (QMap<QString, QAzureStorageSyncManifest::Entry>::const_iterator it = referenceFiles.constBegin(); it != referenceFiles.constEnd(); ++it)
+  {
+    if (updatedFiles.contains(it.key()))
+    {
+      compareFile(it.key());
+    }
+    else
+    {
+      m_filesToTransfer.append(it.key());
+    }
+  }
+
+  for (QMap<QString, QAzureStorageSyncManifest::Entry>::const_iterator it = updatedFiles.constBegin(); it != updatedFiles.constEnd(); ++it)
+  {
+    if (!referenceFiles.contains(it.key()))
+    {
+      m_pendingDeletes.append(it.key());
+    }
+  }
+
+  // Otherwise started once the last local file is hashed
+  if (m_hashingFiles.isEmpty())
+  {
+    startTransfers();
+  }
+}
+
+void QAzureStorageSyncJob::compareFile(const QString& relativePath)
+{
+  QAzureStorageSyncManifest::Entry& localFile = m_localFiles[relativePath];
+  const QAzureStorageSyncManifest::Entry remoteFile = m_remoteFiles.value(relativePath);
+  const QAzureStorageSyncManifest::Entry manifestEntry = m_manifest.entry(relativePath);
+
+  // The MD5 of the last synchronization is still valid if the local file did not change since
+  if (localFile.md5.isEmpty() && manifestEntry.size == localFile.size && manifestEntry.modifiedInMs == localFile.modifiedInMs)
+  {
+    localFile.md5 = manifestEntry.md5;
+  }
+
+  switch (compare(m_direction, localFile, remoteFile, manifestEntry))
+  {
+    case Changed:
+      m_filesToTransfer.append(relativePath);
+      break;
+
+    case Unchanged:
+    {
+      QAzureStorageSyncManifest::Entry syncedFile = localFile;
+      syncedFile.etag = remoteFile.etag;
+      m_syncedFiles.insert(relativePath, syncedFile);
+      ++m_unchangedFileCount;
+      break;
+    }
+
+    case NeedsLocalMd5:
+      m_hashingFiles.insert(relativePath);
+      m_hashPool.start(new HashTask(this, relativePath, localFilePath(relativePath)));
+      break;
+  }
+}
+
+void QAzureStorageSyncJob::onFileHashed(const QString& relativePath, const QString& md5)
+{
+  if (isFinished() || !m_hashingFiles.remove(relativePath))
+  {
+    return;
+  }
+
+  if (md5.isEmpty())
+  {
+    // Unreadable local file: the transfer reports the error (upload) or replaces it (download)
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageSyncJob] Failed to read local file" << localFilePath(relativePath);
+    m_filesToTransfer.append(relativePath);
+  }
+  else
+  {
+    m_localFiles[relativePath].md5 = md5;
+    compareFile(relativePath);
+  }
+
+  if (m_hashingFiles.isEmpty())
+  {
+    startTransfers();
+  }
+}
+
+void QAzureStorageSyncJob::startTransfers()
+{
+  if (m_filesToTransfer.isEmpty())
+  {
+    startDeletes();
+    return;
+  }
+
+  if (m_direction == QAzureStorageRestApi::SyncUpload)
+  {
+    QAzureStorageDirectoryUploadJob* job = new QAzureStorageDirectoryUploadJob(m_api, m_localPath, m_container, m_prefix, m_maxParallelRequests,
+                                                                               4 * 1024 * 1024, 4 * 1024 * 1024, 4, m_timeoutInSec, this);
+    job->setFiles(m_filesToTransfer);
+    QObject::connect(job, &QAzureStorageDirectoryUploadJob::fileUploaded, this,
+                     [this](const QString& relativePath, const QString&, QNetworkReply::NetworkError errorCode, const QString& etag)
+    {
+      onFileTransferred(relativePath, errorCode, etag);
+    });
+    m_transferJob = job;
+  }
+  else
+  {
+    QList< QMap<QString,QString> > files;
+    for (const QString& relativePath : m_filesToTransfer)
+    {
+      QMap<QString,QString> file;
+      file.insert("Name", m_prefix + relativePath);
+      file.insert("Content-Length", QString::number(m_remoteFiles.value(relativePath).size));
+      files.append(file);
+    }
+
+    QAzureStorageDirectoryDownloadJob* job = new QAzureStorageDirectoryDownloadJob(m_api, m_container, m_prefix, m_localPath, m_maxParallelRequests,
+                                                                                   4 * 1024 * 1024, 4 * 1024 * 1024, 4, m_timeoutInSec, this);
+    job->setFiles(files);
+    QObject::connect(job, &QAzureStorageDirectoryDownloadJob::fileDownloaded, this, [this](const QString& blobName, const QString&, QNetworkReply::NetworkError errorCode)
+    {
+      onFileTransferred(blobName.mid(m_prefix.size()), errorCode);
+    });
+    m_transferJob = job;
+  }
+
+  QAzureStorageJob* job = m_transferJob;
+  QObject::connect(job, &QAzureStorageJob::progress, this, [this](qint64 bytesDone, qint64 bytesTotal)
+  {
+    if (!isFinished())
+    {
+      emit progress(bytesDone, bytesTotal);
+    }
+  });
+  QObject::connect(job, &QAzureStorageJob::finished, this, [this, job](QNetworkReply::NetworkError)
+  {
+    // The errors are reported file by file
+    job->deleteLater();
+    if (isFinished() || job != m_transferJob)
+    {
+      return;
+    }
+    m_transferJob = nullptr;
+    startDeletes();
+  });
+
+  // Started from the event loop (a job failing right away must not finish in the middle of this method)
+  QMetaObject::invokeMethod(job, "start", Qt::QueuedConnection);
+}
+
+void QAzureStorageSyncJob::onFileTransferred(const QString& relativePath, const QNetworkReply::NetworkError& errorCode, const QString& uploadedEtag)
+{
+  if (isFinished())
+  {
+    return;
+  }
+
+  QAzureStorageSyncManifest::Entry syncedFile;
+  if (QAzureStorageRestApi::isErrorCodeSuccess(errorCode))
+  {
+    const QFileInfo fileInfo(localFilePath(relativePath));
+    syncedFile.size = fileInfo.size();
+    syncedFile.modifiedInMs = fileInfo.lastModified().toMSecsSinceEpoch();
+    if (m_direction == QAzureStorageRestApi::SyncUpload)
+    {
+      // ETag header of the upload (quoted), listings return it without quotes
+      syncedFile.md5 = m_localFiles.value(relativePath).md5;
+      syncedFile.etag = uploadedEtag;
+      if (syncedFile.etag.size() >= 2 && syncedFile.etag.startsWith('"') && syncedFile.etag.endsWith('"'))
+      {
+        syncedFile.etag = syncedFile.etag.mid(1, syncedFile.etag.size() - 2);
+      }
+    }
+    else
+    {
+      syncedFile.etag = m_remoteFiles.value(relativePath).etag;
+    }
+  }
+
+  onFileDone(relativePath, false, errorCode, syncedFile);
+}
+
+void QAzureStorageSyncJob::startDeletes()
+{
+  if (!m_isDeletingExtraneous)
+  {
+    m_pendingDeletes.clear();
+    finishSync();
+    return;
+  }
+
+  if (m_direction == QAzureStorageRestApi::SyncDownload)
+  {
+    const QStringList extraneousFiles = m_pendingDeletes;
+    m_pendingDeletes.clear();
+    for (const QString& relativePath : extraneousFiles)
+    {
+      const bool isRemoved = QFile::remove(localFilePath(relativePath));
+      onFileDone(relativePath, true, isRemoved ? QNetworkReply::NetworkError::NoError : QNetworkReply::NetworkError::UnknownContentError);
+    }
+    finishSync();
+    return;
+  }
+
+  startNextDeletes();
+}
+
+void QAzureStorageSyncJob::startNextDeletes()
+{
+  while (!isFinished() && !m_pendingDeletes.isEmpty() && m_runningDeletes.size() < m_maxParallelRequests)
+  {
+    const QString relativePath = m_pendingDeletes.takeFirst();
+    QNetworkReply* reply = m_api->deleteFile(m_container, m_prefix + relativePath, m_timeoutInSec);
+    if (reply == nullptr)
+    {
+      onFileDone(relativePath, true, QNetworkReply::NetworkError::UnknownNetworkError);
+      continue;
+    }
+
+    m_runningDeletes.insert(reply, relativePath);
+    QObject::connect(reply, &QNetworkReply::finished, this, [this, reply]() { onDeleteFinished(reply); });
+  }
+
+  if (!isFinished() && m_pendingDeletes.isEmpty() && m_runningDeletes.isEmpty())
+  {
+    finishSync();
+  }
+}
+
+void QAzureStorageSyncJob::onDeleteFinished(QNetworkReply* reply)
+{
+  reply->deleteLater();
+  if (isFinished() || !m_runningDeletes.contains(reply))
+  {
+    return;
+  }
+
+  onFileDone(m_runningDeletes.take(reply), true, reply->error());
+  startNextDeletes();
+}
+
+void QAzureStorageSyncJob::onFileDone(const QString& relativePath, const bool& isDeleted, const QNetworkReply::NetworkError& errorCode,
+                                      const QAzureStorageSyncManifest::Entry& syncedFile)
+{
+  if (QAzureStorageRestApi::isErrorCodeSuccess(errorCode))
+  {
+    if (isDeleted)
+    {
+      ++m_deletedFileCount;
+    }
+    else
+    {
+      ++m_transferredFileCount;
+      m_syncedFiles.insert(relativePath, syncedFile);
+    }
+  }
+  else
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageSyncJob] Failed to" << (isDeleted ? "delete" : "transfer") << relativePath << "(error code" << errorCode << ")";
+    m_failedFiles.insert(relativePath, errorCode);
+    if (m_firstError == QNetworkReply::NetworkError::NoError)
+    {
+      m_firstError = errorCode;
+    }
+  }
+
+  emit fileSynced(relativePath, isDeleted, errorCode);
+}
+
+void QAzureStorageSyncJob::finishSync()
+{
+  // Only the files which are the same on both sides: the failed ones are compared again next time
+  if (m_manifest.isEnabled())
+  {
+    m_manifest.clear();
+    for (QMap<QString, QAzureStorageSyncManifest::Entry>::const_iterator it = m_syncedFiles.constBegin(); it != m_syncedFiles.constEnd(); ++it)
+    {
+      m_manifest.setEntry(it.key(), it.value());
+    }
+    m_manifest.save();
+  }
+
+  finish(m_firstError);
+}
+
+QString QAzureStorageSyncJob::localFilePath(const QString& relativePath) const
+{
+  // Blob names are free text: "../" must not read or write outside of the local directory
+  const QString filePath = QDir::cleanPath(m_localPath + "/" + relativePath);
+  if (!filePath.startsWith(m_localPath + "/"))
+  {
+    return QString();
+  }
+
+  return filePath;
+}
+
+void QAzureStorageSyncJob::cleanup()
+{
+  m_hashingFiles.clear();
+  m_pendingDeletes.clear();
+  m_hashPool.clear();
+
+  // Stop the listing, the transfers and the remaining deletes (their finished signal is ignored since the job is finished)
+  const QList<QNetworkReply*> runningReplies = m_runningDeletes.keys();
+  m_runningDeletes.clear();
+
+  if (m_listJob != nullptr)
+  {
+    m_listJob->abort();
+  }
+  if (m_transferJob != nullptr)
+  {
+    m_transferJob->abort();
+    m_transferJob = nullptr;
+  }
+  for (QNetworkReply* reply : runningReplies)
+  {
+    reply->abort();
+  }
+}
@@ -0,0 +1,146 @@
+/*
+ * \brief Local manifest of the files of a synchronization with Azure storage (used to skip unchanged files quickly)
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#include "QAzureStorageSyncManifest.h"
+#include "QAzureStorageLogging.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QUrl>
+#include <QDebug>
+
+namespace
+{
+  const QByteArray MANIFEST_HEADER = "QAzureStorageSyncManifest 1";
+  const QByteArray IDENTITY_PREFIX = "identity ";
+  const QByteArray FILE_PREFIX = "file ";
+
+  //! Empty values are written as "-" so that each line always has the same number of fields
+  QByteArray encodeField(const QString& value)
+  {
+    return value.isEmpty() ? QByteArray("-") : QUrl::toPercentEncoding(value, QByteArray(), "-");
+  }
+
+  QString decodeField(const QByteArray& value)
+  {
+    return value == "-" ? QString() : QUrl::fromPercentEncoding(value);
+  }
+}
+
+QAzureStorageSyncManifest::QAzureStorageSyncManifest(const QString& manifestPath) :
+  m_manifestPath(manifestPath)
+{
+}
+
+bool QAzureStorageSyncManifest::isEnabled() const
+{
+  return !m_manifestPath.isEmpty();
+}
+
+QString QAzureStorageSyncManifest::manifestPath() const
+{
+  return m_manifestPath;
+}
+
+bool QAzureStorageSyncManifest::load(const QString& identity)
+{
+  m_identity = identity;
+  m_entries.clear();
+  if (!isEnabled())
+  {
+    return false;
+  }
+
+  QFile file(m_manifestPath);
+  if (!file.open(QIODevice::ReadOnly))
+  {
+    return false;
+  }
+
+  const QList<QByteArray> lines = file.readAll().split('\n');
+  if (lines.size() < 2 || lines[0] != MANIFEST_HEADER || lines[1] != IDENTITY_PREFIX + QUrl::toPercentEncoding(identity))
+  {
+    return false;
+  }
+
+  for (int i = 2; i < lines.size(); ++i)
+  {
+    const QByteArray& line = lines[i];
+    if (!line.startsWith(FILE_PREFIX))
+    {
+      continue;
+    }
+
+    // file <path> <size> <modification time in ms> <md5> <etag>
+    const QList<QByteArray> values = line.mid(FILE_PREFIX.size()).split(' ');
+    bool isValidSize = false;
+    bool isValidTime = false;
+    Entry entry;
+    if (values.size() == 5)
+    {
+      entry.size = values[1].toLongLong(&isValidSize);
+      entry.modifiedInMs = values[2].toLongLong(&isValidTime);
+      entry.md5 = decodeField(values[3]);
+      entry.etag = decodeField(values[4]);
+    }
+
+    if (!isValidSize || !isValidTime)
+    {
+      qCDebug(lcAzureStorageParse) << "[QAzureStorageSyncManifest] Invalid line" << i << "in" << m_manifestPath;
+      continue;
+    }
+    m_entries.insert(decodeField(values[0]), entry);
+  }
+
+  return true;
+}
+
+bool QAzureStorageSyncManifest::save()
+{
+  if (!isEnabled())
+  {
+    return false;
+  }
+
+  QByteArray content = MANIFEST_HEADER + '\n' + IDENTITY_PREFIX + QUrl::toPercentEncoding(m_identity) + '\n';
+  for (QMap<QString, Entry>::const_iterator it = m_entries.constBegin(); it != m_entries.constEnd(); ++it)
+  {
+    content.append(FILE_PREFIX + encodeField(it.key()) + ' ' + QByteArray::number(it.value().size) + ' ' + QByteArray::number(it.value().modifiedInMs)
+                   + ' ' + encodeField(it.value().md5) + ' ' + encodeField(it.value().etag) + '\n');
+  }
+
+  QSaveFile file(m_manifestPath);
+  if (!file.open(QIODevice::WriteOnly) || file.write(content) != content.size() || !file.commit())
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageSyncManifest] Failed to write manifest" << m_manifestPath << ":" << file.errorString();
+    return false;
+  }
+  return true;
+}
+
+QMap<QString, QAzureStorageSyncManifest::Entry> QAzureStorageSyncManifest::entries() const
+{
+  return m_entries;
+}
+
+QAzureStorageSyncManifest::Entry QAzureStorageSyncManifest::entry(const QString& relativePath) const
+{
+  return m_entries.value(relativePath);
+}
+
+void QAzureStorageSyncManifest::setEntry(const QString& relativePath, const Entry& entry)
+{
+  m_entries.insert(relativePath, entry);
+}
+
+void QAzureStorageSyncManifest::clear()
+{
+  m_entries.clear();
+}
@@ -0,0 +1,196 @@
+/*
+ * \brief Local journal of the completed parts of a transfer to/from Azure storage (used to resume a transfer)
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#include "QAzureStorageTransferJournal.h"
+#include "QAzureStorageLogging.h"
+
+#include <QFileInfo>
+#include <QUrl>
+#include <QDebug>
+
+namespace
+{
+  const QByteArray JOURNAL_HEADER = "QAzureStorageTransferJournal 1";
+  const QByteArray IDENTITY_PREFIX = "identity ";
+  const QByteArray BLOCK_PREFIX = "block ";
+  const QByteArray RANGE_PREFIX = "range ";
+}
+
+QAzureStorageTransferJournal::QAzureStorageTransferJournal(const QString& journalPath) :
+  m_file(journalPath)
+{
+}
+
+bool QAzureStorageTransferJournal::isEnabled() const
+{
+  return !m_file.fileName().isEmpty();
+}
+
+QString QAzureStorageTransferJournal::journalPath() const
+{
+  return m_file.fileName();
+}
+
+bool QAzureStorageTransferJournal::open(const QString& identity)
+{
+  if (!isEnabled())
+  {
+    return false;
+  }
+
+  m_completedBlocks.clear();
+  m_completedRanges.clear();
+  if (m_file.isOpen())
+  {
+    m_file.close();
+  }
+
+  const QByteArray identityLine = IDENTITY_PREFIX + QUrl::toPercentEncoding(identity);
+  bool isSameTransfer = false;
+
+  // --- Load the previous journal (if any) ---
+  if (m_file.open(QIODevice::ReadOnly))
+  {
+    QList<QByteArray> lines = m_file.readAll().split('\n');
+    m_file.close();
+
+    // Last line is either empty (all lines ended) or incomplete (crash while writing it)
+    if (!lines.isEmpty())
+    {
+      lines.removeLast();
+    }
+
+    isSameTransfer = lines.size() >= 2 && lines[0] == JOURNAL_HEADER && lines[1] == identityLine;
+    for (int i = 2; isSameTransfer && i < lines.size(); ++i)
+    {
+      const QByteArray& line = lines[i];
+      if (line.startsWith(BLOCK_PREFIX))
+      {
+        m_completedBlocks.append(QString::fromLatin1(line.mid(BLOCK_PREFIX.size())));
+      }
+      else if (line.startsWith(RANGE_PREFIX))
+      {
+        QList<QByteArray> values = line.mid(RANGE_PREFIX.size()).split(' ');
+        bool isValidOffset = false;
+        bool isValidLength = false;
+        if (values.size() == 2)
+        {
+          qint64 offset = values[0].toLongLong(&isValidOffset);
+          qint64 length = values[1].toLongLong(&isValidLength);
+          if (isValidOffset && isValidLength)
+          {
+            m_completedRanges.insert(offset, length);
+          }
+        }
+      }
+    }
+  }
+  // ------------------------
+
+  // --- Continue the same journal or start a new one ---
+  if (isSameTransfer)
+  {
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+      qCWarning(lcAzureStorageTransfer) << "[QAzureStorageTransferJournal] Failed to open journal" << m_file.fileName() << ":" << m_file.errorString();
+      return false;
+    }
+    return true;
+  }
+
+  reset(identity);
+  return false;
+}
+
+bool QAzureStorageTransferJournal::reset(const QString& identity)
+{
+  if (!isEnabled())
+  {
+    return false;
+  }
+
+  m_completedBlocks.clear();
+  m_completedRanges.clear();
+  if (m_file.isOpen())
+  {
+    m_file.close();
+  }
+
+  if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageTransferJournal] Failed to create journal" << m_file.fileName() << ":" << m_file.errorString();
+    return false;
+  }
+  return appendLine(JOURNAL_HEADER) && appendLine(IDENTITY_PREFIX + QUrl::toPercentEncoding(identity));
+}
+
+bool QAzureStorageTransferJournal::openForLocalFile(const QString& identity, const QString& localFilePath, const qint64& expectedSize)
+{
+  if (!open(identity))
+  {
+    return false;
+  }
+
+  if (QFileInfo(localFilePath).size() != expectedSize)
+  {
+    reset(identity);
+    return false;
+  }
+  return true;
+}
+
+QStringList QAzureStorageTransferJournal::completedBlocks() const
+{
+  return m_completedBlocks;
+}
+
+QMap<qint64,qint64> QAzureStorageTransferJournal::completedRanges() const
+{
+  return m_completedRanges;
+}
+
+bool QAzureStorageTransferJournal::addCompletedBlock(const QString& blockId)
+{
+  m_completedBlocks.append(blockId);
+  return appendLine(BLOCK_PREFIX + blockId.toLatin1());
+}
+
+bool QAzureStorageTransferJournal::addCompletedRange(const qint64& offset, const qint64& length)
+{
+  m_completedRanges.insert(offset, length);
+  return appendLine(RANGE_PREFIX + QByteArray::number(offset) + ' ' + QByteArray::number(length));
+}
+
+void QAzureStorageTransferJournal::remove()
+{
+  if (!isEnabled())
+  {
+    return;
+  }
+
+  if (m_file.isOpen())
+  {
+    m_file.close();
+  }
+  m_file.remove();
+  m_completedBlocks.clear();
+  m_completedRanges.clear();
+}
+
+bool QAzureStorageTransferJournal::appendLine(const QByteArray& line)
+{
+  if (!m_file.isOpen())
+  {
+    return false;
+  }
+
+  // Flushed immediately so that the line is kept even if the process is killed right after
+  return m_file.write(line + '\n') == line.size() + 1 && m_file.flush();
+}
@@ -0,0 +1,346 @@
+/*
+ * \brief Upload a local file into Azure storage (block blob) using parallel blocks
+ *
+ * \author Quentin Comte-Gaz <quentin@comte-gaz.com>
+ * \date 08 November 2023
+ * \license MIT License (contact me if too restrictive)
+ * \copyright Copyright (c) 2023 Quentin Comte-Gaz
+ * \version 3.2
+ */
+
+#include "QAzureStorageUploadJob.h"
+#include "QAzureStorageRestApi.h"
+#include "QAzureStorageCompression.h"
+#include "QAzureStorageLogging.h"
+
+#include <QRunnable>
+#include <QDebug>
+
+// ------------------------------------- COMPRESSION TASK -------------------------------------
+
+class QAzureStorageUploadJob::CompressionTask : public QRunnable
+{
+public:
+  CompressionTask(QAzureStorageUploadJob* job, const int& blockIndex, const QByteArray& blockContent) :
+    m_job(job),
+    m_blockIndex(blockIndex),
+    m_blockContent(blockContent)
+  {
+  }
+
+  void run() override
+  {
+    // Queued to the job thread (the job waits the end of the tasks before being destroyed)
+    emit m_job->blockCompressed(m_blockIndex, QAzureStorageCompression::gzip(m_blockContent), QAzureStorageUploadJob::QPrivateSignal());
+  }
+
+private:
+  QAzureStorageUploadJob* m_job;
+  int m_blockIndex;
+  QByteArray m_blockContent;
+};
+
+// ------------------------------------- CONSTRUCTOR & INIT -------------------------------------
+
+QAzureStorageUploadJob::QAzureStorageUploadJob(QAzureStorageRestApi* api, const QString& filePath, const QString& container, const QString& blobName,
+                                               const qint64& blockSizeInBytes, const int& maxParallelBlocks, const QString& journalPath,
+                                               const int& timeoutInSec, QObject* parent) :
+  QAzureStorageJob(parent),
+  m_api(api),
+  m_container(container),
+  m_blobName(blobName),
+  m_blockSizeInBytes(blockSizeInBytes),
+  m_maxParallelBlocks(maxParallelBlocks),
+  m_timeoutInSec(timeoutInSec),
+  m_file(filePath),
+  m_journal(journalPath),
+  m_bandwidthLimiter(0, api->uploadBandwidthLimiter())
+{
+  m_compressionPool.setMaxThreadCount(qMax(1, maxParallelBlocks));
+  QObject::connect(this, &QAzureStorageUploadJob::blockCompressed, this, &QAzureStorageUploadJob::onBlockCompressed, Qt::QueuedConnection);
+}
+
+qint64 QAzureStorageUploadJob::fileSize() const
+{
+  return m_fileSize;
+}
+
+qint64 QAzureStorageUploadJob::bytesUploaded() const
+{
+  return m_bytesUploaded;
+}
+
+QString QAzureStorageUploadJob::etag() const
+{
+  return m_etag;
+}
+
+void QAzureStorageUploadJob::setBandwidthLimit(const qint64& bytesPerSecond)
+{
+  m_bandwidthLimiter.setRate(bytesPerSecond);
+}
+
+qint64 QAzureStorageUploadJob::bandwidthLimit() const
+{
+  return m_bandwidthLimiter.rate();
+}
+
+QString QAzureStorageUploadJob::blockId(const int& blockIndex)
+{
+  return QString::fromLatin1(QString("%1").arg(blockIndex, 8, 10, QChar('0')).toLatin1().toBase64());
+}
+
+// ------------------------------------- PUBLIC SLOTS -------------------------------------
+
+void QAzureStorageUploadJob::start()
+{
+  if (m_isStarted || isFinished())
+  {
+    return;
+  }
+  m_isStarted = true;
+
+  if (!m_file.open(QIODevice::ReadOnly))
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageUploadJob] Failed to open local file" << m_file.fileName() << ":" << m_file.errorString();
+    finish(QNetworkReply::NetworkError::UnknownContentError);
+    return;
+  }
+
+  m_fileSize = m_file.size();
+  m_compressContent = m_api->isContentCompressionEnabled();
+
+  // Azure refuses more than 50000 blocks per blob: use bigger blocks for huge files
+  if (m_fileSize > m_blockSizeInBytes * MAX_BLOCKS_PER_BLOB)
+  {
+    m_blockSizeInBytes = (m_fileSize + MAX_BLOCKS_PER_BLOB - 1) / MAX_BLOCKS_PER_BLOB;
+  }
+  m_blockCount = static_cast<int>((m_fileSize + m_blockSizeInBytes - 1) / m_blockSizeInBytes);
+
+  for (int blockIndex = 0; blockIndex < m_blockCount; ++blockIndex)
+  {
+    m_pendingBlocks.append(blockIndex);
+  }
+
+  // Blocks of the journal are only skipped if the local file did not change and Azure still has them (uncommitted blocks expire)
+  if (m_journal.isEnabled())
+  {
+    QString identity = QString("upload\n%1\n%2/%3\n%4\n%5\n%6\n%7").arg(m_file.fileName(), m_container, m_blobName, QString::number(m_fileSize),
+                                                                       QString::number(QFileInfo(m_file).lastModified().toMSecsSinceEpoch()),
+                                                                       QString::number(m_blockSizeInBytes), m_compressContent ? "gzip" : "");
+    if (m_journal.open(identity) && !m_journal.completedBlocks().isEmpty())
+    {
+      m_blockListReply = m_api->getBlockList(m_container, m_blobName, "uncommitted", m_timeoutInSec);
+      if (m_blockListReply != nullptr)
+      {
+        QNetworkReply* reply = m_blockListReply;
+        QObject::connect(reply, &QNetworkReply::finished, this, [this, reply]() { onBlockListFinished(reply); });
+        return;
+      }
+    }
+  }
+
+  emit progress(m_bytesUploaded, m_fileSize);
+  startNextBlocks();
+}
+
+// ------------------------------------- PRIVATE -------------------------------------
+
+void QAzureStorageUploadJob::onBlockListFinished(QNetworkReply* reply)
+{
+  reply->deleteLater();
+  if (isFinished() || reply != m_blockListReply)
+  {
+    return;
+  }
+  m_blockListReply = nullptr;
+
+  if (QAzureStorageRestApi::isErrorCodeSuccess(reply->error()))
+  {
+    QSet<QString> uncommittedBlocks;
+    const QList< QMap<QString,QString> > blocks = QAzureStorageRestApi::parseBlockList(reply->readAll());
+    for (const QMap<QString,QString>& block : blocks)
+    {
+      uncommittedBlocks.insert(block.value("Name"));
+    }
+
+    const QStringList completedBlocks = m_journal.completedBlocks();
+    for (const QString& completedBlock : completedBlocks)
+    {
+      for (int i = 0; i < m_pendingBlocks.size(); ++i)
+      {
+        if (blockId(m_pendingBlocks[i]) == completedBlock && uncommittedBlocks.contains(completedBlock))
+        {
+          m_bytesUploaded += qMin(m_blockSizeInBytes, m_fileSize - m_pendingBlocks[i] * m_blockSizeInBytes);
+          m_pendingBlocks.removeAt(i);
+          break;
+        }
+      }
+    }
+  }
+  else
+  {
+    // Not a reason to fail the upload: all blocks are uploaded again
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageUploadJob] Failed to get uncommitted blocks of" << m_container + "/" + m_blobName << "(error code" << reply->error() << ")";
+  }
+
+  emit progress(m_bytesUploaded, m_fileSize);
+  startNextBlocks();
+}
+
+void QAzureStorageUploadJob::startNextBlocks()
+{
+  while (!isFinished() && !m_pendingBlocks.isEmpty() && m_runningBlocks.count() + m_compressingBlocks.count() < m_maxParallelBlocks)
+  {
+    int blockIndex = m_pendingBlocks.takeFirst();
+
+    // Only the blocks being uploaded are kept in memory
+    QByteArray blockContent;
+    if (m_file.seek(blockIndex * m_blockSizeInBytes))
+    {
+      blockContent = m_file.read(qMin(m_blockSizeInBytes, m_fileSize - blockIndex * m_blockSizeInBytes));
+    }
+
+    if (blockContent.isEmpty())
+    {
+      qCWarning(lcAzureStorageTransfer) << "[QAzureStorageUploadJob] Failed to read local file" << m_file.fileName() << ":" << m_file.errorString();
+      finish(QNetworkReply::NetworkError::UnknownContentError);
+      return;
+    }
+
+    // Compressed in a worker thread while the other blocks are uploaded
+    if (m_compressContent)
+    {
+      m_compressingBlocks.insert(blockIndex);
+      m_compressionPool.start(new CompressionTask(this, blockIndex, blockContent));
+    }
+    else
+    {
+      uploadBlock(blockIndex, blockContent);
+    }
+  }
+
+  if (!isFinished() && m_pendingBlocks.isEmpty() && m_runningBlocks.isEmpty() && m_compressingBlocks.isEmpty() && m_commitReply == nullptr)
+  {
+    QStringList blockIds;
+    for (int blockIndex = 0; blockIndex < m_blockCount; ++blockIndex)
+    {
+      blockIds.append(blockId(blockIndex));
+    }
+
+    m_commitReply = m_api->commitBlockList(m_container, m_blobName, blockIds, m_compressContent ? "gzip" : QString(), m_timeoutInSec);
+    if (m_commitReply == nullptr)
+    {
+      finish(QNetworkReply::NetworkError::UnknownNetworkError);
+      return;
+    }
+
+    QNetworkReply* reply = m_commitReply;
+    QObject::connect(reply, &QNetworkReply::finished, this, [this, reply]() { onCommitFinished(reply); });
+  }
+}
+
+void QAzureStorageUploadJob::onBlockCompressed(int blockIndex, const QByteArray& compressedContent)
+{
+  if (isFinished() || !m_compressingBlocks.remove(blockIndex))
+  {
+    return;
+  }
+
+  if (compressedContent.isEmpty())
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageUploadJob] Failed to compress block" << blockIndex;
+    finish(QNetworkReply::NetworkError::UnknownContentError);
+    return;
+  }
+
+  uploadBlock(blockIndex, compressedContent);
+  startNextBlocks();
+}
+
+void QAzureStorageUploadJob::uploadBlock(const int& blockIndex, const QByteArray& blockContent)
+{
+  QNetworkReply* reply = m_api->uploadBlock(m_container, m_blobName, blockId(blockIndex), blockContent, m_timeoutInSec, &m_bandwidthLimiter);
+  if (reply == nullptr)
+  {
+    finish(QNetworkReply::NetworkError::UnknownNetworkError);
+    return;
+  }
+
+  m_runningBlocks.insert(reply, blockIndex);
+  QObject::connect(reply, &QNetworkReply::finished, this, [this, reply]() { onBlockFinished(reply); });
+}
+
+void QAzureStorageUploadJob::onBlockFinished(QNetworkReply* reply)
+{
+  reply->deleteLater();
+  if (isFinished() || !m_runningBlocks.contains(reply))
+  {
+    return;
+  }
+
+  int blockIndex = m_runningBlocks.take(reply);
+  if (!QAzureStorageRestApi::isErrorCodeSuccess(reply->error()))
+  {
+    finish(reply->error());
+    return;
+  }
+
+  if (m_journal.isEnabled() && !m_journal.addCompletedBlock(blockId(blockIndex)))
+  {
+    qCWarning(lcAzureStorageTransfer) << "[QAzureStorageUploadJob] Failed to journal block" << blockIndex;
+  }
+
+  m_bytesUploaded += qMin(m_blockSizeInBytes, m_fileSize - blockIndex * m_blockSizeInBytes);
+  emit progress(m_bytesUploaded, m_fileSize);
+
+  startNextBlocks();
+}
+
+void QAzureStorageUploadJob::onCommitFinished(QNetworkReply* reply)
+{
+  reply->deleteLater();
+  if (isFinished() || reply != m_commitReply)
+  {
+    return;
+  }
+  m_commitReply = nullptr;
+
+  if (QAzureStorageRestApi::isErrorCodeSuccess(reply->error()))
+  {
+    m_etag = QString::fromLatin1(reply->rawHeader("ETag"));
+    m_journal.remove();
+  }
+
+  finish(reply->error());
+}
+
+void QAzureStorageUploadJob::cleanup()
+{
+  m_pendingBlocks.clear();
+  m_compressingBlocks.clear();
+
+  // Stop the remaining requests (their finished signal is ignored since the job is finished)
+  QList<QNetworkReply*> runningReplies = m_runningBlocks.keys();
+  m_runningBlocks.clear();
+  if (m_blockListReply != nullptr)
+  {
+    runningReplies.append(m_blockListReply);
+    m_blockListReply = nullptr;
+  }
+  if (m_commitReply != nullptr)
+  {
+    runningReplies.append(m_commitReply);
+    m_commitReply = nullptr;
+  }
+
+  for (QNetworkReply* reply : runningReplies)
+  {
+    reply->abort();
+  }
+
+  if (m_file.isOpen())
+  {
+    m_file.close();
+  }
+}
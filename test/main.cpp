@@ -14,6 +14,28 @@
 #include <QDebug>
 
 #include <QAzureStorageRestApi.h>
+#include <QAzureStorageDownloadJob.h>
+#include <QAzureStorageUploadJob.h>
+#include <QAzureStorageAppendBlobWriter.h>
+#include <QAzureStoragePageBlobUploadJob.h>
+#include <QAzureStorageDirectoryUploadJob.h>
+#include <QAzureStorageDirectoryDownloadJob.h>
+#include <QAzureStorageSyncManifest.h>
+#include <QAzureStorageSyncJob.h>
+#include <QAzureStorageInventory.h>
+#include <QAzureStorageAvroReader.h>
+#include <QAzureStorageChangeFeedCursor.h>
+#include <QAzureStorageChangeFeedJob.h>
+#include <QAzureStorageListJob.h>
+#include <QAzureStoragePartitionedListJob.h>
+#include <QAzureStorageFindByTagsJob.h>
+#include <QAzureStorageTransferJournal.h>
+#include <QAzureStorageChecksum.h>
+#include <QAzureStorageCompression.h>
+#include <QAzureStorageMetrics.h>
+#include <QAzureStorageLogging.h>
+#include <QAzureStorageTracer.h>
+#include <QAzureStorageBandwidthLimiter.h>
 
 TEST_CASE("Create instance")
 {
@@ -35,6 +57,326 @@ TEST_CASE("Update credentials")
     api.updateCredentials(username, pass);
 }
 
+TEST_CASE("Request headers")
+{
+    QString username("fakeUser");
+    QString pass("ZmFrZVBhc3M=");
+    QString container = "invalidContainer";
+
+    QAzureStorageRestApi api(username, pass);
+
+    QNetworkReply* reply = api.listFiles(container);
+    REQUIRE(reply != nullptr);
+    REQUIRE(reply->request().rawHeader("x-ms-version") == QByteArray("2021-04-10"));
+    REQUIRE(reply->request().rawHeader("Content-Length") == QByteArray("0"));
+    REQUIRE(!reply->request().rawHeader("x-ms-date").isEmpty());
+    REQUIRE(reply->request().rawHeader("Authorization").startsWith("SharedKey fakeUser:"));
+
+    reply = api.downloadFile(container, "invalidBlolName");
+    REQUIRE(reply != nullptr);
+    REQUIRE(reply->request().rawHeader("Authorization").startsWith("SharedKey fakeUser:"));
+
+    // No shared key signature with SAS credentials
+    api.updateCredentials("fakeUser2", "sv=2022-11-02&sr=c&sig=fakeSig", false);
+    reply = api.listFiles(container);
+    REQUIRE(reply != nullptr);
+    REQUIRE(!reply->request().hasRawHeader("Authorization"));
+    REQUIRE(reply->request().rawHeader("x-ms-version") == QByteArray("2021-04-10"));
+}
+
+TEST_CASE("Request templates")
+{
+    QString username("fakeUser");
+    QString pass("ZmFrZVBhc3M=");
+    QString container = "invalidContainer";
+
+    QAzureStorageRestApi api(username, pass);
+
+    QNetworkReply* reply = api.listContainers("nextMarker", 30);
+    REQUIRE(reply != nullptr);
+    REQUIRE(reply->url().toString(QUrl::RemoveQuery) == "https://fakeuser.blob.core.windows.net/");
+    REQUIRE(reply->url().query(QUrl::FullyDecoded) == "comp=list&marker=nextMarker&timeout=30");
+
+    reply = api.createContainer(container);
+    REQUIRE(reply != nullptr);
+    REQUIRE(reply->url().toString() == "https://fakeuser.blob.core.windows.net/invalidContainer?restype=container");
+
+    reply = api.deleteContainer(container, "leaseId");
+    REQUIRE(reply != nullptr);
+    REQUIRE(reply->request().rawHeader("x-ms-lease-id") == QByteArray("leaseId"));
+
+    reply = api.uploadFileQByteArray("content", container, "folder/file name.txt", "BlockBlob", 10);
+    REQUIRE(reply != nullptr);
+    REQUIRE(reply->url().path(QUrl::FullyEncoded) == "/invalidContainer/folder/file%20name.txt");
+    REQUIRE(reply->url().query() == "timeout=10");
+    REQUIRE(reply->request().rawHeader("x-ms-blob-type") == QByteArray("BlockBlob"));
+    REQUIRE(reply->request().rawHeader("Content-Length") == QByteArray("7"));
+
+    // The SAS credentials are added to every request
+    api.updateCredentials("fakeUser2", "fakeSig", false);
+    reply = api.deleteFile(container, "file.txt");
+    REQUIRE(reply != nullptr);
+    REQUIRE(reply->url().toString() == "https://fakeuser2.blob.core.windows.net/invalidContainer/file.txt?sig=fakeSig");
+}
+
+TEST_CASE("Connection options")
+{
+    QString username("fakeUser");
+    QString pass("fakePass");
+    QString container = "invalidContainer";
+
+    QAzureStorageRestApi api(username, pass);
+
+    api.setHttp2Allowed(true);
+    REQUIRE(api.isHttp2Allowed());
+    QNetworkReply* reply = api.listFiles(container);
+    REQUIRE(reply != nullptr);
+    REQUIRE(reply->request().attribute(QNetworkRequest::Http2AllowedAttribute).toBool());
+
+    api.setMaxConnectionsPerHost(16);
+    REQUIRE(api.maxConnectionsPerHost() == 16);
+
+    REQUIRE(api.networkAccessManagerCount() == 1);
+    api.setNetworkAccessManagerCount(0);
+    REQUIRE(api.networkAccessManagerCount() == 1);
+    api.setNetworkAccessManagerCount(3);
+    REQUIRE(api.networkAccessManagerCount() == 3);
+
+    // The requests are sent by each manager in turn
+    QNetworkReply* reply1 = api.listFiles(container);
+    QNetworkReply* reply2 = api.listFiles(container);
+    QNetworkReply* reply3 = api.listFiles(container);
+    QNetworkReply* reply4 = api.listFiles(container);
+    REQUIRE(reply1->manager() != reply2->manager());
+    REQUIRE(reply2->manager() != reply3->manager());
+    REQUIRE(reply1->manager() != reply3->manager());
+    REQUIRE(reply4->manager() == reply1->manager());
+}
+
+TEST_CASE("Connection warm up")
+{
+    QString username("fakeUser");
+    QString pass("fakePass");
+
+    QAzureStorageRestApi api(username, pass);
+    api.setNetworkAccessManagerCount(2);
+    api.warmUp(4);
+
+    REQUIRE(api.keepWarmInterval() == 0);
+    api.setKeepWarmInterval(30000, 2);
+    REQUIRE(api.keepWarmInterval() == 30000);
+    api.setKeepWarmInterval(0);
+    REQUIRE(api.keepWarmInterval() == 0);
+}
+
+TEST_CASE("Request metrics")
+{
+    QString username("fakeUser");
+    QString pass("fakePass");
+    QString container = "invalidContainer";
+    QString blob = "invalidBlolName";
+
+    QAzureStorageRestApi api(username, pass);
+
+    QList<QAzureStorageRestApi::RequestMetrics> measuredRequests;
+    QObject::connect(&api, &QAzureStorageRestApi::requestFinished, [&measuredRequests](const QAzureStorageRestApi::RequestMetrics& metrics) {
+        measuredRequests.append(metrics);
+    });
+
+    QNetworkReply::NetworkError error = api.deleteFileSynchronous(container, blob, 10);
+    REQUIRE(!QAzureStorageRestApi::isErrorCodeSuccess(error));
+
+    REQUIRE(measuredRequests.count() == 1);
+    REQUIRE(measuredRequests[0].operation == "DeleteBlob");
+    REQUIRE(measuredRequests[0].httpVerb == "DELETE");
+    REQUIRE(measuredRequests[0].resourcePath == "/invalidContainer/invalidBlolName");
+    REQUIRE(measuredRequests[0].buildTimeInUs >= 0);
+    REQUIRE(measuredRequests[0].totalTimeInUs >= 0);
+    REQUIRE(measuredRequests[0].error != QNetworkReply::NetworkError::NoError);
+}
+
+TEST_CASE("Metrics")
+{
+    QAzureStorageMetrics metrics;
+    REQUIRE(metrics.requestCount() == 0);
+    REQUIRE(metrics.latencyPercentileInUs(50) == -1);
+
+    for (int i = 0; i < 9; ++i)
+    {
+        metrics.recordRequestStarted();
+        metrics.recordRequestFinished("GetBlob", 200, 1500, 0, 1000);
+    }
+    metrics.recordRequestStarted();
+    metrics.recordRequestFinished("PutBlock", 503, 3000000, 4096, 0);
+    metrics.recordRequestStarted();
+    metrics.recordRetry();
+
+    REQUIRE(metrics.requestCount() == 10);
+    REQUIRE(metrics.requestCount("GetBlob") == 9);
+    REQUIRE(metrics.requestCount("PutBlock") == 1);
+    REQUIRE(metrics.sentBytes() == 4096);
+    REQUIRE(metrics.receivedBytes() == 9000);
+    REQUIRE(metrics.inFlightRequests() == 1);
+    REQUIRE(metrics.retryCount() == 1);
+    REQUIRE(metrics.throttledCount() == 1);
+
+    // 4 buckets per power of two: 1500 us is in [1280, 1536[ and 3 s in [2.62, 3.15[
+    REQUIRE(metrics.latencyPercentileInUs(50) == 1536);
+    REQUIRE(metrics.latencyPercentileInUs(100) == 3145728);
+    REQUIRE(metrics.latencyPercentileInUs(99, "GetBlob") == 1536);
+
+    QByteArray text = metrics.toPrometheusText();
+    REQUIRE(text.contains("# TYPE qazurestorage_request_duration_seconds histogram\n"));
+    REQUIRE(text.contains("qazurestorage_request_duration_seconds_bucket{operation=\"GetBlob\",status=\"2xx\",le=\"0.001536\"} 9\n"));
+    REQUIRE(text.contains("qazurestorage_request_duration_seconds_count{operation=\"PutBlock\",status=\"5xx\"} 1\n"));
+    REQUIRE(!text.contains("operation=\"DeleteBlob\""));
+    REQUIRE(text.contains("qazurestorage_in_flight_requests 1\n"));
+    REQUIRE(text.contains("qazurestorage_throttled_requests_total 1\n"));
+
+    metrics.reset();
+    REQUIRE(metrics.requestCount() == 0);
+    REQUIRE(metrics.inFlightRequests() == 1);
+
+    QString username("fakeUser");
+    QString pass("fakePass");
+    QAzureStorageRestApi api(username, pass);
+    REQUIRE(api.metrics() == nullptr);
+    api.setMetricsEnabled(true);
+    REQUIRE(api.isMetricsEnabled());
+    REQUIRE(api.metrics() != nullptr);
+
+    api.deleteFileSynchronous("invalidContainer", "invalidBlolName", 10);
+    REQUIRE(api.metrics()->requestCount("DeleteBlob") == 1);
+    REQUIRE(api.metrics()->inFlightRequests() == 0);
+}
+
+class TestTracer : public QAzureStorageTracer
+{
+public:
+    void startSpan(Span& span) override
+    {
+        span.context = startedSpans.count();
+        startedSpans.append(span);
+    }
+
+    void endSpan(Span& span) override
+    {
+        endedSpans.append(span);
+    }
+
+    QList<Span> startedSpans;
+    QList<Span> endedSpans;
+};
+
+TEST_CASE("Tracing")
+{
+    QString username("fakeUser");
+    QString pass("fakePass");
+    QString container = "invalidContainer";
+    QString blob = "invalidFolder/invalidBlolName";
+
+    QAzureStorageRestApi api(username, pass);
+    REQUIRE(api.tracer() == nullptr);
+
+    TestTracer tracer;
+    api.setTracer(&tracer);
+    REQUIRE(api.tracer() == &tracer);
+
+    api.deleteFileSynchronous(container, blob, 10);
+
+    REQUIRE(tracer.startedSpans.count() == 1);
+    REQUIRE(tracer.endedSpans.count() == 1);
+
+    const QAzureStorageTracer::Span& span = tracer.endedSpans[0];
+    REQUIRE(span.name == "DeleteBlob");
+    REQUIRE(span.context.toInt() == 0);
+    REQUIRE(span.clientRequestId.size() == 36);
+    REQUIRE(span.attributes.value("az.client_request_id").toString() == QString::fromLatin1(span.clientRequestId));
+    REQUIRE(span.attributes.value("http.request.method").toString() == "DELETE");
+    REQUIRE(span.attributes.value("az.storage.container").toString() == container);
+    REQUIRE(span.attributes.value("az.storage.blob").toString() == blob);
+    REQUIRE(span.endTimeInUs >= span.startTimeInUs);
+    REQUIRE(span.isError);
+
+    api.setTracer(nullptr);
+    api.deleteFileSynchronous(container, blob, 10);
+    REQUIRE(tracer.startedSpans.count() == 1);
+}
+
+TEST_CASE("Logging")
+{
+    REQUIRE(QString(lcAzureStorageUrl().categoryName()) == "qazurestorage.url");
+    REQUIRE(QString(lcAzureStorageAuth().categoryName()) == "qazurestorage.auth");
+    REQUIRE(QString(lcAzureStorageTransfer().categoryName()) == "qazurestorage.transfer");
+    REQUIRE(QString(lcAzureStorageParse().categoryName()) == "qazurestorage.parse");
+
+    // Debug messages are not built unless enabled
+    REQUIRE(!lcAzureStorageUrl().isDebugEnabled());
+    REQUIRE(lcAzureStorageUrl().isInfoEnabled());
+    REQUIRE(lcAzureStorageTransfer().isWarningEnabled());
+
+    REQUIRE(QAzureStorageLogging::redactSasSignature("https://fakeuser.blob.core.windows.net/container/file?timeout=30&sv=2021-04-10&sig=abc%2Bdef&se=2030")
+            == "https://fakeuser.blob.core.windows.net/container/file?timeout=30&sv=2021-04-10&sig=REDACTED&se=2030");
+    REQUIRE(QAzureStorageLogging::redactSasSignature("sig=abcdef") == "sig=REDACTED");
+    REQUIRE(QAzureStorageLogging::redactSasSignature("https://fakeuser.blob.core.windows.net/container/file?comp=list&design=1")
+            == "https://fakeuser.blob.core.windows.net/container/file?comp=list&design=1");
+}
+
+TEST_CASE("Bandwidth limiter")
+{
+    QAzureStorageBandwidthLimiter unlimited;
+    REQUIRE(!unlimited.isLimited());
+    REQUIRE(unlimited.acquire(100 * 1024 * 1024) == 100 * 1024 * 1024);
+    REQUIRE(unlimited.waitTimeInMs(1024) == 0);
+
+    // The bucket holds 100 ms of bandwidth
+    QAzureStorageBandwidthLimiter global(1000 * 1000);
+    REQUIRE(global.isLimited());
+    REQUIRE(global.rate() == 1000 * 1000);
+    REQUIRE(global.acquire(1000) == 1000);
+    REQUIRE(global.acquire(1000 * 1000) < 1000 * 1000);
+    REQUIRE(global.waitTimeInMs(50 * 1000) > 0);
+
+    // The bytes granted to a transfer are also taken from its parent
+    QAzureStorageBandwidthLimiter parent(10 * 1000 * 1000);
+    QAzureStorageBandwidthLimiter transfer(0, &parent);
+    REQUIRE(transfer.isLimited());
+    REQUIRE(transfer.acquire(600 * 1000) == 600 * 1000);
+    REQUIRE(parent.acquire(600 * 1000) < 600 * 1000);
+
+    transfer.setRate(-1);
+    REQUIRE(transfer.rate() == 0);
+    parent.setRate(0);
+    REQUIRE(!transfer.isLimited());
+
+    QAzureStorageBandwidthLimiter deviceLimiter(1000 * 1000);
+    QIODevice* device = deviceLimiter.createThrottledDevice(QByteArray(1024, 'a'));
+    REQUIRE(device->isOpen());
+    REQUIRE(device->isSequential());
+    REQUIRE(device->readAll() == QByteArray(1024, 'a'));
+    REQUIRE(device->atEnd());
+    delete device;
+
+    QString username("fakeUser");
+    QString pass("fakePass");
+    QAzureStorageRestApi api(username, pass);
+    REQUIRE(api.uploadBandwidthLimit() == 0);
+    REQUIRE(api.downloadBandwidthLimit() == 0);
+    api.setUploadBandwidthLimit(1024 * 1024);
+    api.setDownloadBandwidthLimit(2 * 1024 * 1024);
+    REQUIRE(api.uploadBandwidthLimit() == 1024 * 1024);
+    REQUIRE(api.downloadBandwidthLimit() == 2 * 1024 * 1024);
+    REQUIRE(api.uploadBandwidthLimiter()->isLimited());
+
+    QAzureStorageDownloadJob* job = api.downloadFileToPath("invalidContainer", "invalidBlolName", "dummyDownload.bin");
+    REQUIRE(job != nullptr);
+    REQUIRE(job->bandwidthLimit() == 0);
+    job->setBandwidthLimit(512 * 1024);
+    REQUIRE(job->bandwidthLimit() == 512 * 1024);
+    job->abort();
+    job->deleteLater();
+}
+
 TEST_CASE("Upload file (invalid path)")
 {
     QString username("fakeUser");
@@ -62,6 +404,70 @@ TEST_CASE("List files")
     qDebug() << "Error response: " << reply->error();
 }
 
+TEST_CASE("Walk files")
+{
+    QString username("fakeUser");
+    QString pass("fakePass");
+    QString container = "invalidContainer";
+
+    QAzureStorageRestApi api(username, pass);
+
+    QNetworkReply* reply = api.listFiles(container, QString(), "folder/", 10, -1, "/");
+    REQUIRE(reply != nullptr);
+    REQUIRE(reply->url().query(QUrl::FullyDecoded).contains("delimiter=/"));
+    REQUIRE(reply->url().query(QUrl::FullyDecoded).contains("maxresults=10"));
+
+    REQUIRE(api.walkFiles("") == nullptr);
+    QAzureStorageListJob* job = api.walkFiles(container, "folder/");
+    REQUIRE(job != nullptr);
+    job->abort();
+    REQUIRE(job->isFinished());
+    job->deleteLater();
+
+    QByteArray fileList("<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+                        "<EnumerationResults ContainerName=\"mycontainer\"><Prefix>folder/</Prefix><Delimiter>/</Delimiter><Blobs>"
+                        "<Blob><Name>folder/file.txt</Name></Blob>"
+                        "<BlobPrefix><Name>folder/sub1/</Name></BlobPrefix>"
+                        "<BlobPrefix><Name>folder/sub2/</Name></BlobPrefix>"
+                        "</Blobs><NextMarker>nextMarker</NextMarker></EnumerationResults>");
+    QString nextMarker;
+    QStringList folders;
+    QList< QMap<QString,QString> > files = QAzureStorageRestApi::parseFileList(fileList, &nextMarker, &folders);
+    REQUIRE(files.count() == 1);
+    REQUIRE(files[0]["Name"] == "folder/file.txt");
+    REQUIRE(folders == QStringList({"folder/sub1/", "folder/sub2/"}));
+    REQUIRE(nextMarker == "nextMarker");
+}
+
+TEST_CASE("List files in parallel")
+{
+    QString username("fakeUser");
+    QString pass("fakePass");
+    QString container = "invalidContainer";
+
+    QAzureStorageRestApi api(username, pass);
+
+    REQUIRE(api.listFilesParallel("") == nullptr);
+    QAzureStoragePartitionedListJob* job = api.listFilesParallel(container, "logs/", "0123456789abcdef");
+    REQUIRE(job != nullptr);
+    REQUIRE(!job->isComplete());
+    job->abort();
+    REQUIRE(job->isFinished());
+    REQUIRE(!job->isComplete());
+    job->deleteLater();
+
+    QList< QMap<QString,QString> > files;
+    bool isComplete = true;
+    REQUIRE(!QAzureStorageRestApi::isErrorCodeSuccess(api.listFilesParallelSynchronous(container, files, &isComplete, "logs/", "", "/", 2, 30)));
+    REQUIRE(!isComplete);
+
+    REQUIRE(QAzureStoragePartitionedListJob::partitionPrefixes("logs/", "ba1b") == QStringList({"logs/1", "logs/a", "logs/b"}));
+    REQUIRE(QAzureStoragePartitionedListJob::isListedBefore("a", "a/b"));
+    REQUIRE(QAzureStoragePartitionedListJob::isListedBefore("a.txt", "a/"));
+    REQUIRE(QAzureStoragePartitionedListJob::isListedBefore("Z", "a"));
+    REQUIRE(!QAzureStoragePartitionedListJob::isListedBefore("b", "a/"));
+}
+
 TEST_CASE("Upload file")
 {
     QString username("fakeUser");
@@ -100,6 +506,723 @@ TEST_CASE("Download file")
     qDebug() << "Error response: " << reply->error();
 }
 
+TEST_CASE("Download file to path")
+{
+    QString username("fakeUser");
+    QString pass("fakePass");
+    QString container = "invalidContainer";
+    QString blob = "invalidBlolName";
+
+    QAzureStorageRestApi api(username, pass);
+
+    REQUIRE(api.downloadFileToPath(container, blob, "") == nullptr);
+    REQUIRE(api.downloadFileToPath(container, blob, "dummyDownload.bin", 0) == nullptr);
+
+    QAzureStorageDownloadJob* job = api.downloadFileToPath(container, blob, "dummyDownload.bin");
+    REQUIRE(job != nullptr);
+    REQUIRE(!job->isFinished());
+    REQUIRE(job->fileSize() == -1);
+
+    job->abort();
+    REQUIRE(job->isFinished());
+    REQUIRE(job->error() == QNetworkReply::NetworkError::OperationCanceledError);
+    job->deleteLater();
+
+    QNetworkReply* reply = api.downloadFileRange(container, blob, 0, 1024);
+    REQUIRE(reply != nullptr);
+    REQUIRE(reply->request().rawHeader("x-ms-range") == QByteArray("bytes=0-1023"));
+    REQUIRE(api.downloadFileRange(container, blob, 0, 0) == nullptr);
+}
+
+TEST_CASE("Download prefix")
+{
+    QString username("fakeUser");
+    QString pass("fakePass");
+    QString container = "invalidContainer";
+
+    QAzureStorageRestApi api(username, pass);
+
+    REQUIRE(api.downloadPrefix("", "backup", "dummyRestore") == nullptr);
+    REQUIRE(api.downloadPrefix(container, "backup", "") == nullptr);
+
+    QAzureStorageDirectoryDownloadJob* job = api.downloadPrefix(container, "backup", "dummyRestore");
+    REQUIRE(job != nullptr);
+    REQUIRE(!job->isListingFinished());
+    REQUIRE(job->localFilePath("backup/a/b.txt") == "dummyRestore/a/b.txt");
+    REQUIRE(job->localFilePath("backup/a/../b.txt") == "dummyRestore/b.txt");
+    REQUIRE(job->localFilePath("backup/../../evil.txt").isEmpty());
+    REQUIRE(job->localFilePath("backupOther/b.txt").isEmpty());
+    REQUIRE(job->localFilePath("backup/").isEmpty());
+    job->abort();
+    REQUIRE(job->isFinished());
+    job->deleteLater();
+
+    // The listing fails (fake account): no file is downloaded
+    QMap<QString, QNetworkReply::NetworkError> failedFiles;
+    REQUIRE(!QAzureStorageRestApi::isErrorCodeSuccess(api.downloadPrefixSynchronous(container, "backup", "dummyRestore", &failedFiles, 4, 30)));
+    REQUIRE(failedFiles.isEmpty());
+
+    QDir("dummyRestore").removeRecursively();
+}
+
+TEST_CASE("Upload file in blocks")
+{
+    QString username("fakeUser");
+    QString pass("fakePass");
+    QString container = "invalidContainer";
+    QString blob = "invalidBlolName";
+
+    QAzureStorageRestApi api(username, pass);
+
+    REQUIRE(api.uploadFileInBlocks("invalidPath", container, blob) == nullptr);
+
+    QString path = "dummyBlocks.txt";
+    QFile file(path);
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    file.write(QByteArray(1024, 'a'));
+    file.close();
+
+    QAzureStorageUploadJob* job = api.uploadFileInBlocks(path, container, blob, 256);
+    REQUIRE(job != nullptr);
+    job->abort();
+    REQUIRE(job->isFinished());
+    REQUIRE(job->etag().isEmpty());
+
+    REQUIRE(QAzureStorageUploadJob::blockId(0).size() == QAzureStorageUploadJob::blockId(49999).size());
+    REQUIRE(QAzureStorageUploadJob::blockId(1) != QAzureStorageUploadJob::blockId(2));
+
+    QNetworkReply* reply = api.uploadBlock(container, blob, QAzureStorageUploadJob::blockId(0), QByteArray("content"));
+    REQUIRE(reply != nullptr);
+    REQUIRE(reply->url().query(QUrl::FullyDecoded).contains("blockid=" + QAzureStorageUploadJob::blockId(0)));
+}
+
+TEST_CASE("Upload directory")
+{
+    QString username("fakeUser");
+    QString pass("fakePass");
+    QString container = "invalidContainer";
+
+    QAzureStorageRestApi api(username, pass);
+
+    REQUIRE(api.uploadDirectory("invalidPath", container) == nullptr);
+
+    QDir directory("dummyDirectory");
+    REQUIRE(directory.mkpath("sub"));
+    const QStringList paths = { "a.txt", "b.txt", "sub/c.bin" };
+    for (const QString& path : paths)
+    {
+        QFile file(directory.filePath(path));
+        REQUIRE(file.open(QIODevice::WriteOnly));
+        file.write(QByteArray(100, 'a'));
+    }
+
+    REQUIRE(api.uploadDirectory(directory.path(), "") == nullptr);
+    QAzureStorageDirectoryUploadJob* job = api.uploadDirectory(directory.path(), container, "backup");
+    REQUIRE(job != nullptr);
+    REQUIRE(job->fileCount() == -1);
+    REQUIRE(job->blobName("sub/c.bin") == "backup/sub/c.bin");
+    job->abort();
+    REQUIRE(job->isFinished());
+    job->deleteLater();
+
+    QMap<QString, QNetworkReply::NetworkError> failedFiles;
+    QNetworkReply::NetworkError result = api.uploadDirectorySynchronous(directory.path(), container, "backup/", &failedFiles, 2, 30);
+    REQUIRE(!QAzureStorageRestApi::isErrorCodeSuccess(result));
+    if (result != QNetworkReply::NetworkError::TimeoutError)
+    {
+        REQUIRE(failedFiles.keys() == paths);
+    }
+
+    REQUIRE(directory.removeRecursively());
+}
+
+TEST_CASE("Sync")
+{
+    QAzureStorageSyncManifest::Entry localFile;
+    localFile.size = 100;
+    localFile.modifiedInMs = 2000;
+    QAzureStorageSyncManifest::Entry remoteFile;
+    remoteFile.size = 100;
+    remoteFile.modifiedInMs = 1000;
+    remoteFile.etag = "0x8D4BCC2E4835CD0";
+    QAzureStorageSyncManifest::Entry manifestEntry;
+
+    // Without MD5 of the blob: the most recent side wins
+    REQUIRE(QAzureStorageSyncJob::compare(QAzureStorageRestApi::SyncUpload, localFile, remoteFile, manifestEntry) == QAzureStorageSyncJob::Changed);
+    REQUIRE(QAzureStorageSyncJob::compare(QAzureStorageRestApi::SyncDownload, localFile, remoteFile, manifestEntry) == QAzureStorageSyncJob::Unchanged);
+
+    // Same state as after the last synchronization
+    manifestEntry = localFile;
+    manifestEntry.etag = remoteFile.etag;
+    REQUIRE(QAzureStorageSyncJob::compare(QAzureStorageRestApi::SyncUpload, localFile, remoteFile, manifestEntry) == QAzureStorageSyncJob::Unchanged);
+    manifestEntry.etag = "0x8D4BCC2E4835CD1";
+
+    // With MD5 of the blob
+    remoteFile.md5 = "sQqNsWTgdUEFt6mb5y4/5Q==";
+    REQUIRE(QAzureStorageSyncJob::compare(QAzureStorageRestApi::SyncUpload, localFile, remoteFile, manifestEntry) == QAzureStorageSyncJob::NeedsLocalMd5);
+    localFile.md5 = remoteFile.md5;
+    REQUIRE(QAzureStorageSyncJob::compare(QAzureStorageRestApi::SyncUpload, localFile, remoteFile, manifestEntry) == QAzureStorageSyncJob::Unchanged);
+    localFile.md5 = "CY9rzUYh03PK3k6DJie09g==";
+    REQUIRE(QAzureStorageSyncJob::compare(QAzureStorageRestApi::SyncDownload, localFile, remoteFile, manifestEntry) == QAzureStorageSyncJob::Changed);
+
+    // Different size
+    localFile.size = 101;
+    REQUIRE(QAzureStorageSyncJob::compare(QAzureStorageRestApi::SyncDownload, localFile, remoteFile, manifestEntry) == QAzureStorageSyncJob::Changed);
+
+    QString manifestPath = "dummyManifest.txt";
+    QFile::remove(manifestPath);
+
+    {
+        QAzureStorageSyncManifest manifest(manifestPath);
+        REQUIRE(!manifest.load("sync 1"));
+        manifest.setEntry("sub dir/a file.txt", localFile);
+        manifest.setEntry("-", remoteFile);
+        REQUIRE(manifest.save());
+    }
+
+    {
+        // Same synchronization: entries are loaded
+        QAzureStorageSyncManifest manifest(manifestPath);
+        REQUIRE(manifest.load("sync 1"));
+        REQUIRE(manifest.entries().keys() == QStringList({"-", "sub dir/a file.txt"}));
+        REQUIRE(manifest.entry("sub dir/a file.txt").size == 101);
+        REQUIRE(manifest.entry("sub dir/a file.txt").modifiedInMs == 2000);
+        REQUIRE(manifest.entry("sub dir/a file.txt").md5 == "CY9rzUYh03PK3k6DJie09g==");
+        REQUIRE(manifest.entry("sub dir/a file.txt").etag.isEmpty());
+        REQUIRE(manifest.entry("-").etag == remoteFile.etag);
+        REQUIRE(manifest.entry("missing").size == -1);
+    }
+
+    {
+        // Other synchronization: entries are discarded
+        QAzureStorageSyncManifest manifest(manifestPath);
+        REQUIRE(!manifest.load("sync 2"));
+        REQUIRE(manifest.entries().isEmpty());
+    }
+
+    REQUIRE(QFile::remove(manifestPath));
+    REQUIRE(!QAzureStorageSyncManifest().isEnabled());
+
+    QAzureStorageRestApi api("fakeUser", "fakePass");
+    REQUIRE(api.sync("invalidPath", "invalidContainer", "backup", QAzureStorageRestApi::SyncUpload) == nullptr);
+    REQUIRE(api.sync(".", "", "backup", QAzureStorageRestApi::SyncUpload) == nullptr);
+
+    QAzureStorageSyncJob* job = api.sync(".", "invalidContainer", "backup", QAzureStorageRestApi::SyncUpload, true);
+    REQUIRE(job != nullptr);
+    job->abort();
+    REQUIRE(job->isFinished());
+    REQUIRE(job->transferredFileCount() == 0);
+    job->deleteLater();
+}
+
+TEST_CASE("Append blob")
+{
+    QString username("fakeUser");
+    QString pass("fakePass");
+    QString container = "invalidContainer";
+    QString blob = "invalidBlolName";
+
+    QAzureStorageRestApi api(username, pass);
+
+    QNetworkReply* reply = api.createAppendBlob(container, blob);
+    REQUIRE(reply != nullptr);
+    REQUIRE(reply->request().rawHeader("x-ms-blob-type") == QByteArray("AppendBlob"));
+
+    REQUIRE(api.appendBlock(container, blob, QByteArray()) == nullptr);
+    reply = api.appendBlock(container, blob, QByteArray("content"), 42);
+    REQUIRE(reply != nullptr);
+    REQUIRE(reply->url().query(QUrl::FullyDecoded).contains("comp=appendblock"));
+    REQUIRE(reply->request().rawHeader("x-ms-blob-condition-appendpos") == QByteArray("42"));
+
+    QAzureStorageAppendBlobWriter writer(&api, container, blob, true, 1000, 4);
+    REQUIRE(writer.blobSize() == -1);
+    writer.write(QByteArray("line1\n"));
+    writer.write(QByteArray("line2\n"));
+    REQUIRE(writer.pendingBytes() == 12);
+    REQUIRE(!writer.isFailed());
+}
+
+TEST_CASE("Page blob")
+{
+    QString username("fakeUser");
+    QString pass("fakePass");
+    QString container = "invalidContainer";
+    QString blob = "invalidBlolName";
+
+    QAzureStorageRestApi api(username, pass);
+
+    REQUIRE(api.createPageBlob(container, blob, 1000) == nullptr);
+    QNetworkReply* reply = api.createPageBlob(container, blob, 1024);
+    REQUIRE(reply != nullptr);
+    REQUIRE(reply->request().rawHeader("x-ms-blob-content-length") == QByteArray("1024"));
+
+    REQUIRE(api.uploadPages(container, blob, 512, QByteArray(100, 'a')) == nullptr);
+    reply = api.uploadPages(container, blob, 512, QByteArray(1024, 'a'));
+    REQUIRE(reply != nullptr);
+    REQUIRE(reply->request().rawHeader("x-ms-range") == QByteArray("bytes=512-1535"));
+    REQUIRE(reply->request().rawHeader("x-ms-page-write") == QByteArray("update"));
+
+    QByteArray page(QAzureStoragePageBlobUploadJob::pageSizeInBytes, '\0');
+    REQUIRE(QAzureStoragePageBlobUploadJob::isZero(page.constData(), page.size()));
+    REQUIRE(QAzureStoragePageBlobUploadJob::isZero(page.constData(), 0));
+    page[page.size() - 1] = 1;
+    REQUIRE(!QAzureStoragePageBlobUploadJob::isZero(page.constData(), page.size()));
+    page[page.size() - 1] = 0;
+    page[0] = 1;
+    REQUIRE(!QAzureStoragePageBlobUploadJob::isZero(page.constData(), page.size()));
+
+    REQUIRE(api.uploadFileAsPageBlob("invalidPath", container, blob) == nullptr);
+
+    QString path = "dummyDisk.img";
+    QFile file(path);
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    file.write(QByteArray(4096, '\0'));
+    file.write(QByteArray(100, 'a'));
+    file.close();
+
+    QAzureStoragePageBlobUploadJob* job = api.uploadFileAsPageBlob(path, container, blob);
+    REQUIRE(job != nullptr);
+    job->abort();
+    REQUIRE(job->isFinished());
+    job->deleteLater();
+}
+
+TEST_CASE("Page blob download")
+{
+    QString username("fakeUser");
+    QString pass("fakePass");
+    QString container = "invalidContainer";
+    QString blob = "invalidBlolName";
+
+    QAzureStorageRestApi api(username, pass);
+
+    QNetworkReply* reply = api.getPageRanges(container, blob, "2023-11-08T10:00:00.0000000Z");
+    REQUIRE(reply != nullptr);
+    REQUIRE(reply->url().query(QUrl::FullyDecoded).contains("comp=pagelist"));
+    REQUIRE(reply->url().query(QUrl::FullyDecoded).contains("prevsnapshot=2023-11-08T10:00:00.0000000Z"));
+
+    REQUIRE(api.downloadPageBlobToPath(container, blob, "") == nullptr);
+    QAzureStorageDownloadJob* job = api.downloadPageBlobToPath(container, blob, "dummyDisk.img");
+    REQUIRE(job != nullptr);
+    job->abort();
+    REQUIRE(job->isFinished());
+    job->deleteLater();
+
+    QByteArray xmlPageRanges("<?xml version=\"1.0\" encoding=\"utf-8\"?><PageList>"
+                             "<PageRange><Start>0</Start><End>511</End></PageRange>"
+                             "<ClearRange><Start>512</Start><End>1023</End></ClearRange>"
+                             "<PageRange><Start>4096</Start><End>8191</End></PageRange>"
+                             "<NextMarker>nextMarker</NextMarker></PageList>");
+    QString nextMarker;
+    QList< QMap<QString,QString> > pageRanges = QAzureStorageRestApi::parsePageRanges(xmlPageRanges, &nextMarker);
+    REQUIRE(pageRanges.size() == 3);
+    REQUIRE(pageRanges[0]["Type"] == "PageRange");
+    REQUIRE(pageRanges[0]["End"] == "511");
+    REQUIRE(pageRanges[1]["Type"] == "ClearRange");
+    REQUIRE(pageRanges[1]["Start"] == "512");
+    REQUIRE(pageRanges[2]["Start"] == "4096");
+    REQUIRE(nextMarker == "nextMarker");
+}
+
+TEST_CASE("Transfer journal")
+{
+    QString path = "dummyJournal.txt";
+    QFile::remove(path);
+
+    {
+        QAzureStorageTransferJournal journal(path);
+        REQUIRE(journal.isEnabled());
+        REQUIRE(!journal.open("transfer 1"));
+        REQUIRE(journal.addCompletedBlock("MDAwMDAwMDA="));
+        REQUIRE(journal.addCompletedRange(0, 4096));
+        REQUIRE(journal.addCompletedRange(4096, 100));
+    }
+
+    {
+        // Same transfer: completed parts are resumed
+        QAzureStorageTransferJournal journal(path);
+        REQUIRE(journal.open("transfer 1"));
+        REQUIRE(journal.completedBlocks() == QStringList({"MDAwMDAwMDA="}));
+        REQUIRE(journal.completedRanges() == QMap<qint64,qint64>({{0, 4096}, {4096, 100}}));
+    }
+
+    {
+        // Same download but local file deleted: the journal is reset instead of keeping ranges not in the file
+        QString localPath = "dummyJournalDownload.bin";
+        QFile::remove(localPath);
+        {
+            QAzureStorageTransferJournal journal(path);
+            REQUIRE(!journal.openForLocalFile("transfer 1", localPath, 16384));
+            REQUIRE(journal.completedRanges().isEmpty());
+            REQUIRE(journal.addCompletedRange(8192, 4096));
+        }
+
+        // Resumed again after a second crash (local file pre-sized): only the ranges written after the reset are skipped
+        QFile localFile(localPath);
+        REQUIRE(localFile.open(QIODevice::WriteOnly));
+        REQUIRE(localFile.resize(16384));
+        localFile.close();
+        QAzureStorageTransferJournal resumedJournal(path);
+        REQUIRE(resumedJournal.openForLocalFile("transfer 1", localPath, 16384));
+        REQUIRE(resumedJournal.completedBlocks().isEmpty());
+        REQUIRE(resumedJournal.completedRanges() == QMap<qint64,qint64>({{8192, 4096}}));
+        REQUIRE(QFile::remove(localPath));
+    }
+
+    {
+        // Other transfer: completed parts are discarded
+        QAzureStorageTransferJournal journal(path);
+        REQUIRE(!journal.open("transfer 2"));
+        REQUIRE(journal.completedBlocks().isEmpty());
+        REQUIRE(journal.completedRanges().isEmpty());
+        journal.remove();
+    }
+
+    REQUIRE(!QFile::exists(path));
+    REQUIRE(!QAzureStorageTransferJournal().isEnabled());
+}
+
+TEST_CASE("Inventory")
+{
+    QString path = "dummyInventory.bin";
+    QFile::remove(path);
+
+    REQUIRE(QAzureStorageRestApi::parseDateTime("Wed, 09 Sep 2009 09:20:02 GMT").toMSecsSinceEpoch() == Q_INT64_C(1252488002000));
+    REQUIRE(!QAzureStorageRestApi::parseDateTime("invalid").isValid());
+
+    QList< QMap<QString,QString> > files;
+    const QStringList names = { "photos/b.jpg", "photos/a.jpg", "docs/report.pdf", "photos/2023/c.jpg", "photos-old/d.jpg" };
+    for (int i = 0; i < names.size(); ++i)
+    {
+        QMap<QString,QString> file;
+        file.insert("Name", names[i]);
+        file.insert("Content-Length", QString::number((i + 1) * 100));
+        file.insert("Last-Modified", "Wed, 09 Sep 2009 09:20:02 GMT");
+        file.insert("Etag", QString("0x8D4BCC2E4835CD%1").arg(i));
+        files.append(file);
+    }
+
+    {
+        QAzureStorageInventory inventory(path);
+        REQUIRE(!inventory.open("container"));
+        REQUIRE(inventory.count() == 0);
+        REQUIRE(inventory.totalSize("") == 0);
+        REQUIRE(inventory.replacePrefix("", files));
+        REQUIRE(inventory.isOpen());
+        REQUIRE(inventory.count() == 5);
+    }
+
+    {
+        // Mapped again: sorted names, point lookups, prefix queries and sizes per prefix
+        QAzureStorageInventory inventory(path);
+        REQUIRE(inventory.open("container"));
+        REQUIRE(inventory.entryAt(0).name == "docs/report.pdf");
+        REQUIRE(inventory.entryAt(1).name == "photos-old/d.jpg");
+
+        QAzureStorageInventory::Entry entry;
+        REQUIRE(inventory.find("photos/a.jpg", &entry));
+        REQUIRE(entry.size == 200);
+        REQUIRE(entry.modifiedInMs == Q_INT64_C(1252488002000));
+        REQUIRE(entry.etag == "0x8D4BCC2E4835CD1");
+        REQUIRE(!inventory.find("photos/"));
+        REQUIRE(!inventory.find("photos/a.jpg2"));
+
+        REQUIRE(inventory.fileCount("photos/") == 3);
+        REQUIRE(inventory.totalSize("photos/") == 100 + 200 + 400);
+        REQUIRE(inventory.totalSize("photos") == 100 + 200 + 400 + 500);
+        REQUIRE(inventory.totalSize("") == 1500);
+        REQUIRE(inventory.fileCount("videos/") == 0);
+        REQUIRE(inventory.filesWithPrefix("photos/", 2).size() == 2);
+        REQUIRE(inventory.filesWithPrefix("photos/").last().name == "photos/b.jpg");
+
+        // Refresh of a prefix: the other files are kept
+        REQUIRE(inventory.replacePrefix("photos/", QList< QMap<QString,QString> >({ files[1] })));
+        REQUIRE(inventory.count() == 3);
+        REQUIRE(inventory.fileCount("photos/") == 1);
+        REQUIRE(inventory.find("docs/report.pdf"));
+        REQUIRE(inventory.find("photos-old/d.jpg"));
+
+        QMap<QString,QString> updatedFile = files[2];
+        updatedFile.insert("Content-Length", "42");
+        QMap<QString,QString> newFile = files[0];
+        newFile.insert("Name", "a.txt");
+        REQUIRE(inventory.applyChanges(QList< QMap<QString,QString> >({ updatedFile, newFile }), QStringList({ "photos/b.jpg" })));
+        REQUIRE(inventory.count() == 4);
+        REQUIRE(inventory.entryAt(0).name == "a.txt");
+        REQUIRE(inventory.find("docs/report.pdf", &entry));
+        REQUIRE(entry.size == 42);
+        REQUIRE(!inventory.find("photos/b.jpg"));
+    }
+
+    {
+        // Failed refresh (no network): the files of the prefix are kept, including names outside any partition alphabet
+        QAzureStorageInventory inventory(path);
+        REQUIRE(inventory.open("container"));
+        QMap<QString,QString> outsideFile = files[1];
+        outsideFile.insert("Name", "photos/_thumbs.db");
+        REQUIRE(inventory.applyChanges(QList< QMap<QString,QString> >({ files[0], outsideFile }), QStringList()));
+
+        QString username("fakeUser");
+        QString pass("fakePass");
+        QAzureStorageRestApi api(username, pass);
+        REQUIRE(!QAzureStorageRestApi::isErrorCodeSuccess(api.refreshInventorySynchronous(inventory, "photos/", 2, 30)));
+        REQUIRE(inventory.find("photos/_thumbs.db"));
+        REQUIRE(inventory.find("photos/b.jpg"));
+    }
+
+    {
+        // Inventory of another container
+        QAzureStorageInventory inventory(path);
+        REQUIRE(!inventory.open("otherContainer"));
+        REQUIRE(inventory.count() == 0);
+    }
+
+    {
+        // Truncated inventory
+        QFile file(path);
+        REQUIRE(file.resize(50));
+        QAzureStorageInventory inventory(path);
+        REQUIRE(!inventory.open("container"));
+    }
+
+    REQUIRE(QFile::remove(path));
+    REQUIRE(!QAzureStorageInventory().isEnabled());
+}
+
+TEST_CASE("Change feed")
+{
+    // Avro object container file (zigzag varint longs, null codec)
+    const auto avroLong = [](qint64 value) -> QByteArray
+    {
+        QByteArray result;
+        quint64 zigzag = (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63);
+        do
+        {
+            char byte = static_cast<char>(zigzag & 0x7F);
+            zigzag >>= 7;
+            result.append(zigzag != 0 ? static_cast<char>(byte | 0x80) : byte);
+        } while (zigzag != 0);
+        return result;
+    };
+    const auto avroString = [&avroLong](const QByteArray& value) -> QByteArray { return avroLong(value.size()) + value; };
+
+    const QByteArray schema = "{\"type\":\"record\",\"name\":\"BlobChangeEvent\",\"namespace\":\"com.microsoft.storage\",\"fields\":["
+                              "{\"name\":\"eventType\",\"type\":{\"type\":\"enum\",\"name\":\"EventType\",\"symbols\":[\"BlobCreated\",\"BlobDeleted\"]}},"
+                              "{\"name\":\"subject\",\"type\":\"string\"},"
+                              "{\"name\":\"eventTime\",\"type\":\"string\"},"
+                              "{\"name\":\"data\",\"type\":{\"type\":\"map\",\"values\":[\"null\",\"string\",\"long\"]}}]}";
+    const QByteArray syncMarker = "0123456789abcdef";
+    const auto avroFile = [&](const QByteArray& codec, const QList<QByteArray>& blocks) -> QByteArray
+    {
+        QByteArray file = QByteArray("Obj") + '\x01';
+        file += avroLong(2) + avroString("avro.schema") + avroString(schema) + avroString("avro.codec") + avroString(codec) + avroLong(0);
+        file += syncMarker;
+        for (const QByteArray& block : blocks)
+        {
+            file += block + syncMarker;
+        }
+        return file;
+    };
+    const auto avroEvent = [&](qint64 eventType, const QByteArray& blob, qint64 contentLength) -> QByteArray
+    {
+        return avroLong(eventType) + avroString("/blobServices/default/containers/container/blobs/" + blob) + avroString("2023-11-08T10:00:00Z")
+               + avroLong(2) + avroString("contentLength") + avroLong(2) + avroLong(contentLength)
+               + avroString("snapshot") + avroLong(0) + avroLong(0);
+    };
+
+    const auto avroBlock = [&avroLong](qint64 count, const QByteArray& records) -> QByteArray { return avroLong(count) + avroLong(records.size()) + records; };
+
+    const QByteArray file = avroFile("null", { avroBlock(2, avroEvent(0, "a.txt", 42) + avroEvent(1, "b.txt", 0)),
+                                               avroBlock(1, avroEvent(0, "dir/c.txt", 300)) });
+
+    {
+        // Fed byte by byte: records are decoded as soon as their block is complete
+        QAzureStorageAvroReader reader;
+        QList<QVariant> records;
+        for (int i = 0; i < file.size(); ++i)
+        {
+            REQUIRE(reader.append(file.mid(i, 1)));
+            records += reader.takeRecords();
+        }
+        REQUIRE(reader.isHeaderRead());
+        REQUIRE(reader.isComplete());
+        REQUIRE(records.size() == 3);
+        REQUIRE(records[0].toMap().value("eventType").toString() == "BlobCreated");
+        REQUIRE(records[1].toMap().value("eventType").toString() == "BlobDeleted");
+        REQUIRE(records[2].toMap().value("subject").toString() == "/blobServices/default/containers/container/blobs/dir/c.txt");
+        REQUIRE(records[2].toMap().value("data").toMap().value("contentLength").toLongLong() == 300);
+        REQUIRE(records[2].toMap().value("data").toMap().value("snapshot").isNull());
+    }
+
+    {
+        QAzureStorageAvroReader reader;
+        REQUIRE(reader.append(file.left(file.size() - 5)));
+        REQUIRE(reader.takeRecords().size() == 2);
+        REQUIRE(!reader.isComplete());
+    }
+
+    {
+        QAzureStorageAvroReader reader;
+        REQUIRE(!reader.append(QByteArray("Obj") + '\x02' + file.mid(4)));
+        REQUIRE(reader.hasError());
+
+        QAzureStorageAvroReader deflateReader;
+        REQUIRE(!deflateReader.append(avroFile("deflate", {})));
+        REQUIRE(!deflateReader.errorString().isEmpty());
+    }
+
+    {
+        QString path = "dummyChangeFeedCursor.txt";
+        QFile::remove(path);
+
+        QAzureStorageChangeFeedCursor cursor(path);
+        REQUIRE(!cursor.load());
+        REQUIRE(cursor.segmentPath().isEmpty());
+        cursor.setSegment("idx/segments/2023/11/08/1000/meta.json", false);
+        cursor.setShardPosition("log/00/2023/11/08/1000/", "log/00/2023/11/08/1000/00000.avro", 12);
+        REQUIRE(cursor.save());
+
+        QAzureStorageChangeFeedCursor loadedCursor(path);
+        REQUIRE(loadedCursor.load());
+        REQUIRE(loadedCursor.segmentPath() == "idx/segments/2023/11/08/1000/meta.json");
+        REQUIRE(!loadedCursor.isSegmentDone());
+        QString chunkPath;
+        qint64 eventCount = 0;
+        loadedCursor.shardPosition("log/00/2023/11/08/1000/", chunkPath, eventCount);
+        REQUIRE(chunkPath == "log/00/2023/11/08/1000/00000.avro");
+        REQUIRE(eventCount == 12);
+
+        // Next segment: positions of the shards are reset
+        loadedCursor.setSegment("idx/segments/2023/11/08/1100/meta.json", false);
+        loadedCursor.shardPosition("log/00/2023/11/08/1000/", chunkPath, eventCount);
+        REQUIRE(chunkPath.isEmpty());
+        REQUIRE(eventCount == 0);
+
+        REQUIRE(QFile::remove(path));
+    }
+
+    QString container;
+    QString blobName;
+    REQUIRE(QAzureStorageChangeFeedJob::parseSubject("/blobServices/default/containers/container/blobs/dir/c.txt", container, blobName));
+    REQUIRE(container == "container");
+    REQUIRE(blobName == "dir/c.txt");
+    REQUIRE(!QAzureStorageChangeFeedJob::parseSubject("/blobServices/default/containers/container", container, blobName));
+
+    QString username("fakeUser");
+    QString pass("fakePass");
+    QAzureStorageRestApi api(username, pass);
+    QAzureStorageChangeFeedJob* job = api.readChangeFeed("", "container");
+    REQUIRE(job != nullptr);
+    job->abort();
+    REQUIRE(job->isFinished());
+    job->deleteLater();
+}
+
+TEST_CASE("Transactional checksum")
+{
+    // Azure CRC64 check value
+    REQUIRE(QAzureStorageChecksum::crc64(QByteArray("123456789")) == Q_UINT64_C(0xAE8B14860A799888));
+    REQUIRE(QAzureStorageChecksum::crc64(QByteArray()) == 0);
+
+    // Incremental computation
+    QByteArray content;
+    for (int i = 0; i < 1000; ++i)
+    {
+        content.append(static_cast<char>(i * 7 + 3));
+    }
+    REQUIRE(QAzureStorageChecksum::crc64(content.mid(333), QAzureStorageChecksum::crc64(content.left(333))) == QAzureStorageChecksum::crc64(content));
+
+    REQUIRE(QAzureStorageChecksum::crc64ToBase64(Q_UINT64_C(0x0807060504030201)) == QString("AQIDBAUGBwg="));
+    REQUIRE(QAzureStorageChecksum::md5ToBase64(QByteArray()) == QString("1B2M2Y8AsgTpgAmY7PhCfg=="));
+
+    QAzureStorageRestApi api("fakeUser", "fakePass");
+    REQUIRE(api.transactionalChecksum() == QAzureStorageRestApi::NoChecksum);
+
+    api.setTransactionalChecksum(QAzureStorageRestApi::Crc64Checksum);
+    QNetworkReply* reply = api.uploadFileQByteArray(QByteArray("123456789"), "invalidContainer", "invalidBlolName");
+    REQUIRE(reply != nullptr);
+    REQUIRE(reply->request().rawHeader("x-ms-content-crc64") == QAzureStorageChecksum::crc64ToBase64(Q_UINT64_C(0xAE8B14860A799888)).toLatin1());
+
+    api.setTransactionalChecksum(QAzureStorageRestApi::Md5Checksum);
+    reply = api.uploadBlock("invalidContainer", "invalidBlolName", QAzureStorageUploadJob::blockId(0), QByteArray());
+    REQUIRE(reply == nullptr);
+    reply = api.uploadFileQByteArray(QByteArray(), "invalidContainer", "invalidBlolName");
+    REQUIRE(reply != nullptr);
+    REQUIRE(reply->request().rawHeader("Content-MD5") == QByteArray("1B2M2Y8AsgTpgAmY7PhCfg=="));
+}
+
+TEST_CASE("Content compression")
+{
+    REQUIRE(QAzureStorageChecksum::crc32(QByteArray("123456789")) == 0xCBF43926u);
+
+    QByteArray firstBlock;
+    for (int i = 0; i < 100000; ++i)
+    {
+        firstBlock.append("{\"key\":\"value\"},"[i % 16]);
+    }
+    QByteArray secondBlock("last block");
+
+    // Blocks compressed independently make a valid gzip file (one member per block)
+    QByteArray compressed = QAzureStorageCompression::gzip(firstBlock) + QAzureStorageCompression::gzip(secondBlock);
+    REQUIRE(compressed.startsWith("\x1f\x8b\x08"));
+    REQUIRE(compressed.size() < firstBlock.size() / 10);
+    REQUIRE(QAzureStorageCompression::gzip(QByteArray()).isEmpty());
+
+    // Decompression while receiving the content
+    QAzureStorageGzipDecoder decoder;
+    QByteArray decompressed;
+    for (int offset = 0; offset < compressed.size(); offset += 1000)
+    {
+        REQUIRE(decoder.decode(compressed.mid(offset, 1000), decompressed));
+    }
+    REQUIRE(decoder.isComplete());
+    REQUIRE(decompressed == firstBlock + secondBlock);
+
+    // Corrupted content (CRC32 of the last member)
+    compressed[compressed.size() - 8] = static_cast<char>(compressed.at(compressed.size() - 8) ^ 0x01);
+    QAzureStorageGzipDecoder corruptedDecoder;
+    decompressed.clear();
+    REQUIRE(!corruptedDecoder.decode(compressed, decompressed));
+    REQUIRE(!corruptedDecoder.isStandardGzip());
+
+    // Standard gzip content ("abc" with a file name, no extra field) is detected on its first member so that it can be downloaded as is
+    const QByteArray standardGzip = QByteArray::fromHex("1f8b08080000000002ff612e747874004b4c4a0600c241243503000000");
+    QAzureStorageGzipDecoder standardDecoder;
+    decompressed.clear();
+    REQUIRE(!standardDecoder.decode(standardGzip, decompressed));
+    REQUIRE(standardDecoder.isStandardGzip());
+
+    QAzureStorageGzipDecoder mixedDecoder;
+    decompressed.clear();
+    REQUIRE(!mixedDecoder.decode(QAzureStorageCompression::gzip(secondBlock) + standardGzip, decompressed));
+    REQUIRE(!mixedDecoder.isStandardGzip());
+
+    QAzureStorageRestApi api("fakeUser", "fakePass");
+    REQUIRE(!api.isContentCompressionEnabled());
+    api.setContentCompression(true);
+    QNetworkReply* reply = api.uploadFileQByteArray(firstBlock, "invalidContainer", "invalidBlolName");
+    REQUIRE(reply != nullptr);
+    REQUIRE(reply->request().rawHeader("x-ms-blob-content-encoding") == QByteArray("gzip"));
+}
+
+TEST_CASE("Parse block list")
+{
+    QByteArray blockList("<?xml version=\"1.0\" encoding=\"utf-8\"?>\
+                          <BlockList>\
+                            <CommittedBlocks>\
+                              <Block><Name>MDAwMDAwMDA=</Name><Size>4194304</Size></Block>\
+                            </CommittedBlocks>\
+                            <UncommittedBlocks>\
+                              <Block><Name>MDAwMDAwMDE=</Name><Size>1024</Size></Block>\
+                            </UncommittedBlocks>\
+                          </BlockList>");
+
+    QList< QMap<QString,QString> > res = QAzureStorageRestApi::parseBlockList(blockList);
+    REQUIRE(res.count() == 2);
+    REQUIRE(res[0] == QMap<QString,QString>({{"Name", "MDAwMDAwMDA="}, {"Size", "4194304"}, {"Type", "Committed"}}));
+    REQUIRE(res[1] == QMap<QString,QString>({{"Name", "MDAwMDAwMDE="}, {"Size", "1024"}, {"Type", "Uncommitted"}}));
+}
+
 TEST_CASE("Parse file list")
 {
     QByteArray fileList;
@@ -170,6 +1293,102 @@ TEST_CASE("Parse file list")
     REQUIRE(res[1] == QMap<QString,QString>({{"FakeKey", "FakeValue"}, {"FakeKey2", "FakeValue2"}, {"Name", "blob-name-2"}}));
 }
 
+TEST_CASE("Parse file list with metadata and tags")
+{
+    QString username("fakeUser");
+    QString pass("fakePass");
+    QString container = "invalidContainer";
+
+    QAzureStorageRestApi api(username, pass);
+
+    QAzureStorageRestApi::ListIncludeOptions include;
+    REQUIRE(include.toString().isEmpty());
+    include.metadata = true;
+    include.tags = true;
+    include.deleted = true;
+    REQUIRE(include.toString() == "deleted,metadata,tags");
+
+    QNetworkReply* reply = api.listFiles(container, QString(), QString(), -1, -1, QString(), include);
+    REQUIRE(reply != nullptr);
+    REQUIRE(reply->url().query(QUrl::FullyDecoded).contains("include=deleted,metadata,tags"));
+
+    QByteArray fileList("<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+                        "<EnumerationResults ContainerName=\"mycontainer\"><Blobs>"
+                        "<Blob><Name>blob-name</Name>"
+                        "<Properties><Content-Length>42</Content-Length><Content-MD5 /></Properties>"
+                        "<Metadata><Name>metadata-name</Name><Owner>tenant1</Owner></Metadata>"
+                        "<Tags><TagSet><Tag><Key>status</Key><Value>done</Value></Tag><Tag><Key>date</Key><Value>2023-11-08</Value></Tag></TagSet></Tags>"
+                        "</Blob>"
+                        "<Blob><Name>blob-name-2</Name><Metadata /></Blob>"
+                        "</Blobs><NextMarker /></EnumerationResults>");
+
+    QList< QMap<QString,QString> > res = QAzureStorageRestApi::parseFileList(fileList);
+    REQUIRE(res.count() == 2);
+    REQUIRE(res[0]["Name"] == "blob-name");
+    REQUIRE(res[0]["Content-Length"] == "42");
+    REQUIRE(res[0].contains("Content-MD5"));
+    REQUIRE(res[0]["Metadata:Name"] == "metadata-name");
+    REQUIRE(res[0]["Metadata:Owner"] == "tenant1");
+    REQUIRE(res[0]["Tags:status"] == "done");
+    REQUIRE(res[0]["Tags:date"] == "2023-11-08");
+    REQUIRE(res[1] == QMap<QString,QString>({{"Name", "blob-name-2"}}));
+}
+
+TEST_CASE("Blob index tags")
+{
+    QString username("fakeUser");
+    QString pass("fakePass");
+    QString container = "invalidContainer";
+    QString blob = "invalidBlolName";
+
+    QAzureStorageRestApi api(username, pass);
+
+    QMap<QString,QString> tags({{"tenant", "abc"}, {"status", "a<b"}});
+    QNetworkReply* reply = api.setFileTags(container, blob, tags);
+    REQUIRE(reply != nullptr);
+    REQUIRE(reply->url().query(QUrl::FullyDecoded).contains("comp=tags"));
+    REQUIRE(api.setFileTags("", blob, tags) == nullptr);
+
+    reply = api.getFileTags(container, blob);
+    REQUIRE(reply != nullptr);
+
+    QString where("\"tenant\" = 'abc' AND \"status\" = 'done'");
+    REQUIRE(api.findFilesByTags("") == nullptr);
+    reply = api.findFilesByTags(where);
+    REQUIRE(reply != nullptr);
+    REQUIRE(reply->url().path() == "/");
+    REQUIRE(reply->url().query(QUrl::FullyDecoded).contains("comp=blobs"));
+    REQUIRE(reply->url().query(QUrl::FullyDecoded).contains("where=" + where));
+    REQUIRE(!reply->url().query(QUrl::FullyDecoded).contains("restype=container"));
+
+    reply = api.findFilesByTags(where, container, "nextMarker", 100);
+    REQUIRE(reply != nullptr);
+    REQUIRE(reply->url().path() == "/" + container);
+    REQUIRE(reply->url().query(QUrl::FullyDecoded).contains("restype=container"));
+    REQUIRE(reply->url().query(QUrl::FullyDecoded).contains("marker=nextMarker"));
+
+    QAzureStorageFindByTagsJob* job = api.findAllFilesByTags(where, container);
+    REQUIRE(job != nullptr);
+    job->abort();
+    REQUIRE(job->isFinished());
+    job->deleteLater();
+
+    QByteArray xmlTags("<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+                       "<Tags><TagSet><Tag><Key>tenant</Key><Value>abc</Value></Tag><Tag><Key>status</Key><Value>a&lt;b</Value></Tag></TagSet></Tags>");
+    REQUIRE(QAzureStorageRestApi::parseTags(xmlTags) == tags);
+
+    QByteArray foundFiles("<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+                          "<EnumerationResults ServiceEndpoint=\"https://myaccount.blob.core.windows.net/\"><Where>\"tenant\"='abc'</Where><Blobs>"
+                          "<Blob><Name>file.txt</Name><ContainerName>mycontainer</ContainerName>"
+                          "<Tags><TagSet><Tag><Key>tenant</Key><Value>abc</Value></Tag></TagSet></Tags></Blob>"
+                          "</Blobs><NextMarker>nextMarker</NextMarker></EnumerationResults>");
+    QString nextMarker;
+    QList< QMap<QString,QString> > files = QAzureStorageRestApi::parseFileList(foundFiles, &nextMarker);
+    REQUIRE(files.count() == 1);
+    REQUIRE(files[0] == QMap<QString,QString>({{"Name", "file.txt"}, {"ContainerName", "mycontainer"}, {"Tags:tenant", "abc"}}));
+    REQUIRE(nextMarker == "nextMarker");
+}
+
 int main(int argc, char* argv[])
 {
     QCoreApplication a(argc, argv);